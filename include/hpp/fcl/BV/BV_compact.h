@@ -0,0 +1,153 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_BV_COMPACT_H
+#define HPP_FCL_BV_COMPACT_H
+
+#include <hpp/fcl/BV/BV.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// @brief Storage of a bounding volume in the split node layout of BVHModel
+/// (see BVH_LAYOUT_SPLIT).
+///
+/// By default the volume is stored as is. The specializations store it in
+/// single precision, enlarged so that the decoded volume contains the
+/// original one.
+template<typename BV>
+struct CompactBV
+{
+  BV bv;
+
+  void set(const BV& bv_) { bv = bv_; }
+
+  /// @brief Get the volume. The specializations decode it in buffer.
+  const BV& get(BV&) const { return bv; }
+};
+
+/// @brief AABB in single precision, rounded outwards.
+template<>
+struct CompactBV<AABB>
+{
+  float min_[3];
+  float max_[3];
+
+  void set(const AABB& bv);
+
+  const AABB& get(AABB& bv) const
+  {
+    bv.min_ << min_[0], min_[1], min_[2];
+    bv.max_ << max_[0], max_[1], max_[2];
+    return bv;
+  }
+};
+
+/// @brief OBB in single precision. The extents cover the rounding of the
+/// frame.
+template<>
+struct CompactBV<OBB>
+{
+  float axes[9];
+  float To[3];
+  float extent[3];
+
+  void set(const OBB& bv);
+
+  const OBB& get(OBB& bv) const
+  {
+    bv.axes << axes[0], axes[1], axes[2],
+               axes[3], axes[4], axes[5],
+               axes[6], axes[7], axes[8];
+    bv.To << To[0], To[1], To[2];
+    bv.extent << extent[0], extent[1], extent[2];
+    return bv;
+  }
+};
+
+/// @brief RSS in single precision. The radius covers the rounding of the
+/// frame.
+template<>
+struct CompactBV<RSS>
+{
+  float axes[9];
+  float Tr[3];
+  float length[2];
+  float radius;
+
+  void set(const RSS& bv);
+
+  const RSS& get(RSS& bv) const
+  {
+    bv.axes << axes[0], axes[1], axes[2],
+               axes[3], axes[4], axes[5],
+               axes[6], axes[7], axes[8];
+    bv.Tr << Tr[0], Tr[1], Tr[2];
+    bv.length[0] = length[0];
+    bv.length[1] = length[1];
+    bv.radius = radius;
+    return bv;
+  }
+};
+
+template<>
+struct CompactBV<OBBRSS>
+{
+  CompactBV<OBB> obb;
+  CompactBV<RSS> rss;
+
+  void set(const OBBRSS& bv)
+  {
+    obb.set(bv.obb);
+    rss.set(bv.rss);
+  }
+
+  const OBBRSS& get(OBBRSS& bv) const
+  {
+    obb.get(bv.obb);
+    rss.get(bv.rss);
+    return bv;
+  }
+};
+
+} // namespace details
+} // namespace fcl
+} // namespace hpp
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef HPP_FCL_BV_QUANTIZED_H
+#define HPP_FCL_BV_QUANTIZED_H
+
+#include <hpp/fcl/BV/AABB.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// @brief Node of the quantized layout of BVHModel<AABB> (see
+/// BVH_LAYOUT_QUANTIZED).
+///
+/// The box of the node is stored relative to the decoded box of its parent,
+/// in 16 bits per coordinate: lower[i] is the offset of the lower corner
+/// from the lower corner of the parent, upper[i] the offset of the upper
+/// corner from the upper corner of the parent, both in units of 1 / 65535
+/// of the extent of the parent. The offsets are rounded so that the decoded
+/// box contains the original one.
+struct QuantizedNode
+{
+  unsigned short lower[3];
+  unsigned short upper[3];
+
+  /// @brief Index of the first child, or -(primitive id + 1) for a leaf.
+  int first_child;
+
+  /// @brief Encode box, which must be inside the decoded box of the parent.
+  void set(const AABB& box, const AABB& parent);
+
+  /// @brief Decode the box of the node from the decoded box of its parent.
+  /// box and parent may be the same object.
+  void get(const AABB& parent, AABB& box) const
+  {
+    for(int i = 0; i < 3; ++i)
+    {
+      FCL_REAL step = (parent.max_[i] - parent.min_[i]) * (1. / 65535);
+      FCL_REAL lo = parent.min_[i] + lower[i] * step;
+      FCL_REAL hi = parent.max_[i] - upper[i] * step;
+      box.min_[i] = lo;
+      box.max_[i] = hi;
+    }
+  }
+};
+
+} // namespace details
+} // namespace fcl
+} // namespace hpp
+
+#endif
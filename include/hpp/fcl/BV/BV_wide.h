@@ -0,0 +1,171 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef HPP_FCL_BV_WIDE_H
+#define HPP_FCL_BV_WIDE_H
+
+#include <hpp/fcl/BV/BV.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// @brief One component of the volumes of the four children of a wide node
+typedef Eigen::Array<FCL_REAL, 4, 1, Eigen::DontAlign> WideLanes;
+
+/// @brief Volumes of the children of a node of the 4-ary hierarchy of
+/// BVHModel (see BVH_LAYOUT_WIDE).
+///
+/// By default the volumes are stored side by side and tested one after the
+/// other. The specializations store them component by component, so that
+/// the four children are tested at once with vector instructions.
+template<typename BV>
+struct WideVolumes
+{
+  BV bv[4];
+
+  void set(int i, const BV& bv_) { bv[i] = bv_; }
+
+  /// @brief Test the first count volumes against query.
+  /// @return a mask whose bit i is set if volume i overlaps query.
+  /// @retval sqrDistLowerBound squared lower bound of the distance between
+  ///         query and each disjoint volume.
+  unsigned int overlap(const BV& query, int count,
+                       const CollisionRequest& request,
+                       FCL_REAL sqrDistLowerBound[4]) const
+  {
+    unsigned int mask = 0;
+    for(int i = 0; i < count; ++i)
+      if(bv[i].overlap(query, request, sqrDistLowerBound[i]))
+        mask |= 1u << i;
+    return mask;
+  }
+
+  /// @brief Same test, with query in another frame: a point x of query is
+  /// at R x + T in the frame of the volumes.
+  unsigned int overlap(const Matrix3f& R, const Vec3f& T, const BV& query,
+                       int count, const CollisionRequest& request,
+                       FCL_REAL sqrDistLowerBound[4]) const
+  {
+    unsigned int mask = 0;
+    for(int i = 0; i < count; ++i)
+      if(fcl::overlap(R, T, bv[i], query, request, sqrDistLowerBound[i]))
+        mask |= 1u << i;
+    return mask;
+  }
+};
+
+/// @brief Four AABB, one array per coordinate of their corners.
+template<>
+struct WideVolumes<AABB>
+{
+  WideLanes min_[3];
+  WideLanes max_[3];
+
+  void set(int i, const AABB& bv)
+  {
+    for(int k = 0; k < 3; ++k)
+    {
+      min_[k][i] = bv.min_[k];
+      max_[k][i] = bv.max_[k];
+    }
+  }
+
+  unsigned int overlap(const AABB& query, int count,
+                       const CollisionRequest& request,
+                       FCL_REAL sqrDistLowerBound[4]) const;
+
+  unsigned int overlap(const Matrix3f& R, const Vec3f& T, const AABB& query,
+                       int count, const CollisionRequest& request,
+                       FCL_REAL sqrDistLowerBound[4]) const;
+};
+
+/// @brief Four OBB, one array per coefficient of their axes, centers and
+/// extents.
+template<>
+struct WideVolumes<OBB>
+{
+  /// axes[i][j] is coordinate i of axis j.
+  WideLanes axes[3][3];
+  WideLanes To[3];
+  WideLanes extent[3];
+
+  void set(int i, const OBB& bv)
+  {
+    for(int k = 0; k < 3; ++k)
+    {
+      for(int j = 0; j < 3; ++j)
+        axes[k][j][i] = bv.axes(k, j);
+      To[k][i] = bv.To[k];
+      extent[k][i] = bv.extent[k];
+    }
+  }
+
+  unsigned int overlap(const OBB& query, int count,
+                       const CollisionRequest& request,
+                       FCL_REAL sqrDistLowerBound[4]) const;
+
+  unsigned int overlap(const Matrix3f& R, const Vec3f& T, const OBB& query,
+                       int count, const CollisionRequest& request,
+                       FCL_REAL sqrDistLowerBound[4]) const;
+};
+
+/// @brief Node of the 4-ary hierarchy of BVHModel. Its children are nodes
+/// of the binary hierarchy, two to four levels below the node it collapses.
+template<typename BV>
+struct WideNode
+{
+  /// @brief Volumes of the children
+  WideVolumes<BV> volumes;
+
+  /// @brief Index of each child in the binary hierarchy (see BVHModel::getBV)
+  int children[4];
+
+  /// @brief Wide node of each child, -1 if the child is a leaf
+  int wide_children[4];
+
+  /// @brief Number of children, between 2 and 4
+  int num_children;
+};
+
+} // namespace details
+} // namespace fcl
+} // namespace hpp
+
+#endif
@@ -39,7 +39,7 @@
 #define HPP_FCL_BVH_FRONT_H
 
 
-#include <list>
+#include <vector>
 
 namespace hpp
 {
@@ -66,7 +66,10 @@ struct BVHFrontNode
 };
 
 /// @brief BVH front list is a list of front nodes.
-typedef std::list<BVHFrontNode> BVHFrontList;
+///
+/// The front nodes are stored contiguously: a front list kept across
+/// queries does not allocate memory once its capacity is large enough.
+typedef std::vector<BVHFrontNode> BVHFrontList;
 
 /// @brief Add new front node into the front list
 inline void updateFrontList(BVHFrontList* front_list, int b1, int b2)
@@ -74,6 +77,20 @@ inline void updateFrontList(BVHFrontList* front_list, int b1, int b2)
   if(front_list) front_list->push_back(BVHFrontNode(b1, b2));
 }
 
+/// @brief Remove the front nodes which are not valid anymore, in place and
+/// preserving the order of the other nodes.
+inline void compactFrontList(BVHFrontList* front_list)
+{
+  BVHFrontList::iterator last = front_list->begin();
+  for(BVHFrontList::iterator it = front_list->begin();
+      it != front_list->end(); ++it)
+  {
+    if(it->valid)
+      *last++ = *it;
+  }
+  front_list->erase(last, front_list->end());
+}
+
 
 }
 
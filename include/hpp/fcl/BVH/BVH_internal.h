@@ -81,6 +81,22 @@ enum BVHModelType
     BVH_MODEL_POINTCLOUD            /// @brief point cloud model
   };
 
+/// @brief Algorithm used to build the hierarchy of a BVH model
+enum BVHBuildMethod
+  {
+    BVH_BUILD_TOP_DOWN,             /// @brief recursive splits computed by the split rule
+    BVH_BUILD_LINEAR                /// @brief primitives sorted along a Morton curve (linear BVH)
+  };
+
+/// @brief Storage of the nodes of a BVH model for the traversals
+enum BVHNodeLayout
+  {
+    BVH_LAYOUT_NODES,               /// @brief array of BVNode, holding the children and the volume of each node
+    BVH_LAYOUT_SPLIT,               /// @brief separate arrays of children and of volumes, in single precision when possible
+    BVH_LAYOUT_WIDE,                /// @brief array of BVNode, plus 4-ary nodes holding the volumes of their children side by side
+    BVH_LAYOUT_QUANTIZED            /// @brief array of 16 bytes nodes, holding the children and the box of each node in 16 bit coordinates (AABB only)
+  };
+
 
 }
 
@@ -41,10 +41,18 @@
 #include <hpp/fcl/collision_object.h>
 #include <hpp/fcl/BVH/BVH_internal.h>
 #include <hpp/fcl/BV/BV_node.h>
+#include <hpp/fcl/BV/BV_compact.h>
+#include <hpp/fcl/BV/BV_wide.h>
+#include <hpp/fcl/BV/BV_quantized.h>
 #include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 
+namespace boost
+{
+class barrier;
+}
+
 namespace hpp
 {
 namespace fcl
@@ -171,6 +179,9 @@ public:
   int updateSubModel(const std::vector<Vec3f>& ps);
 
   /// @brief End BVH model update, will also refit or rebuild the bounding volume hierarchy
+  ///
+  /// When few vertices moved, the bottom-up refit only updates the nodes
+  /// above them.
   int endUpdateModel(bool refit = true, bool bottomup = true);
 
   /// @brief Build this Convex<Triangle> representation of this model.
@@ -244,9 +255,21 @@ protected:
   /// @brief Refit the bounding volume hierarchy
   virtual int refitTree(bool bottomup) = 0;
 
+  /// @brief Whether the nodes are kept after a build. Otherwise, a refit
+  /// rebuilds the hierarchy.
+  virtual bool keepsNodes() const = 0;
+
   int num_tris_allocated;
   int num_vertices_allocated;
   int num_vertex_updated; /// for ccd vertex update
+
+  /// @brief Vertices which differ from the previous frame, recorded by
+  /// updateVertex, updateTriangle and updateSubModel.
+  std::vector<int> moved_vertices;
+
+  /// @brief Vertices moved by the previous update. Their volumes still
+  /// contain their position two frames ago.
+  std::vector<int> prev_moved_vertices;
 };
 
 /// @brief A class describing the bounding hierarchy of a mesh model or a point cloud model (which is viewed as a degraded version of mesh)
@@ -261,6 +284,18 @@ public:
   /// @brief Fitting rule to fit a BV node to a set of geometry primitives
   boost::shared_ptr<BVFitter<BV> > bv_fitter;
 
+  /// @brief Algorithm used to build the hierarchy.
+  /// BVH_BUILD_LINEAR is much faster than the default BVH_BUILD_TOP_DOWN,
+  /// which uses bv_splitter, but gives trees of lower quality. It suits
+  /// models rebuilt at every frame, like point clouds from a sensor.
+  BVHBuildMethod build_method;
+
+  /// @brief Number of threads used to build and refit the hierarchy, 0
+  /// meaning one per core. The top levels of the hierarchy are built in
+  /// parallel, and the large levels are refitted in parallel. The result
+  /// does not depend on the number of threads.
+  unsigned int num_build_threads;
+
   /// @brief Constructing an empty BVH
   BVHModel();
 
@@ -272,20 +307,31 @@ public:
   {
     delete [] bvs;
     delete [] primitive_indices;
+    delete [] node_children;
+    delete [] node_volumes;
+    delete [] wide_nodes;
+    delete [] wide_slots;
+    delete [] quantized_nodes;
   }
 
   /// @brief We provide getBV() and getNumBVs() because BVH may be compressed (in future), so we must provide some flexibility here
   
   /// @brief Access the bv giving the its index
+  /// @note Not available with the quantized layout, which frees the nodes
+  ///       (see setNodeLayout).
   const BVNode<BV>& getBV(int id) const
   {
+    assert (bvs != NULL);
     assert (id < num_bvs);
     return bvs[id];
   }
 
   /// @brief Access the bv giving the its index
+  /// @note Not available with the quantized layout, which frees the nodes
+  ///       (see setNodeLayout).
   BVNode<BV>& getBV(int id)
   {
+    assert (bvs != NULL);
     assert (id < num_bvs);
     return bvs[id];
   }
@@ -296,6 +342,99 @@ public:
     return num_bvs;
   }
 
+  /// @brief Set the storage of the nodes read by the traversals.
+  ///
+  /// With BVH_LAYOUT_SPLIT, the model keeps the children and the volumes of
+  /// the nodes in two separate arrays, besides the nodes returned by getBV.
+  /// Both arrays are in the depth-first order of the nodes, with siblings
+  /// adjacent. AABB, OBB, RSS and OBBRSS volumes are stored in single
+  /// precision (see details::CompactBV), which halves the memory read by a
+  /// traversal. The arrays follow the builds and refits of the model.
+  ///
+  /// With BVH_LAYOUT_WIDE, the model also collapses the binary hierarchy
+  /// into a 4-ary one (see getWideNodes), which the collision of two
+  /// meshes, or of a mesh and a shape, traverses instead of the binary one.
+  ///
+  /// With BVH_LAYOUT_QUANTIZED, which only BVHModel<AABB> supports, the
+  /// nodes returned by getBV are freed. The model keeps the children of the
+  /// nodes and their boxes in 16 bit coordinates relative to the box of the
+  /// parent (see details::QuantizedNode), a third of the memory of the boxes.
+  /// The collision of two meshes, or of a mesh and a shape, decodes the
+  /// boxes along the traversal. The other queries decode them from the root
+  /// at each node, and the refits rebuild the hierarchy: this layout is
+  /// meant for large static models.
+  void setNodeLayout(BVHNodeLayout layout);
+
+  /// @brief Get the storage of the nodes read by the traversals
+  BVHNodeLayout getNodeLayout() const
+  {
+    return node_layout;
+  }
+
+  /// @brief Whether node id is a leaf
+  bool isLeaf(int id) const
+  {
+    return firstChild(id) < 0;
+  }
+
+  /// @brief Index of the first child of node id
+  int leftChild(int id) const
+  {
+    return firstChild(id);
+  }
+
+  /// @brief Index of the second child of node id
+  int rightChild(int id) const
+  {
+    return firstChild(id) + 1;
+  }
+
+  /// @brief Primitive of the leaf id
+  int primitiveId(int id) const
+  {
+    return -(firstChild(id) + 1);
+  }
+
+  /// @brief Bounding volume of node id, as read by the traversals. With
+  /// the split and the quantized layouts, the volume may be decoded in
+  /// buffer.
+  const BV& getVolume(int id, BV& buffer) const
+  {
+    if(node_volumes)
+      return node_volumes[id].get(buffer);
+    if(quantized_nodes)
+      return decodeVolume(id, buffer);
+    return bvs[id].bv;
+  }
+
+  /// @brief Whether getVolume decodes the volumes in its buffer, with the
+  /// split and the quantized layouts. Otherwise, the volume of node id is
+  /// getBV(id).bv, and the traversals read it without a buffer.
+  bool decodesVolumes() const
+  {
+    return node_volumes != NULL || quantized_nodes != NULL;
+  }
+
+  /// @brief Nodes of the 4-ary hierarchy with the wide layout, NULL
+  /// otherwise. Node 0 collapses the root of the binary hierarchy, unless
+  /// the root is a leaf.
+  const details::WideNode<BV>* getWideNodes() const
+  {
+    return wide_nodes;
+  }
+
+  /// @brief Nodes of the quantized layout, NULL otherwise.
+  const details::QuantizedNode* getQuantizedNodes() const
+  {
+    return quantized_nodes;
+  }
+
+  /// @brief Box of the root with the quantized layout.
+  const AABB& getQuantizedRoot() const
+  {
+    return quantized_root;
+  }
+
   /// @brief Get the BV type: default is unknown
   NODE_TYPE getNodeType() const { return BV_UNKNOWN; }
 
@@ -304,10 +443,15 @@ public:
 
   /// @brief This is a special acceleration: BVH_model default stores the BV's transform in world coordinate. However, we can also store each BV's transform related to its parent 
   /// BV node. When traversing the BVH, this can save one matrix transformation.
+  ///
+  /// Does nothing with the quantized layout, whose boxes are already
+  /// relative to their parent.
   void makeParentRelative()
   {
+    if(!bvs) return;
     Matrix3f I (Matrix3f::Identity());
     makeParentRelativeRecurse(0, I, Vec3f());
+    updateNodeLayout();
   }
 
 private:
@@ -323,12 +467,57 @@ private:
   /// @brief Number of BV nodes in bounding volume hierarchy
   int num_bvs;
 
+  BVHNodeLayout node_layout;
+
+  /// @brief Children and volumes of the nodes with the split layout, NULL
+  /// otherwise.
+  int* node_children;
+  details::CompactBV<BV>* node_volumes;
+
+  int firstChild(int id) const
+  {
+    if(node_children) return node_children[id];
+    if(quantized_nodes) return quantized_nodes[id].first_child;
+    return bvs[id].first_child;
+  }
+
+  /// @brief Nodes of the wide layout, NULL otherwise. wide_slots[i] is
+  /// 4 * w + k if node i is the child k of the wide node w, -1 otherwise.
+  details::WideNode<BV>* wide_nodes;
+  int num_wide_nodes;
+  int* wide_slots;
+
+  /// @brief Nodes of the quantized layout, NULL otherwise, and the box of
+  /// the root, which the boxes of the other nodes are relative to.
+  details::QuantizedNode* quantized_nodes;
+  AABB quantized_root;
+
+  /// @brief Copy the nodes to the arrays of the split or wide layout, or
+  /// free them.
+  void updateNodeLayout();
+
+  /// @brief Collapse the binary subtree of node bv_id into wide nodes.
+  /// @return the index of the wide node of bv_id
+  int collapseWideNodes(int bv_id);
+
+  /// @brief Encode the nodes in the quantized layout and free bvs. Only
+  /// AABB models support this layout.
+  void quantizeNodes();
+
+  /// @brief Decode the volume of node id, from the root.
+  const BV& decodeVolume(int id, BV& buffer) const;
+
   /// @brief Build the bounding volume hierarchy
   int buildTree();
 
   /// @brief Refit the bounding volume hierarchy
   int refitTree(bool bottomup);
 
+  bool keepsNodes() const
+  {
+    return bvs != NULL;
+  }
+
   /// @brief Refit the bounding volume hierarchy in a top-down way (slow but more compact)
   int refitTree_topdown();
 
@@ -336,10 +525,64 @@ private:
   int refitTree_bottomup();
 
   /// @brief Recursive kernel for hierarchy construction
-  int recursiveBuildTree(int bv_id, int first_primitive, int num_primitives);
-
-  /// @brief Recursive kernel for bottomup refitting 
-  int recursiveRefitTree_bottomup(int bv_id);
+  /// @param first_child index of the first free BV node. The subtree of the
+  ///        node uses the 2 * (num_primitives - 1) nodes starting there.
+  /// @param splitter split rule, not shared with other threads.
+  /// @param num_threads number of threads which may build the subtree.
+  int recursiveBuildTree(int bv_id, int first_primitive, int num_primitives,
+                         int first_child, BVSplitter<BV>& splitter,
+                         unsigned int num_threads);
+
+  /// @brief Build the hierarchy of a linear BVH: sort the primitives by the
+  /// Morton code of their centroid and split the nodes where the codes
+  /// differ in their highest bit.
+  template<typename Code>
+  void buildTree_linear(int num_primitives, unsigned int num_threads);
+
+  /// @brief Recursive kernel for linear hierarchy construction. The volumes
+  /// are fitted after the children have been built.
+  /// @param codes sorted Morton codes of the primitives.
+  template<typename Code>
+  void recursiveBuildTree_linear(int bv_id, int first_primitive, int num_primitives,
+                                 int first_child, const Code* codes,
+                                 unsigned int num_threads);
+
+  /// @brief Refit one node bottom-up: fit a leaf to its primitive, in the
+  /// current and the previous frame, or merge the volumes of the children of
+  /// an inner node.
+  int refitNode_bottomup(int bv_id);
+
+  /// @brief Compute the schedule of the bottom-up refit from the hierarchy.
+  void computeRefitSchedule();
+
+  /// @brief Refit the levels of refit_order, from the deepest to the root.
+  /// Thread thread_id refits its share of the large levels and the threads
+  /// meet at the barrier after each of them. The other levels are refitted
+  /// by thread 0 alone.
+  void refitLevels(unsigned int thread_id, unsigned int num_threads,
+                   boost::barrier* barrier);
+
+  /// @brief Refit the leaves of the moved vertices and their ancestors.
+  void refitMovedVertices();
+
+  /// @brief Nodes by decreasing depth, so that the children of a node are
+  /// refitted before it. Empty until the first refit after a build.
+  std::vector<int> refit_order;
+
+  /// @brief Start of each level in refit_order, followed by refit_order.size().
+  std::vector<int> refit_levels;
+
+  /// @brief Parent of each node, -1 for the root.
+  std::vector<int> parents;
+
+  /// @brief Leaf of each primitive.
+  std::vector<int> primitive_leaves;
+
+  /// @brief Triangles of each vertex: those of vertex v are
+  /// vertex_triangles[vertex_triangles_begin[v]] to
+  /// vertex_triangles[vertex_triangles_begin[v + 1] - 1].
+  std::vector<int> vertex_triangles_begin;
+  std::vector<int> vertex_triangles;
 
   /// @ recursively compute each bv's transform related to its parent. For default BV, only the translation works. 
   /// For oriented BV (OBB, RSS, OBBRSS), special implementation is provided.
@@ -358,6 +601,12 @@ private:
 
 /// @}
 
+template<>
+void BVHModel<AABB>::quantizeNodes();
+
+template<>
+const AABB& BVHModel<AABB>::decodeVolume(int id, AABB& buffer) const;
+
 template<>
 void BVHModel<OBB>::makeParentRelativeRecurse(int bv_id, Matrix3f& parent_axes, const Vec3f& parent_c);
 
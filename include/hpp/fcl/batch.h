@@ -0,0 +1,93 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_BATCH_H
+#define HPP_FCL_BATCH_H
+
+#include <vector>
+
+#include <hpp/fcl/collision_object.h>
+#include <hpp/fcl/collision_data.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Two geometries at given poses, for the batch versions of collide
+/// and distance.
+struct GeometryQuery
+{
+  const CollisionGeometry* o1;
+  Transform3f tf1;
+  const CollisionGeometry* o2;
+  Transform3f tf2;
+
+  GeometryQuery() : o1 (NULL), o2 (NULL) {}
+
+  GeometryQuery(const CollisionGeometry* o1_, const Transform3f& tf1_,
+                const CollisionGeometry* o2_, const Transform3f& tf2_) :
+    o1 (o1_), tf1 (tf1_), o2 (o2_), tf2 (tf2_) {}
+};
+
+/// @brief Check collision for many independent queries, on several threads.
+///
+/// Each thread has its own narrow phase solver. results[i] is the result of
+/// queries[i], and does not depend on the number of threads nor on the
+/// order in which the queries are processed.
+/// The geometries are only read and may appear in several queries.
+/// @param num_threads number of threads, or 0 to use one thread per core.
+/// @return the number of queries in collision.
+std::size_t collide(const std::vector<GeometryQuery>& queries,
+                    const CollisionRequest& request,
+                    std::vector<CollisionResult>& results,
+                    std::size_t num_threads = 0);
+
+/// @brief Compute the distance for many independent queries, on several
+/// threads.
+///
+/// Each thread has its own narrow phase solver. results[i] is the result of
+/// queries[i], and does not depend on the number of threads nor on the
+/// order in which the queries are processed.
+/// @param num_threads number of threads, or 0 to use one thread per core.
+void distance(const std::vector<GeometryQuery>& queries,
+              const DistanceRequest& request,
+              std::vector<DistanceResult>& results,
+              std::size_t num_threads = 0);
+
+}
+
+} // namespace hpp
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_BROADPHASE_SAP_H
+#define HPP_FCL_BROADPHASE_SAP_H
+
+#include <map>
+#include <set>
+#include <hpp/fcl/broadphase/broadphase_collision_manager.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Broad phase collision manager based on sweep and prune (SaP).
+///
+/// The bounds of the AABB of the objects are kept sorted along the three
+/// axes, and the set of pairs of objects whose AABB overlap is maintained
+/// incrementally. When an object moves, its bounds are moved by insertion
+/// sort: with coherent motion, they only swap with a few neighbours, so
+/// that updating k objects costs O(k) instead of O(n).
+///
+/// The manager reads CollisionObject::getAABB(): call
+/// CollisionObject::computeAABB() on the objects that moved before
+/// updating the manager.
+class SaPCollisionManager : public BroadPhaseCollisionManager
+{
+public:
+  /// @brief pair of objects whose AABB overlap, stored with first < second.
+  typedef std::pair<CollisionObject*, CollisionObject*> ObjectPair;
+  typedef std::set<ObjectPair> OverlappingPairs;
+
+  SaPCollisionManager();
+
+  /// @brief add objects to the manager
+  void registerObjects(const std::vector<CollisionObject*>& other_objs);
+
+  /// @brief add one object to the manager
+  void registerObject(CollisionObject* obj);
+
+  /// @brief remove one object from the manager
+  void unregisterObject(CollisionObject* obj);
+
+  /// @brief initialize the manager, related with the specific type of manager
+  void setup();
+
+  /// @brief update the condition of manager
+  void update();
+
+  /// @brief update the manager by explicitly given the object updated
+  void update(CollisionObject* updated_obj);
+
+  /// @brief update the manager by explicitly given the set of objects update
+  void update(const std::vector<CollisionObject*>& updated_objs);
+
+  /// @brief clear the manager
+  void clear();
+
+  /// @brief return the objects managed by the manager
+  void getObjects(std::vector<CollisionObject*>& objs) const;
+
+  /// @brief perform collision test between one object and all the objects belonging to the manager
+  void collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const;
+
+  /// @brief perform distance computation between one object and all the objects belonging to the manager
+  void distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const;
+
+  /// @brief perform collision test for the objects belonging to the manager (i.e., N^2 self collision)
+  ///
+  /// The callback is called on the overlapping pairs only.
+  void collide(void* cdata, CollisionCallBack callback) const;
+
+  /// @brief perform distance test for the objects belonging to the manager (i.e., N^2 self distance)
+  void distance(void* cdata, DistanceCallBack callback) const;
+
+  /// @brief whether the manager is empty
+  bool empty() const
+  {
+    return boxes.empty();
+  }
+
+  /// @brief the number of objects managed by the manager
+  std::size_t size() const
+  {
+    return boxes.size();
+  }
+
+  /// @brief the pairs of objects whose AABB overlap.
+  ///
+  /// The set is kept up to date by the insertions, removals and updates,
+  /// and can be iterated without any extra computation.
+  const OverlappingPairs& getOverlappingPairs() const
+  {
+    return overlapping_pairs;
+  }
+
+private:
+  /// @brief lower or upper bound of an AABB along one axis
+  struct EndPoint
+  {
+    FCL_REAL value;
+
+    /// @brief index of the box in boxes
+    std::size_t box;
+
+    /// @brief whether it is the upper bound
+    bool is_max;
+
+    /// @brief order by value, lower bounds first for equal values, so that
+    /// touching AABBs are considered as overlapping.
+    bool operator< (const EndPoint& other) const
+    {
+      return value < other.value
+        || (value == other.value && !is_max && other.is_max);
+    }
+  };
+
+  struct SaPBox
+  {
+    CollisionObject* obj;
+
+    /// @brief the AABB of the object at the last update
+    AABB aabb;
+
+    /// @brief position of the lower and upper bounds in each axis
+    std::size_t endpoints[3][2];
+  };
+
+  /// @brief the sorted bounds along each axis
+  std::vector<EndPoint> axes[3];
+
+  std::vector<SaPBox> boxes;
+
+  /// @brief index of each object in boxes
+  std::map<CollisionObject*, std::size_t> table;
+
+  OverlappingPairs overlapping_pairs;
+
+  /// @brief set the AABB of a box and restore the order of its bounds
+  void updateBox(std::size_t box, const AABB& aabb);
+
+  /// @brief move a bound to its new value and restore the order
+  void moveEndPoint(int axis, std::size_t pos, FCL_REAL value);
+
+  /// @brief update the overlapping pairs when the bound at pos moves
+  /// before the bound at pos - 1
+  void swapEndPoints(int axis, std::size_t pos);
+
+  /// @brief update the positions stored in the boxes of the bounds from
+  /// begin to the end of the axis
+  void renumberEndPoints(int axis, std::size_t begin);
+
+  /// @brief add the pair of objects of two boxes if their AABB overlap
+  void addPair(std::size_t b1, std::size_t b2);
+
+  void removePair(std::size_t b1, std::size_t b2);
+};
+
+}
+
+} // namespace hpp
+
+#endif
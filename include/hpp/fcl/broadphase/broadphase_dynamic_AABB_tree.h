@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_BROADPHASE_DYNAMIC_AABB_TREE_MANAGER_H
+#define HPP_FCL_BROADPHASE_DYNAMIC_AABB_TREE_MANAGER_H
+
+#include <map>
+#include <hpp/fcl/broadphase/broadphase_collision_manager.h>
+#include <hpp/fcl/broadphase/dynamic_AABB_tree.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Broad phase collision manager based on a dynamic AABB tree.
+///
+/// Each object is stored in a leaf of the tree, with its world AABB inflated
+/// by aabb_margin ("fat" AABB). When an object moves, it is moved in the tree
+/// only if its new AABB is not contained in the fat AABB anymore. Queries
+/// cost O(log n) per object and self collision O(n log n).
+class DynamicAABBTreeCollisionManager : public BroadPhaseCollisionManager
+{
+public:
+  /// @param aabb_margin margin added on each side of the AABB of the objects
+  DynamicAABBTreeCollisionManager(FCL_REAL aabb_margin = 0);
+
+  /// @brief margin added on each side of the AABB of the objects.
+  ///
+  /// Larger margins make updates cheaper for moving objects, at the cost of
+  /// more conservative bounding volume tests. A modification only applies
+  /// to the objects inserted or moved afterwards.
+  FCL_REAL aabb_margin;
+
+  /// @brief the tree is rebuilt top-down by setup() when its height exceeds
+  /// the height of a balanced tree by more than this value.
+  int max_tree_nonbalanced_level;
+
+  /// @brief add objects to the manager
+  void registerObjects(const std::vector<CollisionObject*>& other_objs);
+
+  /// @brief add one object to the manager
+  void registerObject(CollisionObject* obj);
+
+  /// @brief remove one object from the manager
+  void unregisterObject(CollisionObject* obj);
+
+  /// @brief initialize the manager, related with the specific type of manager
+  void setup();
+
+  /// @brief update the condition of manager
+  void update();
+
+  /// @brief update the manager by explicitly given the object updated
+  void update(CollisionObject* updated_obj);
+
+  /// @brief update the manager by explicitly given the set of objects update
+  void update(const std::vector<CollisionObject*>& updated_objs);
+
+  /// @brief clear the manager
+  void clear();
+
+  /// @brief return the objects managed by the manager
+  void getObjects(std::vector<CollisionObject*>& objs) const;
+
+  /// @brief perform collision test between one object and all the objects belonging to the manager
+  void collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const;
+
+  /// @brief perform distance computation between one object and all the objects belonging to the manager
+  void distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const;
+
+  /// @brief perform collision test for the objects belonging to the manager (i.e., N^2 self collision)
+  void collide(void* cdata, CollisionCallBack callback) const;
+
+  /// @brief perform distance test for the objects belonging to the manager (i.e., N^2 self distance)
+  void distance(void* cdata, DistanceCallBack callback) const;
+
+  /// @brief perform collision test with objects belonging to another manager
+  void collide(BroadPhaseCollisionManager* other_manager, void* cdata, CollisionCallBack callback) const;
+
+  /// @brief perform distance test with objects belonging to another manager
+  void distance(BroadPhaseCollisionManager* other_manager, void* cdata, DistanceCallBack callback) const;
+
+  /// @brief whether the manager is empty
+  bool empty() const
+  {
+    return dtree.empty();
+  }
+
+  /// @brief the number of objects managed by the manager
+  std::size_t size() const
+  {
+    return dtree.size();
+  }
+
+  /// @brief the underlying tree
+  const DynamicAABBTree& getTree() const
+  {
+    return dtree;
+  }
+
+private:
+  typedef std::map<CollisionObject*, std::size_t> ObjectLeafMap;
+
+  DynamicAABBTree dtree;
+
+  /// @brief leaf of each object in the tree
+  ObjectLeafMap table;
+
+  bool setup_;
+
+  AABB fatAABB(const CollisionObject* obj) const
+  {
+    return AABB(obj->getAABB(), Vec3f::Constant(aabb_margin));
+  }
+
+  /// @brief move the leaf of an object if the object left its fat AABB
+  void updateLeaf(CollisionObject* obj, std::size_t leaf);
+};
+
+}
+
+} // namespace hpp
+
+#endif
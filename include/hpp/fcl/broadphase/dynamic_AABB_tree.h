@@ -0,0 +1,164 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_BROADPHASE_DYNAMIC_AABB_TREE_H
+#define HPP_FCL_BROADPHASE_DYNAMIC_AABB_TREE_H
+
+#include <vector>
+#include <hpp/fcl/BV/AABB.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Dynamic bounding volume hierarchy of AABBs.
+///
+/// Leaves can be inserted, removed and moved at any time. The tree is kept
+/// balanced by rotations on the path from the modified leaf to the root, as
+/// in the dynamic trees of Box2D and Bullet. The nodes are stored in a
+/// contiguous array and referred to by index: freed nodes are recycled, so
+/// that modifying the tree does not allocate once its capacity is reached.
+class DynamicAABBTree
+{
+public:
+  /// @brief index of a node which does not exist
+  static const std::size_t NULL_NODE = (std::size_t)-1;
+
+  struct Node
+  {
+    /// @brief bounding volume of the node
+    AABB bv;
+
+    /// @brief index of the parent node, NULL_NODE for the root.
+    /// For free nodes, index of the next free node.
+    std::size_t parent;
+
+    /// @brief indices of the children, NULL_NODE for leaves
+    std::size_t children[2];
+
+    /// @brief user data stored in the leaves
+    void* data;
+
+    /// @brief height of the subtree, 0 for leaves and -1 for free nodes.
+    int height;
+
+    bool isLeaf() const
+    {
+      return children[0] == NULL_NODE;
+    }
+  };
+
+  DynamicAABBTree();
+
+  /// @brief insert a leaf with bounding volume bv
+  /// @return the index of the leaf
+  std::size_t insert(const AABB& bv, void* data);
+
+  /// @brief remove a leaf
+  void remove(std::size_t leaf);
+
+  /// @brief change the bounding volume of a leaf and move it in the tree
+  void update(std::size_t leaf, const AABB& bv);
+
+  /// @brief build the tree top-down from scratch
+  ///
+  /// The objects are sorted by the median of their center along the longest
+  /// axis of the node, which produces a tree of minimal height.
+  /// @param[out] leaves the index of the leaf of each bounding volume
+  void build(const std::vector<AABB>& bvs, const std::vector<void*>& data,
+             std::vector<std::size_t>& leaves);
+
+  /// @brief remove all the nodes
+  void clear();
+
+  /// @brief whether the tree has no leaf
+  bool empty() const
+  {
+    return root == NULL_NODE;
+  }
+
+  /// @brief number of leaves
+  std::size_t size() const
+  {
+    return n_leaves;
+  }
+
+  /// @brief height of the tree, -1 when the tree is empty
+  int getHeight() const
+  {
+    return (root == NULL_NODE) ? -1 : nodes[root].height;
+  }
+
+  /// @brief index of the root node, NULL_NODE if the tree is empty
+  std::size_t getRoot() const
+  {
+    return root;
+  }
+
+  const Node& getNode(std::size_t i) const
+  {
+    return nodes[i];
+  }
+
+private:
+  std::vector<Node> nodes;
+  std::size_t root;
+  std::size_t free_list;
+  std::size_t n_leaves;
+
+  std::size_t allocateNode();
+
+  void freeNode(std::size_t i);
+
+  void insertLeaf(std::size_t leaf);
+
+  void removeLeaf(std::size_t leaf);
+
+  /// @brief refit the bounding volumes and heights from node i to the root
+  /// and rebalance the tree along the way.
+  void refitAndBalance(std::size_t i);
+
+  /// @brief perform a left or right rotation if node a is unbalanced
+  /// @return the new root of the subtree
+  std::size_t balance(std::size_t a);
+
+  std::size_t buildRecurse(std::size_t* leaves, std::size_t n);
+};
+
+}
+
+} // namespace hpp
+
+#endif
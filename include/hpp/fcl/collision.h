@@ -39,9 +39,11 @@
 #ifndef HPP_FCL_COLLISION_H
 #define HPP_FCL_COLLISION_H
 
+#include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/data_types.h>
 #include <hpp/fcl/collision_object.h>
 #include <hpp/fcl/collision_data.h>
+#include <hpp/fcl/collision_func_matrix.h>
 
 namespace hpp
 {
@@ -59,6 +61,67 @@ std::size_t collide(const CollisionObject* o1, const CollisionObject* o2,
 std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
                     const CollisionGeometry* o2, const Transform3f& tf2,
                     const CollisionRequest& request, CollisionResult& result);
+
+/// @brief Collision between two objects using the provided narrow phase
+///        solver.
+///
+/// The solver keeps its GJK and EPA workspaces between calls: reusing the
+/// same solver avoids heap allocations in the narrow phase. A solver must not
+/// be shared between threads.
+std::size_t collide(const CollisionObject* o1, const CollisionObject* o2,
+                    const GJKSolver* nsolver,
+                    const CollisionRequest& request, CollisionResult& result);
+
+/// @copydoc collide(const CollisionObject*, const CollisionObject*, const GJKSolver*, const CollisionRequest&, CollisionResult&)
+std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
+                    const CollisionGeometry* o2, const Transform3f& tf2,
+                    const GJKSolver* nsolver,
+                    const CollisionRequest& request, CollisionResult& result);
+
+/// @brief Collision between a given pair of geometries, at several poses.
+///
+/// The dispatch on the types of the geometries and the narrow phase solver
+/// are set up once, at construction. This saves their cost when the same
+/// pair is checked at many poses, as in sampling-based planners.
+/// An instance must not be shared between threads.
+class ComputeCollision
+{
+public:
+  ComputeCollision(const CollisionGeometry* o1, const CollisionGeometry* o2);
+
+  /// @brief whether the collision between the two geometries is implemented.
+  bool isSupported() const
+  {
+    return func != NULL;
+  }
+
+  /// @brief Collision at one pose.
+  /// Same as collide(o1, tf1, o2, tf2, request, result).
+  std::size_t operator()(const Transform3f& tf1, const Transform3f& tf2,
+                         const CollisionRequest& request,
+                         CollisionResult& result) const;
+
+  /// @brief Collision at n poses.
+  /// @param tf1, tf2 arrays of the n poses of o1 and o2.
+  /// @param results array of n results. results[i] is cleared and filled
+  ///        with the collision at pose i.
+  /// @param stop_at_first_collision stop at the first pose in collision.
+  /// @return the number of poses which have been checked: n, or the index
+  ///         of the first pose in collision plus one when stopping early.
+  std::size_t operator()(const Transform3f* tf1, const Transform3f* tf2,
+                         std::size_t n, const CollisionRequest& request,
+                         CollisionResult* results,
+                         bool stop_at_first_collision = false) const;
+
+private:
+  const CollisionGeometry* o1;
+  const CollisionGeometry* o2;
+  GJKSolver solver;
+
+  CollisionFunctionMatrix::CollisionFunc func;
+  /// @brief whether func expects the geometries in the reverse order.
+  bool swap_geoms;
+};
 }
 
 } // namespace hpp
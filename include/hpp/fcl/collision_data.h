@@ -173,6 +173,17 @@ struct CollisionRequest
   /// @brief Distance below which bounding volumes are break down
   FCL_REAL break_distance;
 
+  /// @brief Number of threads of the traversal of two BVH models, 0 for one
+  /// per core. With more than one thread, the contacts are sorted, and the
+  /// traversal is split in parts which each stop at num_max_contacts: this
+  /// is meant for queries of all the contacts.
+  unsigned int num_threads;
+
+  /// @brief Depth at which the traversal of two octrees stops, the nodes at
+  /// this depth being taken as occupied boxes. 0, like in octomap, for the
+  /// depth of the leaves.
+  unsigned int octree_max_depth;
+
   explicit CollisionRequest(size_t num_max_contacts_,
                    bool enable_contact_ = false,
 		   bool enable_distance_lower_bound_ = false,
@@ -188,7 +199,9 @@ struct CollisionRequest
     enable_distance_lower_bound (flag & DISTANCE_LOWER_BOUND),
     gjk_solver_type(GST_INDEP),
     security_margin (0),
-    break_distance (1e-3)
+    break_distance (1e-3),
+    num_threads (1),
+    octree_max_depth (0)
   {
     enable_cached_gjk_guess = false;
     cached_gjk_guess = Vec3f(1, 0, 0);
@@ -200,7 +213,9 @@ struct CollisionRequest
       enable_distance_lower_bound (false),
       gjk_solver_type(GST_INDEP),
       security_margin (0),
-      break_distance (1e-3)
+      break_distance (1e-3),
+      num_threads (1),
+      octree_max_depth (0)
     {
       enable_cached_gjk_guess = false;
       cached_gjk_guess = Vec3f(1, 0, 0);
@@ -297,7 +312,22 @@ struct DistanceRequest
   /// @brief narrow phase solver type
   GJKSolverType gjk_solver_type;
 
-
+  /// @brief if positive, the query only decides whether the distance is
+  /// below this threshold, and returns as soon as it is proven.
+  /// If the objects are closer, min_distance is the distance between some
+  /// of their parts, below the threshold. Otherwise, min_distance is not
+  /// below the threshold, but it is not the distance and the nearest points
+  /// are not computed.
+  /// The traversals of the hierarchies stop at the threshold, and so does
+  /// GJK on the pairs of shapes and on the leaves between a mesh and a
+  /// shape. The leaves between two meshes compute the distance between
+  /// triangles in closed form.
+  FCL_REAL distance_threshold;
+
+  /// @brief Depth at which the traversal of two octrees stops, the nodes at
+  /// this depth being taken as occupied boxes. 0, like in octomap, for the
+  /// depth of the leaves.
+  unsigned int octree_max_depth;
 
   DistanceRequest(bool enable_nearest_points_ = false,
                   FCL_REAL rel_err_ = 0.0,
@@ -305,7 +335,9 @@ struct DistanceRequest
                   GJKSolverType gjk_solver_type_ = GST_INDEP) : enable_nearest_points(enable_nearest_points_),
                                                                 rel_err(rel_err_),
                                                                 abs_err(abs_err_),
-                                                                gjk_solver_type(gjk_solver_type_)
+                                                                gjk_solver_type(gjk_solver_type_),
+                                                                distance_threshold(0),
+                                                                octree_max_depth(0)
   {
   }
 
@@ -320,6 +352,11 @@ struct DistanceResult
 public:
 
   /// @brief minimum distance between two objects. if two objects are in collision, min_distance <= 0.
+  /// For the distance between a mesh and a mesh or a shape, the value before
+  /// the query is an upper bound: parts of the objects farther apart are
+  /// pruned, and the result is left unchanged if the objects are farther
+  /// apart. Other pairs, such as sphere-sphere or capsule-capsule, may
+  /// overwrite the result.
   FCL_REAL min_distance;
 
   /// @brief nearest points
@@ -440,6 +477,57 @@ public:
 
 };
 
+/// @brief request to the continuous collision computation
+struct ContinuousCollisionRequest
+{
+  /// @brief maximum number of conservative advancement steps
+  std::size_t num_max_iterations;
+
+  /// @brief distance below which the objects are considered in contact
+  FCL_REAL toc_err;
+
+  /// @brief narrow phase solver type
+  GJKSolverType gjk_solver_type;
+
+  ContinuousCollisionRequest(std::size_t num_max_iterations_ = 100,
+                             FCL_REAL toc_err_ = 1e-4,
+                             GJKSolverType gjk_solver_type_ = GST_INDEP) : num_max_iterations(num_max_iterations_),
+                                                                           toc_err(toc_err_),
+                                                                           gjk_solver_type(gjk_solver_type_)
+  {
+  }
+};
+
+/// @brief continuous collision result
+struct ContinuousCollisionResult
+{
+  /// @brief whether the objects get in contact during the motion
+  bool is_collide;
+
+  /// @brief time of contact in [0, 1]. If the objects do not collide, the
+  /// motion is free up to this time: 1, or less when the number of steps
+  /// is exhausted before the end of the motion.
+  FCL_REAL time_of_contact;
+
+  /// @brief poses of the objects at the time of contact
+  Transform3f contact_tf1, contact_tf2;
+
+  /// @brief contact point, in the world frame
+  Vec3f contact_point;
+
+  /// @brief contact normal, pointing from object 1 to object 2
+  Vec3f normal;
+
+  /// @brief number of conservative advancement steps
+  std::size_t num_iterations;
+
+  ContinuousCollisionResult() : is_collide(false),
+                                time_of_contact(1),
+                                num_iterations(0)
+  {
+  }
+};
+
 
 inline CollisionRequestFlag operator~(CollisionRequestFlag a)
 {return static_cast<CollisionRequestFlag>(~static_cast<const int>(a));}
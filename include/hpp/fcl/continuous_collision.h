@@ -0,0 +1,76 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_CONTINUOUS_COLLISION_H
+#define HPP_FCL_CONTINUOUS_COLLISION_H
+
+#include <hpp/fcl/collision_object.h>
+#include <hpp/fcl/collision_data.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Continuous collision between two geometries moving from the poses
+/// tf1_beg, tf2_beg to the poses tf1_end, tf2_end.
+///
+/// Along the motion, the translations are interpolated linearly and the
+/// rotations with a constant angular velocity (quaternion slerp).
+/// The time of contact is computed by conservative advancement: each step
+/// computes the distance at the current time and advances by the time the
+/// objects need to cover it, bounded from their linear and angular
+/// velocities and from their extent around their origin. The objects are
+/// thus never reported free before a contact.
+/// Planes, halfspaces and octrees only support translations.
+/// @return the time of contact, see ContinuousCollisionResult::time_of_contact.
+FCL_REAL continuousCollide(const CollisionGeometry* o1, const Transform3f& tf1_beg, const Transform3f& tf1_end,
+                           const CollisionGeometry* o2, const Transform3f& tf2_beg, const Transform3f& tf2_end,
+                           const ContinuousCollisionRequest& request,
+                           ContinuousCollisionResult& result);
+
+/// @brief Continuous collision between two objects moving from their
+/// current poses to tf1_end and tf2_end.
+/// @copydetails continuousCollide(const CollisionGeometry*, const Transform3f&, const Transform3f&, const CollisionGeometry*, const Transform3f&, const Transform3f&, const ContinuousCollisionRequest&, ContinuousCollisionResult&)
+FCL_REAL continuousCollide(const CollisionObject* o1, const Transform3f& tf1_end,
+                           const CollisionObject* o2, const Transform3f& tf2_end,
+                           const ContinuousCollisionRequest& request,
+                           ContinuousCollisionResult& result);
+
+}
+
+} // namespace hpp
+
+#endif
@@ -38,6 +38,7 @@
 #ifndef HPP_FCL_DISTANCE_H
 #define HPP_FCL_DISTANCE_H
 
+#include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/collision_object.h>
 #include <hpp/fcl/collision_data.h>
 
@@ -54,6 +55,21 @@ FCL_REAL distance(const CollisionObject* o1, const CollisionObject* o2, const Di
 FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
                   const CollisionGeometry* o2, const Transform3f& tf2,
                   const DistanceRequest& request, DistanceResult& result);
+
+/// @brief Distance between two objects using the provided narrow phase
+///        solver.
+///
+/// Reusing the same solver avoids heap allocations in the narrow phase.
+/// A solver must not be shared between threads.
+FCL_REAL distance(const CollisionObject* o1, const CollisionObject* o2,
+                  const GJKSolver* nsolver,
+                  const DistanceRequest& request, DistanceResult& result);
+
+/// @copydoc distance(const CollisionObject*, const CollisionObject*, const GJKSolver*, const DistanceRequest&, DistanceResult&)
+FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
+                  const CollisionGeometry* o2, const Transform3f& tf2,
+                  const GJKSolver* nsolver,
+                  const DistanceRequest& request, DistanceResult& result);
 }
 
 } // namespace hpp
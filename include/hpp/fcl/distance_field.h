@@ -0,0 +1,218 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef HPP_FCL_DISTANCE_FIELD_H
+#define HPP_FCL_DISTANCE_FIELD_H
+
+#include <deque>
+#include <vector>
+
+#include <boost/array.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <hpp/fcl/collision_object.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+class OcTree;
+struct OcTreeChanges;
+#endif
+
+/// @brief Euclidean distance field to the obstacles of a geometry, sampled
+/// on a sparse grid of voxels.
+///
+/// The obstacles are voxelized: the voxels of the grid covered by an
+/// occupied leaf of an octree, or crossed by a triangle of a mesh. Each voxel
+/// within max_distance of the obstacles stores the distance from its center
+/// to the closest obstacle voxel. When the field is signed, the voxels of the
+/// obstacles store minus the distance to the closest free voxel, otherwise
+/// they store zero. The voxels are allocated in blocks of 8x8x8 around the
+/// obstacles and found through a hash table, so that a lookup costs a
+/// constant time.
+///
+/// The interior of a mesh is not filled: only the voxels crossed by its
+/// triangles are obstacles. In a signed field of a closed mesh, only this
+/// shell is negative, and the points deep inside the mesh get a positive
+/// distance to the shell, growing toward the center up to max_distance.
+///
+/// The distances are computed by propagating the closest obstacle voxel from
+/// neighbor to neighbor in increasing distance order. The field is expressed
+/// in the frame of the geometry it was built from.
+class DistanceField
+{
+public:
+  /// @param voxel_size size of the voxels
+  /// @param max_distance distances are only computed up to this value
+  /// @param is_signed whether the voxels of the obstacles store a negative
+  ///        distance to the free space, which for a mesh only covers the
+  ///        voxels crossed by its triangles
+  DistanceField(FCL_REAL voxel_size, FCL_REAL max_distance,
+                bool is_signed = false);
+
+  /// @brief build the field of the triangles of a mesh
+  ///
+  /// The mesh is kept for the exact queries of conservativeDistance and
+  /// must outlive the field.
+  void build(const BVHModelBase& model);
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+  /// @brief build the field of the occupied leaves of an octree
+  ///
+  /// The octree is kept for the exact queries of conservativeDistance and
+  /// must outlive the field.
+  void build(const OcTree& tree);
+
+  /// @brief update the field after an update of the octree it was built from
+  ///
+  /// Only the voxels within max_distance of the changed subtrees are
+  /// recomputed.
+  void update(const OcTree& tree, const OcTreeChanges& changes);
+#endif
+
+  /// @brief distance stored in the voxel containing p, max_distance if the
+  /// voxel is not allocated
+  FCL_REAL distance(const Vec3f& p) const;
+
+  /// @brief trilinear interpolation of the distance at p and its gradient
+  /// @return false if one of the 8 voxels around p is not allocated, in
+  ///         which case it counts as max_distance
+  bool distance(const Vec3f& p, FCL_REAL& d, Vec3f& gradient) const;
+
+  /// @brief lower bound of the distance from p to the obstacles
+  FCL_REAL distanceLowerBound(const Vec3f& p) const;
+
+  /// @brief distance between a sphere and the obstacles, bounded from below
+  /// by the field when it is far enough from them
+  ///
+  /// When the lower bound given by the field is above security_margin, it is
+  /// returned. Otherwise the exact distance is computed by the narrow phase
+  /// against the geometry the field was built from.
+  /// @param tf pose of the sphere in the frame of the field
+  /// @param exact if not NULL, set to whether the exact distance was
+  ///        computed
+  FCL_REAL conservativeDistance(const Sphere& sphere, const Transform3f& tf,
+                                FCL_REAL security_margin = 0,
+                                bool* exact = NULL) const;
+
+  /// @brief distance between a capsule and the obstacles, bounded from below
+  /// by the field when it is far enough from them
+  ///
+  /// The lower bound is the minimum of the field along the axis of the
+  /// capsule, sampled every voxel.
+  /// @sa conservativeDistance(const Sphere&, const Transform3f&, FCL_REAL, bool*) const
+  FCL_REAL conservativeDistance(const Capsule& capsule, const Transform3f& tf,
+                                FCL_REAL security_margin = 0,
+                                bool* exact = NULL) const;
+
+  FCL_REAL getVoxelSize() const { return voxel_size; }
+
+  FCL_REAL getMaxDistance() const { return max_distance; }
+
+  bool isSigned() const { return is_signed; }
+
+  /// @brief number of allocated blocks of 8x8x8 voxels
+  std::size_t numBlocks() const { return blocks.size(); }
+
+private:
+  typedef boost::array<int, 3> Index;
+
+  struct IndexHash
+  {
+    std::size_t operator()(const Index& index) const
+    {
+      return ((std::size_t)index[0] * 73856093u)
+        ^ ((std::size_t)index[1] * 19349663u)
+        ^ ((std::size_t)index[2] * 83492791u);
+    }
+  };
+
+  struct Voxel
+  {
+    /// distance, negative inside the obstacles when the field is signed
+    float distance;
+    /// whether the voxel is an obstacle
+    bool obstacle;
+    /// index of the closest voxel of the other kind, if site_valid
+    bool site_valid;
+    Index site;
+  };
+
+  struct Block
+  {
+    Index index;
+    /// indices in blocks of the 27 blocks around this one, -1 if not
+    /// allocated. Neighbor (x, y, z) in {-1, 0, 1}^3 is at
+    /// x + 1 + 3 (y + 1) + 9 (z + 1).
+    int neighbors[27];
+    Voxel voxels[512];
+  };
+
+  typedef boost::unordered_map<Index, std::size_t, IndexHash> BlockMap;
+
+  const Voxel* findVoxel(const Index& index) const;
+  Voxel* findVoxel(const Index& index);
+  Block& allocateBlock(const Index& block_index);
+  void allocateAround(const std::vector<Index>& obstacles);
+  void resetVoxel(Voxel& voxel, bool obstacle) const;
+  bool neighborVoxel(int block, int x, int y, int z, int& neighbor_block,
+                     int& local) const;
+  void propagate(const std::vector<Index>& active_blocks);
+  static int siteDistance(const Index& index, const Index& site);
+  Index voxelIndex(const Vec3f& p) const;
+  void voxelize(const AABB& box, std::vector<Index>& voxels) const;
+
+  FCL_REAL voxel_size;
+  FCL_REAL max_distance;
+  bool is_signed;
+
+  std::deque<Block> blocks;
+  BlockMap block_map;
+
+  /// geometry the field was built from, for the exact queries
+  const CollisionGeometry* source;
+};
+
+}
+
+} // namespace hpp
+
+#endif
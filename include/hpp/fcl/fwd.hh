@@ -49,6 +49,7 @@ namespace fcl {
   typedef boost::shared_ptr <const CollisionGeometry>
   CollisionGeometryConstPtr_t;
   class Transform3f;
+  struct GJKSolver;
 
   class AABB;
 
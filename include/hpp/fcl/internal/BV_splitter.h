@@ -49,8 +49,21 @@ namespace hpp
 namespace fcl
 {
 
-/// @brief Three types of split algorithms are provided in FCL as default
-enum SplitMethodType {SPLIT_METHOD_MEAN, SPLIT_METHOD_MEDIAN, SPLIT_METHOD_BV_CENTER};
+/// @brief Four types of split algorithms are provided in FCL as default
+enum SplitMethodType {SPLIT_METHOD_MEAN, SPLIT_METHOD_MEDIAN, SPLIT_METHOD_BV_CENTER, SPLIT_METHOD_BINNED_SAH};
+
+/// @brief Find the split of a set of primitives which minimizes the surface
+/// area heuristic (SAH).
+///
+/// The centroids of the primitives are projected on each column of axes and
+/// put in a few bins. The SAH cost of the split between two consecutive bins
+/// is the sum, over the two sides, of the number of primitives times the
+/// area of their bounding box in the frame axes.
+/// @param axes orthonormal frame in which the split is searched.
+/// @retval split_value the threshold: a primitive goes to the second child
+///         iff the projection of its centroid is larger than split_value.
+/// @return the index of the column of axes along which to split.
+int computeSplit_binnedSAH(const Matrix3f& axes, Vec3f* vertices, Triangle* triangles, unsigned int* primitive_indices, int num_primitives, BVHModelType type, FCL_REAL& split_value);
 
 
 /// @brief A class describing the split rule that splits each BV node
@@ -88,6 +101,9 @@ public:
     case SPLIT_METHOD_BV_CENTER:
       computeRule_bvcenter(bv, primitive_indices, num_primitives);
       break;
+    case SPLIT_METHOD_BINNED_SAH:
+      computeRule_binnedSAH(bv, primitive_indices, num_primitives);
+      break;
     default:
       std::cerr << "Split method not supported" << std::endl;
     }
@@ -216,6 +232,12 @@ private:
       split_value = (proj[num_primitives / 2] + proj[num_primitives / 2 - 1]) / 2;
     }
   }
+
+  /// @brief Split algorithm 4: Split the node where the surface area heuristic is minimal
+  void computeRule_binnedSAH(const BV&, unsigned int* primitive_indices, int num_primitives)
+  {
+    split_axis = computeSplit_binnedSAH(Matrix3f::Identity(), vertices, tri_indices, primitive_indices, num_primitives, type, split_value);
+  }
 };
 
 
@@ -240,6 +262,9 @@ void BVSplitter<OBB>::computeRule_mean(const OBB& bv, unsigned int* primitive_in
 template<>
 void BVSplitter<OBB>::computeRule_median(const OBB& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<OBB>::computeRule_binnedSAH(const OBB& bv, unsigned int* primitive_indices, int num_primitives);
+
 template<>
 void BVSplitter<RSS>::computeRule_bvcenter(const RSS& bv, unsigned int* primitive_indices, int num_primitives);
           
@@ -249,6 +274,9 @@ void BVSplitter<RSS>::computeRule_mean(const RSS& bv, unsigned int* primitive_in
 template<>
 void BVSplitter<RSS>::computeRule_median(const RSS& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<RSS>::computeRule_binnedSAH(const RSS& bv, unsigned int* primitive_indices, int num_primitives);
+
 template<>
 void BVSplitter<kIOS>::computeRule_bvcenter(const kIOS& bv, unsigned int* primitive_indices, int num_primitives);
 
@@ -258,6 +286,9 @@ void BVSplitter<kIOS>::computeRule_mean(const kIOS& bv, unsigned int* primitive_
 template<>
 void BVSplitter<kIOS>::computeRule_median(const kIOS& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<kIOS>::computeRule_binnedSAH(const kIOS& bv, unsigned int* primitive_indices, int num_primitives);
+
 template<>
 void BVSplitter<OBBRSS>::computeRule_bvcenter(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives);
 
@@ -267,6 +298,9 @@ void BVSplitter<OBBRSS>::computeRule_mean(const OBBRSS& bv, unsigned int* primit
 template<>
 void BVSplitter<OBBRSS>::computeRule_median(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<OBBRSS>::computeRule_binnedSAH(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives);
+
 }
 
 } // namespace hpp
@@ -186,6 +186,25 @@ public:
 				  const Transform3f& tf,
 				  Vec3f& P, Vec3f& Q);
 
+  /// Compute signed distance between triangles
+  /// @param S and T are two triangles
+  /// @retval P, Q closest points if triangles do not intersect. Otherwise,
+  ///         both are the middle of the segment where the triangles cross
+  ///         each other, or, for coplanar triangles, the deepest points of
+  ///         S and T along the normal.
+  /// @retval normal unit vector from S to T. If the triangles intersect,
+  ///         translating T by the penetration depth along the normal
+  ///         separates the triangles.
+  /// @return distance if triangles do not intersect, opposite of the
+  ///         penetration depth otherwise.
+  ///
+  /// The penetration depth is computed with the separating axis theorem,
+  /// which is much cheaper than GJK and EPA. It is exact for triangles that
+  /// are not coplanar. The in-plane axes are not tested: coplanar triangles
+  /// get a null depth along their common normal.
+  static FCL_REAL signedTriDistance (const Vec3f S[3], const Vec3f T[3],
+                                     Vec3f& P, Vec3f& Q, Vec3f& normal);
+
 };
 
 }
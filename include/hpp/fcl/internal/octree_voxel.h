@@ -0,0 +1,219 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_OCTREE_VOXEL_H
+#define HPP_FCL_OCTREE_VOXEL_H
+
+/// @cond INTERNAL
+
+#include <hpp/fcl/BV/AABB.h>
+#include <hpp/fcl/narrowphase/narrowphase.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// @brief Leaf of an octree: a box aligned with the axes of the octree
+/// frame, posed in the world frame.
+///
+/// The octree leaves are tested against the other object with the closed
+/// form kernels below, instead of building a Box and running GJK.
+struct Voxel
+{
+  Voxel(const AABB& bv, const Transform3f& tf) :
+    R(tf.getRotation()),
+    center(tf.transform(bv.center())),
+    half((bv.max_ - bv.min_) / 2)
+  {
+  }
+
+  /// @brief Express a point of the world frame in the voxel frame.
+  Vec3f toLocal(const Vec3f& p) const { return R.transpose() * (p - center); }
+
+  /// @brief Express a point of the voxel frame in the world frame.
+  Vec3f toWorld(const Vec3f& p) const { return center + R * p; }
+
+  /// @brief The voxel as a Box shape, for the narrow phase solver.
+  void toBox(Box& box, Transform3f& box_tf) const
+  {
+    box.halfSide = half;
+    box_tf.setTransform(R, center);
+  }
+
+  Matrix3f R;
+  Vec3f center;
+  Vec3f half;
+};
+
+/// @brief Whether a voxel and a box overlap, by the separating axis test.
+bool voxelBoxIntersect(const Voxel& voxel, const Box& box,
+                       const Transform3f& tf);
+
+/// @brief Distance between a voxel and a sphere.
+/// normal points from the voxel to the sphere.
+/// @return whether the objects are disjoint.
+bool voxelSphereDistance(const Voxel& voxel, const Sphere& sphere,
+                         const Transform3f& tf, FCL_REAL& dist,
+                         Vec3f& p1, Vec3f& p2, Vec3f& normal);
+
+/// @brief Distance between a voxel and a capsule.
+/// normal points from the voxel to the capsule.
+/// @return false if the axis of the capsule touches the voxel, in which case
+///         the penetration is not computed and dist is only set to 0.
+bool voxelCapsuleDistance(const Voxel& voxel, const Capsule& capsule,
+                          const Transform3f& tf, FCL_REAL& dist,
+                          Vec3f& p1, Vec3f& p2, Vec3f& normal);
+
+/// @brief Whether a voxel and a triangle, given in the world frame, overlap,
+/// by the separating axis test.
+bool voxelTriangleIntersect(const Voxel& voxel, const Vec3f& P1,
+                            const Vec3f& P2, const Vec3f& P3);
+
+/// @brief Collision between a voxel and a shape. The closed form kernels
+/// are used when they compute what is requested, the narrow phase solver
+/// otherwise.
+template<typename S>
+bool voxelShapeIntersect(const GJKSolver* solver, const Voxel& voxel,
+                         const S& s, const Transform3f& tf,
+                         Vec3f* contact, FCL_REAL* depth, Vec3f* normal)
+{
+  Box box;
+  Transform3f box_tf;
+  voxel.toBox(box, box_tf);
+  return solver->shapeIntersect(box, box_tf, s, tf, contact, depth, normal);
+}
+
+template<>
+inline bool voxelShapeIntersect<Box>(const GJKSolver* solver,
+                                     const Voxel& voxel,
+                                     const Box& s, const Transform3f& tf,
+                                     Vec3f* contact, FCL_REAL* depth,
+                                     Vec3f* normal)
+{
+  if(contact || depth || normal)
+  {
+    Box box;
+    Transform3f box_tf;
+    voxel.toBox(box, box_tf);
+    return solver->shapeIntersect(box, box_tf, s, tf, contact, depth, normal);
+  }
+  return voxelBoxIntersect(voxel, s, tf);
+}
+
+template<>
+inline bool voxelShapeIntersect<Sphere>(const GJKSolver*,
+                                        const Voxel& voxel,
+                                        const Sphere& s, const Transform3f& tf,
+                                        Vec3f* contact, FCL_REAL* depth,
+                                        Vec3f* normal)
+{
+  FCL_REAL dist;
+  Vec3f p1, p2, n;
+  if(voxelSphereDistance(voxel, s, tf, dist, p1, p2, n)) return false;
+  if(depth) *depth = dist;
+  if(normal) *normal = n;
+  if(contact) *contact = p2;
+  return true;
+}
+
+template<>
+inline bool voxelShapeIntersect<Capsule>(const GJKSolver* solver,
+                                         const Voxel& voxel,
+                                         const Capsule& s, const Transform3f& tf,
+                                         Vec3f* contact, FCL_REAL* depth,
+                                         Vec3f* normal)
+{
+  FCL_REAL dist;
+  Vec3f p1, p2, n;
+  if(voxelCapsuleDistance(voxel, s, tf, dist, p1, p2, n) && dist > 0)
+    return false;
+  if(!contact && !depth && !normal) return true;
+
+  Box box;
+  Transform3f box_tf;
+  voxel.toBox(box, box_tf);
+  return solver->shapeIntersect(box, box_tf, s, tf, contact, depth, normal);
+}
+
+/// @brief Distance between a voxel and a shape. The closed form kernels
+/// are used for disjoint spheres and capsules, the narrow phase solver
+/// otherwise.
+template<typename S>
+void voxelShapeDistance(const GJKSolver* solver, const Voxel& voxel,
+                        const S& s, const Transform3f& tf, FCL_REAL& dist,
+                        Vec3f& p1, Vec3f& p2, Vec3f& normal)
+{
+  Box box;
+  Transform3f box_tf;
+  voxel.toBox(box, box_tf);
+  solver->shapeDistance(box, box_tf, s, tf, dist, p1, p2, normal);
+}
+
+template<>
+inline void voxelShapeDistance<Sphere>(const GJKSolver*, const Voxel& voxel,
+                                       const Sphere& s, const Transform3f& tf,
+                                       FCL_REAL& dist, Vec3f& p1, Vec3f& p2,
+                                       Vec3f& normal)
+{
+  voxelSphereDistance(voxel, s, tf, dist, p1, p2, normal);
+}
+
+template<>
+inline void voxelShapeDistance<Capsule>(const GJKSolver* solver,
+                                        const Voxel& voxel,
+                                        const Capsule& s, const Transform3f& tf,
+                                        FCL_REAL& dist, Vec3f& p1, Vec3f& p2,
+                                        Vec3f& normal)
+{
+  if(voxelCapsuleDistance(voxel, s, tf, dist, p1, p2, normal)) return;
+
+  Box box;
+  Transform3f box_tf;
+  voxel.toBox(box, box_tf);
+  solver->shapeDistance(box, box_tf, s, tf, dist, p1, p2, normal);
+}
+
+}
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
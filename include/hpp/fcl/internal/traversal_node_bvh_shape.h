@@ -74,22 +74,34 @@ public:
     query_time_seconds = 0.0;
   }
 
+  /// @brief Alway extend the first model, which is a BVH model
+  bool firstOverSecond(int, int) const
+  {
+    return true;
+  }
+
   /// @brief Whether the BV node in the first BVH tree is leaf
   bool isFirstNodeLeaf(int b) const
   {
-    return model1->getBV(b).isLeaf();
+    return model1->isLeaf(b);
+  }
+
+  /// @brief The shape is a leaf
+  bool isSecondNodeLeaf(int) const
+  {
+    return true;
   }
 
   /// @brief Obtain the left child of BV node in the first BVH
   int getFirstLeftChild(int b) const
   {
-    return model1->getBV(b).leftChild();
+    return model1->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the first BVH
   int getFirstRightChild(int b) const
   {
-    return model1->getBV(b).rightChild();
+    return model1->rightChild(b);
   }
 
   const BVHModel<BV>* model1;
@@ -126,19 +138,19 @@ public:
   /// @brief Whether the BV node in the second BVH tree is leaf
   bool isSecondNodeLeaf(int b) const
   {
-    return model2->getBV(b).isLeaf();
+    return model2->isLeaf(b);
   }
 
   /// @brief Obtain the left child of BV node in the second BVH
   int getSecondLeftChild(int b) const
   {
-    return model2->getBV(b).leftChild();
+    return model2->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the second BVH
   int getSecondRightChild(int b) const
   {
-    return model2->getBV(b).rightChild();
+    return model2->rightChild(b);
   }
 
   const S* model1;
@@ -175,10 +187,12 @@ public:
   bool BVDisjoints(int b1, int /*b2*/) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
-    if (RTIsIdentity)
-      return !this->model1->getBV(b1).bv.overlap(this->model2_bv);
-    else
-      return !overlap(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getBV(b1).bv);
+    if(this->model1->decodesVolumes())
+    {
+      BV buffer;
+      return volumeDisjoint(this->model1->getVolume(b1, buffer));
+    }
+    return volumeDisjoint(this->model1->getBV(b1).bv);
   }
 
   /// test between BV b1 and shape
@@ -189,24 +203,20 @@ public:
   bool BVDisjoints(int b1, int /*b2*/, FCL_REAL& sqrDistLowerBound) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
-    bool res;
-    if (RTIsIdentity)
-      res = !this->model1->getBV(b1).bv.overlap(this->model2_bv, this->request, sqrDistLowerBound);
-    else
-      res = !overlap(this->tf1.getRotation(), this->tf1.getTranslation(),
-                      this->model2_bv, this->model1->getBV(b1).bv,
-                      this->request, sqrDistLowerBound);
-    assert (!res || sqrDistLowerBound > 0);
-    return res;
+    if(this->model1->decodesVolumes())
+    {
+      BV buffer;
+      return volumeDisjoint(this->model1->getVolume(b1, buffer),
+                            sqrDistLowerBound);
+    }
+    return volumeDisjoint(this->model1->getBV(b1).bv, sqrDistLowerBound);
   }
 
   /// @brief Intersection testing between leaves (one triangle and one shape)
   void leafCollides(int b1, int /*b2*/, FCL_REAL& sqrDistLowerBound) const
   {
     if(this->enable_statistics) this->num_leaf_tests++;
-    const BVNode<BV>& node = this->model1->getBV(b1);
-
-    int primitive_id = node.primitiveId();
+    int primitive_id = this->model1->primitiveId(b1);
 
     const Triangle& tri_id = tri_indices[primitive_id];
 
@@ -225,9 +235,12 @@ public:
         nsolver->shapeTriangleInteraction(*(this->model2), this->tf2, p1, p2, p3,
                                           Id       , distance, c2, c1, normal);
     } else {
+      nsolver->setGJKCacheKey(GJKCache::Key(this->model2, this->model1,
+                                            primitive_id));
       collision =
         nsolver->shapeTriangleInteraction(*(this->model2), this->tf2, p1, p2, p3,
                                           this->tf1, distance, c2, c1, normal);
+      nsolver->resetGJKCacheKey();
     }
 
     if(collision) {
@@ -263,6 +276,28 @@ public:
   Triangle* tri_indices;
 
   const GJKSolver* nsolver;
+
+private:
+  bool volumeDisjoint(const BV& bv1) const
+  {
+    if (RTIsIdentity)
+      return !bv1.overlap(this->model2_bv);
+    else
+      return !overlap(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, bv1);
+  }
+
+  bool volumeDisjoint(const BV& bv1, FCL_REAL& sqrDistLowerBound) const
+  {
+    bool res;
+    if (RTIsIdentity)
+      res = !bv1.overlap(this->model2_bv, this->request, sqrDistLowerBound);
+    else
+      res = !overlap(this->tf1.getRotation(), this->tf1.getTranslation(),
+                      this->model2_bv, bv1,
+                      this->request, sqrDistLowerBound);
+    assert (!res || sqrDistLowerBound > 0);
+    return res;
+  }
 };
 
 /// @brief Traversal node for mesh and shape, when mesh BVH is one of the oriented node (OBB, RSS, OBBRSS, kIOS)
@@ -336,10 +371,12 @@ public:
   bool BVDisjoints(int /*b1*/, int b2) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
-    if (RTIsIdentity)
-      return !this->model2->getBV(b2).bv.overlap(this->model1_bv);
-    else
-      return !overlap(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, this->model2->getBV(b2).bv);
+    if(this->model2->decodesVolumes())
+    {
+      BV buffer;
+      return volumeDisjoint(this->model2->getVolume(b2, buffer));
+    }
+    return volumeDisjoint(this->model2->getBV(b2).bv);
   }
 
   /// BV test between b1 and b2
@@ -349,24 +386,20 @@ public:
   bool BVDisjoints(int /*b1*/, int b2, FCL_REAL& sqrDistLowerBound) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
-    bool res;
-    if (RTIsIdentity)
-      res = !this->model2->getBV(b2).bv.overlap(this->model1_bv, sqrDistLowerBound);
-    else
-      res = !overlap(this->tf2.getRotation(), this->tf2.getTranslation(),
-                     this->model1_bv, this->model2->getBV(b2).bv,
-                     sqrDistLowerBound);
-    assert (!res || sqrDistLowerBound > 0);
-    return res;
+    if(this->model2->decodesVolumes())
+    {
+      BV buffer;
+      return volumeDisjoint(this->model2->getVolume(b2, buffer),
+                            sqrDistLowerBound);
+    }
+    return volumeDisjoint(this->model2->getBV(b2).bv, sqrDistLowerBound);
   }
 
   /// @brief Intersection testing between leaves (one shape and one triangle)
   void leafCollides(int /*b1*/, int b2, FCL_REAL& sqrDistLowerBound) const
   {
     if(this->enable_statistics) this->num_leaf_tests++;
-    const BVNode<BV>& node = this->model2->getBV(b2);
-
-    int primitive_id = node.primitiveId();
+    int primitive_id = this->model2->primitiveId(b2);
 
     const Triangle& tri_id = tri_indices[primitive_id];
 
@@ -385,9 +418,12 @@ public:
         nsolver->shapeTriangleInteraction(*(this->model1), this->tf1, p1, p2, p3,
                                           Id       , c1, c2, distance, normal);
     } else {
+      nsolver->setGJKCacheKey(GJKCache::Key(this->model1, this->model2,
+                                            primitive_id));
       collision =
         nsolver->shapeTriangleInteraction(*(this->model1), this->tf1, p1, p2, p3,
                                           this->tf2, c1, c2, distance, normal);
+      nsolver->resetGJKCacheKey();
     }
 
     if (collision) {
@@ -423,6 +459,28 @@ public:
   Triangle* tri_indices;
 
   const GJKSolver* nsolver;
+
+private:
+  bool volumeDisjoint(const BV& bv2) const
+  {
+    if (RTIsIdentity)
+      return !bv2.overlap(this->model1_bv);
+    else
+      return !overlap(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, bv2);
+  }
+
+  bool volumeDisjoint(const BV& bv2, FCL_REAL& sqrDistLowerBound) const
+  {
+    bool res;
+    if (RTIsIdentity)
+      res = !bv2.overlap(this->model1_bv, sqrDistLowerBound);
+    else
+      res = !overlap(this->tf2.getRotation(), this->tf2.getTranslation(),
+                     this->model1_bv, bv2,
+                     sqrDistLowerBound);
+    assert (!res || sqrDistLowerBound > 0);
+    return res;
+  }
 };
 
 /// @brief Traversal node for shape and mesh, when mesh BVH is one of the oriented node (OBB, RSS, OBBRSS, kIOS)
@@ -485,27 +543,44 @@ public:
     query_time_seconds = 0.0;
   }
 
+  /// @brief Alway extend the first model, which is a BVH model
+  bool firstOverSecond(int, int) const
+  {
+    return true;
+  }
+
   /// @brief Whether the BV node in the first BVH tree is leaf
   bool isFirstNodeLeaf(int b) const 
   {
-    return model1->getBV(b).isLeaf();
+    return model1->isLeaf(b);
+  }
+
+  /// @brief The shape is a leaf
+  bool isSecondNodeLeaf(int) const
+  {
+    return true;
   }
 
   /// @brief Obtain the left child of BV node in the first BVH
   int getFirstLeftChild(int b) const
   {
-    return model1->getBV(b).leftChild();
+    return model1->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the first BVH
   int getFirstRightChild(int b) const
   {
-    return model1->getBV(b).rightChild();
+    return model1->rightChild(b);
   }
 
   /// @brief BV culling test in one BVTT node
   FCL_REAL BVDistanceLowerBound(int b1, int /*b2*/) const
   {
+    if(model1->decodesVolumes())
+    {
+      BV buffer;
+      return model1->getVolume(b1, buffer).distance(model2_bv);
+    }
     return model1->getBV(b1).bv.distance(model2_bv);
   }
 
@@ -536,24 +611,29 @@ public:
   /// @brief Whether the BV node in the second BVH tree is leaf
   bool isSecondNodeLeaf(int b) const
   {
-    return model2->getBV(b).isLeaf();
+    return model2->isLeaf(b);
   }
 
   /// @brief Obtain the left child of BV node in the second BVH
   int getSecondLeftChild(int b) const
   {
-    return model2->getBV(b).leftChild();
+    return model2->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the second BVH
   int getSecondRightChild(int b) const
   {
-    return model2->getBV(b).rightChild();
+    return model2->rightChild(b);
   }
 
   /// @brief BV culling test in one BVTT node
   FCL_REAL BVDistanceLowerBound(int b1, int b2) const
   {
+    if(model2->decodesVolumes())
+    {
+      BV buffer;
+      return model1_bv.distance(model2->getVolume(b2, buffer));
+    }
     return model1_bv.distance(model2->getBV(b2).bv);
   }
 
@@ -588,9 +668,7 @@ public:
   {
     if(this->enable_statistics) this->num_leaf_tests++;
     
-    const BVNode<BV>& node = this->model1->getBV(b1);
-    
-    int primitive_id = node.primitiveId();
+    int primitive_id = this->model1->primitiveId(b1);
     
     const Triangle& tri_id = tri_indices[primitive_id];
 
@@ -609,9 +687,14 @@ public:
                          normal);
   }
 
-  /// @brief Whether the traversal process can stop early
+  /// @brief Whether the traversal process can stop early, either because
+  /// the bound c cannot improve the result, or because it settles the
+  /// request distance threshold.
   bool canStop(FCL_REAL c) const
   {
+    const FCL_REAL& threshold = this->request.distance_threshold;
+    if(threshold > 0 && (c >= threshold || this->result->min_distance < threshold))
+      return true;
     if((c >= this->result->min_distance - abs_err) && (c * (1 + rel_err) >= this->result->min_distance))
       return true;
     return false;
@@ -644,8 +727,7 @@ void meshShapeDistanceOrientedNodeleafComputeDistance(int b1, int /* b2 */,
 {
   if(enable_statistics) num_leaf_tests++;
     
-  const BVNode<BV>& node = model1->getBV(b1);
-  int primitive_id = node.primitiveId();
+  int primitive_id = model1->primitiveId(b1);
 
   const Triangle& tri_id = tri_indices[primitive_id];
   const Vec3f& p1 = vertices[tri_id[0]];
@@ -654,8 +736,10 @@ void meshShapeDistanceOrientedNodeleafComputeDistance(int b1, int /* b2 */,
     
   FCL_REAL distance;
   Vec3f closest_p1, closest_p2, normal;
+  nsolver->setGJKCacheKey(GJKCache::Key(&model2, model1, primitive_id));
   nsolver->shapeTriangleInteraction(model2, tf2, p1, p2, p3, tf1, distance,
                                     closest_p2, closest_p1, normal);
+  nsolver->resetGJKCacheKey();
 
   result.update(distance, model1, &model2, primitive_id, DistanceResult::NONE,
                 closest_p1, closest_p2, normal);
@@ -714,6 +798,11 @@ public:
   FCL_REAL BVDistanceLowerBound(int b1, int /*b2*/) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if(this->model1->decodesVolumes())
+    {
+      RSS buffer;
+      return distance(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getVolume(b1, buffer));
+    }
     return distance(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getBV(b1).bv);
   }
 
@@ -746,6 +835,11 @@ public:
   FCL_REAL BVDistanceLowerBound(int b1, int /*b2*/) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if(this->model1->decodesVolumes())
+    {
+      kIOS buffer;
+      return distance(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getVolume(b1, buffer));
+    }
     return distance(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getBV(b1).bv);
   }
 
@@ -779,6 +873,11 @@ public:
   FCL_REAL BVDistanceLowerBound(int b1, int /*b2*/) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if(this->model1->decodesVolumes())
+    {
+      OBBRSS buffer;
+      return distance(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getVolume(b1, buffer));
+    }
     return distance(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getBV(b1).bv);
   }
 
@@ -811,9 +910,7 @@ public:
   {
     if(this->enable_statistics) this->num_leaf_tests++;
     
-    const BVNode<BV>& node = this->model2->getBV(b2);
-    
-    int primitive_id = node.primitiveId();
+    int primitive_id = this->model2->primitiveId(b2);
     
     const Triangle& tri_id = tri_indices[primitive_id];
 
@@ -832,9 +929,14 @@ public:
                          closest_p2, normal);
   }
 
-  /// @brief Whether the traversal process can stop early
+  /// @brief Whether the traversal process can stop early, either because
+  /// the bound c cannot improve the result, or because it settles the
+  /// request distance threshold.
   bool canStop(FCL_REAL c) const
   {
+    const FCL_REAL& threshold = this->request.distance_threshold;
+    if(threshold > 0 && (c >= threshold || this->result->min_distance < threshold))
+      return true;
     if((c >= this->result->min_distance - abs_err) && (c * (1 + rel_err) >= this->result->min_distance))
       return true;
     return false;
@@ -871,6 +973,11 @@ public:
   FCL_REAL BVDistanceLowerBound(int b1, int b2) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if(this->model2->decodesVolumes())
+    {
+      RSS buffer;
+      return distance(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, this->model2->getVolume(b2, buffer));
+    }
     return distance(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, this->model2->getBV(b2).bv);
   }
 
@@ -903,6 +1010,11 @@ public:
   FCL_REAL BVDistanceLowerBound(int b1, int b2) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if(this->model2->decodesVolumes())
+    {
+      kIOS buffer;
+      return distance(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, this->model2->getVolume(b2, buffer));
+    }
     return distance(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, this->model2->getBV(b2).bv);
   }
 
@@ -935,6 +1047,11 @@ public:
   FCL_REAL BVDistanceLowerBound(int b1, int b2) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if(this->model2->decodesVolumes())
+    {
+      OBBRSS buffer;
+      return distance(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, this->model2->getVolume(b2, buffer));
+    }
     return distance(this->tf2.getRotation(), this->tf2.getTranslation(), this->model1_bv, this->model2->getBV(b2).bv);
   }
 
@@ -83,23 +83,33 @@ public:
   /// @brief Whether the BV node in the first BVH tree is leaf
   bool isFirstNodeLeaf(int b) const
   {
-    return model1->getBV(b).isLeaf();
+    return model1->isLeaf(b);
   }
 
   /// @brief Whether the BV node in the second BVH tree is leaf
   bool isSecondNodeLeaf(int b) const
   {
-    return model2->getBV(b).isLeaf();
+    return model2->isLeaf(b);
   }
 
   /// @brief Determine the traversal order, is the first BVTT subtree better
   bool firstOverSecond(int b1, int b2) const
   {
-    FCL_REAL sz1 = model1->getBV(b1).bv.size();
-    FCL_REAL sz2 = model2->getBV(b2).bv.size();
+    FCL_REAL sz1, sz2;
+    if(model1->decodesVolumes() || model2->decodesVolumes())
+    {
+      BV buffer1, buffer2;
+      sz1 = model1->getVolume(b1, buffer1).size();
+      sz2 = model2->getVolume(b2, buffer2).size();
+    }
+    else
+    {
+      sz1 = model1->getBV(b1).bv.size();
+      sz2 = model2->getBV(b2).bv.size();
+    }
 
-    bool l1 = model1->getBV(b1).isLeaf();
-    bool l2 = model2->getBV(b2).isLeaf();
+    bool l1 = model1->isLeaf(b1);
+    bool l2 = model2->isLeaf(b2);
 
     if(l2 || (!l1 && (sz1 > sz2)))
       return true;
@@ -109,25 +119,25 @@ public:
   /// @brief Obtain the left child of BV node in the first BVH
   int getFirstLeftChild(int b) const
   {
-    return model1->getBV(b).leftChild();
+    return model1->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the first BVH
   int getFirstRightChild(int b) const
   {
-    return model1->getBV(b).rightChild();
+    return model1->rightChild(b);
   }
 
   /// @brief Obtain the left child of BV node in the second BVH
   int getSecondLeftChild(int b) const
   {
-    return model2->getBV(b).leftChild();
+    return model2->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the second BVH
   int getSecondRightChild(int b) const
   {
-    return model2->getBV(b).rightChild();
+    return model2->rightChild(b);
   }
   
   /// @brief The first BVH model
@@ -164,11 +174,14 @@ public:
   bool BVDisjoints(int b1, int b2) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
-    if (RTIsIdentity)
-      return !this->model1->getBV(b1).overlap(this->model2->getBV(b2));
-    else
-      return !overlap(RT._R(), RT._T(),
-          this->model1->getBV(b1).bv, this->model2->getBV(b2).bv);
+    if(this->model1->decodesVolumes() || this->model2->decodesVolumes())
+    {
+      BV buffer1, buffer2;
+      return volumesDisjoint(this->model1->getVolume(b1, buffer1),
+                             this->model2->getVolume(b2, buffer2));
+    }
+    return volumesDisjoint(this->model1->getBV(b1).bv,
+                           this->model2->getBV(b2).bv);
   }
   
   /// BV test between b1 and b2
@@ -178,16 +191,15 @@ public:
   bool BVDisjoints(int b1, int b2, FCL_REAL& sqrDistLowerBound) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
-    if (RTIsIdentity)
-      return !this->model1->getBV(b1).overlap(this->model2->getBV(b2),
-          this->request, sqrDistLowerBound);
-    else {
-      bool res = !overlap(RT._R(), RT._T(),
-          this->model1->getBV(b1).bv, this->model2->getBV(b2).bv,
-          this->request, sqrDistLowerBound);
-      assert (!res || sqrDistLowerBound > 0);
-      return res;
+    if(this->model1->decodesVolumes() || this->model2->decodesVolumes())
+    {
+      BV buffer1, buffer2;
+      return volumesDisjoint(this->model1->getVolume(b1, buffer1),
+                             this->model2->getVolume(b2, buffer2),
+                             sqrDistLowerBound);
     }
+    return volumesDisjoint(this->model1->getBV(b1).bv,
+                           this->model2->getBV(b2).bv, sqrDistLowerBound);
   }
 
   /// Intersection testing between leaves (two triangles)
@@ -208,11 +220,8 @@ public:
   {
     if(this->enable_statistics) this->num_leaf_tests++;
 
-    const BVNode<BV>& node1 = this->model1->getBV(b1);
-    const BVNode<BV>& node2 = this->model2->getBV(b2);
-
-    int primitive_id1 = node1.primitiveId();
-    int primitive_id2 = node2.primitiveId();
+    int primitive_id1 = this->model1->primitiveId(b1);
+    int primitive_id2 = this->model2->primitiveId(b2);
 
     const Triangle& tri_id1 = tri_indices1[primitive_id1];
     const Triangle& tri_id2 = tri_indices2[primitive_id2];
@@ -224,27 +233,23 @@ public:
     const Vec3f& Q2 = vertices2[tri_id2[1]];
     const Vec3f& Q3 = vertices2[tri_id2[2]];
 
-    TriangleP tri1 (P1, P2, P3);
-    TriangleP tri2 (Q1, Q2, Q3);
-    GJKSolver solver;
-    Vec3f p1, p2; // closest points if no collision contact points if collision.
+    Vec3f S[3] = { this->tf1.transform (P1), this->tf1.transform (P2),
+                   this->tf1.transform (P3) };
+    Vec3f T[3] = { this->tf2.transform (Q1), this->tf2.transform (Q2),
+                   this->tf2.transform (Q3) };
+    Vec3f p1, p2; // closest points if no collision, both at the contact
+                  // point otherwise.
     Vec3f normal;
-    FCL_REAL distance;
-    solver.shapeDistance (tri1, this->tf1, tri2, this->tf2,
-                          distance, p1, p2, normal);
+    FCL_REAL distance = TriangleDistance::signedTriDistance (S, T, p1, p2,
+                                                             normal);
     FCL_REAL distToCollision = distance - this->request.security_margin;
-    sqrDistLowerBound = distance * distance;
+    sqrDistLowerBound = distance > 0 ? distance * distance : 0;
     if (distToCollision <= 0) { // collision
-      Vec3f p (p1); // contact point
-      FCL_REAL penetrationDepth (0);
       if(this->result->numContacts() < this->request.num_max_contacts) {
         // How much (Q1, Q2, Q3) should be moved so that all vertices are
         // above (P1, P2, P3).
-        penetrationDepth = -distance;
-        if (distance > 0) {
-          normal = (p2-p1).normalized ();
-          p = .5* (p1+p2);
-        }
+        FCL_REAL penetrationDepth = -distance;
+        Vec3f p (.5* (p1+p2)); // contact point
         this->result->addContact(Contact(this->model1, this->model2,
                                          primitive_id1, primitive_id2,
                                          p, normal, penetrationDepth));
@@ -265,6 +270,28 @@ public:
   Triangle* tri_indices2;
 
   details::RelativeTransformation<!bool(RTIsIdentity)> RT;
+
+private:
+  bool volumesDisjoint(const BV& bv1, const BV& bv2) const
+  {
+    if (RTIsIdentity)
+      return !bv1.overlap(bv2);
+    else
+      return !overlap(RT._R(), RT._T(), bv1, bv2);
+  }
+
+  bool volumesDisjoint(const BV& bv1, const BV& bv2,
+                       FCL_REAL& sqrDistLowerBound) const
+  {
+    if (RTIsIdentity)
+      return !bv1.overlap(bv2, this->request, sqrDistLowerBound);
+    else {
+      bool res = !overlap(RT._R(), RT._T(), bv1, bv2,
+          this->request, sqrDistLowerBound);
+      assert (!res || sqrDistLowerBound > 0);
+      return res;
+    }
+  }
 };
 
 /// @brief Traversal node for collision between two meshes if their underlying BVH node is oriented node (OBB, RSS, OBBRSS, kIOS)
@@ -279,7 +306,7 @@ namespace details
 {
   template<typename BV> struct DistanceTraversalBVDistanceLowerBound_impl
   {
-    static FCL_REAL run(const BVNode<BV>& b1, const BVNode<BV>& b2)
+    static FCL_REAL run(const BV& b1, const BV& b2)
     {
       return b1.distance(b2);
     }
@@ -287,7 +314,7 @@ namespace details
 
   template<> struct DistanceTraversalBVDistanceLowerBound_impl<OBB>
   {
-    static FCL_REAL run(const BVNode<OBB>& b1, const BVNode<OBB>& b2)
+    static FCL_REAL run(const OBB& b1, const OBB& b2)
     {
       FCL_REAL sqrDistLowerBound;
       CollisionRequest request (DISTANCE_LOWER_BOUND, 0);
@@ -322,23 +349,33 @@ public:
   /// @brief Whether the BV node in the first BVH tree is leaf
   bool isFirstNodeLeaf(int b) const
   {
-    return model1->getBV(b).isLeaf();
+    return model1->isLeaf(b);
   }
 
   /// @brief Whether the BV node in the second BVH tree is leaf
   bool isSecondNodeLeaf(int b) const
   {
-    return model2->getBV(b).isLeaf();
+    return model2->isLeaf(b);
   }
 
   /// @brief Determine the traversal order, is the first BVTT subtree better
   bool firstOverSecond(int b1, int b2) const
   {
-    FCL_REAL sz1 = model1->getBV(b1).bv.size();
-    FCL_REAL sz2 = model2->getBV(b2).bv.size();
+    FCL_REAL sz1, sz2;
+    if(model1->decodesVolumes() || model2->decodesVolumes())
+    {
+      BV buffer1, buffer2;
+      sz1 = model1->getVolume(b1, buffer1).size();
+      sz2 = model2->getVolume(b2, buffer2).size();
+    }
+    else
+    {
+      sz1 = model1->getBV(b1).bv.size();
+      sz2 = model2->getBV(b2).bv.size();
+    }
 
-    bool l1 = model1->getBV(b1).isLeaf();
-    bool l2 = model2->getBV(b2).isLeaf();
+    bool l1 = model1->isLeaf(b1);
+    bool l2 = model2->isLeaf(b2);
 
     if(l2 || (!l1 && (sz1 > sz2)))
       return true;
@@ -348,33 +385,39 @@ public:
   /// @brief Obtain the left child of BV node in the first BVH
   int getFirstLeftChild(int b) const
   {
-    return model1->getBV(b).leftChild();
+    return model1->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the first BVH
   int getFirstRightChild(int b) const
   {
-    return model1->getBV(b).rightChild();
+    return model1->rightChild(b);
   }
 
   /// @brief Obtain the left child of BV node in the second BVH
   int getSecondLeftChild(int b) const
   {
-    return model2->getBV(b).leftChild();
+    return model2->leftChild(b);
   }
 
   /// @brief Obtain the right child of BV node in the second BVH
   int getSecondRightChild(int b) const
   {
-    return model2->getBV(b).rightChild();
+    return model2->rightChild(b);
   }
 
   /// @brief BV culling test in one BVTT node
   FCL_REAL BVDistanceLowerBound(int b1, int b2) const
   {
     if(enable_statistics) num_bv_tests++;
+    if(model1->decodesVolumes() || model2->decodesVolumes())
+    {
+      BV buffer1, buffer2;
+      return details::DistanceTraversalBVDistanceLowerBound_impl<BV>
+        ::run (model1->getVolume(b1, buffer1), model2->getVolume(b2, buffer2));
+    }
     return details::DistanceTraversalBVDistanceLowerBound_impl<BV>
-      ::run (model1->getBV(b1), model2->getBV(b2));
+      ::run (model1->getBV(b1).bv, model2->getBV(b2).bv);
   }
 
   /// @brief The first BVH model
@@ -410,11 +453,8 @@ public:
   {
     if(this->enable_statistics) this->num_leaf_tests++;
 
-    const BVNode<BV>& node1 = this->model1->getBV(b1);
-    const BVNode<BV>& node2 = this->model2->getBV(b2);
-
-    int primitive_id1 = node1.primitiveId();
-    int primitive_id2 = node2.primitiveId();
+    int primitive_id1 = this->model1->primitiveId(b1);
+    int primitive_id2 = this->model2->primitiveId(b2);
 
     const Triangle& tri_id1 = tri_indices1[primitive_id1];
     const Triangle& tri_id2 = tri_indices2[primitive_id2];
@@ -437,9 +477,14 @@ public:
                          primitive_id2, P1, P2, normal);
   }
 
-  /// @brief Whether the traversal process can stop early
+  /// @brief Whether the traversal process can stop early, either because
+  /// the bound c cannot improve the result, or because it settles the
+  /// request distance threshold.
   bool canStop(FCL_REAL c) const
   {
+    const FCL_REAL& threshold = this->request.distance_threshold;
+    if(threshold > 0 && (c >= threshold || this->result->min_distance < threshold))
+      return true;
     if((c >= this->result->min_distance - abs_err) && (c * (1 + rel_err) >= this->result->min_distance))
       return true;
     return false;
@@ -42,6 +42,8 @@
 
 #include <hpp/fcl/collision_data.h>
 #include <hpp/fcl/internal/traversal_node_base.h>
+#include <hpp/fcl/internal/octree_voxel.h>
+#include <hpp/fcl/internal/traversal_octree_pair.h>
 #include <hpp/fcl/narrowphase/narrowphase.h>
 #include <hpp/fcl/octree.h>
 #include <hpp/fcl/BVH/BVH_model.h>
@@ -79,12 +81,9 @@ public:
                        const CollisionRequest& request_,
                        CollisionResult& result_) const
   {
-    crequest = &request_;
-    cresult = &result_;
-    
-    OcTreeIntersectRecurse(tree1, tree1->getRoot(), tree1->getRootBV(), 
-                           tree2, tree2->getRoot(), tree2->getRootBV(), 
-                           tf1, tf2);
+    details::OcTreePair pair(solver, tree1, tf1, tree2, tf2,
+                             request_.octree_max_depth);
+    pair.collide(request_, result_);
   }
 
   /// @brief distance between two octrees
@@ -93,12 +92,9 @@ public:
                       const DistanceRequest& request_,
                       DistanceResult& result_) const
   {
-    drequest = &request_;
-    dresult = &result_;
-
-    OcTreeDistanceRecurse(tree1, tree1->getRoot(), tree1->getRootBV(), 
-                          tree2, tree2->getRoot(), tree2->getRootBV(),
-                          tf1, tf2);
+    details::OcTreePair pair(solver, tree1, tf1, tree2, tf2,
+                             request_.octree_max_depth);
+    pair.distance(request_, result_);
   }
 
   /// @brief collision between octree and mesh
@@ -111,7 +107,10 @@ public:
     crequest = &request_;
     cresult = &result_;
 
-    OcTreeMeshIntersectRecurse(tree1, tree1->getRoot(), tree1->getRootBV(),
+    const OcTreeSnapshot& snap1 = tree1->getSnapshot();
+    if(snap1.empty()) return;
+
+    OcTreeMeshIntersectRecurse(tree1, snap1.getRoot(), snap1.getRootBV(),
                                tree2, 0,
                                tf1, tf2);
   }
@@ -126,7 +125,10 @@ public:
     drequest = &request_;
     dresult = &result_;
 
-    OcTreeMeshDistanceRecurse(tree1, tree1->getRoot(), tree1->getRootBV(),
+    const OcTreeSnapshot& snap1 = tree1->getSnapshot();
+    if(snap1.empty()) return;
+
+    OcTreeMeshDistanceRecurse(tree1, snap1.getRoot(), snap1.getRootBV(),
                               tree2, 0,
                               tf1, tf2);
   }
@@ -142,7 +144,10 @@ public:
     crequest = &request_;
     cresult = &result_;
 
-    OcTreeMeshIntersectRecurse(tree2, tree2->getRoot(), tree2->getRootBV(),
+    const OcTreeSnapshot& snap2 = tree2->getSnapshot();
+    if(snap2.empty()) return;
+
+    OcTreeMeshIntersectRecurse(tree2, snap2.getRoot(), snap2.getRootBV(),
                                tree1, 0,
                                tf2, tf1);
   }
@@ -157,8 +162,11 @@ public:
     drequest = &request_;
     dresult = &result_;
 
+    const OcTreeSnapshot& snap2 = tree2->getSnapshot();
+    if(snap2.empty()) return;
+
     OcTreeMeshDistanceRecurse(tree1, 0,
-                              tree2, tree2->getRoot(), tree2->getRootBV(),
+                              tree2, snap2.getRoot(), snap2.getRootBV(),
                               tf1, tf2);
   }
 
@@ -172,11 +180,14 @@ public:
     crequest = &request_;
     cresult = &result_;
 
+    const OcTreeSnapshot& snap = tree->getSnapshot();
+    if(snap.empty()) return;
+
     AABB bv2;
     computeBV<AABB>(s, Transform3f(), bv2);
     OBB obb2;
     convertBV(bv2, tf2, obb2);
-    OcTreeShapeIntersectRecurse(tree, tree->getRoot(), tree->getRootBV(),
+    OcTreeShapeIntersectRecurse(tree, snap.getRoot(), snap.getRootBV(),
                                 s, obb2,
                                 tf1, tf2);
     
@@ -192,11 +203,14 @@ public:
     crequest = &request_;
     cresult = &result_;
 
+    const OcTreeSnapshot& snap = tree->getSnapshot();
+    if(snap.empty()) return;
+
     AABB bv1;
     computeBV<AABB>(s, Transform3f(), bv1);
     OBB obb1;
     convertBV(bv1, tf1, obb1);
-    OcTreeShapeIntersectRecurse(tree, tree->getRoot(), tree->getRootBV(),
+    OcTreeShapeIntersectRecurse(tree, snap.getRoot(), snap.getRootBV(),
                                 s, obb1,
                                 tf2, tf1);
   }
@@ -211,9 +225,12 @@ public:
     drequest = &request_;
     dresult = &result_;
 
+    const OcTreeSnapshot& snap = tree->getSnapshot();
+    if(snap.empty()) return;
+
     AABB aabb2;
     computeBV<AABB>(s, tf2, aabb2);
-    OcTreeShapeDistanceRecurse(tree, tree->getRoot(), tree->getRootBV(),
+    OcTreeShapeDistanceRecurse(tree, snap.getRoot(), snap.getRootBV(),
                                s, aabb2,
                                tf1, tf2);
   }
@@ -228,9 +245,12 @@ public:
     drequest = &request_;
     dresult = &result_;
 
+    const OcTreeSnapshot& snap = tree->getSnapshot();
+    if(snap.empty()) return;
+
     AABB aabb1;
     computeBV<AABB>(s, tf1, aabb1);
-    OcTreeShapeDistanceRecurse(tree, tree->getRoot(), tree->getRootBV(),
+    OcTreeShapeDistanceRecurse(tree, snap.getRoot(), snap.getRootBV(),
                                s, aabb1,
                                tf2, tf1);
   }
@@ -238,24 +258,23 @@ public:
 
 private:
   template<typename S>
-  bool OcTreeShapeDistanceRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  bool OcTreeShapeDistanceRecurse(const OcTree* tree1, unsigned int root1, const AABB& bv1,
                                   const S& s, const AABB& aabb2,
                                   const Transform3f& tf1, const Transform3f& tf2) const
   {
-    if(!tree1->nodeHasChildren(root1))
+    const OcTreeSnapshot& snap1 = tree1->getSnapshot();
+    if(!snap1.nodeHasChildren(root1))
     {
-      if(tree1->isNodeOccupied(root1))
+      if(snap1.isNodeOccupied(root1))
       {
-        Box box;
-        Transform3f box_tf;
-        constructBox(bv1, tf1, box, box_tf);
- 
+        details::Voxel voxel(bv1, tf1);
+
         FCL_REAL dist;
         Vec3f closest_p1, closest_p2, normal;
-        solver->shapeDistance(box, box_tf, s, tf2, dist, closest_p1,
-                              closest_p2, normal);
+        details::voxelShapeDistance(solver, voxel, s, tf2, dist, closest_p1,
+                                    closest_p2, normal);
         
-        dresult->update(dist, tree1, &s, (int) (root1 - tree1->getRoot()),
+        dresult->update(dist, tree1, &s, (int) root1,
                         DistanceResult::NONE, closest_p1, closest_p2,
                         normal);
         
@@ -265,13 +284,13 @@ private:
         return false;
     }
 
-    if(!tree1->isNodeOccupied(root1)) return false;
+    if(!snap1.isNodeOccupied(root1)) return false;
     
     for(unsigned int i = 0; i < 8; ++i)
     {
-      if(tree1->nodeChildExists(root1, i))
+      if(snap1.nodeChildExists(root1, i))
       {
-        const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+        unsigned int child = snap1.getNodeChild(root1, i);
         AABB child_bv;
         computeChildBV(bv1, i, child_bv);
         
@@ -290,50 +309,27 @@ private:
   }
 
   template<typename S>
-  bool OcTreeShapeIntersectRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  bool OcTreeShapeIntersectRecurse(const OcTree* tree1, unsigned int root1, const AABB& bv1,
                                    const S& s, const OBB& obb2,
                                    const Transform3f& tf1, const Transform3f& tf2) const
   {
-    if(!root1)
+    const OcTreeSnapshot& snap1 = tree1->getSnapshot();
+    if(!snap1.nodeHasChildren(root1))
     {
-      OBB obb1;
-      convertBV(bv1, tf1, obb1);
-      if(obb1.overlap(obb2))
-      {
-        Box box;
-        Transform3f box_tf;
-        constructBox(bv1, tf1, box, box_tf);
-
-        if(solver->shapeIntersect(box, box_tf, s, tf2, NULL, NULL, NULL))
-        {
-          AABB overlap_part;
-          AABB aabb1, aabb2;
-          computeBV<AABB, Box>(box, box_tf, aabb1);
-          computeBV<AABB, S>(s, tf2, aabb2);
-          aabb1.overlap(aabb2, overlap_part);
-        }
-      }
-
-      return false;
-    }
-    else if(!tree1->nodeHasChildren(root1))
-    {
-      if(tree1->isNodeOccupied(root1)) // occupied area
+      if(snap1.isNodeOccupied(root1)) // occupied area
       {
         OBB obb1;
         convertBV(bv1, tf1, obb1);
         if(obb1.overlap(obb2))
         {
-          Box box;
-          Transform3f box_tf;
-          constructBox(bv1, tf1, box, box_tf);
+          details::Voxel voxel(bv1, tf1);
 
           if(!crequest->enable_contact)
           {
-            if(solver->shapeIntersect(box, box_tf, s, tf2, NULL, NULL, NULL))
+            if(details::voxelShapeIntersect(solver, voxel, s, tf2, NULL, NULL, NULL))
             {
               if(cresult->numContacts() < crequest->num_max_contacts)
-                cresult->addContact(Contact(tree1, &s, static_cast<int>(root1 - tree1->getRoot()), Contact::NONE));
+                cresult->addContact(Contact(tree1, &s, static_cast<int>(root1), Contact::NONE));
             }
           }
           else
@@ -342,10 +338,10 @@ private:
             FCL_REAL depth;
             Vec3f normal;
 
-            if(solver->shapeIntersect(box, box_tf, s, tf2, &contact, &depth, &normal))
+            if(details::voxelShapeIntersect(solver, voxel, s, tf2, &contact, &depth, &normal))
             {
               if(cresult->numContacts() < crequest->num_max_contacts)
-                cresult->addContact(Contact(tree1, &s, static_cast<int>(root1 - tree1->getRoot()), Contact::NONE, contact, normal, depth));
+                cresult->addContact(Contact(tree1, &s, static_cast<int>(root1), Contact::NONE, contact, normal, depth));
             }
           }
 
@@ -360,8 +356,8 @@ private:
     /// stop when 1) bounding boxes of two objects not overlap; OR
     ///           2) at least of one the nodes is free; OR
     ///           2) (two uncertain nodes or one node occupied and one node uncertain) AND cost not required
-    if(tree1->isNodeFree(root1)) return false;
-    else if((tree1->isNodeUncertain(root1) || s.isUncertain())) return false;
+    if(snap1.isNodeFree(root1)) return false;
+    else if((snap1.isNodeUncertain(root1) || s.isUncertain())) return false;
     else
     {
       OBB obb1;
@@ -371,9 +367,9 @@ private:
 
     for(unsigned int i = 0; i < 8; ++i)
     {
-      if(tree1->nodeChildExists(root1, i))
+      if(snap1.nodeChildExists(root1, i))
       {
-        const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+        unsigned int child = snap1.getNodeChild(root1, i);
         AABB child_bv;
         computeChildBV(bv1, i, child_bv);
         
@@ -386,19 +382,21 @@ private:
   }
 
   template<typename BV>
-  bool OcTreeMeshDistanceRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  bool OcTreeMeshDistanceRecurse(const OcTree* tree1, unsigned int root1, const AABB& bv1,
                                  const BVHModel<BV>* tree2, int root2,
                                  const Transform3f& tf1, const Transform3f& tf2) const
   {
-    if(!tree1->nodeHasChildren(root1) && tree2->getBV(root2).isLeaf())
+    const OcTreeSnapshot& snap1 = tree1->getSnapshot();
+    BV buffer;
+    if(!snap1.nodeHasChildren(root1) && tree2->isLeaf(root2))
     {
-      if(tree1->isNodeOccupied(root1))
+      if(snap1.isNodeOccupied(root1))
       {
         Box box;
         Transform3f box_tf;
         constructBox(bv1, tf1, box, box_tf);
 
-        int primitive_id = tree2->getBV(root2).primitiveId();
+        int primitive_id = tree2->primitiveId(root2);
         const Triangle& tri_id = tree2->tri_indices[primitive_id];
         const Vec3f& p1 = tree2->vertices[tri_id[0]];
         const Vec3f& p2 = tree2->vertices[tri_id[1]];
@@ -409,7 +407,7 @@ private:
         solver->shapeTriangleInteraction(box, box_tf, p1, p2, p3, tf2, dist,
                                          closest_p1, closest_p2, normal);
 
-        dresult->update(dist, tree1, tree2, (int) (root1 - tree1->getRoot()),
+        dresult->update(dist, tree1, tree2, (int) root1,
                         primitive_id, closest_p1, closest_p2, normal);
 
         return drequest->isSatisfied(*dresult);
@@ -418,22 +416,22 @@ private:
         return false;
     }
 
-    if(!tree1->isNodeOccupied(root1)) return false;
+    if(!snap1.isNodeOccupied(root1)) return false;
 
-    if(tree2->getBV(root2).isLeaf() || (tree1->nodeHasChildren(root1) && (bv1.size() > tree2->getBV(root2).bv.size())))
+    if(tree2->isLeaf(root2) || (snap1.nodeHasChildren(root1) && (bv1.size() > tree2->getVolume(root2, buffer).size())))
     {
       for(unsigned int i = 0; i < 8; ++i)
       {
-        if(tree1->nodeChildExists(root1, i))
+        if(snap1.nodeChildExists(root1, i))
         {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+          unsigned int child = snap1.getNodeChild(root1, i);
           AABB child_bv;
           computeChildBV(bv1, i, child_bv);
 
           FCL_REAL d;
           AABB aabb1, aabb2;
           convertBV(child_bv, tf1, aabb1);
-          convertBV(tree2->getBV(root2).bv, tf2, aabb2);
+          convertBV(tree2->getVolume(root2, buffer), tf2, aabb2);
           d = aabb1.distance(aabb2);
           
           if(d < dresult->min_distance)
@@ -449,8 +447,8 @@ private:
       FCL_REAL d;
       AABB aabb1, aabb2;
       convertBV(bv1, tf1, aabb1);
-      int child = tree2->getBV(root2).leftChild();
-      convertBV(tree2->getBV(child).bv, tf2, aabb2);
+      int child = tree2->leftChild(root2);
+      convertBV(tree2->getVolume(child, buffer), tf2, aabb2);
       d = aabb1.distance(aabb2);
 
       if(d < dresult->min_distance)
@@ -459,8 +457,8 @@ private:
           return true;
       }
 
-      child = tree2->getBV(root2).rightChild();
-      convertBV(tree2->getBV(child).bv, tf2, aabb2);
+      child = tree2->rightChild(root2);
+      convertBV(tree2->getVolume(child, buffer), tf2, aabb2);
       d = aabb1.distance(aabb2);
       
       if(d < dresult->min_distance)
@@ -475,68 +473,24 @@ private:
 
 
   template<typename BV>
-  bool OcTreeMeshIntersectRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  bool OcTreeMeshIntersectRecurse(const OcTree* tree1, unsigned int root1, const AABB& bv1,
                                   const BVHModel<BV>* tree2, int root2,
                                   const Transform3f& tf1, const Transform3f& tf2) const
   {
-    if(!root1)
-    {
-      if(tree2->getBV(root2).isLeaf())
-      {
-        OBB obb1, obb2;
-        convertBV(bv1, tf1, obb1);
-        convertBV(tree2->getBV(root2).bv, tf2, obb2);
-        if(obb1.overlap(obb2))
-        {
-          Box box;
-          Transform3f box_tf;
-          constructBox(bv1, tf1, box, box_tf);
-
-          int primitive_id = tree2->getBV(root2).primitiveId();
-          const Triangle& tri_id = tree2->tri_indices[primitive_id];
-          const Vec3f& p1 = tree2->vertices[tri_id[0]];
-          const Vec3f& p2 = tree2->vertices[tri_id[1]];
-          const Vec3f& p3 = tree2->vertices[tri_id[2]];
-          Vec3f c1, c2, normal;
-          FCL_REAL distance;
-          if(solver->shapeTriangleInteraction
-             (box, box_tf, p1, p2, p3, tf2, distance, c1, c2, normal))
-          {
-            AABB overlap_part;
-            AABB aabb1;
-            computeBV<AABB, Box>(box, box_tf, aabb1);
-            AABB aabb2(tf2.transform(p1), tf2.transform(p2), tf2.transform(p3));
-            aabb1.overlap(aabb2, overlap_part);
-          }
-        }
-
-        return false;
-      }
-      else
-      {
-        if(OcTreeMeshIntersectRecurse(tree1, root1, bv1, tree2, tree2->getBV(root2).leftChild(), tf1, tf2))
-          return true;
-
-        if(OcTreeMeshIntersectRecurse(tree1, root1, bv1, tree2, tree2->getBV(root2).rightChild(), tf1, tf2))
-          return true;
-
-        return false;
-      }
-    }
-    else if(!tree1->nodeHasChildren(root1) && tree2->getBV(root2).isLeaf())
+    const OcTreeSnapshot& snap1 = tree1->getSnapshot();
+    BV buffer;
+    if(!snap1.nodeHasChildren(root1) && tree2->isLeaf(root2))
     {
-      if(tree1->isNodeOccupied(root1))
+      if(snap1.isNodeOccupied(root1))
       {
         OBB obb1, obb2;
         convertBV(bv1, tf1, obb1);
-        convertBV(tree2->getBV(root2).bv, tf2, obb2);
+        convertBV(tree2->getVolume(root2, buffer), tf2, obb2);
         if(obb1.overlap(obb2))
         {
-          Box box;
-          Transform3f box_tf;
-          constructBox(bv1, tf1, box, box_tf);
+          details::Voxel voxel(bv1, tf1);
 
-          int primitive_id = tree2->getBV(root2).primitiveId();
+          int primitive_id = tree2->primitiveId(root2);
           const Triangle& tri_id = tree2->tri_indices[primitive_id];
           const Vec3f& p1 = tree2->vertices[tri_id[0]];
           const Vec3f& p2 = tree2->vertices[tri_id[1]];
@@ -544,19 +498,20 @@ private:
         
           if(!crequest->enable_contact)
           {
-            Vec3f c1, c2, normal;
-            FCL_REAL distance;
-            if(solver->shapeTriangleInteraction
-               (box, box_tf, p1, p2, p3, tf2, distance, c1, c2, normal))
+            if(details::voxelTriangleIntersect
+               (voxel, tf2.transform(p1), tf2.transform(p2), tf2.transform(p3)))
             {
               if(cresult->numContacts() < crequest->num_max_contacts)
                 cresult->addContact(Contact(tree1, tree2,
-                                            (int)(root1 - tree1->getRoot()),
+                                            (int) root1,
                                             primitive_id));
             }
           }
           else
           {
+            Box box;
+            Transform3f box_tf;
+            voxel.toBox(box, box_tf);
             Vec3f c1, c2;
             FCL_REAL distance;
             Vec3f normal;
@@ -567,7 +522,7 @@ private:
               assert (crequest->security_margin == 0);
               if(cresult->numContacts() < crequest->num_max_contacts)
                 cresult->addContact
-                  (Contact(tree1, tree2, (int) (root1 - tree1->getRoot()),
+                  (Contact(tree1, tree2, (int) root1,
                            primitive_id, c1, normal, -distance));
             }
           }
@@ -584,24 +539,24 @@ private:
     /// stop when 1) bounding boxes of two objects not overlap; OR
     ///           2) at least one of the nodes is free; OR
     ///           2) (two uncertain nodes OR one node occupied and one node uncertain) AND cost not required
-    if(tree1->isNodeFree(root1)) return false;
-    else if((tree1->isNodeUncertain(root1) || tree2->isUncertain()))
+    if(snap1.isNodeFree(root1)) return false;
+    else if((snap1.isNodeUncertain(root1) || tree2->isUncertain()))
       return false;
     else
     {
       OBB obb1, obb2;
       convertBV(bv1, tf1, obb1);
-      convertBV(tree2->getBV(root2).bv, tf2, obb2);
+      convertBV(tree2->getVolume(root2, buffer), tf2, obb2);
       if(!obb1.overlap(obb2)) return false;      
     }
    
-    if(tree2->getBV(root2).isLeaf() || (tree1->nodeHasChildren(root1) && (bv1.size() > tree2->getBV(root2).bv.size())))
+    if(tree2->isLeaf(root2) || (snap1.nodeHasChildren(root1) && (bv1.size() > tree2->getVolume(root2, buffer).size())))
     {
       for(unsigned int i = 0; i < 8; ++i)
       {
-        if(tree1->nodeChildExists(root1, i))
+        if(snap1.nodeChildExists(root1, i))
         {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+          unsigned int child = snap1.getNodeChild(root1, i);
           AABB child_bv;
           computeChildBV(bv1, i, child_bv);
           
@@ -612,279 +567,16 @@ private:
     }
     else
     {
-      if(OcTreeMeshIntersectRecurse(tree1, root1, bv1, tree2, tree2->getBV(root2).leftChild(), tf1, tf2))
+      if(OcTreeMeshIntersectRecurse(tree1, root1, bv1, tree2, tree2->leftChild(root2), tf1, tf2))
         return true;
 
-      if(OcTreeMeshIntersectRecurse(tree1, root1, bv1, tree2, tree2->getBV(root2).rightChild(), tf1, tf2))
+      if(OcTreeMeshIntersectRecurse(tree1, root1, bv1, tree2, tree2->rightChild(root2), tf1, tf2))
         return true;      
 
     }
 
     return false;
   }
-
-  bool OcTreeDistanceRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
-                             const OcTree* tree2, const OcTree::OcTreeNode* root2, const AABB& bv2,
-                             const Transform3f& tf1, const Transform3f& tf2) const
-  {
-    if(!tree1->nodeHasChildren(root1) && !tree2->nodeHasChildren(root2))
-    {
-      if(tree1->isNodeOccupied(root1) && tree2->isNodeOccupied(root2))
-      {
-        Box box1, box2;
-        Transform3f box1_tf, box2_tf;
-        constructBox(bv1, tf1, box1, box1_tf);
-        constructBox(bv2, tf2, box2, box2_tf);
-
-        FCL_REAL dist;
-        Vec3f closest_p1, closest_p2, normal;
-        solver->shapeDistance(box1, box1_tf, box2, box2_tf, dist, closest_p1,
-                              closest_p2, normal);
-
-        dresult->update(dist, tree1, tree2, (int) (root1 - tree1->getRoot()),
-                        (int) (root2 - tree2->getRoot()),
-                        closest_p1, closest_p2, normal);
-        
-        return drequest->isSatisfied(*dresult);
-      }
-      else
-        return false;
-    }
-
-    if(!tree1->isNodeOccupied(root1) || !tree2->isNodeOccupied(root2)) return false;
-
-    if(!tree2->nodeHasChildren(root2) || (tree1->nodeHasChildren(root1) && (bv1.size() > bv2.size())))
-    {
-      for(unsigned int i = 0; i < 8; ++i)
-      {
-        if(tree1->nodeChildExists(root1, i))
-        {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
-          AABB child_bv;
-          computeChildBV(bv1, i, child_bv);
-
-          FCL_REAL d;
-          AABB aabb1, aabb2;
-          convertBV(bv1, tf1, aabb1);
-          convertBV(bv2, tf2, aabb2);
-          d = aabb1.distance(aabb2);
-
-          if(d < dresult->min_distance)
-          {
-          
-            if(OcTreeDistanceRecurse(tree1, child, child_bv, tree2, root2, bv2, tf1, tf2))
-              return true;
-          }
-        }
-      }
-    }
-    else
-    {
-      for(unsigned int i = 0; i < 8; ++i)
-      {
-        if(tree2->nodeChildExists(root2, i))
-        {
-          const OcTree::OcTreeNode* child = tree2->getNodeChild(root2, i);
-          AABB child_bv;
-          computeChildBV(bv2, i, child_bv);
-
-          FCL_REAL d;
-          AABB aabb1, aabb2;
-          convertBV(bv1, tf1, aabb1);
-          convertBV(bv2, tf2, aabb2);
-          d = aabb1.distance(aabb2);
-
-          if(d < dresult->min_distance)
-          {
-            if(OcTreeDistanceRecurse(tree1, root1, bv1, tree2, child, child_bv, tf1, tf2))
-              return true;
-          }
-        }
-      }
-    }
-    
-    return false;
-  }
-
-
-  bool OcTreeIntersectRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
-                              const OcTree* tree2, const OcTree::OcTreeNode* root2, const AABB& bv2,
-                              const Transform3f& tf1, const Transform3f& tf2) const
-  {
-    if(!root1 && !root2)
-    {
-      OBB obb1, obb2;
-      convertBV(bv1, tf1, obb1);
-      convertBV(bv2, tf2, obb2);
-
-      if(obb1.overlap(obb2))
-      {
-        Box box1, box2;
-        Transform3f box1_tf, box2_tf;
-        constructBox(bv1, tf1, box1, box1_tf);
-        constructBox(bv2, tf2, box2, box2_tf);
-        
-        AABB overlap_part;
-        AABB aabb1, aabb2;
-        computeBV<AABB, Box>(box1, box1_tf, aabb1);
-        computeBV<AABB, Box>(box2, box2_tf, aabb2);
-        aabb1.overlap(aabb2, overlap_part);
-      }
-
-      return false;
-    }
-    else if(!root1 && root2)
-    {
-      if(tree2->nodeHasChildren(root2))
-      {
-        for(unsigned int i = 0; i < 8; ++i)
-        {
-          if(tree2->nodeChildExists(root2, i))
-          {
-            const OcTree::OcTreeNode* child = tree2->getNodeChild(root2, i);
-            AABB child_bv;
-            computeChildBV(bv2, i, child_bv);
-            if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, child, child_bv, tf1, tf2))
-              return true;
-          }
-          else 
-          {
-            AABB child_bv;
-            computeChildBV(bv2, i, child_bv);
-            if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, NULL, child_bv, tf1, tf2))
-              return true;
-          }
-        }
-      }
-      else
-      {
-        if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, NULL, bv2, tf1, tf2))
-          return true;
-      }
-      
-      return false;
-    }
-    else if(root1 && !root2)
-    {
-      if(tree1->nodeHasChildren(root1))
-      {
-        for(unsigned int i = 0; i < 8; ++i)
-        {
-          if(tree1->nodeChildExists(root1, i))
-          {
-            const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
-            AABB child_bv;
-            computeChildBV(bv1, i,  child_bv);
-            if(OcTreeIntersectRecurse(tree1, child, child_bv, tree2, NULL, bv2, tf1, tf2))
-              return true;
-          }
-          else
-          {
-            AABB child_bv;
-            computeChildBV(bv1, i, child_bv);
-            if(OcTreeIntersectRecurse(tree1, NULL, child_bv, tree2, NULL, bv2, tf1, tf2))
-              return true;
-          }
-        }
-      }
-      else
-      {
-        if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, NULL, bv2, tf1, tf2))
-          return true;
-      }
-      
-      return false;
-    }
-    else if(!tree1->nodeHasChildren(root1) && !tree2->nodeHasChildren(root2))
-    {
-      if(tree1->isNodeOccupied(root1) && tree2->isNodeOccupied(root2)) // occupied area
-      {
-        if(!crequest->enable_contact)
-        {
-          OBB obb1, obb2;
-          convertBV(bv1, tf1, obb1);
-          convertBV(bv2, tf2, obb2);
-          
-          if(obb1.overlap(obb2))
-          {
-            if(cresult->numContacts() < crequest->num_max_contacts)
-              cresult->addContact(Contact(tree1, tree2, static_cast<int>(root1 - tree1->getRoot()), static_cast<int>(root2 - tree2->getRoot())));
-          }
-        }
-        else
-        {
-          Box box1, box2;
-          Transform3f box1_tf, box2_tf;
-          constructBox(bv1, tf1, box1, box1_tf);
-          constructBox(bv2, tf2, box2, box2_tf);
-
-          Vec3f contact;
-          FCL_REAL depth;
-          Vec3f normal;
-          if(solver->shapeIntersect(box1, box1_tf, box2, box2_tf, &contact, &depth, &normal))
-          {
-            if(cresult->numContacts() < crequest->num_max_contacts)
-              cresult->addContact(Contact(tree1, tree2, static_cast<int>(root1 - tree1->getRoot()), static_cast<int>(root2 - tree2->getRoot()), contact, normal, depth));
-          }
-        }
-
-        return crequest->isSatisfied(*cresult);
-      }
-      else // free area (at least one node is free)
-        return false;
-    }
-
-    /// stop when 1) bounding boxes of two objects not overlap; OR
-    ///           2) at least one of the nodes is free; OR
-    ///           2) (two uncertain nodes OR one node occupied and one node uncertain) AND cost not required
-    if(tree1->isNodeFree(root1) || tree2->isNodeFree(root2)) return false;
-    else if((tree1->isNodeUncertain(root1) || tree2->isNodeUncertain(root2)))
-      return false;
-    else 
-    {
-      OBB obb1, obb2;
-      convertBV(bv1, tf1, obb1);
-      convertBV(bv2, tf2, obb2);
-      if(!obb1.overlap(obb2)) return false;
-    }
-
-    if(!tree2->nodeHasChildren(root2) || (tree1->nodeHasChildren(root1) && (bv1.size() > bv2.size())))
-    {
-      for(unsigned int i = 0; i < 8; ++i)
-      {
-        if(tree1->nodeChildExists(root1, i))
-        {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
-          AABB child_bv;
-          computeChildBV(bv1, i, child_bv);
-        
-          if(OcTreeIntersectRecurse(tree1, child, child_bv, 
-                                    tree2, root2, bv2,
-                                    tf1, tf2))
-            return true;
-        }
-      }
-    }
-    else
-    {
-      for(unsigned int i = 0; i < 8; ++i)
-      {
-        if(tree2->nodeChildExists(root2, i))
-        {
-          const OcTree::OcTreeNode* child = tree2->getNodeChild(root2, i);
-          AABB child_bv;
-          computeChildBV(bv2, i, child_bv);
-          
-          if(OcTreeIntersectRecurse(tree1, root1, bv1,
-                                    tree2, child, child_bv,
-                                    tf1, tf2))
-            return true;
-        }
-      }
-    }
-
-    return false;
-  }
 };
 
 /// @addtogroup Traversal_For_Collision
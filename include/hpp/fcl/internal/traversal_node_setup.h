@@ -612,6 +612,8 @@ bool initialize(MeshDistanceTraversalNode<BV>& node,
 
   node.request = request;
   node.result = &result;
+  node.rel_err = request.rel_err;
+  node.abs_err = request.abs_err;
 
   node.model1 = &model1;
   node.tf1 = tf1;
@@ -681,6 +683,8 @@ bool initialize(MeshShapeDistanceTraversalNode<BV, S>& node,
 
   node.request = request;
   node.result = &result;
+  node.rel_err = request.rel_err;
+  node.abs_err = request.abs_err;
 
   node.model1 = &model1;
   node.tf1 = tf1;
@@ -728,6 +732,8 @@ bool initialize(ShapeMeshDistanceTraversalNode<S, BV>& node,
 
   node.request = request;
   node.result = &result;
+  node.rel_err = request.rel_err;
+  node.abs_err = request.abs_err;
 
   node.model1 = &model1;
   node.tf1 = tf1;
@@ -760,6 +766,8 @@ static inline bool setupMeshShapeDistanceOrientedNode(OrientedNode<S>& node,
 
   node.request = request;
   node.result = &result;
+  node.rel_err = request.rel_err;
+  node.abs_err = request.abs_err;
 
   node.model1 = &model1;
   node.tf1 = tf1;
@@ -84,6 +84,7 @@ public:
   void leafCollides(int, int, FCL_REAL&) const
   {
     bool is_collision = false;
+    nsolver->setGJKCacheKey(GJKCache::Key(model1, model2));
     if(request.enable_contact)
     {
       Vec3f contact_point, normal;
@@ -108,6 +109,7 @@ public:
                                      Contact::NONE));
       }
     }
+    nsolver->resetGJKCacheKey();
   }
 
   const S1* model1;
@@ -145,8 +147,10 @@ public:
   {
     FCL_REAL distance;
     Vec3f closest_p1, closest_p2, normal;
+    nsolver->setGJKCacheKey(GJKCache::Key(model1, model2));
     nsolver->shapeDistance(*model1, tf1, *model2, tf2, distance, closest_p1,
                            closest_p2, normal);
+    nsolver->resetGJKCacheKey();
     result->update(distance, model1, model2, DistanceResult::NONE,
                    DistanceResult::NONE, closest_p1, closest_p2, normal);
   }
@@ -0,0 +1,403 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_TRAVERSAL_OCTREE_PAIR_H
+#define HPP_FCL_TRAVERSAL_OCTREE_PAIR_H
+
+/// @cond INTERNAL
+
+#include <algorithm>
+#include <vector>
+
+#include <hpp/fcl/collision_data.h>
+#include <hpp/fcl/narrowphase/narrowphase.h>
+#include <hpp/fcl/octree.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+
+/// @brief Collision and distance between two octrees, by a simultaneous
+/// descent of their snapshots.
+///
+/// The nodes are expressed in the frame of the first octree, where the
+/// nodes of the first octree are axis aligned boxes and the nodes of the
+/// second octree are boxes of rotation R. All the nodes of a level have the
+/// same half extents, so that the half extents, the extents along the axes
+/// of the other frame and the offsets of the centers of the children are
+/// computed once per level at the beginning of the query. A pair of nodes
+/// is then tested by the separating axis test with |R| computed once, and
+/// the nodes are descended by adding offsets to their centers.
+///
+/// The two nodes of a pair are split together when they have about the same
+/// size, the larger one otherwise. Nodes marked OcTreeSnapshot::FULL are
+/// occupied boxes and are not descended, nor are the nodes at max_depth.
+class OcTreePair
+{
+public:
+  /// @param max_depth depth at which the nodes are taken as occupied
+  ///        boxes, 0 for the depth of the leaves.
+  OcTreePair(const GJKSolver* solver_,
+             const OcTree* tree1_, const Transform3f& tf1_,
+             const OcTree* tree2_, const Transform3f& tf2_,
+             unsigned int max_depth) :
+    solver(solver_), tree1(tree1_), tree2(tree2_), tf1(tf1_), tf2(tf2_),
+    snap1(tree1_->getSnapshot()), snap2(tree2_->getSnapshot()),
+    crequest(NULL), drequest(NULL), cresult(NULL), dresult(NULL)
+  {
+    Transform3f tf(tf1.inverseTimes(tf2));
+    R = tf.getRotation();
+    Rabs = R.array().abs() + 1e-6;
+
+    depth1 = snap1.getTreeDepth();
+    depth2 = snap2.getTreeDepth();
+    if(max_depth > 0)
+    {
+      depth1 = std::min(depth1, max_depth);
+      depth2 = std::min(depth2, max_depth);
+    }
+    // The extents of the first octree along the axes of the second one,
+    // and conversely.
+    makeLevels(snap1.getRootBV(), depth1, Matrix3f::Identity(),
+               Rabs.transpose(), levels1);
+    makeLevels(snap2.getRootBV(), depth2, R, Rabs, levels2);
+
+    root1.id = snap1.getRoot();
+    root1.depth = 0;
+    root1.center = snap1.getRootBV().center();
+    root2.id = snap2.getRoot();
+    root2.depth = 0;
+    root2.center = tf.transform(snap2.getRootBV().center());
+  }
+
+  /// @brief collision between the occupied nodes of the octrees
+  void collide(const CollisionRequest& request, CollisionResult& result) const
+  {
+    crequest = &request;
+    cresult = &result;
+    if(!occupied()) return;
+    intersectRecurse(root1, root2);
+  }
+
+  /// @brief distance between the occupied nodes of the octrees
+  void distance(const DistanceRequest& request, DistanceResult& result) const
+  {
+    drequest = &request;
+    dresult = &result;
+    if(!occupied()) return;
+    if(bound(root1, root2) < dresult->min_distance)
+      distanceRecurse(root1, root2);
+  }
+
+private:
+  /// Nodes of a given depth.
+  struct Level
+  {
+    /// half extents of the nodes, in their frame
+    Vec3f half;
+    /// half extents of the nodes along the axes of the other frame
+    Vec3f projected;
+    /// offsets from the center of a node to the centers of its children, in
+    /// the frame of the first octree
+    Vec3f child_offset[8];
+    /// the nodes as a shape for the narrow phase
+    Box box;
+  };
+
+  struct Node
+  {
+    unsigned int id;
+    unsigned int depth;
+    /// center, in the frame of the first octree
+    Vec3f center;
+  };
+
+  /// Compute the levels of an octree whose frame has rotation rot in the
+  /// frame of the first octree. projection maps half extents to the half
+  /// extents along the axes of the other frame.
+  static void makeLevels(const AABB& root_bv, unsigned int depth,
+                         const Matrix3f& rot, const Matrix3f& projection,
+                         std::vector<Level>& levels)
+  {
+    levels.resize(depth + 1);
+    Vec3f half((root_bv.max_ - root_bv.min_) / 2);
+    for(unsigned int d = 0; d <= depth; ++d, half /= 2)
+    {
+      Level& level = levels[d];
+      level.half = half;
+      level.projected = projection * half;
+      for(unsigned int i = 0; i < 8; ++i)
+      {
+        Vec3f offset((i & 1) ? half[0] / 2 : - half[0] / 2,
+                     (i & 2) ? half[1] / 2 : - half[1] / 2,
+                     (i & 4) ? half[2] / 2 : - half[2] / 2);
+        level.child_offset[i] = rot * offset;
+      }
+      level.box.halfSide = half;
+    }
+  }
+
+  /// Whether the roots can contain occupied leaves.
+  bool occupied() const
+  {
+    if(snap1.empty() || snap2.empty()) return false;
+    return snap1.isNodeOccupied(root1.id) && snap2.isNodeOccupied(root2.id);
+  }
+
+  bool isLeaf(const OcTreeSnapshot& snap, unsigned int max_depth,
+              const Node& node) const
+  {
+    return node.depth >= max_depth || !snap.nodeHasChildren(node.id)
+      || snap.isNodeFull(node.id);
+  }
+
+  /// Stored children of a node, returns their number.
+  unsigned int children(const OcTreeSnapshot& snap,
+                        const std::vector<Level>& levels, const Node& node,
+                        Node* out) const
+  {
+    const OcTreeSnapshot::Node& n = snap.getNode(node.id);
+    const Level& level = levels[node.depth];
+    unsigned int k = 0, child = n.first_child;
+    for(unsigned int i = 0; i < 8; ++i)
+    {
+      if(!(n.child_mask & (1 << i))) continue;
+      out[k].id = child++;
+      out[k].depth = node.depth + 1;
+      out[k].center = node.center + level.child_offset[i];
+      ++k;
+    }
+    return k;
+  }
+
+  bool areLeaves(const Node& n1, const Node& n2) const
+  {
+    return isLeaf(snap1, depth1, n1) && isLeaf(snap2, depth2, n2);
+  }
+
+  /// Split n1 and n2, which are not both leaves, into their children c1
+  /// and c2. A node which is not split is its own single child.
+  void split(const Node& n1, const Node& n2, Node* c1, unsigned int& k1,
+             Node* c2, unsigned int& k2) const
+  {
+    bool leaf1 = isLeaf(snap1, depth1, n1), leaf2 = isLeaf(snap2, depth2, n2);
+    FCL_REAL size1 = levels1[n1.depth].half.maxCoeff(),
+      size2 = levels2[n2.depth].half.maxCoeff();
+    c1[0] = n1;
+    c2[0] = n2;
+    k1 = k2 = 1;
+    if(!leaf1 && (leaf2 || 2 * size1 > size2))
+      k1 = children(snap1, levels1, n1, c1);
+    if(!leaf2 && (leaf1 || 2 * size2 > size1))
+      k2 = children(snap2, levels2, n2, c2);
+  }
+
+  /// Separating axis test. The 9 cross axes are only tested if exact, the
+  /// axes of the two frames are enough to prune the traversal.
+  bool disjoint(const Node& n1, const Node& n2, bool exact) const
+  {
+    const Level& l1 = levels1[n1.depth];
+    const Level& l2 = levels2[n2.depth];
+    Vec3f T(n2.center - n1.center);
+    for(int i = 0; i < 3; ++i)
+      if(std::abs(T[i]) > l1.half[i] + l2.projected[i]) return true;
+    Vec3f T2(R.transpose() * T);
+    for(int j = 0; j < 3; ++j)
+      if(std::abs(T2[j]) > l2.half[j] + l1.projected[j]) return true;
+    if(!exact) return false;
+
+    const Vec3f& a = l1.half;
+    const Vec3f& b = l2.half;
+    for(int i = 0; i < 3; ++i)
+    {
+      int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+      for(int j = 0; j < 3; ++j)
+      {
+        int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+        FCL_REAL t = std::abs(T[i2] * R(i1, j) - T[i1] * R(i2, j));
+        if(t > a[i1] * Rabs(i2, j) + a[i2] * Rabs(i1, j)
+           + b[j1] * Rabs(i, j2) + b[j2] * Rabs(i, j1)) return true;
+      }
+    }
+    return false;
+  }
+
+  /// Lower bound on the distance between two nodes: the largest of the
+  /// distances between the projections of the boxes on the axes of each
+  /// frame.
+  FCL_REAL bound(const Node& n1, const Node& n2) const
+  {
+    const Level& l1 = levels1[n1.depth];
+    const Level& l2 = levels2[n2.depth];
+    Vec3f T(n2.center - n1.center);
+    Vec3f T2(R.transpose() * T);
+    FCL_REAL d1 = (T.cwiseAbs() - l1.half - l2.projected).cwiseMax(0)
+      .squaredNorm();
+    FCL_REAL d2 = (T2.cwiseAbs() - l2.half - l1.projected).cwiseMax(0)
+      .squaredNorm();
+    return std::sqrt(std::max(d1, d2));
+  }
+
+  /// Poses of the boxes of two nodes in the world frame.
+  void boxPoses(const Node& n1, const Node& n2, Transform3f& box1_tf,
+                Transform3f& box2_tf) const
+  {
+    box1_tf.setTransform(tf1.getRotation(), tf1.transform(n1.center));
+    box2_tf.setTransform(tf2.getRotation(), tf1.transform(n2.center));
+  }
+
+  bool intersectRecurse(const Node& n1, const Node& n2) const
+  {
+    bool leaves = areLeaves(n1, n2);
+    if(disjoint(n1, n2, leaves)) return false;
+
+    if(leaves)
+    {
+      // The separating axis test is exact for boxes.
+      if(!crequest->enable_contact)
+      {
+        if(cresult->numContacts() < crequest->num_max_contacts)
+          cresult->addContact(Contact(tree1, tree2, (int)n1.id, (int)n2.id));
+      }
+      else
+      {
+        Transform3f box1_tf, box2_tf;
+        boxPoses(n1, n2, box1_tf, box2_tf);
+        Vec3f contact, normal;
+        FCL_REAL depth;
+        if(solver->shapeIntersect(levels1[n1.depth].box, box1_tf,
+                                  levels2[n2.depth].box, box2_tf,
+                                  &contact, &depth, &normal)
+           && cresult->numContacts() < crequest->num_max_contacts)
+          cresult->addContact(Contact(tree1, tree2, (int)n1.id, (int)n2.id,
+                                      contact, normal, depth));
+      }
+      return crequest->isSatisfied(*cresult);
+    }
+
+    Node c1[8], c2[8];
+    unsigned int k1, k2;
+    split(n1, n2, c1, k1, c2, k2);
+    for(unsigned int i = 0; i < k1; ++i)
+      for(unsigned int j = 0; j < k2; ++j)
+        if(intersectRecurse(c1[i], c2[j])) return true;
+    return false;
+  }
+
+  bool distanceRecurse(const Node& n1, const Node& n2) const
+  {
+    if(areLeaves(n1, n2))
+    {
+      Transform3f box1_tf, box2_tf;
+      boxPoses(n1, n2, box1_tf, box2_tf);
+      FCL_REAL dist;
+      Vec3f p1, p2, normal;
+      solver->shapeDistance(levels1[n1.depth].box, box1_tf,
+                            levels2[n2.depth].box, box2_tf,
+                            dist, p1, p2, normal);
+      dresult->update(dist, tree1, tree2, (int)n1.id, (int)n2.id, p1, p2,
+                      normal);
+      return drequest->isSatisfied(*dresult);
+    }
+
+    // Visit the closest pairs first, as they lower min_distance the most.
+    Node c1[8], c2[8];
+    unsigned int k1, k2;
+    split(n1, n2, c1, k1, c2, k2);
+    struct Candidate
+    {
+      FCL_REAL d;
+      unsigned char i, j;
+    };
+    Candidate candidates[64];
+    unsigned int n = 0;
+    for(unsigned int i = 0; i < k1; ++i)
+      for(unsigned int j = 0; j < k2; ++j)
+      {
+        FCL_REAL d = bound(c1[i], c2[j]);
+        if(d >= dresult->min_distance) continue;
+        unsigned int k = n++;
+        for(; k > 0 && candidates[k - 1].d > d; --k)
+          candidates[k] = candidates[k - 1];
+        candidates[k].d = d;
+        candidates[k].i = (unsigned char)i;
+        candidates[k].j = (unsigned char)j;
+      }
+
+    for(unsigned int k = 0; k < n; ++k)
+    {
+      if(candidates[k].d >= dresult->min_distance) break;
+      if(distanceRecurse(c1[candidates[k].i], c2[candidates[k].j]))
+        return true;
+    }
+    return false;
+  }
+
+  const GJKSolver* solver;
+  const OcTree* tree1;
+  const OcTree* tree2;
+  Transform3f tf1, tf2;
+  const OcTreeSnapshot& snap1;
+  const OcTreeSnapshot& snap2;
+
+  /// rotation of the second octree in the frame of the first one
+  Matrix3f R;
+  /// |R| with a margin against parallel axes
+  Matrix3f Rabs;
+  /// depths at which the descent stops
+  unsigned int depth1, depth2;
+  std::vector<Level> levels1, levels2;
+  Node root1, root2;
+
+  mutable const CollisionRequest* crequest;
+  mutable const DistanceRequest* drequest;
+  mutable CollisionResult* cresult;
+  mutable DistanceResult* dresult;
+};
+
+} // namespace details
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_TRAVERSAL_ORDERED_H
+#define HPP_FCL_TRAVERSAL_ORDERED_H
+
+/// @cond INTERNAL
+
+#include <hpp/fcl/data_types.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+  /// @brief Pair of nodes waiting to be visited by distanceOrdered, with
+  /// the lower bound on their distance.
+  struct OrderedDistancePair
+  {
+    FCL_REAL d;
+    int b1, b2;
+
+    bool operator> (const OrderedDistancePair& other) const
+    {
+      return d > other.d;
+    }
+  };
+
+  /// @brief Binary heap of the pairs of nodes to visit, the closest on top.
+  /// Clearing it keeps its storage, so that a heap reused across queries
+  /// stops allocating once it has grown to the largest traversal.
+  class DistanceHeap
+  {
+  public:
+    bool empty() const { return pairs.empty(); }
+
+    std::size_t size() const { return pairs.size(); }
+
+    const OrderedDistancePair& top() const { return pairs.front(); }
+
+    void push(FCL_REAL d, int b1, int b2)
+    {
+      OrderedDistancePair pair;
+      pair.d = d; pair.b1 = b1; pair.b2 = b2;
+      pairs.push_back(pair);
+      std::push_heap(pairs.begin(), pairs.end(),
+                     std::greater<OrderedDistancePair>());
+    }
+
+    void pop()
+    {
+      std::pop_heap(pairs.begin(), pairs.end(),
+                    std::greater<OrderedDistancePair>());
+      pairs.pop_back();
+    }
+
+    void clear() { pairs.clear(); }
+
+  private:
+    std::vector<OrderedDistancePair> pairs;
+  };
+
+  /// @brief Heap of the calling thread, reused by all its traversals.
+  DistanceHeap& threadDistanceHeap();
+} // namespace details
+
+/// @brief Distance traversal visiting the pairs of nodes closest first.
+///
+/// The pairs are kept in a heap, ordered by the lower bound on their
+/// distance. The closest pair is popped, and the traversal dives from it to
+/// a leaf through the closest children, pushing the other ones. A pair is
+/// discarded as soon as node->canStop accepts its bound, which accounts for
+/// the current result->min_distance and for the relative and absolute
+/// errors of the request, and the traversal ends when canStop accepts the
+/// pair on top of the heap. A result whose min_distance is set before the
+/// query thus acts as an upper bound: if the objects are farther apart, the
+/// traversal ends at the first bounds that exceed it and the result is left
+/// unchanged.
+///
+/// The methods of the node are called without virtual dispatch. Node must
+/// be the type of the traversal node, not one of its bases.
+/// @param b1, b2 ids of the bounding volume nodes to start from.
+/// @param heap storage of the pairs to visit, emptied by the call.
+template<typename Node>
+void distanceOrdered(const Node* node, int b1, int b2,
+                     details::DistanceHeap& heap)
+{
+  heap.clear();
+  FCL_REAL d = node->Node::BVDistanceLowerBound(b1, b2);
+  if(node->Node::canStop(d)) return;
+  heap.push(d, b1, b2);
+
+  while(!heap.empty())
+  {
+    // The bounds of the other pairs are not smaller.
+    const details::OrderedDistancePair& closest = heap.top();
+    if(node->Node::canStop(closest.d)) break;
+    int a = closest.b1, b = closest.b2;
+    heap.pop();
+
+    // Dive to a leaf through the closest children, so that min_distance
+    // soon prunes the pairs left in the heap.
+    while(!node->Node::isFirstNodeLeaf(a) || !node->Node::isSecondNodeLeaf(b))
+    {
+      int a1, b1, a2, b2;
+      if(node->Node::firstOverSecond(a, b))
+      {
+        a1 = node->Node::getFirstLeftChild(a); b1 = b;
+        a2 = node->Node::getFirstRightChild(a); b2 = b;
+      }
+      else
+      {
+        a1 = a; b1 = node->Node::getSecondLeftChild(b);
+        a2 = a; b2 = node->Node::getSecondRightChild(b);
+      }
+
+      FCL_REAL d1 = node->Node::BVDistanceLowerBound(a1, b1);
+      FCL_REAL d2 = node->Node::BVDistanceLowerBound(a2, b2);
+      if(d2 < d1)
+      {
+        std::swap(d1, d2); std::swap(a1, a2); std::swap(b1, b2);
+      }
+      if(!node->Node::canStop(d2)) heap.push(d2, a2, b2);
+      if(node->Node::canStop(d1)) break;
+      a = a1; b = b1;
+    }
+    if(node->Node::isFirstNodeLeaf(a) && node->Node::isSecondNodeLeaf(b))
+      node->Node::leafComputeDistance(a, b);
+  }
+  heap.clear();
+}
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
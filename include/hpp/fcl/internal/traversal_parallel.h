@@ -0,0 +1,199 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef HPP_FCL_TRAVERSAL_PARALLEL_H
+#define HPP_FCL_TRAVERSAL_PARALLEL_H
+
+/// @cond INTERNAL
+
+#include <hpp/fcl/internal/traversal_static.h>
+#include <hpp/fcl/collision_data.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+  /// @brief Number of pairs of nodes the top of the traversal is expanded
+  /// to, before the threads share them.
+  enum { ParallelTraversalTasks = 256 };
+
+  /// @brief Independent parts of a collision traversal, each with its own
+  /// result.
+  template<typename Node>
+  struct ParallelCollisionTasks
+  {
+    const Node* node;
+    const std::vector<std::pair<int, int> >& pairs;
+    std::vector<CollisionResult> results;
+    std::vector<FCL_REAL> sqrDistLowerBounds;
+    std::vector<int> num_bv_tests, num_leaf_tests;
+
+    ParallelCollisionTasks(const Node* node_,
+                           const std::vector<std::pair<int, int> >& pairs_,
+                           unsigned int num_threads) :
+      node(node_), pairs(pairs_), results(pairs_.size()),
+      sqrDistLowerBounds(pairs_.size()),
+      num_bv_tests(num_threads, 0), num_leaf_tests(num_threads, 0) {}
+
+    /// @brief Traverse the pairs thread_id, thread_id + num_threads, ...
+    /// with a copy of the node.
+    void run(unsigned int thread_id, unsigned int num_threads)
+    {
+      Node worker(*node);
+      worker.num_bv_tests = worker.num_leaf_tests = 0;
+      for(std::size_t i = thread_id; i < pairs.size(); i += num_threads)
+      {
+        worker.result = &results[i];
+        collisionStatic(&worker, pairs[i].first, pairs[i].second,
+                        sqrDistLowerBounds[i]);
+      }
+      num_bv_tests[thread_id] = worker.num_bv_tests;
+      num_leaf_tests[thread_id] = worker.num_leaf_tests;
+    }
+  };
+} // namespace details
+
+/// @brief Collision traversal between two BVH models shared by threads.
+///
+/// The top levels of the traversal are expanded, in the calling thread,
+/// into up to details::ParallelTraversalTasks pairs of nodes. The threads
+/// traverse these pairs with collisionStatic, each into its own result.
+/// The contacts are then sorted and added to the result of the node, up
+/// to request.num_max_contacts. Each pair stops at num_max_contacts on its
+/// own, so the split, and therefore the contacts, do not depend on the
+/// number of threads.
+/// @param num_threads number of threads, 0 for one per core.
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+template<typename Node>
+void collisionParallel(const Node* node, unsigned int num_threads,
+                       FCL_REAL& sqrDistLowerBound)
+{
+  typedef std::pair<int, int> BVPair_t;
+
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+
+  // Expand the pairs level by level. Pairs of leaves are kept as they are.
+  std::vector<BVPair_t> pairs(1, BVPair_t(0, 0)), next;
+  FCL_REAL sdlb;
+  bool expanded = true;
+  while(expanded && pairs.size() < details::ParallelTraversalTasks)
+  {
+    expanded = false;
+    next.clear();
+    for(std::size_t i = 0; i < pairs.size(); ++i)
+    {
+      int a = pairs[i].first, b = pairs[i].second;
+      if(node->Node::isFirstNodeLeaf(a) && node->Node::isSecondNodeLeaf(b))
+      {
+        next.push_back(pairs[i]);
+        continue;
+      }
+      if(node->Node::BVDisjoints(a, b, sdlb))
+      {
+        sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+        continue;
+      }
+      expanded = true;
+      if(node->Node::firstOverSecond(a, b))
+      {
+        next.push_back(BVPair_t(node->Node::getFirstLeftChild(a), b));
+        next.push_back(BVPair_t(node->Node::getFirstRightChild(a), b));
+      }
+      else
+      {
+        next.push_back(BVPair_t(a, node->Node::getSecondLeftChild(b)));
+        next.push_back(BVPair_t(a, node->Node::getSecondRightChild(b)));
+      }
+    }
+    pairs.swap(next);
+  }
+  if(pairs.empty()) return;
+
+  if(num_threads == 0)
+    num_threads = std::max(boost::thread::hardware_concurrency(), 1u);
+  num_threads = std::min(num_threads, (unsigned int)pairs.size());
+
+  details::ParallelCollisionTasks<Node> tasks(node, pairs, num_threads);
+  if(num_threads == 1)
+    tasks.run(0, 1);
+  else
+  {
+    boost::thread_group threads;
+    for(unsigned int k = 1; k < num_threads; ++k)
+      threads.create_thread(boost::bind(&details::ParallelCollisionTasks<Node>::run,
+                                        &tasks, k, num_threads));
+    tasks.run(0, num_threads);
+    threads.join_all();
+  }
+
+  std::vector<Contact> contacts, task_contacts;
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    tasks.results[i].getContacts(task_contacts);
+    contacts.insert(contacts.end(), task_contacts.begin(), task_contacts.end());
+    sqrDistLowerBound = std::min(sqrDistLowerBound, tasks.sqrDistLowerBounds[i]);
+  }
+  for(unsigned int k = 0; k < num_threads; ++k)
+  {
+    node->num_bv_tests += tasks.num_bv_tests[k];
+    node->num_leaf_tests += tasks.num_leaf_tests[k];
+  }
+
+  std::sort(contacts.begin(), contacts.end());
+  for(std::size_t i = 0; i < contacts.size() &&
+        node->result->numContacts() < node->request.num_max_contacts; ++i)
+    node->result->addContact(contacts[i]);
+}
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
@@ -0,0 +1,241 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef HPP_FCL_TRAVERSAL_QUANTIZED_H
+#define HPP_FCL_TRAVERSAL_QUANTIZED_H
+
+/// @cond INTERNAL
+
+#include <hpp/fcl/internal/traversal_node_bvhs.h>
+#include <hpp/fcl/internal/traversal_node_bvh_shape.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+  /// @brief Pair of nodes to visit in the collision of two quantized
+  /// hierarchies, with their decoded boxes.
+  struct QuantizedNodePair
+  {
+    int b1, b2;
+    AABB bv1, bv2;
+
+    QuantizedNodePair(int b1_, const AABB& bv1_, int b2_, const AABB& bv2_) :
+      b1(b1_), b2(b2_), bv1(bv1_), bv2(bv2_) {}
+  };
+
+  /// @brief Node to visit in the collision of a quantized hierarchy and a
+  /// shape, with its decoded box.
+  struct QuantizedNodeBox
+  {
+    int b;
+    AABB bv;
+
+    QuantizedNodeBox(int b_, const AABB& bv_) : b(b_), bv(bv_) {}
+  };
+} // namespace details
+
+/// @brief Only AABB models have the quantized layout.
+/// @return false
+template<typename BV, int Options>
+bool collisionQuantized(const MeshCollisionTraversalNode<BV, Options>*,
+                        FCL_REAL&)
+{
+  return false;
+}
+
+/// @brief Collision between two meshes through their quantized hierarchies
+/// (see BVH_LAYOUT_QUANTIZED).
+///
+/// The pairs of nodes to visit carry the boxes of the nodes, so that the
+/// box of a child is decoded once, from the box of its parent. The nodes
+/// are visited in the order of the binary traversal.
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+/// @return whether both models have the quantized layout. Otherwise,
+///         nothing is computed.
+template<int Options>
+bool collisionQuantized(const MeshCollisionTraversalNode<AABB, Options>* node,
+                        FCL_REAL& sqrDistLowerBound)
+{
+  typedef MeshCollisionTraversalNode<AABB, Options> Node;
+  typedef details::QuantizedNodePair Pair;
+
+  const BVHModel<AABB>* model1 = node->model1;
+  const BVHModel<AABB>* model2 = node->model2;
+  const details::QuantizedNode* nodes1 = model1->getQuantizedNodes();
+  const details::QuantizedNode* nodes2 = model2->getQuantizedNodes();
+  if(!nodes1 || !nodes2) return false;
+  const CollisionRequest& request = node->request;
+
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+
+  std::vector<Pair> pairs;
+  pairs.reserve(100);
+  pairs.push_back(Pair(0, model1->getQuantizedRoot(),
+                       0, model2->getQuantizedRoot()));
+
+  FCL_REAL sdlb;
+  while(!pairs.empty())
+  {
+    Pair p = pairs.back();
+    pairs.pop_back();
+
+    if(node->enable_statistics) node->num_bv_tests++;
+    bool disjoint = Node::RTIsIdentity
+      ? !p.bv1.overlap(p.bv2, request, sdlb)
+      : !overlap(node->RT._R(), node->RT._T(), p.bv1, p.bv2, request, sdlb);
+    if(disjoint)
+    {
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      continue;
+    }
+
+    int c1 = nodes1[p.b1].first_child;
+    int c2 = nodes2[p.b2].first_child;
+    if(c1 < 0 && c2 < 0)
+    {
+      sdlb = 0;
+      node->leafCollides(p.b1, p.b2, sdlb);
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      if(node->canStop()) return true;
+      continue;
+    }
+
+    // Descend the larger node, the left child first.
+    if(c2 < 0 || (c1 >= 0 && p.bv1.size() > p.bv2.size()))
+    {
+      pairs.push_back(p);
+      nodes1[c1 + 1].get(p.bv1, pairs.back().bv1);
+      pairs.back().b1 = c1 + 1;
+      pairs.push_back(p);
+      nodes1[c1].get(p.bv1, pairs.back().bv1);
+      pairs.back().b1 = c1;
+    }
+    else
+    {
+      pairs.push_back(p);
+      nodes2[c2 + 1].get(p.bv2, pairs.back().bv2);
+      pairs.back().b2 = c2 + 1;
+      pairs.push_back(p);
+      nodes2[c2].get(p.bv2, pairs.back().bv2);
+      pairs.back().b2 = c2;
+    }
+  }
+  return true;
+}
+
+/// @brief Only AABB models have the quantized layout.
+/// @return false
+template<typename BV, typename S, int Options>
+bool collisionQuantized(const MeshShapeCollisionTraversalNode<BV, S, Options>*,
+                        FCL_REAL&)
+{
+  return false;
+}
+
+/// @brief Collision between a mesh and a shape through the quantized
+/// hierarchy of the mesh (see BVH_LAYOUT_QUANTIZED).
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+/// @return whether the mesh has the quantized layout. Otherwise, nothing is
+///         computed.
+template<typename S, int Options>
+bool collisionQuantized(const MeshShapeCollisionTraversalNode<AABB, S, Options>* node,
+                        FCL_REAL& sqrDistLowerBound)
+{
+  typedef MeshShapeCollisionTraversalNode<AABB, S, Options> Node;
+  typedef details::QuantizedNodeBox Box;
+
+  const BVHModel<AABB>* model1 = node->model1;
+  const details::QuantizedNode* nodes = model1->getQuantizedNodes();
+  if(!nodes) return false;
+  const CollisionRequest& request = node->request;
+
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+
+  std::vector<Box> stack;
+  stack.reserve(100);
+  stack.push_back(Box(0, model1->getQuantizedRoot()));
+
+  FCL_REAL sdlb;
+  while(!stack.empty())
+  {
+    Box n = stack.back();
+    stack.pop_back();
+
+    if(node->enable_statistics) node->num_bv_tests++;
+    bool disjoint = Node::RTIsIdentity
+      ? !n.bv.overlap(node->model2_bv, request, sdlb)
+      : !overlap(node->tf1.getRotation(), node->tf1.getTranslation(),
+                 node->model2_bv, n.bv, request, sdlb);
+    if(disjoint)
+    {
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      continue;
+    }
+
+    int c = nodes[n.b].first_child;
+    if(c < 0)
+    {
+      sdlb = 0;
+      node->leafCollides(n.b, 0, sdlb);
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      if(node->canStop()) return true;
+      continue;
+    }
+
+    stack.push_back(Box(c + 1, n.bv));
+    nodes[c + 1].get(n.bv, stack.back().bv);
+    stack.push_back(Box(c, n.bv));
+    nodes[c].get(n.bv, stack.back().bv);
+  }
+  return true;
+}
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#ifndef HPP_FCL_TRAVERSAL_STATIC_H
+#define HPP_FCL_TRAVERSAL_STATIC_H
+
+/// @cond INTERNAL
+
+#include <hpp/fcl/data_types.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+  /// @brief Number of pairs of nodes held by the stack of collisionStatic.
+  /// The pairs beyond are traversed by nested calls.
+  enum { StaticTraversalStackSize = 64 };
+} // namespace details
+
+/// @brief Collision traversal bound at compile time to the type of the
+/// traversal node.
+///
+/// The pairs of nodes are visited in the order of collisionRecurse. The
+/// methods of the node are called without virtual dispatch, so that those
+/// defined in headers are inlined, and the pairs to visit are kept on a
+/// stack of fixed size. Node must be the type of the traversal node, not
+/// one of its bases.
+/// @param b1, b2 ids of the bounding volume nodes to start from.
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+/// @return whether the traversal stopped early.
+template<typename Node>
+bool collisionStatic(const Node* node, int b1, int b2,
+                     FCL_REAL& sqrDistLowerBound)
+{
+  int pairs[2 * details::StaticTraversalStackSize];
+  int size = 1;
+  pairs[0] = b1;
+  pairs[1] = b2;
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+
+  FCL_REAL sdlb;
+  while(size > 0)
+  {
+    --size;
+    int a = pairs[2 * size], b = pairs[2 * size + 1];
+
+    if(node->Node::isFirstNodeLeaf(a) && node->Node::isSecondNodeLeaf(b))
+    {
+      sdlb = 0;
+      node->Node::leafCollides(a, b, sdlb);
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      if(node->Node::canStop()) return true;
+      continue;
+    }
+
+    if(node->Node::BVDisjoints(a, b, sdlb))
+    {
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      continue;
+    }
+
+    // Children to visit, the left one in children[2], children[3].
+    int children[4];
+    if(node->Node::firstOverSecond(a, b))
+    {
+      children[0] = node->Node::getFirstRightChild(a); children[1] = b;
+      children[2] = node->Node::getFirstLeftChild(a); children[3] = b;
+    }
+    else
+    {
+      children[0] = a; children[1] = node->Node::getSecondRightChild(b);
+      children[2] = a; children[3] = node->Node::getSecondLeftChild(b);
+    }
+
+    if(size + 2 <= details::StaticTraversalStackSize)
+    {
+      std::copy(children, children + 4, pairs + 2 * size);
+      size += 2;
+      continue;
+    }
+
+    // The stack is full: traverse the children in nested calls.
+    for(int k = 2; k >= 0; k -= 2)
+    {
+      bool stop = collisionStatic(node, children[k], children[k + 1], sdlb);
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      if(stop) return true;
+    }
+  }
+  return false;
+}
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
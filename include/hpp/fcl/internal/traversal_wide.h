@@ -0,0 +1,244 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef HPP_FCL_TRAVERSAL_WIDE_H
+#define HPP_FCL_TRAVERSAL_WIDE_H
+
+/// @cond INTERNAL
+
+#include <hpp/fcl/internal/traversal_node_bvhs.h>
+#include <hpp/fcl/internal/traversal_node_bvh_shape.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+  /// @brief Pair of nodes to visit in the collision of two wide hierarchies:
+  /// the indices b1, b2 in the binary hierarchies and the wide nodes w1, w2,
+  /// which are -1 for leaves.
+  struct WideNodePair
+  {
+    int b1, w1, b2, w2;
+
+    WideNodePair(int b1_, int w1_, int b2_, int w2_) :
+      b1(b1_), w1(w1_), b2(b2_), w2(w2_) {}
+  };
+} // namespace details
+
+/// @brief Collision between two meshes through their 4-ary hierarchies.
+///
+/// Both models must have the wide layout (see BVH_LAYOUT_WIDE). Each step
+/// tests the volume of one node against the four children of the other,
+/// larger node at once. The binary hierarchies only provide the volumes of
+/// the nodes which are descended, and the leaves.
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+template<typename BV, int Options>
+void collisionWide(const MeshCollisionTraversalNode<BV, Options>* node,
+                   FCL_REAL& sqrDistLowerBound)
+{
+  typedef MeshCollisionTraversalNode<BV, Options> Node;
+  typedef details::WideNodePair Pair;
+
+  const BVHModel<BV>* model1 = node->model1;
+  const BVHModel<BV>* model2 = node->model2;
+  const details::WideNode<BV>* nodes1 = model1->getWideNodes();
+  const details::WideNode<BV>* nodes2 = model2->getWideNodes();
+  const CollisionRequest& request = node->request;
+
+  // (R, T) takes the frame of model2 to the frame of model1, (Ri, Ti) the
+  // frame of model1 to the frame of model2.
+  Matrix3f R, Ri;
+  Vec3f T, Ti;
+  if(!Node::RTIsIdentity)
+  {
+    R = node->RT._R();
+    T = node->RT._T();
+    Ri = R.transpose();
+    Ti = - Ri * T;
+  }
+
+  FCL_REAL sdlb = 0;
+  if(node->BVDisjoints(0, 0, sdlb))
+  {
+    sqrDistLowerBound = sdlb;
+    return;
+  }
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+
+  std::vector<Pair> pairs;
+  pairs.reserve(1000);
+  pairs.push_back(Pair(0, model1->isLeaf(0) ? -1 : 0,
+                       0, model2->isLeaf(0) ? -1 : 0));
+
+  FCL_REAL sqrDistLowerBounds[4];
+  while(!pairs.empty())
+  {
+    Pair p = pairs.back();
+    pairs.pop_back();
+
+    if(p.w1 < 0 && p.w2 < 0)
+    {
+      sdlb = 0;
+      node->leafCollides(p.b1, p.b2, sdlb);
+      sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+      if(node->canStop()) return;
+      continue;
+    }
+
+    const BV& bv1 = model1->getBV(p.b1).bv;
+    const BV& bv2 = model2->getBV(p.b2).bv;
+    if(p.w2 < 0 || (p.w1 >= 0 && bv1.size() > bv2.size()))
+    {
+      const details::WideNode<BV>& n = nodes1[p.w1];
+      unsigned int mask = Node::RTIsIdentity
+        ? n.volumes.overlap(bv2, n.num_children, request, sqrDistLowerBounds)
+        : n.volumes.overlap(R, T, bv2, n.num_children, request,
+                            sqrDistLowerBounds);
+      if(node->enable_statistics) node->num_bv_tests += n.num_children;
+
+      for(int i = n.num_children - 1; i >= 0; --i)
+      {
+        if(mask & (1u << i))
+          pairs.push_back(Pair(n.children[i], n.wide_children[i], p.b2, p.w2));
+        else
+          sqrDistLowerBound = std::min(sqrDistLowerBound, sqrDistLowerBounds[i]);
+      }
+    }
+    else
+    {
+      const details::WideNode<BV>& n = nodes2[p.w2];
+      unsigned int mask = Node::RTIsIdentity
+        ? n.volumes.overlap(bv1, n.num_children, request, sqrDistLowerBounds)
+        : n.volumes.overlap(Ri, Ti, bv1, n.num_children, request,
+                            sqrDistLowerBounds);
+      if(node->enable_statistics) node->num_bv_tests += n.num_children;
+
+      for(int i = n.num_children - 1; i >= 0; --i)
+      {
+        if(mask & (1u << i))
+          pairs.push_back(Pair(p.b1, p.w1, n.children[i], n.wide_children[i]));
+        else
+          sqrDistLowerBound = std::min(sqrDistLowerBound, sqrDistLowerBounds[i]);
+      }
+    }
+  }
+}
+
+/// @brief Collision between a mesh and a shape through the 4-ary hierarchy
+/// of the mesh, which must have the wide layout (see BVH_LAYOUT_WIDE).
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+template<typename BV, typename S, int Options>
+void collisionWide(const MeshShapeCollisionTraversalNode<BV, S, Options>* node,
+                   FCL_REAL& sqrDistLowerBound)
+{
+  typedef MeshShapeCollisionTraversalNode<BV, S, Options> Node;
+
+  const BVHModel<BV>* model1 = node->model1;
+  const details::WideNode<BV>* nodes = model1->getWideNodes();
+  const CollisionRequest& request = node->request;
+
+  // The volume of the shape is expressed in the world frame. (R, T) takes
+  // it to the frame of the mesh.
+  Matrix3f R;
+  Vec3f T;
+  if(!Node::RTIsIdentity)
+  {
+    R = node->tf1.getRotation().transpose();
+    T = - R * node->tf1.getTranslation();
+  }
+
+  FCL_REAL sdlb = 0;
+  if(node->BVDisjoints(0, 0, sdlb))
+  {
+    sqrDistLowerBound = sdlb;
+    return;
+  }
+  if(model1->isLeaf(0))
+  {
+    sqrDistLowerBound = 0;
+    node->leafCollides(0, 0, sqrDistLowerBound);
+    return;
+  }
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+
+  std::vector<int> stack;
+  stack.reserve(100);
+  stack.push_back(0);
+
+  FCL_REAL sqrDistLowerBounds[4];
+  while(!stack.empty())
+  {
+    const details::WideNode<BV>& n = nodes[stack.back()];
+    stack.pop_back();
+
+    unsigned int mask = Node::RTIsIdentity
+      ? n.volumes.overlap(node->model2_bv, n.num_children, request,
+                          sqrDistLowerBounds)
+      : n.volumes.overlap(R, T, node->model2_bv, n.num_children, request,
+                          sqrDistLowerBounds);
+    if(node->enable_statistics) node->num_bv_tests += n.num_children;
+
+    for(int i = n.num_children - 1; i >= 0; --i)
+    {
+      if(!(mask & (1u << i)))
+        sqrDistLowerBound = std::min(sqrDistLowerBound, sqrDistLowerBounds[i]);
+      else if(n.wide_children[i] >= 0)
+        stack.push_back(n.wide_children[i]);
+      else
+      {
+        sdlb = 0;
+        node->leafCollides(n.children[i], 0, sdlb);
+        sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+        if(node->canStop()) return;
+      }
+    }
+  }
+}
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_INTERNAL_WORK_STEALING_H
+#define HPP_FCL_INTERNAL_WORK_STEALING_H
+
+#include <vector>
+
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// @brief Indices [begin, end) not yet processed by one worker of
+/// parallelFor.
+struct WorkRange
+{
+  boost::mutex mutex;
+  std::size_t begin;
+  std::size_t end;
+};
+
+/// @brief Worker of parallelFor.
+///
+/// A worker processes the indices of its own range from the front. When its
+/// range is empty, it steals the second half of the range of another worker.
+template<typename Body>
+struct WorkStealingWorker
+{
+  WorkStealingWorker(Body& body_, WorkRange* ranges_, std::size_t num_ranges_,
+                     std::size_t id_) :
+    body (&body_), ranges (ranges_), num_ranges (num_ranges_), id (id_) {}
+
+  void operator()()
+  {
+    std::size_t i;
+    while(pop(i))
+      (*body)(i);
+  }
+
+  /// @brief Take the next index of the own range, or steal one.
+  bool pop(std::size_t& i)
+  {
+    WorkRange& own = ranges[id];
+    {
+      boost::mutex::scoped_lock lock(own.mutex);
+      if(own.begin < own.end)
+      {
+        i = own.begin++;
+        return true;
+      }
+    }
+    return steal(i);
+  }
+
+  bool steal(std::size_t& i)
+  {
+    for(std::size_t k = 1; k < num_ranges; ++k)
+    {
+      WorkRange& victim = ranges[(id + k) % num_ranges];
+      std::size_t begin, end;
+      {
+        boost::mutex::scoped_lock lock(victim.mutex);
+        if(victim.begin >= victim.end) continue;
+        begin = victim.begin + (victim.end - victim.begin) / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+      i = begin;
+      WorkRange& own = ranges[id];
+      boost::mutex::scoped_lock lock(own.mutex);
+      own.begin = begin + 1;
+      own.end = end;
+      return true;
+    }
+    return false;
+  }
+
+  Body* body;
+  WorkRange* ranges;
+  std::size_t num_ranges;
+  std::size_t id;
+};
+
+/// @brief Call bodies[k](i) for every i in [0, n), on bodies.size() threads.
+///
+/// Thread k only calls bodies[k], so that each body can hold the state of
+/// its thread (e.g. a narrow phase solver) without synchronization. The
+/// indices are first split into contiguous ranges, one per thread, and idle
+/// threads steal work from the others. The order in which the indices are
+/// processed is not specified: the bodies should write the result of index i
+/// at position i.
+///
+/// The calling thread runs bodies[0]. The bodies must not throw.
+template<typename Body>
+void parallelFor(std::size_t n, std::vector<Body>& bodies)
+{
+  const std::size_t num_threads = bodies.size();
+  if(num_threads == 0) return;
+  if(num_threads == 1 || n <= 1)
+  {
+    for(std::size_t i = 0; i < n; ++i)
+      bodies[0](i);
+    return;
+  }
+
+  boost::scoped_array<WorkRange> ranges(new WorkRange[num_threads]);
+  for(std::size_t k = 0; k < num_threads; ++k)
+  {
+    ranges[k].begin = n * k / num_threads;
+    ranges[k].end = n * (k + 1) / num_threads;
+  }
+
+  boost::thread_group threads;
+  for(std::size_t k = 1; k < num_threads; ++k)
+    threads.create_thread(WorkStealingWorker<Body>(bodies[k], ranges.get(),
+                                                   num_threads, k));
+  WorkStealingWorker<Body>(bodies[0], ranges.get(), num_threads, 0)();
+  threads.join_all();
+}
+
+} // details
+} // fcl
+
+} // namespace hpp
+
+#endif
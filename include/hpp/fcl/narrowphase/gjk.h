@@ -49,9 +49,20 @@ namespace fcl
 namespace details
 {
 
+/// @brief Index of the last support vertex of each shape of a MinkowskiDiff.
+/// It is used to warm-start the support search of ConvexBase and is ignored
+/// by the other shapes.
+typedef Eigen::Vector2i support_func_guess_t;
+
 /// @brief the support function for shape
 Vec3f getSupport(const ShapeBase* shape, const Vec3f& dir, bool dirIsNormalized); 
 
+/// @brief the support function for shape, starting the search of
+/// ConvexBase from vertex \c hint. On output, \c hint is the index of the
+/// support vertex.
+Vec3f getSupport(const ShapeBase* shape, const Vec3f& dir, bool dirIsNormalized,
+    int& hint);
+
 /// @brief Minkowski difference class of two shapes
 ///
 /// @todo template this by the two shapes. The triangle / triangle case can be
@@ -72,7 +83,8 @@ struct MinkowskiDiff
   Vec3f ot1;
 
   typedef void (*GetSupportFunction) (const MinkowskiDiff& minkowskiDiff,
-      const Vec3f& dir, bool dirIsNormalized, Vec3f& support0, Vec3f& support1);
+      const Vec3f& dir, bool dirIsNormalized, Vec3f& support0, Vec3f& support1,
+      support_func_guess_t& hint);
   GetSupportFunction getSupportFunc;
 
   MinkowskiDiff() : getSupportFunc (NULL) {}
@@ -98,10 +110,13 @@ struct MinkowskiDiff
   }
 
   /// @brief support function for the pair of shapes
-  inline void support(const Vec3f& d, bool dIsNormalized, Vec3f& supp0, Vec3f& supp1) const
+  /// @param hint index of the previous support vertex of each shape,
+  ///        updated with the new ones.
+  inline void support(const Vec3f& d, bool dIsNormalized, Vec3f& supp0, Vec3f& supp1,
+      support_func_guess_t& hint) const
   {
     assert(getSupportFunc != NULL);
-    getSupportFunc(*this, d, dIsNormalized, supp0, supp1);
+    getSupportFunc(*this, d, dIsNormalized, supp0, supp1, hint);
   }
 };
 
@@ -137,8 +152,13 @@ struct GJK
   FCL_REAL distance;
   Simplex simplices[2];
 
+  /// @brief index of the last support vertex of each shape.
+  /// It is kept by initialize() and reset() so that successive queries on
+  /// the same pair start the support search where the previous one ended.
+  support_func_guess_t support_hint;
 
-  GJK(unsigned int max_iterations_, FCL_REAL tolerance_)  : max_iterations(max_iterations_),
+  GJK(unsigned int max_iterations_, FCL_REAL tolerance_)  : support_hint(0, 0),
+                                                            max_iterations(max_iterations_),
                                                             tolerance(tolerance_)
   {
     initialize(); 
@@ -146,13 +166,32 @@ struct GJK
   
   void initialize();
 
+  /// @brief reset the parameters and the state of the algorithm
+  ///
+  /// This lets a single instance be reused for several queries.
+  void reset(unsigned int max_iterations_, FCL_REAL tolerance_)
+  {
+    max_iterations = max_iterations_;
+    tolerance = tolerance_;
+    initialize();
+  }
+
   /// @brief GJK algorithm, given the initial value guess
   Status evaluate(const MinkowskiDiff& shape, const Vec3f& guess);
 
+  /// @brief GJK algorithm, starting from the simplex of a previous query.
+  /// @param seed vertices of the initial simplex, typically the final simplex
+  ///        of a previous query on the same pair. Only \c w0 and \c w1 are
+  ///        read: they must lie respectively on shape 0 and on shape 1, in
+  ///        the frame of the MinkowskiDiff.
+  /// @param rank number of vertices of seed, between 1 and 4.
+  Status evaluate(const MinkowskiDiff& shape, const SimplexV* seed,
+                  vertex_id_t rank);
+
   /// @brief apply the support function along a direction, the result is return in sv
-  inline void getSupport(const Vec3f& d, bool dIsNormalized, SimplexV& sv) const
+  inline void getSupport(const Vec3f& d, bool dIsNormalized, SimplexV& sv)
   {
-    shape->support(d, dIsNormalized, sv.w0, sv.w1);
+    shape->support(d, dIsNormalized, sv.w0, sv.w1, support_hint);
     sv.w.noalias() = sv.w0 - sv.w1;
   }
 
@@ -172,6 +211,12 @@ struct GJK
   /// @brief get the guess from current simplex
   Vec3f getGuessFromSimplex() const;
 
+  /// @brief number of iterations of the last call to evaluate.
+  unsigned int getIterations() const
+  {
+    return iterations;
+  }
+
   /// @brief Distance threshold for early break.
   /// GJK stops when it proved the distance is more than this threshold.
   /// @note The closest points will be erroneous in this case.
@@ -192,6 +237,11 @@ private:
   unsigned int max_iterations;
   FCL_REAL tolerance;
   FCL_REAL distance_upper_bound;
+  unsigned int iterations;
+
+  /// @brief main loop of the algorithm, from the simplex simplices[current]
+  /// and the closest point ray of this simplex to the origin.
+  Status iterate();
 
   /// @brief discard one vertex from the simplex
   inline void removeVertex(Simplex& simplex);
@@ -292,11 +342,33 @@ public:
   EPA(unsigned int max_face_num_, unsigned int max_vertex_num_, unsigned int max_iterations_, FCL_REAL tolerance_) : max_face_num(max_face_num_),
                                                                                                                      max_vertex_num(max_vertex_num_),
                                                                                                                      max_iterations(max_iterations_),
-                                                                                                                     tolerance(tolerance_)
+                                                                                                                     tolerance(tolerance_),
+                                                                                                                     sv_store(NULL),
+                                                                                                                     fc_store(NULL)
+  {
+    initialize();
+  }
+
+  /// @brief copy the parameters only.
+  /// The storage is never shared: the copy allocates its own on first use.
+  EPA(const EPA& other) : max_face_num(other.max_face_num),
+                          max_vertex_num(other.max_vertex_num),
+                          max_iterations(other.max_iterations),
+                          tolerance(other.tolerance),
+                          sv_store(NULL),
+                          fc_store(NULL)
   {
     initialize();
   }
 
+  EPA& operator= (const EPA& other)
+  {
+    if (this != &other)
+      reset(other.max_face_num, other.max_vertex_num,
+            other.max_iterations, other.tolerance);
+    return *this;
+  }
+
   ~EPA()
   {
     delete [] sv_store;
@@ -305,9 +377,20 @@ public:
 
   void initialize();
 
+  /// @brief reset the parameters and the state of the algorithm
+  ///
+  /// The vertex and face storage is kept when the maximum number of
+  /// vertices and faces are unchanged, so that reusing an instance does
+  /// not allocate.
+  void reset(unsigned int max_face_num_, unsigned int max_vertex_num_,
+             unsigned int max_iterations_, FCL_REAL tolerance_);
+
   Status evaluate(GJK& gjk, const Vec3f& guess);
 
 private:
+  /// @brief allocate the vertex and face storage if not done yet
+  void allocate();
+
   bool getEdgeDist(SimplexF* face, SimplexV* a, SimplexV* b, FCL_REAL& dist);
 
   SimplexF* newFace(SimplexV* a, SimplexV* b, SimplexV* vertex, bool forced);
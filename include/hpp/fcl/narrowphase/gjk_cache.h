@@ -0,0 +1,151 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_NARROWPHASE_GJK_CACHE_H
+#define HPP_FCL_NARROWPHASE_GJK_CACHE_H
+
+#include <list>
+#include <map>
+#include <functional>
+
+#include <hpp/fcl/narrowphase/gjk.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Cache of the final GJK simplex of pairs of geometries.
+///
+/// When the geometries move slightly between two queries, starting GJK from
+/// the simplex of the previous query makes it converge in a few iterations.
+/// The simplex is stored in the frames of the geometries so that it remains
+/// valid when they move.
+///
+/// The cache holds at most maxSize() entries. When it is full, the least
+/// recently used entry is discarded. Entries are not invalidated
+/// automatically: when a geometry is modified or destroyed, call
+/// invalidate(const void*).
+class GJKCache
+{
+public:
+  /// @brief Identifies a pair of geometries.
+  /// @c o1 and @c o2 are the first and second geometries of the query, and
+  /// @c primitive the index of a sub-primitive (e.g. the triangle of a
+  /// BVHModel), or -1.
+  struct Key
+  {
+    const void* o1;
+    const void* o2;
+    int primitive;
+
+    Key() : o1 (NULL), o2 (NULL), primitive (-1) {}
+
+    Key(const void* o1_, const void* o2_, int primitive_ = -1) :
+      o1 (o1_), o2 (o2_), primitive (primitive_) {}
+
+    bool operator< (const Key& other) const
+    {
+      std::less<const void*> less;
+      if (o1 != other.o1) return less (o1, other.o1);
+      if (o2 != other.o2) return less (o2, other.o2);
+      return primitive < other.primitive;
+    }
+  };
+
+  /// @brief Final simplex of a query.
+  struct Entry
+  {
+    /// @brief number of vertices of the simplex
+    unsigned char rank;
+    /// @brief vertices of the simplex on the first geometry, in its frame.
+    Vec3f w0[4];
+    /// @brief vertices of the simplex on the second geometry, in its frame.
+    Vec3f w1[4];
+    /// @brief separating direction, in the frame of the first geometry.
+    Vec3f ray;
+    /// @brief index of the last support vertex of each geometry.
+    details::support_func_guess_t support_hint;
+
+    Entry() : rank (0), support_hint (0, 0) {}
+  };
+
+  /// @param max_size maximum number of entries, must be positive.
+  explicit GJKCache(std::size_t max_size = 1024);
+
+  /// @brief Get the entry of a pair.
+  /// @return NULL if the pair is not in the cache.
+  const Entry* find(const Key& key);
+
+  /// @brief Get the entry of a pair, creating it if needed.
+  /// This may discard the least recently used entry.
+  Entry& insert(const Key& key);
+
+  /// @brief Remove all the entries involving a geometry.
+  void invalidate(const void* object);
+
+  /// @brief Remove the entry of a pair.
+  void invalidate(const Key& key);
+
+  /// @brief Remove all the entries.
+  void clear();
+
+  /// @brief number of entries.
+  std::size_t size() const { return map.size(); }
+
+  /// @brief maximum number of entries.
+  std::size_t maxSize() const { return max_size; }
+
+  /// @brief Set the maximum number of entries, discarding the least recently
+  /// used ones if needed.
+  void setMaxSize(std::size_t max_size_);
+
+private:
+  typedef std::pair<Key, Entry> Item;
+  typedef std::list<Item> List;
+  typedef std::map<Key, List::iterator> Map;
+
+  /// @brief entries, from the most to the least recently used.
+  List items;
+  Map map;
+  std::size_t max_size;
+
+  void shrink();
+};
+
+}
+
+} // namespace hpp
+
+#endif
@@ -40,6 +40,7 @@
 #define HPP_FCL_NARROWPHASE_H
 
 #include <hpp/fcl/narrowphase/gjk.h>
+#include <hpp/fcl/narrowphase/gjk_cache.h>
 
 namespace hpp
 {
@@ -50,6 +51,9 @@ namespace fcl
 
 
   /// @brief collision and distance solver based on GJK algorithm implemented in fcl (rewritten the code from the GJK in bullet)
+  ///
+  /// The solver owns the GJK and EPA workspaces. Reusing the same instance
+  /// for successive queries avoids any heap allocation in steady state.
   struct GJKSolver
   {
     /// @brief intersection checking between two shapes
@@ -64,15 +68,15 @@ namespace fcl
       details::MinkowskiDiff shape;
       shape.set (&s1, &s2, tf1, tf2);
   
-      details::GJK gjk((unsigned int )gjk_max_iterations, gjk_tolerance);
-      details::GJK::Status gjk_status = gjk.evaluate(shape, -guess);
+      gjk.reset((unsigned int )gjk_max_iterations, gjk_tolerance);
+      details::GJK::Status gjk_status = evaluateGJK(shape, -guess, tf1, tf1, tf2);
       if(enable_cached_guess) cached_guess = gjk.getGuessFromSimplex();
     
       switch(gjk_status)
         {
         case details::GJK::Inside:
           {
-            details::EPA epa(epa_max_face_num, epa_max_vertex_num, epa_max_iterations, epa_tolerance);
+            epa.reset(epa_max_face_num, epa_max_vertex_num, epa_max_iterations, epa_tolerance);
             details::EPA::Status epa_status = epa.evaluate(gjk, -guess);
             if(epa_status != details::EPA::Failed)
               {
@@ -115,8 +119,9 @@ namespace fcl
       details::MinkowskiDiff shape;
       shape.set (&s, &tri);
   
-      details::GJK gjk((unsigned int )gjk_max_iterations, gjk_tolerance);
-      details::GJK::Status gjk_status = gjk.evaluate(shape, -guess);
+      gjk.reset((unsigned int )gjk_max_iterations, gjk_tolerance);
+      gjk.setDistanceEarlyBreak(distance_upper_bound);
+      details::GJK::Status gjk_status = evaluateGJK(shape, -guess, tf1, tf1, tf2);
       if(enable_cached_guess) cached_guess = gjk.getGuessFromSimplex();
 
       switch(gjk_status)
@@ -124,7 +129,7 @@ namespace fcl
         case details::GJK::Inside:
           {
             col = true;
-            details::EPA epa(epa_max_face_num, epa_max_vertex_num, epa_max_iterations, epa_tolerance);
+            epa.reset(epa_max_face_num, epa_max_vertex_num, epa_max_iterations, epa_tolerance);
             details::EPA::Status epa_status = epa.evaluate(gjk, -guess);
             assert (epa_status != details::EPA::Failed); (void) epa_status;
             Vec3f w0, w1;
@@ -175,8 +180,9 @@ namespace fcl
       details::MinkowskiDiff shape;
       shape.set (&s1, &s2, tf1, tf2);
 
-      details::GJK gjk((unsigned int) gjk_max_iterations, gjk_tolerance);
-      details::GJK::Status gjk_status = gjk.evaluate(shape, -guess);
+      gjk.reset((unsigned int) gjk_max_iterations, gjk_tolerance);
+      gjk.setDistanceEarlyBreak(distance_upper_bound);
+      details::GJK::Status gjk_status = evaluateGJK(shape, -guess, tf1, tf1, tf2);
       if(enable_cached_guess) cached_guess = gjk.getGuessFromSimplex();
 
       if(gjk_status == details::GJK::Failed)
@@ -207,8 +213,8 @@ namespace fcl
           assert (gjk_status == details::GJK::Inside);
           if (compute_normal)
             {
-              details::EPA epa(epa_max_face_num, epa_max_vertex_num,
-                               epa_max_iterations, epa_tolerance);
+              epa.reset(epa_max_face_num, epa_max_vertex_num,
+                        epa_max_iterations, epa_tolerance);
               details::EPA::Status epa_status = epa.evaluate(gjk, -guess);
               if(epa_status != details::EPA::Failed)
                 {
@@ -233,7 +239,9 @@ namespace fcl
     }
 
     /// @brief default setting for GJK algorithm
-    GJKSolver()
+    GJKSolver() :
+      gjk (128, 1e-6),
+      epa (128, 64, 255, 1e-6)
     {
       gjk_max_iterations = 128;
       gjk_tolerance = 1e-6;
@@ -243,6 +251,8 @@ namespace fcl
       epa_tolerance = 1e-6;
       enable_cached_guess = false;
       cached_guess = Vec3f(1, 0, 0);
+      gjk_cache = NULL;
+      distance_upper_bound = std::numeric_limits<FCL_REAL>::max();
     }
 
     void enableCachedGuess(bool if_enable) const
@@ -260,6 +270,63 @@ namespace fcl
       return cached_guess;
     }
 
+    /// @brief Forget the state left by the previous queries (cached guess
+    /// and support hints), so that the next query gives the same result as
+    /// with a new solver.
+    void resetWarmStart() const
+    {
+      cached_guess = Vec3f(1, 0, 0);
+      gjk.support_hint.setZero();
+    }
+
+    /// @brief Distance above which the distance queries which run GJK stop
+    /// as soon as they prove that the shapes are farther apart. The distance
+    /// they return is then a lower bound above this threshold, and the
+    /// closest points are erroneous.
+    /// @sa details::GJK::setDistanceEarlyBreak
+    void setDistanceEarlyBreak(const FCL_REAL& dup) const
+    {
+      distance_upper_bound = dup;
+    }
+
+    /// @brief Distance above which the distance queries stop, see
+    /// setDistanceEarlyBreak
+    FCL_REAL getDistanceEarlyBreak() const
+    {
+      return distance_upper_bound;
+    }
+
+    /// @brief Set the cache of GJK simplices used by the queries.
+    /// @param cache the cache, not owned by the solver, or NULL to disable
+    ///        it (the default).
+    void setGJKCache(GJKCache* cache) const
+    {
+      gjk_cache = cache;
+    }
+
+    GJKCache* getGJKCache() const
+    {
+      return gjk_cache;
+    }
+
+    /// @brief Set the pair of geometries of the next query, used as key in
+    /// the cache of GJK simplices.
+    ///
+    /// The key is only used by the next query which runs GJK: the caller
+    /// must call resetGJKCacheKey once the query is done, in case the query
+    /// did not use GJK. Queries without key are not cached.
+    /// @note the geometries must not be temporary copies, and must not be
+    ///       expressed in another frame than their own.
+    void setGJKCacheKey(const GJKCache::Key& key) const
+    {
+      gjk_cache_key = key;
+    }
+
+    void resetGJKCacheKey() const
+    {
+      gjk_cache_key = GJKCache::Key();
+    }
+
     /// @brief maximum number of simplex face used in EPA algorithm
     unsigned int epa_max_face_num;
 
@@ -283,6 +350,35 @@ namespace fcl
 
     /// @brief smart guess
     mutable Vec3f cached_guess;
+
+  private:
+    /// @brief cache of GJK simplices, may be NULL
+    mutable GJKCache* gjk_cache;
+
+    /// @brief key of the next query in gjk_cache
+    mutable GJKCache::Key gjk_cache_key;
+
+    /// @brief distance above which GJK stops, see setDistanceEarlyBreak
+    mutable FCL_REAL distance_upper_bound;
+
+    /// @brief Run GJK, starting from the cached simplex of the pair
+    /// gjk_cache_key if any, and store the final simplex in the cache.
+    /// @param tf0 pose of the frame of shape.
+    /// @param tf1, tf2 poses of the two geometries.
+    details::GJK::Status evaluateGJK(const details::MinkowskiDiff& shape,
+        const Vec3f& guess, const Transform3f& tf0,
+        const Transform3f& tf1, const Transform3f& tf2) const;
+
+    /// @brief GJK workspace, reused by every query
+    mutable details::GJK gjk;
+
+    /// @brief EPA workspace, reused by every query.
+    ///
+    /// The EPA storage is allocated on the first penetration query and kept
+    /// until the solver is destroyed, so that successive queries do not
+    /// allocate. As a consequence, a solver must not be shared between
+    /// threads: use one solver per thread.
+    mutable details::EPA epa;
   };
 
   /// @brief Fast implementation for sphere-capsule collision
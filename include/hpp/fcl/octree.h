@@ -40,22 +40,95 @@
 #define HPP_FCL_OCTREE_H
 
 
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
 #include <boost/shared_ptr.hpp>
 #include <boost/array.hpp>
 
 #include <octomap/octomap.h>
 #include <hpp/fcl/BV/AABB.h>
 #include <hpp/fcl/collision_object.h>
+#include <hpp/fcl/octree_snapshot.h>
 
 namespace hpp
 {
 namespace fcl
 {
 
+/// @brief A batch of occupancy changes, applied at once by OcTree::update
+class OcTreeUpdate
+{
+public:
+  /// @brief a sensor ray
+  struct Ray
+  {
+    Vec3f origin;
+    Vec3f end;
+    /// whether the end of the ray is a hit
+    bool hit;
+  };
+
+  /// @brief register a hit in the voxel containing p
+  void addOccupied(const Vec3f& p) { occupied.push_back(p); }
+
+  /// @brief register a miss in the voxel containing p
+  void addFree(const Vec3f& p) { free.push_back(p); }
+
+  /// @brief register a sensor ray: a miss in every voxel it crosses and a
+  /// hit at its end
+  /// @param max_range longer rays are truncated, and their end is then not
+  ///        a hit. Negative means no limit.
+  void addRay(const Vec3f& origin, const Vec3f& end, FCL_REAL max_range = -1)
+  {
+    Ray ray;
+    ray.origin = origin;
+    ray.end = end;
+    ray.hit = true;
+    FCL_REAL length = (end - origin).norm();
+    if(max_range >= 0 && length > max_range)
+    {
+      ray.end = origin + (end - origin) * (max_range / length);
+      ray.hit = false;
+    }
+    rays.push_back(ray);
+  }
+
+  /// @brief register the rays from a sensor origin to each point of a cloud
+  void addPointCloud(const std::vector<Vec3f>& points, const Vec3f& origin,
+                     FCL_REAL max_range = -1)
+  {
+    rays.reserve(rays.size() + points.size());
+    for(std::size_t i = 0; i < points.size(); ++i)
+      addRay(origin, points[i], max_range);
+  }
+
+  bool empty() const
+  {
+    return occupied.empty() && free.empty() && rays.empty();
+  }
+
+  void clear()
+  {
+    occupied.clear();
+    free.clear();
+    rays.clear();
+  }
+
+  std::vector<Vec3f> occupied;
+  std::vector<Vec3f> free;
+  std::vector<Ray> rays;
+};
+
 /// @brief Octree is one type of collision geometry which can encode uncertainty information in the sensor data.
 class OcTree : public CollisionGeometry
 {
 private:
+  /// the same tree as below when the octree can be updated, NULL otherwise
+  boost::shared_ptr<octomap::OcTree> updatable_tree;
+  /// number of updates applied to updatable_tree, shared with the copies
+  boost::shared_ptr<std::size_t> tree_revision;
   boost::shared_ptr<const octomap::OcTree> tree;
 
   FCL_REAL default_occupancy;
@@ -63,18 +136,26 @@ private:
   FCL_REAL occupancy_threshold;
   FCL_REAL free_threshold;
 
+  boost::shared_ptr<const OcTreeSnapshot> snapshot;
+
+  /// value of tree_revision when the snapshot was built
+  std::size_t snapshot_revision;
+
 public:
 
   typedef octomap::OcTreeNode OcTreeNode;
 
   /// @brief construct octree with a given resolution
-  OcTree(FCL_REAL resolution) : tree(boost::shared_ptr<const octomap::OcTree>(new octomap::OcTree(resolution)))                               
+  OcTree(FCL_REAL resolution) : updatable_tree(new octomap::OcTree(resolution)),
+                                 tree_revision(new std::size_t(0)),
+                                 tree(updatable_tree)
   {
     default_occupancy = tree->getOccupancyThres();
 
     // default occupancy/free threshold is consistent with default setting from octomap
     occupancy_threshold = tree->getOccupancyThres();
     free_threshold = 0;
+    updateSnapshot();
   }
 
   /// @brief construct octree from octomap
@@ -85,6 +166,20 @@ public:
     // default occupancy/free threshold is consistent with default setting from octomap
     occupancy_threshold = tree->getOccupancyThres();
     free_threshold = 0;
+    updateSnapshot();
+  }
+
+  /// @brief construct octree from octomap, which can then be modified with
+  /// update
+  OcTree(const boost::shared_ptr<octomap::OcTree>& tree_) :
+    updatable_tree(tree_), tree_revision(new std::size_t(0)), tree(tree_)
+  {
+    default_occupancy = tree->getOccupancyThres();
+
+    // default occupancy/free threshold is consistent with default setting from octomap
+    occupancy_threshold = tree->getOccupancyThres();
+    free_threshold = 0;
+    updateSnapshot();
   }
 
   /// @brief compute the AABB for the octree in its local coordinate system
@@ -104,6 +199,121 @@ public:
     return AABB(Vec3f(-delta, -delta, -delta), Vec3f(delta, delta, delta));
   }
 
+  /// @brief snapshot of the octree on which the collision and distance
+  /// queries run
+  ///
+  /// The leaf ids reported in contacts and distance results are indices of
+  /// nodes in this snapshot.
+  const OcTreeSnapshot& getSnapshot() const
+  {
+    return *snapshot;
+  }
+
+  /// @brief rebuild the snapshot, to be called after the underlying octomap
+  /// tree was modified
+  void updateSnapshot()
+  {
+    snapshot.reset(new OcTreeSnapshot(*tree, occupancy_threshold,
+                                      free_threshold));
+    snapshot_revision = tree_revision ? *tree_revision : 0;
+  }
+
+  /// @brief whether the octree was built from a non-const octomap tree and
+  /// can be modified with update
+  bool isUpdatable() const
+  {
+    return updatable_tree.get() != NULL;
+  }
+
+  /// @brief apply a batch of occupancy changes to the octomap tree
+  ///
+  /// Rays are cast as in octomap::OcTree::insertPointCloud: the voxels they
+  /// cross get a miss unless another ray of the batch ends there. The
+  /// snapshot is then rebuilt from the previous one, reading only the
+  /// subtrees of 8x8x8 voxels in which the occupancy of a voxel changed.
+  ///
+  /// The snapshot is replaced, so the update must not run concurrently with
+  /// queries on this object. Queries on a copy made before the update keep
+  /// using the previous snapshot, but the copy shares the octomap tree: its
+  /// getRoot(), toBoxes() and node accessors already show the updated tree.
+  /// A copy whose snapshot missed an update made through another copy
+  /// rebuilds its whole snapshot at its next update. The OcTree built
+  /// separately on the same octomap tree do not share this count, and must
+  /// call updateSnapshot after an update made through another one.
+  /// @param batch the changes to apply
+  /// @param changes if not NULL, the changed subtrees, so that other caches
+  ///        derived from the octree can be updated in the same regions
+  void update(const OcTreeUpdate& batch, OcTreeChanges* changes = NULL)
+  {
+    if(!updatable_tree)
+      throw std::logic_error("OcTree::update: the octomap tree is const");
+    octomap::OcTree& t = *updatable_tree;
+    const bool snapshot_current = snapshot_revision == *tree_revision;
+
+    std::vector<octomap::OcTreeKey> hits, misses;
+    octomap::OcTreeKey key;
+    for(std::size_t i = 0; i < batch.occupied.size(); ++i)
+      if(t.coordToKeyChecked(toPoint3d(batch.occupied[i]), key))
+        hits.push_back(key);
+    for(std::size_t i = 0; i < batch.free.size(); ++i)
+      if(t.coordToKeyChecked(toPoint3d(batch.free[i]), key))
+        misses.push_back(key);
+    octomap::KeyRay ray;
+    for(std::size_t i = 0; i < batch.rays.size(); ++i)
+    {
+      const OcTreeUpdate::Ray& r = batch.rays[i];
+      if(t.computeRayKeys(toPoint3d(r.origin), toPoint3d(r.end), ray))
+        misses.insert(misses.end(), ray.begin(), ray.end());
+      if(r.hit && t.coordToKeyChecked(toPoint3d(r.end), key))
+        hits.push_back(key);
+    }
+    std::sort(hits.begin(), hits.end(), lessKey);
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+    std::sort(misses.begin(), misses.end(), lessKey);
+    misses.erase(std::unique(misses.begin(), misses.end()), misses.end());
+    std::vector<octomap::OcTreeKey> free_keys;
+    std::set_difference(misses.begin(), misses.end(), hits.begin(), hits.end(),
+                        std::back_inserter(free_keys), lessKey);
+
+    OcTreeChanges local_changes;
+    local_changes.depth = t.getTreeDepth() - 3;
+    updateNodes(t, free_keys, false, local_changes.keys);
+    updateNodes(t, hits, true, local_changes.keys);
+    std::sort(local_changes.keys.begin(), local_changes.keys.end(), lessKey);
+    local_changes.keys.erase(std::unique(local_changes.keys.begin(),
+                                         local_changes.keys.end()),
+                             local_changes.keys.end());
+
+    if(!snapshot_current)
+      snapshot.reset(new OcTreeSnapshot(*tree, occupancy_threshold,
+                                        free_threshold));
+    else if(!local_changes.empty())
+      snapshot.reset(new OcTreeSnapshot(*snapshot, *tree, occupancy_threshold,
+                                        free_threshold, local_changes));
+    snapshot_revision = ++*tree_revision;
+    if(changes)
+    {
+      changes->depth = local_changes.depth;
+      changes->keys.swap(local_changes.keys);
+    }
+  }
+
+  /// @brief the bounding volume, in the octree frame, of the node at a given
+  /// depth containing the voxel of a key
+  AABB getNodeBV(const octomap::OcTreeKey& key, unsigned int depth) const
+  {
+    unsigned int tree_depth = tree->getTreeDepth();
+    unsigned int mask = ~((1u << (tree_depth - depth)) - 1);
+    FCL_REAL resolution = tree->getResolution();
+    FCL_REAL size = (1 << (tree_depth - depth)) * resolution;
+    int origin = 1 << (tree_depth - 1);
+    Vec3f min_((int)(key[0] & mask) - origin,
+               (int)(key[1] & mask) - origin,
+               (int)(key[2] & mask) - origin);
+    min_ *= resolution;
+    return AABB(min_, min_ + Vec3f(size, size, size));
+  }
+
   /// @brief get the root node of the octree
   OcTreeNode* getRoot() const
   {
@@ -183,11 +393,13 @@ public:
   void setOccupancyThres(FCL_REAL d)
   {
     occupancy_threshold = d;
+    updateSnapshot();
   }
 
   void setFreeThres(FCL_REAL d)
   {
     free_threshold = d;
+    updateSnapshot();
   }
 
   /// @return ptr to child number childIdx of node
@@ -235,6 +447,42 @@ public:
 
   /// @brief return node type, it is an octree
   NODE_TYPE getNodeType() const { return GEOM_OCTREE; }
+
+private:
+  static octomap::point3d toPoint3d(const Vec3f& p)
+  {
+    return octomap::point3d((float)p[0], (float)p[1], (float)p[2]);
+  }
+
+  static bool lessKey(const octomap::OcTreeKey& a, const octomap::OcTreeKey& b)
+  {
+    if(a[0] != b[0]) return a[0] < b[0];
+    if(a[1] != b[1]) return a[1] < b[1];
+    return a[2] < b[2];
+  }
+
+  /// Update the voxels of keys and append to changed the key of the 8x8x8
+  /// subtree of each voxel whose log-odds changed.
+  static void updateNodes(octomap::OcTree& t,
+                          const std::vector<octomap::OcTreeKey>& keys,
+                          bool occupied,
+                          std::vector<octomap::OcTreeKey>& changed)
+  {
+    for(std::size_t i = 0; i < keys.size(); ++i)
+    {
+      const octomap::OcTreeNode* node = t.search(keys[i]);
+      bool known = node != NULL;
+      float before = known ? node->getLogOdds() : 0;
+      node = t.updateNode(keys[i], occupied, false);
+      if(!known || node->getLogOdds() != before)
+      {
+        octomap::OcTreeKey block(keys[i]);
+        for(unsigned int j = 0; j < 3; ++j)
+          block[j] = (octomap::key_type)(block[j] & ~7u);
+        changed.push_back(block);
+      }
+    }
+  }
 };
 
 /// @brief compute the bounding volume of an octree node's i-th child
@@ -0,0 +1,429 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef HPP_FCL_OCTREE_SNAPSHOT_H
+#define HPP_FCL_OCTREE_SNAPSHOT_H
+
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <utility>
+
+#include <boost/cstdint.hpp>
+
+#include <octomap/octomap.h>
+#include <hpp/fcl/BV/AABB.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Subtrees of an octree changed by an update
+///
+/// The changed subtrees are rooted at the same depth. Each one is identified
+/// by the octomap key of its first voxel, that is the key of any of its
+/// voxels with the bits below that depth cleared.
+struct OcTreeChanges
+{
+  OcTreeChanges() : depth(0) {}
+
+  /// @brief depth of the roots of the changed subtrees
+  unsigned int depth;
+
+  /// @brief keys of the changed subtrees, sorted and unique
+  std::vector<octomap::OcTreeKey> keys;
+
+  bool empty() const { return keys.empty(); }
+
+  void clear() { keys.clear(); }
+
+private:
+  friend class OcTreeSnapshot;
+
+  static boost::uint64_t code(unsigned int depth, unsigned int x,
+                              unsigned int y, unsigned int z)
+  {
+    return ((boost::uint64_t)depth << 48) | ((boost::uint64_t)x << 32)
+      | ((boost::uint64_t)y << 16) | (boost::uint64_t)z;
+  }
+
+  /// Codes of the changed subtrees and of all their ancestors, sorted.
+  void prefixes(unsigned int tree_depth,
+                std::vector<boost::uint64_t>& codes) const
+  {
+    codes.clear();
+    codes.reserve(keys.size() * (depth + 1));
+    for(std::size_t k = 0; k < keys.size(); ++k)
+      for(unsigned int d = 0; d <= depth; ++d)
+      {
+        unsigned int shift = tree_depth - d;
+        codes.push_back(code(d, keys[k][0] >> shift, keys[k][1] >> shift,
+                             keys[k][2] >> shift));
+      }
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+  }
+
+  static bool contains(const std::vector<boost::uint64_t>& codes,
+                       unsigned int depth, unsigned int x, unsigned int y,
+                       unsigned int z)
+  {
+    return std::binary_search(codes.begin(), codes.end(),
+                              code(depth, x, y, z));
+  }
+};
+
+/// @brief Immutable, pointer-free copy of an octomap tree used by the
+/// collision and distance queries.
+///
+/// Nodes are stored breadth first in a single array: the children of a node
+/// are contiguous, in increasing child index, starting at
+/// Node::first_child. The occupancy of each node is classified once against
+/// the thresholds given at construction. Children that are not occupied are
+/// dropped: every query stops at such a node, so their subtrees can never
+/// produce a contact nor a distance. The snapshot never changes
+/// after construction, so that it can be shared between threads; updates of
+/// the octree build a new snapshot from the previous one.
+class OcTreeSnapshot
+{
+public:
+  /// @brief Occupancy classification of a node
+  enum NodeFlag
+  {
+    OCCUPIED = 1,
+    FREE = 2,
+    /// set when the octomap node has children, even if all of them
+    /// were pruned
+    HAS_CHILDREN = 4,
+    /// set when the whole volume of the node is occupied: the node is an
+    /// occupied leaf, or its 8 children are stored and full
+    FULL = 8
+  };
+
+  struct Node
+  {
+    /// index of the first stored child
+    unsigned int first_child;
+    /// bit i is set if child i is stored
+    unsigned char child_mask;
+    /// combination of NodeFlag
+    unsigned char flags;
+  };
+
+  /// @brief Build the snapshot of an octomap tree
+  /// @param tree the octomap tree
+  /// @param occupancy_threshold nodes whose occupancy is above are occupied
+  /// @param free_threshold nodes whose occupancy is below are free
+  OcTreeSnapshot(const octomap::OcTree& tree, FCL_REAL occupancy_threshold,
+                 FCL_REAL free_threshold)
+  {
+    build(tree, occupancy_threshold, free_threshold, NULL, NULL);
+  }
+
+  /// @brief Build the snapshot of an octomap tree from the snapshot of a
+  /// previous state of the same tree
+  ///
+  /// Only the subtrees listed in changes, and their ancestors, are read from
+  /// the octomap tree. The other nodes are copied from previous.
+  /// @param previous snapshot of the tree before the changes, built with
+  ///        the same thresholds
+  /// @param changes the subtrees that changed since previous was built
+  OcTreeSnapshot(const OcTreeSnapshot& previous, const octomap::OcTree& tree,
+                 FCL_REAL occupancy_threshold, FCL_REAL free_threshold,
+                 const OcTreeChanges& changes)
+  {
+    build(tree, occupancy_threshold, free_threshold, &previous, &changes);
+  }
+
+  /// @brief whether the snapshot has no node at all
+  bool empty() const { return nodes.empty(); }
+
+  /// @brief number of stored nodes
+  std::size_t size() const { return nodes.size(); }
+
+  /// @brief index of the root node, only valid if the snapshot is not empty
+  unsigned int getRoot() const { return 0; }
+
+  /// @brief the bounding volume of the root, in the octree frame
+  const AABB& getRootBV() const { return root_bv; }
+
+  /// @brief depth of the leaves of the octomap tree
+  unsigned int getTreeDepth() const { return tree_depth; }
+
+  /// @brief the node at a given index
+  const Node& getNode(unsigned int id) const { return nodes[id]; }
+
+  /// @brief whether the node is occupied
+  bool isNodeOccupied(unsigned int id) const
+  {
+    return (nodes[id].flags & OCCUPIED) != 0;
+  }
+
+  /// @brief whether the node is free
+  bool isNodeFree(unsigned int id) const
+  {
+    return (nodes[id].flags & FREE) != 0;
+  }
+
+  /// @brief whether the node is neither occupied nor free
+  bool isNodeUncertain(unsigned int id) const
+  {
+    return (nodes[id].flags & (OCCUPIED | FREE)) == 0;
+  }
+
+  /// @brief whether the whole volume of the node is occupied
+  bool isNodeFull(unsigned int id) const
+  {
+    return (nodes[id].flags & FULL) != 0;
+  }
+
+  /// @brief whether the node was an inner node of the octomap tree
+  bool nodeHasChildren(unsigned int id) const
+  {
+    return (nodes[id].flags & HAS_CHILDREN) != 0;
+  }
+
+  /// @brief whether child i of the node is stored
+  bool nodeChildExists(unsigned int id, unsigned int i) const
+  {
+    return (nodes[id].child_mask & (1 << i)) != 0;
+  }
+
+  /// @brief index of child i, which must exist
+  unsigned int getNodeChild(unsigned int id, unsigned int i) const
+  {
+    const Node& node = nodes[id];
+    return node.first_child
+      + countBits((unsigned char)(node.child_mask & ((1 << i) - 1)));
+  }
+
+private:
+  /// Node waiting in the breadth first queue of build. Nodes read from the
+  /// octomap tree carry their coordinates, at their depth, to be matched
+  /// against the changed subtrees. Nodes copied from the previous snapshot
+  /// have a NULL octomap node.
+  struct Pending
+  {
+    const octomap::OcTreeNode* node;
+    /// index in the previous snapshot, or -1
+    int previous;
+    unsigned int id;
+    unsigned int depth;
+    unsigned int x, y, z;
+    bool touched;
+  };
+
+  void build(const octomap::OcTree& tree, FCL_REAL occupancy_threshold,
+             FCL_REAL free_threshold, const OcTreeSnapshot* previous,
+             const OcTreeChanges* changes)
+  {
+    tree_depth = tree.getTreeDepth();
+    FCL_REAL delta = (1 << tree.getTreeDepth()) * tree.getResolution() / 2;
+    root_bv = AABB(Vec3f(-delta, -delta, -delta), Vec3f(delta, delta, delta));
+
+    const octomap::OcTreeNode* root = tree.getRoot();
+    if(!root) return;
+
+    if(previous && previous->empty()) previous = NULL;
+    std::vector<boost::uint64_t> prefixes;
+    unsigned int changes_depth = 0;
+    if(previous)
+    {
+      changes_depth = changes->depth;
+      changes->prefixes(tree.getTreeDepth(), prefixes);
+    }
+
+    nodes.reserve(previous ? previous->size() : tree.size());
+    std::deque<Pending> queue;
+    Pending pending = { root, previous ? 0 : -1, 0, 0, 0, 0, 0, true };
+    if(previous)
+      pending.touched = OcTreeChanges::contains(prefixes, 0, 0, 0, 0);
+    nodes.push_back(makeNode(tree, root, occupancy_threshold, free_threshold));
+    queue.push_back(pending);
+    while(!queue.empty())
+    {
+      Pending current = queue.front();
+      queue.pop_front();
+      Node& node = nodes[current.id];
+      if((node.flags & (HAS_CHILDREN | OCCUPIED))
+         != (HAS_CHILDREN | OCCUPIED)) continue;
+      node.first_child = (unsigned int)nodes.size();
+
+      if(!current.node)
+      {
+        // Untouched subtree: copy the children of the previous snapshot.
+        const Node& old = previous->nodes[current.previous];
+        for(unsigned int i = 0; i < 8; ++i)
+        {
+          if(!(old.child_mask & (1 << i))) continue;
+          Pending child = { NULL,
+                            (int)previous->getNodeChild(current.previous, i),
+                            (unsigned int)nodes.size(), 0, 0, 0, 0, false };
+          queue.push_back(child);
+          nodes.push_back(previous->nodes[child.previous]);
+        }
+        continue;
+      }
+
+      // The children of the previous snapshot can be reused only if the
+      // previous node stored them.
+      const Node* old = NULL;
+      if(current.previous >= 0)
+      {
+        old = &previous->nodes[current.previous];
+        if((old->flags & (HAS_CHILDREN | OCCUPIED))
+           != (HAS_CHILDREN | OCCUPIED)) old = NULL;
+      }
+
+      for(unsigned int i = 0; i < 8; ++i)
+      {
+        if(!nodeChildExists(tree, current.node, i)) continue;
+        Pending child = { getNodeChild(tree, current.node, i), -1, 0,
+                          current.depth + 1,
+                          2 * current.x + (i & 1),
+                          2 * current.y + ((i >> 1) & 1),
+                          2 * current.z + ((i >> 2) & 1),
+                          current.touched };
+        if(child.touched && current.depth < changes_depth)
+          child.touched = OcTreeChanges::contains(prefixes, child.depth,
+                                                  child.x, child.y, child.z);
+        bool stored = old && (old->child_mask & (1 << i));
+        if(stored)
+          child.previous = (int)previous->getNodeChild(current.previous, i);
+
+        Node child_node;
+        if(old && !child.touched)
+        {
+          // Unchanged child, pruned from the previous snapshot if not stored.
+          if(!stored) continue;
+          child.node = NULL;
+          child_node = previous->nodes[child.previous];
+        }
+        else
+        {
+          child_node = makeNode(tree, child.node, occupancy_threshold,
+                                free_threshold);
+          if(!(child_node.flags & OCCUPIED)) continue;
+        }
+
+        nodes[current.id].child_mask =
+          (unsigned char)(nodes[current.id].child_mask | (1 << i));
+        child.id = (unsigned int)nodes.size();
+        queue.push_back(child);
+        nodes.push_back(child_node);
+      }
+    }
+
+    // Occupancy summary, bottom up since children are stored after their
+    // parent. Copied nodes are summarized again as their children may
+    // have changed.
+    for(std::size_t i = nodes.size(); i-- > 0;)
+    {
+      Node& node = nodes[i];
+      node.flags = (unsigned char)(node.flags & ~FULL);
+      if(!(node.flags & OCCUPIED)) continue;
+      bool full = !(node.flags & HAS_CHILDREN);
+      if(!full && node.child_mask == 0xFF)
+      {
+        full = true;
+        for(unsigned int c = 0; c < 8 && full; ++c)
+          full = (nodes[node.first_child + c].flags & FULL) != 0;
+      }
+      if(full) node.flags = (unsigned char)(node.flags | FULL);
+    }
+  }
+
+  static unsigned int countBits(unsigned char m)
+  {
+    m = (unsigned char)(m - ((m >> 1) & 0x55));
+    m = (unsigned char)((m & 0x33) + ((m >> 2) & 0x33));
+    return (m + (m >> 4)) & 0x0F;
+  }
+
+  static Node makeNode(const octomap::OcTree& tree,
+                       const octomap::OcTreeNode* node,
+                       FCL_REAL occupancy_threshold, FCL_REAL free_threshold)
+  {
+    Node n;
+    n.first_child = 0;
+    n.child_mask = 0;
+    n.flags = 0;
+    // Same tests as OcTree::isNodeOccupied and OcTree::isNodeFree.
+    FCL_REAL occupancy = node->getOccupancy();
+    if(occupancy >= occupancy_threshold) n.flags |= OCCUPIED;
+    if(occupancy <= free_threshold) n.flags |= FREE;
+#if OCTOMAP_VERSION_AT_LEAST(1,8,0)
+    if(tree.nodeHasChildren(node)) n.flags |= HAS_CHILDREN;
+#else
+    (void)tree;
+    if(node->hasChildren()) n.flags |= HAS_CHILDREN;
+#endif
+    return n;
+  }
+
+  static bool nodeChildExists(const octomap::OcTree& tree,
+                              const octomap::OcTreeNode* node, unsigned int i)
+  {
+#if OCTOMAP_VERSION_AT_LEAST(1,8,0)
+    return tree.nodeChildExists(node, i);
+#else
+    (void)tree;
+    return node->childExists(i);
+#endif
+  }
+
+  static const octomap::OcTreeNode* getNodeChild
+  (const octomap::OcTree& tree, const octomap::OcTreeNode* node, unsigned int i)
+  {
+#if OCTOMAP_VERSION_AT_LEAST(1,8,0)
+    return tree.getNodeChild(node, i);
+#else
+    (void)tree;
+    return node->getChild(i);
+#endif
+  }
+
+  std::vector<Node> nodes;
+  AABB root_bv;
+  unsigned int tree_depth;
+};
+
+}
+
+} // namespace hpp
+
+#endif
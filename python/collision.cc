@@ -69,6 +69,7 @@ void exposeCollisionAPI ()
       .def_readwrite ("cached_gjk_guess"           , &CollisionRequest::cached_gjk_guess)
       .def_readwrite ("security_margin"            , &CollisionRequest::security_margin)
       .def_readwrite ("break_distance"             , &CollisionRequest::break_distance)
+      .def_readwrite ("num_threads"                , &CollisionRequest::num_threads)
       ;
   }
 
@@ -60,6 +60,7 @@ void exposeDistanceAPI ()
       .def_readwrite ("enable_nearest_points", &DistanceRequest::enable_nearest_points)
       .def_readwrite ("rel_err"              , &DistanceRequest::rel_err)
       .def_readwrite ("abs_err"              , &DistanceRequest::abs_err)
+      .def_readwrite ("distance_threshold"   , &DistanceRequest::distance_threshold)
       ;
   }
 
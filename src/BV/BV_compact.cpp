@@ -0,0 +1,107 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/BV/BV_compact.h>
+
+#include <limits>
+#include <math.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// Largest float which is not greater than x.
+static inline float floatBelow(FCL_REAL x)
+{
+  float f = (float)x;
+  return ((FCL_REAL)f > x) ? nextafterf(f, -std::numeric_limits<float>::infinity()) : f;
+}
+
+/// Smallest float which is not less than x.
+static inline float floatAbove(FCL_REAL x)
+{
+  float f = (float)x;
+  return ((FCL_REAL)f < x) ? nextafterf(f, std::numeric_limits<float>::infinity()) : f;
+}
+
+/// Rounding the axes and the origin of an oriented volume to single
+/// precision moves its points by a few float epsilons times their distance
+/// to the origin of the frame. The volume is enlarged by this fraction of
+/// that distance, which leaves a factor larger than 10.
+static const FCL_REAL rounding_margin = 4e-6;
+
+void CompactBV<AABB>::set(const AABB& bv)
+{
+  for(int i = 0; i < 3; ++i)
+  {
+    min_[i] = floatBelow(bv.min_[i]);
+    max_[i] = floatAbove(bv.max_[i]);
+  }
+}
+
+void CompactBV<OBB>::set(const OBB& bv)
+{
+  FCL_REAL margin = rounding_margin *
+    (bv.To.lpNorm<Eigen::Infinity>() + bv.extent.sum());
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 3; ++j)
+      axes[3 * i + j] = (float)bv.axes(i, j);
+    To[i] = (float)bv.To[i];
+    extent[i] = floatAbove(bv.extent[i] + margin);
+  }
+}
+
+void CompactBV<RSS>::set(const RSS& bv)
+{
+  FCL_REAL margin = rounding_margin *
+    (bv.Tr.lpNorm<Eigen::Infinity>() + bv.length[0] + bv.length[1] + bv.radius);
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 3; ++j)
+      axes[3 * i + j] = (float)bv.axes(i, j);
+    Tr[i] = (float)bv.Tr[i];
+  }
+  length[0] = floatAbove(bv.length[0]);
+  length[1] = floatAbove(bv.length[1]);
+  radius = floatAbove(bv.radius + margin);
+}
+
+} // namespace details
+} // namespace fcl
+} // namespace hpp
@@ -0,0 +1,76 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <hpp/fcl/BV/BV_quantized.h>
+
+#include <algorithm>
+#include <math.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+void QuantizedNode::set(const AABB& box, const AABB& parent)
+{
+  // Round the offsets towards the parent, then step back while the decoded
+  // box, computed as in get, misses the original one.
+  for(int i = 0; i < 3; ++i)
+  {
+    FCL_REAL step = (parent.max_[i] - parent.min_[i]) * (1. / 65535);
+    if(step <= 0)
+    {
+      lower[i] = upper[i] = 0;
+      continue;
+    }
+
+    FCL_REAL q = floor((box.min_[i] - parent.min_[i]) / step);
+    lower[i] = (unsigned short)std::min(std::max(q, 0.), 65535.);
+    while(lower[i] > 0 && parent.min_[i] + lower[i] * step > box.min_[i])
+      --lower[i];
+
+    q = floor((parent.max_[i] - box.max_[i]) / step);
+    upper[i] = (unsigned short)std::min(std::max(q, 0.), 65535.);
+    while(upper[i] > 0 && parent.max_[i] - upper[i] * step < box.max_[i])
+      --upper[i];
+  }
+}
+
+} // namespace details
+} // namespace fcl
+} // namespace hpp
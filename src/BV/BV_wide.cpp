@@ -0,0 +1,177 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/BV/BV_wide.h>
+#include <hpp/fcl/collision_data.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// Aligned version of WideLanes, for the intermediate results. Eigen maps
+/// its operations to SSE or AVX instructions, depending on the compilation
+/// flags.
+typedef Eigen::Array<FCL_REAL, 4, 1> Lanes;
+
+/// Bit i of the result is set if the squared distance of lane i, among the
+/// first count ones, is below the break distance of request.
+static inline unsigned int overlapMask(const Lanes& sqrDist, int count,
+                                       const CollisionRequest& request,
+                                       FCL_REAL sqrDistLowerBound[4])
+{
+  const FCL_REAL breakDistance (request.break_distance + request.security_margin);
+  const FCL_REAL breakDistance2 = breakDistance * breakDistance;
+
+  unsigned int mask = 0;
+  for(int i = 0; i < count; ++i)
+  {
+    sqrDistLowerBound[i] = sqrDist[i];
+    if(!(sqrDist[i] > breakDistance2))
+      mask |= 1u << i;
+  }
+  return mask;
+}
+
+unsigned int WideVolumes<AABB>::overlap(const AABB& query, int count,
+                                        const CollisionRequest& request,
+                                        FCL_REAL sqrDistLowerBound[4]) const
+{
+  // Squared distance between query and each box.
+  Lanes sqrDist (Lanes::Zero());
+  for(int k = 0; k < 3; ++k)
+  {
+    Lanes gap ((min_[k] - query.max_[k]).max(query.min_[k] - max_[k]).max(0));
+    sqrDist += gap.square();
+  }
+  return overlapMask(sqrDist, count, request, sqrDistLowerBound);
+}
+
+unsigned int WideVolumes<AABB>::overlap(const Matrix3f& R, const Vec3f& T,
+                                        const AABB& query, int count,
+                                        const CollisionRequest& request,
+                                        FCL_REAL sqrDistLowerBound[4]) const
+{
+  Vec3f center (R * query.center() + T);
+  Vec3f half (R.cwiseAbs() * (query.max_ - query.min_) / 2);
+  return overlap(AABB(center - half, center + half), count, request,
+                 sqrDistLowerBound);
+}
+
+unsigned int WideVolumes<OBB>::overlap(const OBB& query, int count,
+                                       const CollisionRequest& request,
+                                       FCL_REAL sqrDistLowerBound[4]) const
+{
+  // Separating axis test of obbDisjointAndLowerBoundDistance, for the four
+  // boxes. B and T are the orientation and the position of query in the
+  // frame of each box, a the extents of the boxes and b the extent of query.
+  Lanes B[3][3], Bf[3][3], T[3], d[3];
+  const WideLanes* a = extent;
+  const Vec3f& b = query.extent;
+
+  for(int k = 0; k < 3; ++k)
+    d[k] = query.To[k] - To[k];
+  for(int i = 0; i < 3; ++i)
+  {
+    T[i] = axes[0][i] * d[0] + axes[1][i] * d[1] + axes[2][i] * d[2];
+    for(int j = 0; j < 3; ++j)
+    {
+      B[i][j] = axes[0][i] * query.axes(0, j) + axes[1][i] * query.axes(1, j)
+        + axes[2][i] * query.axes(2, j);
+      Bf[i][j] = B[i][j].abs();
+    }
+  }
+
+  // Each separating axis gives a lower bound of the squared distance. The
+  // largest one is kept.
+  Lanes sqrDist (Lanes::Zero()), sqrDistB (Lanes::Zero()), s;
+
+  // Axes of the boxes
+  for(int i = 0; i < 3; ++i)
+  {
+    s = (T[i].abs() - a[i] - Bf[i][0] * b[0] - Bf[i][1] * b[1]
+         - Bf[i][2] * b[2]).max(0);
+    sqrDist += s.square();
+  }
+
+  // Axes of query
+  for(int j = 0; j < 3; ++j)
+  {
+    s = ((B[0][j] * T[0] + B[1][j] * T[1] + B[2][j] * T[2]).abs()
+         - Bf[0][j] * a[0] - Bf[1][j] * a[1] - Bf[2][j] * a[2] - b[j]).max(0);
+    sqrDistB += s.square();
+  }
+  sqrDist = sqrDist.max(sqrDistB);
+
+  // Most disjoint pairs are separated by one of these six axes.
+  unsigned int mask = overlapMask(sqrDist, count, request, sqrDistLowerBound);
+  if(!mask) return mask;
+
+  // Cross products of the axes. Nearly parallel axes are skipped.
+  for(int ia = 0; ia < 3; ++ia)
+  {
+    const int ja = (ia + 1) % 3, ka = (ia + 2) % 3;
+    for(int ib = 0; ib < 3; ++ib)
+    {
+      const int jb = (ib + 1) % 3, kb = (ib + 2) % 3;
+      Lanes diff ((T[ka] * B[ja][ib] - T[ja] * B[ka][ib]).abs()
+                  - a[ja] * Bf[ka][ib] - a[ka] * Bf[ja][ib]
+                  - b[jb] * Bf[ia][kb] - b[kb] * Bf[ia][jb]);
+      Lanes sinus2 (1 - Bf[ia][ib].square());
+      sqrDist = sqrDist.max(((diff > 0) && (sinus2 > 1e-6))
+                            .select(diff.square() / sinus2, FCL_REAL(0)));
+    }
+  }
+
+  return overlapMask(sqrDist, count, request, sqrDistLowerBound);
+}
+
+unsigned int WideVolumes<OBB>::overlap(const Matrix3f& R, const Vec3f& T,
+                                       const OBB& query, int count,
+                                       const CollisionRequest& request,
+                                       FCL_REAL sqrDistLowerBound[4]) const
+{
+  OBB transformed;
+  transformed.axes.noalias() = R * query.axes;
+  transformed.To = R * query.To + T;
+  transformed.extent = query.extent;
+  return overlap(transformed, count, request, sqrDistLowerBound);
+}
+
+} // namespace details
+} // namespace fcl
+} // namespace hpp
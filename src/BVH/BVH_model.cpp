@@ -37,6 +37,8 @@
 
 #include <hpp/fcl/BVH/BVH_model.h>
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <string.h>
 
@@ -45,6 +47,11 @@
 
 #include <hpp/fcl/internal/BV_splitter.h>
 #include <hpp/fcl/internal/BV_fitter.h>
+#include <boost/bind.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "morton.h"
 
 namespace hpp
 {
@@ -57,7 +64,9 @@ BVHModelBase::BVHModelBase(const BVHModelBase& other) :
   num_vertices(other.num_vertices),
   build_state(other.build_state),
   num_tris_allocated(other.num_tris),
-  num_vertices_allocated(other.num_vertices)
+  num_vertices_allocated(other.num_vertices),
+  moved_vertices(other.moved_vertices),
+  prev_moved_vertices(other.prev_moved_vertices)
 {
   if(other.vertices)
   {
@@ -103,7 +112,9 @@ void BVHModelBase::buildConvexRepresentation(bool share_memory)
 template<typename BV>
 BVHModel<BV>::BVHModel(const BVHModel<BV>& other) : BVHModelBase(other),
                                                     bv_splitter(other.bv_splitter),
-                                                    bv_fitter(other.bv_fitter)
+                                                    bv_fitter(other.bv_fitter),
+                                                    build_method(other.build_method),
+                                                    num_build_threads(other.num_build_threads)
 {
   if(other.primitive_indices)
   {
@@ -134,6 +145,43 @@ BVHModel<BV>::BVHModel(const BVHModel<BV>& other) : BVHModelBase(other),
   }
   else
     bvs = NULL;
+
+  node_layout = other.node_layout;
+  if(other.node_children)
+  {
+    node_children = new int[num_bvs];
+    node_volumes = new details::CompactBV<BV>[num_bvs];
+    std::copy(other.node_children, other.node_children + num_bvs, node_children);
+    std::copy(other.node_volumes, other.node_volumes + num_bvs, node_volumes);
+  }
+  else
+  {
+    node_children = NULL;
+    node_volumes = NULL;
+  }
+
+  num_wide_nodes = other.num_wide_nodes;
+  if(other.wide_nodes)
+  {
+    wide_nodes = new details::WideNode<BV>[num_bvs / 2 + 1];
+    wide_slots = new int[num_bvs];
+    std::copy(other.wide_nodes, other.wide_nodes + num_wide_nodes, wide_nodes);
+    std::copy(other.wide_slots, other.wide_slots + num_bvs, wide_slots);
+  }
+  else
+  {
+    wide_nodes = NULL;
+    wide_slots = NULL;
+  }
+
+  quantized_root = other.quantized_root;
+  if(other.quantized_nodes)
+  {
+    quantized_nodes = new details::QuantizedNode[num_bvs];
+    std::copy(other.quantized_nodes, other.quantized_nodes + num_bvs, quantized_nodes);
+  }
+  else
+    quantized_nodes = NULL;
 }
 
 
@@ -529,6 +577,11 @@ int BVHModelBase::beginUpdateModel()
   }
 
   num_vertex_updated = 0;
+  if(build_state == BVH_BUILD_STATE_UPDATED)
+    prev_moved_vertices.swap(moved_vertices);
+  else
+    prev_moved_vertices.clear();
+  moved_vertices.clear();
 
   build_state = BVH_BUILD_STATE_UPDATE_BEGUN;
 
@@ -543,6 +596,8 @@ int BVHModelBase::updateVertex(const Vec3f& p)
     return BVH_ERR_BUILD_OUT_OF_SEQUENCE;
   }
 
+  if(p != prev_vertices[num_vertex_updated])
+    moved_vertices.push_back(num_vertex_updated);
   vertices[num_vertex_updated] = p;
   num_vertex_updated++;
 
@@ -557,9 +612,14 @@ int BVHModelBase::updateTriangle(const Vec3f& p1, const Vec3f& p2, const Vec3f&
     return BVH_ERR_BUILD_OUT_OF_SEQUENCE;
   }
 
-  vertices[num_vertex_updated] = p1; num_vertex_updated++;
-  vertices[num_vertex_updated] = p2; num_vertex_updated++;
-  vertices[num_vertex_updated] = p3; num_vertex_updated++;
+  const Vec3f* ps[3] = { &p1, &p2, &p3 };
+  for(int i = 0; i < 3; ++i)
+  {
+    if(*ps[i] != prev_vertices[num_vertex_updated])
+      moved_vertices.push_back(num_vertex_updated);
+    vertices[num_vertex_updated] = *ps[i];
+    num_vertex_updated++;
+  }
   return BVH_OK;
 }
 
@@ -573,6 +633,8 @@ int BVHModelBase::updateSubModel(const std::vector<Vec3f>& ps)
 
   for(unsigned int i = 0; i < ps.size(); ++i)
   {
+    if(ps[i] != prev_vertices[num_vertex_updated])
+      moved_vertices.push_back(num_vertex_updated);
     vertices[num_vertex_updated] = ps[i];
     num_vertex_updated++;
   }
@@ -601,9 +663,11 @@ int BVHModelBase::endUpdateModel(bool refit, bool bottomup)
   {
     buildTree();
 
-    // then refit
+    // then refit, unless the layout does not keep the nodes, which the refit
+    // would build again.
 
-    refitTree(bottomup);
+    if(keepsNodes())
+      refitTree(bottomup);
   }
 
 
@@ -643,10 +707,19 @@ BVHModel<BV>::BVHModel() :
   BVHModelBase (),
   bv_splitter(new BVSplitter<BV>(SPLIT_METHOD_MEAN)),
   bv_fitter(new BVFitter<BV>()),
+  build_method(BVH_BUILD_TOP_DOWN),
+  num_build_threads(0),
   num_bvs_allocated(0),
   primitive_indices(NULL),
   bvs(NULL),
-  num_bvs(0)
+  num_bvs(0),
+  node_layout(BVH_LAYOUT_NODES),
+  node_children(NULL),
+  node_volumes(NULL),
+  wide_nodes(NULL),
+  num_wide_nodes(0),
+  wide_slots(NULL),
+  quantized_nodes(NULL)
 {
 }
 
@@ -655,9 +728,212 @@ void BVHModel<BV>::deleteBVs()
 {
   delete [] bvs; bvs = NULL;
   delete [] primitive_indices; primitive_indices = NULL;
+  delete [] node_children; node_children = NULL;
+  delete [] node_volumes; node_volumes = NULL;
+  delete [] wide_nodes; wide_nodes = NULL;
+  delete [] wide_slots; wide_slots = NULL;
+  num_wide_nodes = 0;
+  delete [] quantized_nodes; quantized_nodes = NULL;
   num_bvs_allocated = num_bvs = 0;
 }
 
+template<typename BV>
+void BVHModel<BV>::setNodeLayout(BVHNodeLayout layout)
+{
+  node_layout = layout;
+  if(bvs) updateNodeLayout();
+  // The quantized layout does not keep the nodes the other layouts are
+  // copied from.
+  else if(quantized_nodes) buildTree();
+}
+
+template<typename BV>
+void BVHModel<BV>::updateNodeLayout()
+{
+  if(node_layout != BVH_LAYOUT_SPLIT)
+  {
+    delete [] node_children; node_children = NULL;
+    delete [] node_volumes; node_volumes = NULL;
+  }
+  if(node_layout != BVH_LAYOUT_WIDE)
+  {
+    delete [] wide_nodes; wide_nodes = NULL;
+    delete [] wide_slots; wide_slots = NULL;
+    num_wide_nodes = 0;
+  }
+  if(node_layout != BVH_LAYOUT_QUANTIZED)
+  {
+    delete [] quantized_nodes; quantized_nodes = NULL;
+  }
+
+  if(node_layout == BVH_LAYOUT_SPLIT)
+  {
+    if(!node_children)
+    {
+      node_children = new int[num_bvs_allocated];
+      node_volumes = new details::CompactBV<BV>[num_bvs_allocated];
+    }
+    for(int i = 0; i < num_bvs; ++i)
+    {
+      node_children[i] = bvs[i].first_child;
+      node_volumes[i].set(bvs[i].bv);
+    }
+  }
+  else if(node_layout == BVH_LAYOUT_WIDE)
+  {
+    // Each wide node collapses at least one internal node of the binary
+    // hierarchy.
+    if(!wide_nodes)
+    {
+      wide_nodes = new details::WideNode<BV>[num_bvs_allocated / 2 + 1];
+      wide_slots = new int[num_bvs_allocated];
+    }
+    std::fill(wide_slots, wide_slots + num_bvs, -1);
+    num_wide_nodes = 0;
+    if(num_bvs > 0 && !bvs[0].isLeaf())
+      collapseWideNodes(0);
+  }
+  else if(node_layout == BVH_LAYOUT_QUANTIZED)
+    quantizeNodes();
+}
+
+template<typename BV>
+int BVHModel<BV>::collapseWideNodes(int bv_id)
+{
+  int w = num_wide_nodes++;
+
+  // Replace the internal child of largest volume by its children, until
+  // there are four of them. Children stay in depth-first order.
+  int children[4] = { bvs[bv_id].leftChild(), bvs[bv_id].rightChild(), -1, -1 };
+  int num_children = 2;
+  while(num_children < 4)
+  {
+    int expanded = -1;
+    for(int i = 0; i < num_children; ++i)
+    {
+      if(bvs[children[i]].isLeaf()) continue;
+      if(expanded < 0 || bvs[children[i]].bv.size() > bvs[children[expanded]].bv.size())
+        expanded = i;
+    }
+    if(expanded < 0) break;
+
+    int c = children[expanded];
+    for(int i = num_children; i > expanded + 1; --i)
+      children[i] = children[i - 1];
+    children[expanded] = bvs[c].leftChild();
+    children[expanded + 1] = bvs[c].rightChild();
+    ++num_children;
+  }
+
+  details::WideNode<BV>& node = wide_nodes[w];
+  node.num_children = num_children;
+  for(int i = 0; i < 4; ++i)
+  {
+    // Unused slots hold a copy of the last child, which keeps their lanes
+    // finite.
+    int c = children[std::min(i, num_children - 1)];
+    node.volumes.set(i, bvs[c].bv);
+    node.children[i] = c;
+    node.wide_children[i] = -1;
+  }
+  for(int i = 0; i < num_children; ++i)
+  {
+    wide_slots[children[i]] = 4 * w + i;
+    if(!bvs[children[i]].isLeaf())
+    {
+      int wide_child = collapseWideNodes(children[i]);
+      wide_nodes[w].wide_children[i] = wide_child;
+    }
+  }
+  return w;
+}
+
+template<typename BV>
+void BVHModel<BV>::quantizeNodes()
+{
+  std::cerr << "BVH Warning! The quantized layout is only available for AABB models." << std::endl;
+  node_layout = BVH_LAYOUT_NODES;
+}
+
+template<>
+void BVHModel<AABB>::quantizeNodes()
+{
+  if(num_bvs == 0) return;
+
+  // Fit the boxes to the primitives bottom-up, so that each box contains
+  // the boxes of its children. The children of a node follow it.
+  std::vector<AABB> boxes((std::size_t)num_bvs);
+  for(int i = num_bvs - 1; i >= 0; --i)
+  {
+    const BVNode<AABB>& node = bvs[i];
+    if(!node.isLeaf())
+    {
+      boxes[i] = boxes[node.leftChild()] + boxes[node.rightChild()];
+      continue;
+    }
+    int primitive = node.primitiveId();
+    if(getModelType() == BVH_MODEL_TRIANGLES)
+    {
+      const Triangle& t = tri_indices[primitive];
+      boxes[i] = AABB(vertices[t[0]], vertices[t[1]], vertices[t[2]]);
+    }
+    else
+      boxes[i] = AABB(vertices[primitive]);
+  }
+
+  if(!quantized_nodes)
+    quantized_nodes = new details::QuantizedNode[num_bvs_allocated];
+
+  // Encode the children of each node relative to its decoded box, and
+  // replace their boxes by the decoded ones for their own children.
+  quantized_root = boxes[0];
+  for(int i = 0; i < num_bvs; ++i)
+  {
+    details::QuantizedNode& node = quantized_nodes[i];
+    node.first_child = bvs[i].first_child;
+    if(i == 0)
+      node.set(boxes[0], boxes[0]);
+    if(bvs[i].isLeaf()) continue;
+
+    for(int c = bvs[i].leftChild(); c <= bvs[i].rightChild(); ++c)
+    {
+      quantized_nodes[c].set(boxes[c], boxes[i]);
+      quantized_nodes[c].get(boxes[i], boxes[c]);
+    }
+  }
+
+  delete [] bvs; bvs = NULL;
+}
+
+template<typename BV>
+const BV& BVHModel<BV>::decodeVolume(int, BV& buffer) const
+{
+  // Only AABB models have the quantized layout.
+  return buffer;
+}
+
+template<>
+const AABB& BVHModel<AABB>::decodeVolume(int id, AABB& buffer) const
+{
+  // The nodes of the subtree of a node follow it, those of the right child
+  // after those of the left child.
+  buffer = quantized_root;
+  int i = 0;
+  while(i != id)
+  {
+    int c = quantized_nodes[i].first_child;
+    int right_first_child = quantized_nodes[c + 1].first_child;
+    if(id == c || id == c + 1)
+      i = id;
+    else if(right_first_child >= 0 && id >= right_first_child)
+      i = c + 1;
+    else
+      i = c;
+    quantized_nodes[i].get(buffer, buffer);
+  }
+  return buffer;
+}
+
 template<typename BV>
 bool BVHModel<BV>::allocateBVs()
 {
@@ -684,7 +960,14 @@ bool BVHModel<BV>::allocateBVs()
 template<typename BV>
 int BVHModel<BV>::memUsage(int msg) const
 {
-  int mem_bv_list = (int)sizeof(BV) * num_bvs;
+  int mem_bv_list = bvs ? (int)sizeof(BV) * num_bvs : 0;
+  if(node_children)
+    mem_bv_list += (int)(sizeof(int) + sizeof(details::CompactBV<BV>)) * num_bvs;
+  if(wide_nodes)
+    mem_bv_list += (int)sizeof(details::WideNode<BV>) * num_wide_nodes
+      + (int)sizeof(int) * num_bvs;
+  if(quantized_nodes)
+    mem_bv_list += (int)sizeof(details::QuantizedNode) * num_bvs;
   int mem_tri_list = (int)sizeof(Triangle) * num_tris;
   int mem_vertex_list = (int)sizeof(Vec3f) * num_vertices;
 
@@ -701,16 +984,24 @@ int BVHModel<BV>::memUsage(int msg) const
   return BVH_OK;
 }
 
+/// Subtrees with less primitives are built by the calling thread.
+static const int min_primitives_per_build_thread = 10000;
+
+/// Levels with less nodes per thread are refitted by the calling thread.
+static const int min_nodes_per_refit_thread = 512;
+
 template<typename BV>
 int BVHModel<BV>::buildTree()
 {
+  // The quantized layout frees the nodes.
+  if(!bvs)
+    bvs = new BVNode<BV>[num_bvs_allocated];
+
   // set BVFitter
   bv_fitter->set(vertices, tri_indices, getModelType());
   // set SplitRule
   bv_splitter->set(vertices, tri_indices, getModelType());
 
-  num_bvs = 1;
-
   int num_primitives = 0;
   switch(getModelType())
   {
@@ -727,7 +1018,23 @@ int BVHModel<BV>::buildTree()
 
   for(int i = 0; i < num_primitives; ++i)
     primitive_indices[i] = i;
-  recursiveBuildTree(0, 0, num_primitives);
+
+  unsigned int num_threads = num_build_threads;
+  if(num_threads == 0)
+    num_threads = std::max(boost::thread::hardware_concurrency(), 1u);
+  if(build_method == BVH_BUILD_LINEAR)
+  {
+    // 10 bits per axis are enough to separate about 2^20 primitives.
+    if(num_primitives <= (1 << 20))
+      buildTree_linear<boost::uint32_t>(num_primitives, num_threads);
+    else
+      buildTree_linear<boost::uint64_t>(num_primitives, num_threads);
+  }
+  else
+    recursiveBuildTree(0, 0, num_primitives, 1, *bv_splitter, num_threads);
+  num_bvs = 2 * num_primitives - 1;
+  refit_order.clear();
+  updateNodeLayout();
 
   bv_fitter->clear();
   bv_splitter->clear();
@@ -736,7 +1043,9 @@ int BVHModel<BV>::buildTree()
 }
 
 template<typename BV>
-int BVHModel<BV>::recursiveBuildTree(int bv_id, int first_primitive, int num_primitives)
+int BVHModel<BV>::recursiveBuildTree(int bv_id, int first_primitive, int num_primitives,
+                                     int first_child, BVSplitter<BV>& splitter,
+                                     unsigned int num_threads)
 {
   BVHModelType type = getModelType();
   BVNode<BV>* bvnode = bvs + bv_id;
@@ -744,7 +1053,7 @@ int BVHModel<BV>::recursiveBuildTree(int bv_id, int first_primitive, int num_pri
 
   // constructing BV
   BV bv = bv_fitter->fit(cur_primitive_indices, num_primitives);
-  bv_splitter->computeRule(bv, cur_primitive_indices, num_primitives);
+  splitter.computeRule(bv, cur_primitive_indices, num_primitives);
 
   bvnode->bv = bv;
   bvnode->first_primitive = first_primitive;
@@ -756,8 +1065,7 @@ int BVHModel<BV>::recursiveBuildTree(int bv_id, int first_primitive, int num_pri
   }
   else
   {
-    bvnode->first_child = num_bvs;
-    num_bvs += 2;
+    bvnode->first_child = first_child;
 
     int c1 = 0;
     for(int i = 0; i < num_primitives; ++i)
@@ -786,7 +1094,7 @@ int BVHModel<BV>::recursiveBuildTree(int bv_id, int first_primitive, int num_pri
       //  [1] [1] [1] [1] [2] [2] [2] [x] [x] ... [x]
       //                   c1          i
       //
-      if(bv_splitter->apply(p)) // in the right side
+      if(splitter.apply(p)) // in the right side
       {
         // do nothing
       }
@@ -804,16 +1112,224 @@ int BVHModel<BV>::recursiveBuildTree(int bv_id, int first_primitive, int num_pri
 
     int num_first_half = c1;
 
-    recursiveBuildTree(bvnode->leftChild(), first_primitive, num_first_half);
-    recursiveBuildTree(bvnode->rightChild(), first_primitive + num_first_half, num_primitives - num_first_half);
+    // The nodes of the left subtree come first, so that the layout does not
+    // depend on the number of threads.
+    int left_first_child = first_child + 2;
+    int right_first_child = first_child + 2 * num_first_half;
+
+    if(num_threads > 1 && num_primitives >= min_primitives_per_build_thread)
+    {
+      // Build the left subtree in a new thread, with its own split rule.
+      BVSplitter<BV> left_splitter (splitter);
+      boost::thread left (boost::bind(&BVHModel<BV>::recursiveBuildTree, this,
+                                      bvnode->leftChild(), first_primitive, num_first_half,
+                                      left_first_child, boost::ref(left_splitter),
+                                      num_threads / 2));
+      recursiveBuildTree(bvnode->rightChild(), first_primitive + num_first_half, num_primitives - num_first_half,
+                         right_first_child, splitter, num_threads - num_threads / 2);
+      left.join();
+    }
+    else
+    {
+      recursiveBuildTree(bvnode->leftChild(), first_primitive, num_first_half,
+                         left_first_child, splitter, 1);
+      recursiveBuildTree(bvnode->rightChild(), first_primitive + num_first_half, num_primitives - num_first_half,
+                         right_first_child, splitter, 1);
+    }
   }
 
   return BVH_OK;
 }
 
+namespace
+{
+
+/// Compute the Morton codes of the centroids of a range of primitives.
+template<typename Code>
+struct ComputeMortonCodes
+{
+  const Vec3f* vertices;
+  const Triangle* tri_indices;
+  BVHModelType type;
+  Vec3f lower, scale;
+  std::size_t n, num_chunks;
+  Code* codes;
+
+  void operator()(std::size_t chunk)
+  {
+    for(std::size_t i = n * chunk / num_chunks; i < n * (chunk + 1) / num_chunks; ++i)
+    {
+      Vec3f p;
+      if(type == BVH_MODEL_POINTCLOUD) p = vertices[i];
+      else
+      {
+        const Triangle& t = tri_indices[i];
+        p = (vertices[t[0]] + vertices[t[1]] + vertices[t[2]]) / 3.;
+      }
+      codes[i] = details::mortonCode<Code>((p - lower).cwiseProduct(scale));
+    }
+  }
+};
+
+/// Fit the volume of an inner node from the primitives below it. The union
+/// of the volumes of the children is exact for axis aligned volumes.
+template<typename BV>
+void fitInnerNode(BVFitter<BV>& fitter, const BVNode<BV>*,
+                  unsigned int* primitive_indices, BVNode<BV>& node)
+{
+  node.bv = fitter.fit(primitive_indices + node.first_primitive, node.num_primitives);
+}
+
+template<typename BV>
+void fitInnerNodeFromChildren(const BVNode<BV>* bvs, BVNode<BV>& node)
+{
+  node.bv = bvs[node.leftChild()].bv + bvs[node.rightChild()].bv;
+}
+
+template<>
+void fitInnerNode<AABB>(BVFitter<AABB>&, const BVNode<AABB>* bvs,
+                        unsigned int*, BVNode<AABB>& node)
+{
+  fitInnerNodeFromChildren(bvs, node);
+}
+
+template<>
+void fitInnerNode<KDOP<16> >(BVFitter<KDOP<16> >&, const BVNode<KDOP<16> >* bvs,
+                             unsigned int*, BVNode<KDOP<16> >& node)
+{
+  fitInnerNodeFromChildren(bvs, node);
+}
+
+template<>
+void fitInnerNode<KDOP<18> >(BVFitter<KDOP<18> >&, const BVNode<KDOP<18> >* bvs,
+                             unsigned int*, BVNode<KDOP<18> >& node)
+{
+  fitInnerNodeFromChildren(bvs, node);
+}
+
+template<>
+void fitInnerNode<KDOP<24> >(BVFitter<KDOP<24> >&, const BVNode<KDOP<24> >* bvs,
+                             unsigned int*, BVNode<KDOP<24> >& node)
+{
+  fitInnerNodeFromChildren(bvs, node);
+}
+
+}
+
+template<typename BV>
+template<typename Code>
+void BVHModel<BV>::buildTree_linear(int num_primitives, unsigned int num_threads)
+{
+  BVHModelType type = getModelType();
+
+  // Bounding box of the centroids.
+  Vec3f lower, upper;
+  for(int i = 0; i < num_primitives; ++i)
+  {
+    Vec3f p;
+    if(type == BVH_MODEL_POINTCLOUD) p = vertices[i];
+    else
+    {
+      const Triangle& t = tri_indices[i];
+      p = (vertices[t[0]] + vertices[t[1]] + vertices[t[2]]) / 3.;
+    }
+    if(i == 0) lower = upper = p;
+    lower = lower.cwiseMin(p);
+    upper = upper.cwiseMax(p);
+  }
+
+  ComputeMortonCodes<Code> compute;
+  compute.vertices = vertices;
+  compute.tri_indices = tri_indices;
+  compute.type = type;
+  compute.lower = lower;
+  for(int i = 0; i < 3; ++i)
+    compute.scale[i] = (upper[i] > lower[i]) ? 1 / (upper[i] - lower[i]) : 0;
+  compute.n = (std::size_t)num_primitives;
+  compute.num_chunks = num_threads;
+
+  std::vector<Code> codes((std::size_t)num_primitives);
+  std::vector<unsigned int> indices((std::size_t)num_primitives);
+  for(int i = 0; i < num_primitives; ++i)
+    indices[i] = i;
+  compute.codes = &codes[0];
+  std::vector<ComputeMortonCodes<Code> > bodies(num_threads, compute);
+  details::parallelFor(num_threads, bodies);
+
+  details::radixSort(codes, indices, num_threads);
+  std::copy(indices.begin(), indices.end(), primitive_indices);
+
+  recursiveBuildTree_linear(0, 0, num_primitives, 1, &codes[0], num_threads);
+}
+
+template<typename BV>
+template<typename Code>
+void BVHModel<BV>::recursiveBuildTree_linear(int bv_id, int first_primitive, int num_primitives,
+                                             int first_child, const Code* codes,
+                                             unsigned int num_threads)
+{
+  BVNode<BV>* bvnode = bvs + bv_id;
+  bvnode->first_primitive = first_primitive;
+  bvnode->num_primitives = num_primitives;
+
+  if(num_primitives == 1)
+  {
+    bvnode->first_child = -((int)primitive_indices[first_primitive] + 1);
+    bvnode->bv = bv_fitter->fit(primitive_indices + first_primitive, 1);
+    return;
+  }
+
+  // The codes of the first half have a 0 at the highest bit which differs
+  // in the range. Split in the middle when all the codes are the same.
+  const Code* first = codes + first_primitive;
+  const Code* last = first + num_primitives - 1;
+  int num_first_half = num_primitives / 2;
+  Code diff = *first ^ *last;
+  if(diff != 0)
+  {
+    Code bit = 1;
+    while(diff >>= 1) bit <<= 1;
+    int lo = 0, hi = num_primitives - 1; // first[lo] & bit == 0, first[hi] & bit != 0
+    while(hi - lo > 1)
+    {
+      int mid = (lo + hi) / 2;
+      if(first[mid] & bit) hi = mid;
+      else lo = mid;
+    }
+    num_first_half = hi;
+  }
+
+  bvnode->first_child = first_child;
+  int left_first_child = first_child + 2;
+  int right_first_child = first_child + 2 * num_first_half;
+
+  if(num_threads > 1 && num_primitives >= min_primitives_per_build_thread)
+  {
+    boost::thread left (boost::bind(&BVHModel<BV>::recursiveBuildTree_linear<Code>, this,
+                                    bvnode->leftChild(), first_primitive, num_first_half,
+                                    left_first_child, codes, num_threads / 2));
+    recursiveBuildTree_linear(bvnode->rightChild(), first_primitive + num_first_half, num_primitives - num_first_half,
+                              right_first_child, codes, num_threads - num_threads / 2);
+    left.join();
+  }
+  else
+  {
+    recursiveBuildTree_linear(bvnode->leftChild(), first_primitive, num_first_half,
+                              left_first_child, codes, 1);
+    recursiveBuildTree_linear(bvnode->rightChild(), first_primitive + num_first_half, num_primitives - num_first_half,
+                              right_first_child, codes, 1);
+  }
+
+  fitInnerNode(*bv_fitter, bvs, primitive_indices, *bvnode);
+}
+
 template<typename BV>
 int BVHModel<BV>::refitTree(bool bottomup)
 {
+  // The quantized layout only keeps the boxes of the nodes: rebuild them.
+  if(!bvs)
+    return buildTree();
+
   if(bottomup)
     return refitTree_bottomup();
   else
@@ -828,15 +1344,171 @@ int BVHModel<BV>::refitTree_bottomup()
   // seems to correct the bug.
   //bv_fitter->set(vertices, tri_indices, getModelType());
 
-  int res = recursiveRefitTree_bottomup(0);
+  BVHModelType type = getModelType();
+  if(type != BVH_MODEL_POINTCLOUD && type != BVH_MODEL_TRIANGLES)
+  {
+    std::cerr << "BVH Error: Model type not supported!" << std::endl;
+    return BVH_ERR_UNSUPPORTED_FUNCTION;
+  }
+
+  if(refit_order.empty())
+    computeRefitSchedule();
+
+  // During an update, the volumes of the vertices which did not move in the
+  // last two frames are already up to date.
+  if(build_state == BVH_BUILD_STATE_UPDATE_BEGUN &&
+     4 * (moved_vertices.size() + prev_moved_vertices.size()) < (std::size_t)num_vertices)
+  {
+    refitMovedVertices();
+    return BVH_OK;
+  }
+
+  int max_level_size = 0;
+  for(std::size_t l = 0; l + 1 < refit_levels.size(); ++l)
+    max_level_size = std::max(max_level_size, refit_levels[l + 1] - refit_levels[l]);
+
+  unsigned int num_threads = num_build_threads;
+  if(num_threads == 0)
+    num_threads = std::max(boost::thread::hardware_concurrency(), 1u);
+  num_threads = std::min(num_threads, (unsigned int)(max_level_size / min_nodes_per_refit_thread));
+
+  if(num_threads <= 1)
+    refitLevels(0, 1, NULL);
+  else
+  {
+    boost::barrier barrier(num_threads);
+    boost::thread_group threads;
+    for(unsigned int k = 1; k < num_threads; ++k)
+      threads.create_thread(boost::bind(&BVHModel<BV>::refitLevels, this,
+                                        k, num_threads, &barrier));
+    refitLevels(0, num_threads, &barrier);
+    threads.join_all();
+  }
 
   //bv_fitter->clear();
-  return res;
+  return BVH_OK;
+}
+
+template<typename BV>
+void BVHModel<BV>::computeRefitSchedule()
+{
+  // The children of a node come after it.
+  parents.assign((std::size_t)num_bvs, -1);
+  std::vector<int> depths((std::size_t)num_bvs, 0);
+  int max_depth = 0;
+  for(int i = 0; i < num_bvs; ++i)
+  {
+    if(bvs[i].isLeaf()) continue;
+    int children[2] = { bvs[i].leftChild(), bvs[i].rightChild() };
+    for(int k = 0; k < 2; ++k)
+    {
+      parents[children[k]] = i;
+      depths[children[k]] = depths[i] + 1;
+    }
+    max_depth = std::max(max_depth, depths[i] + 1);
+  }
+
+  // Counting sort of the nodes by decreasing depth.
+  refit_levels.assign((std::size_t)max_depth + 2, 0);
+  for(int i = 0; i < num_bvs; ++i)
+    ++refit_levels[max_depth - depths[i] + 1];
+  for(std::size_t l = 1; l < refit_levels.size(); ++l)
+    refit_levels[l] += refit_levels[l - 1];
+  std::vector<int> next(refit_levels.begin(), refit_levels.end() - 1);
+  refit_order.resize((std::size_t)num_bvs);
+  for(int i = 0; i < num_bvs; ++i)
+    refit_order[next[max_depth - depths[i]]++] = i;
+
+  primitive_leaves.resize((std::size_t)(num_bvs + 1) / 2);
+  for(int i = 0; i < num_bvs; ++i)
+  {
+    if(bvs[i].isLeaf())
+      primitive_leaves[-(bvs[i].first_child + 1)] = i;
+  }
+
+  vertex_triangles_begin.clear();
+  vertex_triangles.clear();
+  if(getModelType() == BVH_MODEL_TRIANGLES)
+  {
+    vertex_triangles_begin.assign((std::size_t)num_vertices + 1, 0);
+    for(int i = 0; i < num_tris; ++i)
+      for(int k = 0; k < 3; ++k)
+        ++vertex_triangles_begin[tri_indices[i][k] + 1];
+    for(int v = 0; v < num_vertices; ++v)
+      vertex_triangles_begin[v + 1] += vertex_triangles_begin[v];
+    next.assign(vertex_triangles_begin.begin(), vertex_triangles_begin.end() - 1);
+    vertex_triangles.resize(3 * (std::size_t)num_tris);
+    for(int i = 0; i < num_tris; ++i)
+      for(int k = 0; k < 3; ++k)
+        vertex_triangles[next[tri_indices[i][k]]++] = i;
+  }
+}
+
+template<typename BV>
+void BVHModel<BV>::refitLevels(unsigned int thread_id, unsigned int num_threads,
+                               boost::barrier* barrier)
+{
+  bool previous_shared = true;
+  for(std::size_t l = 0; l + 1 < refit_levels.size(); ++l)
+  {
+    const int begin = refit_levels[l], size = refit_levels[l + 1] - begin;
+    if(num_threads > 1 && size >= (int)num_threads * min_nodes_per_refit_thread)
+    {
+      // Wait for thread 0 to refit the levels below.
+      if(!previous_shared) barrier->wait();
+      for(int i = begin + (int)((long)size * thread_id / num_threads);
+          i < begin + (int)((long)size * (thread_id + 1) / num_threads); ++i)
+        refitNode_bottomup(refit_order[i]);
+      barrier->wait();
+      previous_shared = true;
+    }
+    else
+    {
+      if(thread_id == 0)
+      {
+        for(int i = begin; i < begin + size; ++i)
+          refitNode_bottomup(refit_order[i]);
+      }
+      previous_shared = false;
+    }
+  }
 }
 
+template<typename BV>
+void BVHModel<BV>::refitMovedVertices()
+{
+  std::vector<int> leaves;
+  const std::vector<int>* moved[2] = { &moved_vertices, &prev_moved_vertices };
+  for(int k = 0; k < 2; ++k)
+  {
+    for(std::size_t i = 0; i < moved[k]->size(); ++i)
+    {
+      int v = (*moved[k])[i];
+      if(getModelType() == BVH_MODEL_POINTCLOUD)
+        leaves.push_back(primitive_leaves[v]);
+      else
+      {
+        for(int j = vertex_triangles_begin[v]; j < vertex_triangles_begin[v + 1]; ++j)
+          leaves.push_back(primitive_leaves[vertex_triangles[j]]);
+      }
+    }
+  }
+
+  // The children of a node come after it: refit by decreasing index.
+  std::vector<int> nodes;
+  for(std::size_t i = 0; i < leaves.size(); ++i)
+  {
+    for(int id = leaves[i]; id != -1; id = parents[id])
+      nodes.push_back(id);
+  }
+  std::sort(nodes.begin(), nodes.end(), std::greater<int>());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  for(std::size_t i = 0; i < nodes.size(); ++i)
+    refitNode_bottomup(nodes[i]);
+}
 
 template<typename BV>
-int BVHModel<BV>::recursiveRefitTree_bottomup(int bv_id)
+int BVHModel<BV>::refitNode_bottomup(int bv_id)
 {
   BVNode<BV>* bvnode = bvs + bv_id;
   if(bvnode->isLeaf())
@@ -899,14 +1571,16 @@ int BVHModel<BV>::recursiveRefitTree_bottomup(int bv_id)
   }
   else
   {
-    recursiveRefitTree_bottomup(bvnode->leftChild());
-    recursiveRefitTree_bottomup(bvnode->rightChild());
     bvnode->bv = bvs[bvnode->leftChild()].bv + bvs[bvnode->rightChild()].bv;
     //TODO use bv_fitter to build BV. See comment in refitTree_bottomup
     //unsigned int* cur_primitive_indices = primitive_indices + bvnode->first_primitive;
     //bvnode->bv = bv_fitter->fit(cur_primitive_indices, bvnode->num_primitives);
   }
 
+  if(node_volumes)
+    node_volumes[bv_id].set(bvnode->bv);
+  if(wide_slots && wide_slots[bv_id] >= 0)
+    wide_nodes[wide_slots[bv_id] / 4].volumes.set(wide_slots[bv_id] % 4, bvnode->bv);
   return BVH_OK;
 }
 
@@ -921,6 +1595,7 @@ int BVHModel<BV>::refitTree_topdown()
   }
 
   bv_fitter->clear();
+  updateNodeLayout();
 
   return BVH_OK;
 }
@@ -37,6 +37,8 @@
 
 #include <hpp/fcl/internal/BV_splitter.h>
 
+#include <limits>
+
 namespace hpp
 {
 namespace fcl
@@ -169,6 +171,96 @@ void computeSplitValue_median(const BV&, Vec3f* vertices, Triangle* triangles, u
   }  
 }
 
+int computeSplit_binnedSAH(const Matrix3f& axes, Vec3f* vertices, Triangle* triangles, unsigned int* primitive_indices, int num_primitives, BVHModelType type, FCL_REAL& split_value)
+{
+  const int num_bins = 16;
+  const FCL_REAL inf = std::numeric_limits<FCL_REAL>::max();
+
+  // Centroid and bounding box of each primitive, in the frame axes.
+  std::vector<Vec3f> centroids(num_primitives), lower(num_primitives), upper(num_primitives);
+  Vec3f cmin(inf, inf, inf), cmax(-inf, -inf, -inf);
+  for(int i = 0; i < num_primitives; ++i)
+  {
+    if(type == BVH_MODEL_TRIANGLES)
+    {
+      const Triangle& t = triangles[primitive_indices[i]];
+      Vec3f p1 (axes.transpose() * vertices[t[0]]);
+      Vec3f p2 (axes.transpose() * vertices[t[1]]);
+      Vec3f p3 (axes.transpose() * vertices[t[2]]);
+      centroids[i] = (p1 + p2 + p3) / 3;
+      lower[i] = p1.cwiseMin(p2).cwiseMin(p3);
+      upper[i] = p1.cwiseMax(p2).cwiseMax(p3);
+    }
+    else
+    {
+      centroids[i] = lower[i] = upper[i] = axes.transpose() * vertices[primitive_indices[i]];
+    }
+    cmin = cmin.cwiseMin(centroids[i]);
+    cmax = cmax.cwiseMax(centroids[i]);
+  }
+
+  int best_axis = 0;
+  split_value = cmin[0];
+  FCL_REAL best_cost = inf;
+
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    FCL_REAL extent = cmax[axis] - cmin[axis];
+    if(extent <= 0) continue;
+
+    int count[num_bins];
+    Vec3f bin_lower[num_bins], bin_upper[num_bins];
+    for(int k = 0; k < num_bins; ++k)
+    {
+      count[k] = 0;
+      bin_lower[k].setConstant(inf);
+      bin_upper[k].setConstant(-inf);
+    }
+    for(int i = 0; i < num_primitives; ++i)
+    {
+      int k = (int)(num_bins * (centroids[i][axis] - cmin[axis]) / extent);
+      if(k >= num_bins) k = num_bins - 1;
+      ++count[k];
+      bin_lower[k] = bin_lower[k].cwiseMin(lower[i]);
+      bin_upper[k] = bin_upper[k].cwiseMax(upper[i]);
+    }
+
+    // cost[k]: cost of the bins [k, num_bins) put in the second child.
+    FCL_REAL cost[num_bins];
+    Vec3f l(inf, inf, inf), u(-inf, -inf, -inf);
+    int n = 0;
+    for(int k = num_bins - 1; k > 0; --k)
+    {
+      n += count[k];
+      l = l.cwiseMin(bin_lower[k]);
+      u = u.cwiseMax(bin_upper[k]);
+      Vec3f d (u - l);
+      cost[k] = (n == 0) ? inf : n * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+    }
+
+    l.setConstant(inf);
+    u.setConstant(-inf);
+    n = 0;
+    for(int k = 1; k < num_bins; ++k)
+    {
+      n += count[k - 1];
+      l = l.cwiseMin(bin_lower[k - 1]);
+      u = u.cwiseMax(bin_upper[k - 1]);
+      if(n == 0 || cost[k] == inf) continue;
+      Vec3f d (u - l);
+      FCL_REAL c = cost[k] + n * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+      if(c < best_cost)
+      {
+        best_cost = c;
+        best_axis = axis;
+        split_value = cmin[axis] + extent * k / num_bins;
+      }
+    }
+  }
+
+  return best_axis;
+}
+
 template<>
 void BVSplitter<OBB>::computeRule_bvcenter(const OBB& bv, unsigned int*, int)
 {
@@ -190,6 +282,13 @@ void BVSplitter<OBB>::computeRule_median(const OBB& bv, unsigned int* primitive_
   computeSplitValue_median<OBB>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<OBB>::computeRule_binnedSAH(const OBB& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  int axis = computeSplit_binnedSAH(bv.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_value);
+  split_vector.noalias() = bv.axes.col(axis);
+}
+
 template<>
 void BVSplitter<RSS>::computeRule_bvcenter(const RSS& bv, unsigned int*, int)
 {
@@ -211,6 +310,13 @@ void BVSplitter<RSS>::computeRule_median(const RSS& bv, unsigned int* primitive_
   computeSplitValue_median<RSS>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<RSS>::computeRule_binnedSAH(const RSS& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  int axis = computeSplit_binnedSAH(bv.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_value);
+  split_vector.noalias() = bv.axes.col(axis);
+}
+
 template<>
 void BVSplitter<kIOS>::computeRule_bvcenter(const kIOS& bv, unsigned int*, int)
 {
@@ -232,6 +338,13 @@ void BVSplitter<kIOS>::computeRule_median(const kIOS& bv, unsigned int* primitiv
   computeSplitValue_median<kIOS>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<kIOS>::computeRule_binnedSAH(const kIOS& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  int axis = computeSplit_binnedSAH(bv.obb.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_value);
+  split_vector.noalias() = bv.obb.axes.col(axis);
+}
+
 template<>
 void BVSplitter<OBBRSS>::computeRule_bvcenter
 (const OBBRSS& bv, unsigned int*, int)
@@ -254,6 +367,13 @@ void BVSplitter<OBBRSS>::computeRule_median(const OBBRSS& bv, unsigned int* prim
   computeSplitValue_median<OBBRSS>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<OBBRSS>::computeRule_binnedSAH(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  int axis = computeSplit_binnedSAH(bv.obb.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_value);
+  split_vector.noalias() = bv.obb.axes.col(axis);
+}
+
 
 template<>
 bool BVSplitter<OBB>::apply(const Vec3f& q) const
@@ -0,0 +1,207 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_SRC_BVH_MORTON_H
+#define HPP_FCL_SRC_BVH_MORTON_H
+
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <hpp/fcl/data_types.h>
+#include <hpp/fcl/internal/work_stealing.h>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+/// @brief Morton codes on 30 bits (10 bits per axis).
+inline boost::uint32_t expandBits(boost::uint32_t x)
+{
+  x &= 0x3ffu;
+  x = (x | (x << 16)) & 0x030000ffu;
+  x = (x | (x <<  8)) & 0x0300f00fu;
+  x = (x | (x <<  4)) & 0x030c30c3u;
+  x = (x | (x <<  2)) & 0x09249249u;
+  return x;
+}
+
+/// @brief Morton codes on 63 bits (21 bits per axis).
+inline boost::uint64_t expandBits(boost::uint64_t x)
+{
+  x &= UINT64_C(0x1fffff);
+  x = (x | (x << 32)) & UINT64_C(0x001f00000000ffff);
+  x = (x | (x << 16)) & UINT64_C(0x001f0000ff0000ff);
+  x = (x | (x <<  8)) & UINT64_C(0x100f00f00f00f00f);
+  x = (x | (x <<  4)) & UINT64_C(0x10c30c30c30c30c3);
+  x = (x | (x <<  2)) & UINT64_C(0x1249249249249249);
+  return x;
+}
+
+/// @brief Morton code of a point of the unit cube.
+template<typename Code>
+Code mortonCode(const Vec3f& p)
+{
+  const int bits = (int)(sizeof(Code) * 8) / 3;
+  const FCL_REAL scale = (FCL_REAL)((Code)1 << bits);
+  Code c[3];
+  for(int i = 0; i < 3; ++i)
+  {
+    FCL_REAL x = p[i] * scale;
+    if(x <= 0) c[i] = 0;
+    else if(x >= scale) c[i] = ((Code)1 << bits) - 1;
+    else c[i] = (Code)x;
+  }
+  return (expandBits(c[0]) << 2) | (expandBits(c[1]) << 1) | expandBits(c[2]);
+}
+
+/// @brief Count the digits of one chunk of keys, for radixSort.
+template<typename Code>
+struct RadixHistogram
+{
+  const Code* keys;
+  std::size_t n;
+  std::size_t num_chunks;
+  int shift;
+  std::size_t* counts; // num_chunks x 256
+
+  void operator()(std::size_t chunk)
+  {
+    std::size_t* count = counts + 256 * chunk;
+    for(std::size_t d = 0; d < 256; ++d) count[d] = 0;
+    for(std::size_t i = n * chunk / num_chunks; i < n * (chunk + 1) / num_chunks; ++i)
+      ++count[(keys[i] >> shift) & 0xff];
+  }
+};
+
+/// @brief Move one chunk of keys and values at their sorted position, for
+/// radixSort.
+template<typename Code>
+struct RadixScatter
+{
+  const Code* keys;
+  const unsigned int* values;
+  Code* sorted_keys;
+  unsigned int* sorted_values;
+  std::size_t n;
+  std::size_t num_chunks;
+  int shift;
+  const std::size_t* offsets; // num_chunks x 256
+
+  void operator()(std::size_t chunk)
+  {
+    std::size_t offset[256];
+    for(std::size_t d = 0; d < 256; ++d) offset[d] = offsets[256 * chunk + d];
+    for(std::size_t i = n * chunk / num_chunks; i < n * (chunk + 1) / num_chunks; ++i)
+    {
+      std::size_t j = offset[(keys[i] >> shift) & 0xff]++;
+      sorted_keys[j] = keys[i];
+      sorted_values[j] = values[i];
+    }
+  }
+};
+
+/// @brief Stable sort of keys, and of values along with them, by least
+/// significant digit radix sort on bytes.
+///
+/// Each pass splits the keys into one chunk per thread. The threads count
+/// the digits of their chunk, then move the keys of their chunk, so that
+/// the result does not depend on the number of threads. The passes where
+/// all the keys have the same digit are skipped.
+template<typename Code>
+void radixSort(std::vector<Code>& keys, std::vector<unsigned int>& values,
+               std::size_t num_threads)
+{
+  const std::size_t n = keys.size();
+  if(n == 0) return;
+  if(num_threads < 1) num_threads = 1;
+  const std::size_t num_chunks = num_threads;
+  std::vector<Code> tmp_keys(n);
+  std::vector<unsigned int> tmp_values(n);
+  std::vector<std::size_t> counts(256 * num_chunks);
+
+  for(int shift = 0; shift < (int)(8 * sizeof(Code)); shift += 8)
+  {
+    RadixHistogram<Code> histogram;
+    histogram.keys = &keys[0];
+    histogram.n = n;
+    histogram.num_chunks = num_chunks;
+    histogram.shift = shift;
+    histogram.counts = &counts[0];
+    std::vector<RadixHistogram<Code> > histograms(num_threads, histogram);
+    parallelFor(num_chunks, histograms);
+
+    // Exclusive prefix sum, digit first and chunk second.
+    std::size_t sum = 0;
+    bool skip = false;
+    for(std::size_t d = 0; d < 256 && !skip; ++d)
+    {
+      std::size_t total = 0;
+      for(std::size_t c = 0; c < num_chunks; ++c)
+      {
+        std::size_t count = counts[256 * c + d];
+        counts[256 * c + d] = sum + total;
+        total += count;
+      }
+      if(total == n) skip = true;
+      sum += total;
+    }
+    if(skip) continue;
+
+    RadixScatter<Code> scatter;
+    scatter.keys = &keys[0];
+    scatter.values = &values[0];
+    scatter.sorted_keys = &tmp_keys[0];
+    scatter.sorted_values = &tmp_values[0];
+    scatter.n = n;
+    scatter.num_chunks = num_chunks;
+    scatter.shift = shift;
+    scatter.offsets = &counts[0];
+    std::vector<RadixScatter<Code> > scatters(num_threads, scatter);
+    parallelFor(num_chunks, scatters);
+
+    keys.swap(tmp_keys);
+    values.swap(tmp_values);
+  }
+}
+
+} // details
+} // fcl
+
+} // namespace hpp
+
+#endif
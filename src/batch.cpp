@@ -0,0 +1,150 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <hpp/fcl/batch.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/collision_func_matrix.h>
+#include <hpp/fcl/distance_func_matrix.h>
+#include <hpp/fcl/narrowphase/narrowphase.h>
+#include <hpp/fcl/internal/work_stealing.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+CollisionFunctionMatrix& getCollisionFunctionLookTable();
+DistanceFunctionMatrix& getDistanceFunctionLookTable();
+
+namespace
+{
+
+std::size_t numThreads(std::size_t num_threads, std::size_t num_queries)
+{
+  if(num_threads == 0)
+    num_threads = boost::thread::hardware_concurrency();
+  if(num_threads == 0)
+    num_threads = 1;
+  if(num_threads > num_queries)
+    num_threads = std::max<std::size_t>(num_queries, 1);
+  return num_threads;
+}
+
+/// Runs the collision queries of one thread.
+struct BatchCollide
+{
+  const std::vector<GeometryQuery>* queries;
+  const CollisionRequest* request;
+  std::vector<CollisionResult>* results;
+  GJKSolver solver;
+
+  void operator()(std::size_t i)
+  {
+    const GeometryQuery& q = (*queries)[i];
+    CollisionResult& result = (*results)[i];
+    result.clear();
+    solver.resetWarmStart();
+    collide(q.o1, q.tf1, q.o2, q.tf2, &solver, *request, result);
+  }
+};
+
+/// Runs the distance queries of one thread.
+struct BatchDistance
+{
+  const std::vector<GeometryQuery>* queries;
+  const DistanceRequest* request;
+  std::vector<DistanceResult>* results;
+  GJKSolver solver;
+
+  void operator()(std::size_t i)
+  {
+    const GeometryQuery& q = (*queries)[i];
+    DistanceResult& result = (*results)[i];
+    result.clear();
+    solver.resetWarmStart();
+    distance(q.o1, q.tf1, q.o2, q.tf2, &solver, *request, result);
+  }
+};
+
+}
+
+std::size_t collide(const std::vector<GeometryQuery>& queries,
+                    const CollisionRequest& request,
+                    std::vector<CollisionResult>& results,
+                    std::size_t num_threads)
+{
+  results.resize(queries.size());
+  // Build the look-up table before starting the threads.
+  getCollisionFunctionLookTable();
+
+  std::vector<BatchCollide> bodies
+    (numThreads(num_threads, queries.size()));
+  for(std::size_t k = 0; k < bodies.size(); ++k)
+  {
+    bodies[k].queries = &queries;
+    bodies[k].request = &request;
+    bodies[k].results = &results;
+  }
+  details::parallelFor(queries.size(), bodies);
+
+  std::size_t num_collisions = 0;
+  for(std::size_t i = 0; i < results.size(); ++i)
+    if(results[i].isCollision()) ++num_collisions;
+  return num_collisions;
+}
+
+void distance(const std::vector<GeometryQuery>& queries,
+              const DistanceRequest& request,
+              std::vector<DistanceResult>& results,
+              std::size_t num_threads)
+{
+  results.resize(queries.size());
+  // Build the look-up table before starting the threads.
+  getDistanceFunctionLookTable();
+
+  std::vector<BatchDistance> bodies
+    (numThreads(num_threads, queries.size()));
+  for(std::size_t k = 0; k < bodies.size(); ++k)
+  {
+    bodies[k].queries = &queries;
+    bodies[k].request = &request;
+    bodies[k].results = &results;
+  }
+  details::parallelFor(queries.size(), bodies);
+}
+
+}
+
+} // namespace hpp
@@ -0,0 +1,422 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <hpp/fcl/broadphase/broadphase_SaP.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  inline bool sameAABB(const AABB& a, const AABB& b)
+  {
+    return a.min_ == b.min_ && a.max_ == b.max_;
+  }
+}
+
+SaPCollisionManager::SaPCollisionManager()
+{
+}
+
+void SaPCollisionManager::registerObjects
+(const std::vector<CollisionObject*>& other_objs)
+{
+  if(other_objs.empty()) return;
+
+  if(!empty())
+  {
+    BroadPhaseCollisionManager::registerObjects(other_objs);
+    return;
+  }
+
+  // Bulk insertion: sort the bounds, then find the overlapping pairs by
+  // sweeping along the first axis.
+  const std::size_t n = other_objs.size();
+  boxes.resize(n);
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    boxes[i].obj = other_objs[i];
+    boxes[i].aabb = other_objs[i]->getAABB();
+    table[other_objs[i]] = i;
+  }
+
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<EndPoint>& endpoints = axes[axis];
+    endpoints.resize(2 * n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      EndPoint& lo = endpoints[2 * i];
+      lo.value = boxes[i].aabb.min_[axis];
+      lo.box = i;
+      lo.is_max = false;
+      EndPoint& hi = endpoints[2 * i + 1];
+      hi.value = boxes[i].aabb.max_[axis];
+      hi.box = i;
+      hi.is_max = true;
+    }
+    std::sort(endpoints.begin(), endpoints.end());
+    for(std::size_t k = 0; k < endpoints.size(); ++k)
+      boxes[endpoints[k].box].endpoints[axis][endpoints[k].is_max] = k;
+  }
+
+  std::vector<std::size_t> active;
+  const std::vector<EndPoint>& endpoints = axes[0];
+  for(std::size_t k = 0; k < endpoints.size(); ++k)
+  {
+    const std::size_t b = endpoints[k].box;
+    if(!endpoints[k].is_max)
+    {
+      for(std::size_t i = 0; i < active.size(); ++i)
+        addPair(active[i], b);
+      active.push_back(b);
+    }
+    else
+    {
+      std::vector<std::size_t>::iterator it =
+        std::find(active.begin(), active.end(), b);
+      *it = active.back();
+      active.pop_back();
+    }
+  }
+}
+
+void SaPCollisionManager::registerObject(CollisionObject* obj)
+{
+  // The bounds are inserted at their sorted position. Inserting with an
+  // insertion sort from the end of the lists would not be cheaper, and could
+  // not be ordered with bounds at infinity.
+  const std::size_t b = boxes.size();
+  SaPBox box;
+  box.obj = obj;
+  box.aabb = obj->getAABB();
+  boxes.push_back(box);
+  table[obj] = b;
+
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<EndPoint>& endpoints = axes[axis];
+    EndPoint e;
+    e.box = b;
+    e.is_max = false;
+    e.value = box.aabb.min_[axis];
+    std::size_t lo = (std::size_t)
+      (std::upper_bound(endpoints.begin(), endpoints.end(), e) - endpoints.begin());
+    endpoints.insert(endpoints.begin() + (std::ptrdiff_t)lo, e);
+    e.is_max = true;
+    e.value = box.aabb.max_[axis];
+    std::size_t hi = (std::size_t)
+      (std::upper_bound(endpoints.begin() + (std::ptrdiff_t)lo + 1,
+                        endpoints.end(), e) - endpoints.begin());
+    endpoints.insert(endpoints.begin() + (std::ptrdiff_t)hi, e);
+    renumberEndPoints(axis, lo);
+  }
+
+  for(std::size_t i = 0; i < b; ++i)
+    addPair(i, b);
+}
+
+void SaPCollisionManager::unregisterObject(CollisionObject* obj)
+{
+  std::map<CollisionObject*, std::size_t>::iterator it = table.find(obj);
+  if(it == table.end()) return;
+  const std::size_t b = it->second;
+  table.erase(it);
+
+  for(OverlappingPairs::iterator pair = overlapping_pairs.begin();
+      pair != overlapping_pairs.end();)
+  {
+    if(pair->first == obj || pair->second == obj)
+      overlapping_pairs.erase(pair++);
+    else
+      ++pair;
+  }
+
+  // The bounds are erased at the positions stored in the box: other bounds
+  // may have the same values.
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<EndPoint>& endpoints = axes[axis];
+    const std::size_t lo = boxes[b].endpoints[axis][0];
+    const std::size_t hi = boxes[b].endpoints[axis][1];
+    endpoints.erase(endpoints.begin() + (std::ptrdiff_t)hi);
+    endpoints.erase(endpoints.begin() + (std::ptrdiff_t)lo);
+    renumberEndPoints(axis, lo);
+  }
+
+  const std::size_t last = boxes.size() - 1;
+  if(b != last)
+  {
+    boxes[b] = boxes[last];
+    for(int axis = 0; axis < 3; ++axis)
+      for(int k = 0; k < 2; ++k)
+        axes[axis][boxes[b].endpoints[axis][k]].box = b;
+    table[boxes[b].obj] = b;
+  }
+  boxes.pop_back();
+}
+
+void SaPCollisionManager::setup()
+{
+  // The bounds and the overlapping pairs are always up to date.
+}
+
+void SaPCollisionManager::update()
+{
+  for(std::size_t b = 0; b < boxes.size(); ++b)
+  {
+    const AABB& aabb = boxes[b].obj->getAABB();
+    if(!sameAABB(aabb, boxes[b].aabb))
+      updateBox(b, aabb);
+  }
+}
+
+void SaPCollisionManager::update(CollisionObject* updated_obj)
+{
+  std::map<CollisionObject*, std::size_t>::const_iterator it =
+    table.find(updated_obj);
+  if(it == table.end()) return;
+
+  const AABB& aabb = updated_obj->getAABB();
+  if(!sameAABB(aabb, boxes[it->second].aabb))
+    updateBox(it->second, aabb);
+}
+
+void SaPCollisionManager::update
+(const std::vector<CollisionObject*>& updated_objs)
+{
+  for(std::size_t i = 0; i < updated_objs.size(); ++i)
+    update(updated_objs[i]);
+}
+
+void SaPCollisionManager::clear()
+{
+  for(int axis = 0; axis < 3; ++axis)
+    axes[axis].clear();
+  boxes.clear();
+  table.clear();
+  overlapping_pairs.clear();
+}
+
+void SaPCollisionManager::getObjects(std::vector<CollisionObject*>& objs) const
+{
+  objs.resize(boxes.size());
+  for(std::size_t b = 0; b < boxes.size(); ++b)
+    objs[b] = boxes[b].obj;
+}
+
+void SaPCollisionManager::collide
+(CollisionObject* obj, void* cdata, CollisionCallBack callback) const
+{
+  if(empty()) return;
+
+  const AABB& query = obj->getAABB();
+
+  // The boxes overlapping the query have their lower bound before the upper
+  // bound of the query, and their upper bound after its lower bound, on
+  // every axis. Scan the shortest of these six ranges.
+  EndPoint lo, hi;
+  lo.box = hi.box = 0;
+  lo.is_max = false;
+  hi.is_max = true;
+
+  int best_axis = 0;
+  bool best_from_start = true;
+  std::size_t best_begin = 0, best_end = axes[0].size();
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    const std::vector<EndPoint>& endpoints = axes[axis];
+    hi.value = query.max_[axis];
+    lo.value = query.min_[axis];
+    std::size_t end = (std::size_t)
+      (std::upper_bound(endpoints.begin(), endpoints.end(), hi) - endpoints.begin());
+    std::size_t begin = (std::size_t)
+      (std::lower_bound(endpoints.begin(), endpoints.end(), lo) - endpoints.begin());
+    if(end < best_end - best_begin)
+    {
+      best_axis = axis; best_from_start = true;
+      best_begin = 0; best_end = end;
+    }
+    if(endpoints.size() - begin < best_end - best_begin)
+    {
+      best_axis = axis; best_from_start = false;
+      best_begin = begin; best_end = endpoints.size();
+    }
+  }
+
+  const std::vector<EndPoint>& endpoints = axes[best_axis];
+  for(std::size_t k = best_begin; k < best_end; ++k)
+  {
+    // Lower bounds when scanning from the start, upper bounds otherwise
+    if(endpoints[k].is_max == best_from_start) continue;
+    const SaPBox& box = boxes[endpoints[k].box];
+    if(box.aabb.overlap(query) && callback(box.obj, obj, cdata))
+      return;
+  }
+}
+
+void SaPCollisionManager::distance
+(CollisionObject* obj, void* cdata, DistanceCallBack callback) const
+{
+  if(empty()) return;
+
+  const AABB& query = obj->getAABB();
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  for(std::size_t b = 0; b < boxes.size(); ++b)
+  {
+    if(boxes[b].aabb.distance(query) < min_dist
+       && callback(boxes[b].obj, obj, cdata, min_dist))
+      return;
+  }
+}
+
+void SaPCollisionManager::collide(void* cdata, CollisionCallBack callback) const
+{
+  for(OverlappingPairs::const_iterator it = overlapping_pairs.begin();
+      it != overlapping_pairs.end(); ++it)
+  {
+    if(callback(it->first, it->second, cdata))
+      return;
+  }
+}
+
+void SaPCollisionManager::distance(void* cdata, DistanceCallBack callback) const
+{
+  if(empty()) return;
+
+  // Each pair is visited from the box with the lowest lower bound along the
+  // first axis. The scan stops when the gap along this axis exceeds the
+  // current minimal distance.
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  const std::vector<EndPoint>& endpoints = axes[0];
+  for(std::size_t i = 0; i < endpoints.size(); ++i)
+  {
+    if(endpoints[i].is_max) continue;
+    const SaPBox& box1 = boxes[endpoints[i].box];
+    for(std::size_t j = i + 1; j < endpoints.size(); ++j)
+    {
+      if(endpoints[j].is_max) continue;
+      if(endpoints[j].value - box1.aabb.max_[0] >= min_dist) break;
+      const SaPBox& box2 = boxes[endpoints[j].box];
+      if(box1.aabb.distance(box2.aabb) < min_dist
+         && callback(box1.obj, box2.obj, cdata, min_dist))
+        return;
+    }
+  }
+}
+
+void SaPCollisionManager::updateBox(std::size_t b, const AABB& aabb)
+{
+  // The pairs are tested against the new AABB, so it is set first.
+  boxes[b].aabb = aabb;
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    // Move the bounds in an order such that they never cross each other.
+    if(aabb.max_[axis] > axes[axis][boxes[b].endpoints[axis][1]].value)
+    {
+      moveEndPoint(axis, boxes[b].endpoints[axis][1], aabb.max_[axis]);
+      moveEndPoint(axis, boxes[b].endpoints[axis][0], aabb.min_[axis]);
+    }
+    else
+    {
+      moveEndPoint(axis, boxes[b].endpoints[axis][0], aabb.min_[axis]);
+      moveEndPoint(axis, boxes[b].endpoints[axis][1], aabb.max_[axis]);
+    }
+  }
+}
+
+void SaPCollisionManager::moveEndPoint(int axis, std::size_t pos, FCL_REAL value)
+{
+  std::vector<EndPoint>& endpoints = axes[axis];
+  endpoints[pos].value = value;
+  while(pos > 0 && endpoints[pos] < endpoints[pos - 1])
+  {
+    swapEndPoints(axis, pos);
+    --pos;
+  }
+  while(pos + 1 < endpoints.size() && endpoints[pos + 1] < endpoints[pos])
+  {
+    swapEndPoints(axis, pos + 1);
+    ++pos;
+  }
+}
+
+void SaPCollisionManager::swapEndPoints(int axis, std::size_t pos)
+{
+  std::vector<EndPoint>& endpoints = axes[axis];
+  EndPoint& prev = endpoints[pos - 1];
+  EndPoint& next = endpoints[pos];
+
+  // A lower bound passing an upper bound starts an overlap along this axis,
+  // an upper bound passing a lower bound ends it.
+  if(!next.is_max && prev.is_max)
+    addPair(next.box, prev.box);
+  else if(next.is_max && !prev.is_max)
+    removePair(next.box, prev.box);
+
+  std::swap(prev, next);
+  boxes[prev.box].endpoints[axis][prev.is_max] = pos - 1;
+  boxes[next.box].endpoints[axis][next.is_max] = pos;
+}
+
+void SaPCollisionManager::renumberEndPoints(int axis, std::size_t begin)
+{
+  const std::vector<EndPoint>& endpoints = axes[axis];
+  for(std::size_t k = begin; k < endpoints.size(); ++k)
+    boxes[endpoints[k].box].endpoints[axis][endpoints[k].is_max] = k;
+}
+
+void SaPCollisionManager::addPair(std::size_t b1, std::size_t b2)
+{
+  if(!boxes[b1].aabb.overlap(boxes[b2].aabb)) return;
+  CollisionObject* o1 = boxes[b1].obj;
+  CollisionObject* o2 = boxes[b2].obj;
+  overlapping_pairs.insert(o1 < o2 ? ObjectPair(o1, o2) : ObjectPair(o2, o1));
+}
+
+void SaPCollisionManager::removePair(std::size_t b1, std::size_t b2)
+{
+  CollisionObject* o1 = boxes[b1].obj;
+  CollisionObject* o2 = boxes[b2].obj;
+  overlapping_pairs.erase(o1 < o2 ? ObjectPair(o1, o2) : ObjectPair(o2, o1));
+}
+
+}
+
+} // namespace hpp
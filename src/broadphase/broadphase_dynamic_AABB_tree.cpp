@@ -0,0 +1,388 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <hpp/fcl/broadphase/broadphase_dynamic_AABB_tree.h>
+
+#include <cmath>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  typedef DynamicAABBTree::Node Node;
+
+  inline CollisionObject* object(const Node& node)
+  {
+    return static_cast<CollisionObject*>(node.data);
+  }
+
+  /// Collision between an object and the subtree rooted at i.
+  bool collideRecurse(const DynamicAABBTree& tree, std::size_t i,
+                      CollisionObject* query, void* cdata,
+                      CollisionCallBack callback)
+  {
+    const Node& node = tree.getNode(i);
+    if(!node.bv.overlap(query->getAABB())) return false;
+
+    if(node.isLeaf())
+    {
+      CollisionObject* obj = object(node);
+      if(!obj->getAABB().overlap(query->getAABB())) return false;
+      return callback(obj, query, cdata);
+    }
+
+    return collideRecurse(tree, node.children[0], query, cdata, callback)
+      ||   collideRecurse(tree, node.children[1], query, cdata, callback);
+  }
+
+  /// Collision between the subtrees rooted at i1 and i2.
+  bool collideRecurse(const DynamicAABBTree& tree1, std::size_t i1,
+                      const DynamicAABBTree& tree2, std::size_t i2,
+                      void* cdata, CollisionCallBack callback)
+  {
+    const Node& n1 = tree1.getNode(i1);
+    const Node& n2 = tree2.getNode(i2);
+    if(!n1.bv.overlap(n2.bv)) return false;
+
+    if(n1.isLeaf() && n2.isLeaf())
+    {
+      CollisionObject* o1 = object(n1);
+      CollisionObject* o2 = object(n2);
+      if(!o1->getAABB().overlap(o2->getAABB())) return false;
+      return callback(o1, o2, cdata);
+    }
+
+    // Descend into the largest node
+    if(n2.isLeaf() || (!n1.isLeaf() && n1.bv.size() > n2.bv.size()))
+      return collideRecurse(tree1, n1.children[0], tree2, i2, cdata, callback)
+        ||   collideRecurse(tree1, n1.children[1], tree2, i2, cdata, callback);
+    else
+      return collideRecurse(tree1, i1, tree2, n2.children[0], cdata, callback)
+        ||   collideRecurse(tree1, i1, tree2, n2.children[1], cdata, callback);
+  }
+
+  /// Self collision of the subtree rooted at i.
+  bool selfCollideRecurse(const DynamicAABBTree& tree, std::size_t i,
+                          void* cdata, CollisionCallBack callback)
+  {
+    const Node& node = tree.getNode(i);
+    if(node.isLeaf()) return false;
+
+    return selfCollideRecurse(tree, node.children[0], cdata, callback)
+      ||   selfCollideRecurse(tree, node.children[1], cdata, callback)
+      ||   collideRecurse(tree, node.children[0], tree, node.children[1],
+                          cdata, callback);
+  }
+
+  /// Distance between an object and the subtree rooted at i.
+  /// The closest child is visited first, and the subtrees further than
+  /// min_dist are pruned.
+  bool distanceRecurse(const DynamicAABBTree& tree, std::size_t i,
+                       CollisionObject* query, void* cdata,
+                       DistanceCallBack callback, FCL_REAL& min_dist)
+  {
+    const Node& node = tree.getNode(i);
+    if(node.isLeaf())
+    {
+      CollisionObject* obj = object(node);
+      if(obj->getAABB().distance(query->getAABB()) >= min_dist) return false;
+      return callback(obj, query, cdata, min_dist);
+    }
+
+    std::size_t c[2] = { node.children[0], node.children[1] };
+    FCL_REAL d[2] = { tree.getNode(c[0]).bv.distance(query->getAABB()),
+                      tree.getNode(c[1]).bv.distance(query->getAABB()) };
+    if(d[1] < d[0])
+    {
+      std::swap(c[0], c[1]);
+      std::swap(d[0], d[1]);
+    }
+
+    for(int k = 0; k < 2; ++k)
+    {
+      if(d[k] < min_dist
+         && distanceRecurse(tree, c[k], query, cdata, callback, min_dist))
+        return true;
+    }
+    return false;
+  }
+
+  /// Distance between the subtrees rooted at i1 and i2.
+  bool distanceRecurse(const DynamicAABBTree& tree1, std::size_t i1,
+                       const DynamicAABBTree& tree2, std::size_t i2,
+                       void* cdata, DistanceCallBack callback,
+                       FCL_REAL& min_dist)
+  {
+    const Node& n1 = tree1.getNode(i1);
+    const Node& n2 = tree2.getNode(i2);
+
+    if(n1.isLeaf() && n2.isLeaf())
+    {
+      CollisionObject* o1 = object(n1);
+      CollisionObject* o2 = object(n2);
+      if(o1->getAABB().distance(o2->getAABB()) >= min_dist) return false;
+      return callback(o1, o2, cdata, min_dist);
+    }
+
+    // Descend into the largest node
+    const bool descend1 =
+      n2.isLeaf() || (!n1.isLeaf() && n1.bv.size() > n2.bv.size());
+    const Node& parent = descend1 ? n1 : n2;
+    const Node& other  = descend1 ? n2 : n1;
+    const DynamicAABBTree& tree = descend1 ? tree1 : tree2;
+
+    std::size_t c[2] = { parent.children[0], parent.children[1] };
+    FCL_REAL d[2] = { tree.getNode(c[0]).bv.distance(other.bv),
+                      tree.getNode(c[1]).bv.distance(other.bv) };
+    if(d[1] < d[0])
+    {
+      std::swap(c[0], c[1]);
+      std::swap(d[0], d[1]);
+    }
+
+    for(int k = 0; k < 2; ++k)
+    {
+      if(d[k] >= min_dist) continue;
+      bool stop = descend1
+        ? distanceRecurse(tree1, c[k], tree2, i2, cdata, callback, min_dist)
+        : distanceRecurse(tree1, i1, tree2, c[k], cdata, callback, min_dist);
+      if(stop) return true;
+    }
+    return false;
+  }
+
+  /// Self distance of the subtree rooted at i.
+  bool selfDistanceRecurse(const DynamicAABBTree& tree, std::size_t i,
+                           void* cdata, DistanceCallBack callback,
+                           FCL_REAL& min_dist)
+  {
+    const Node& node = tree.getNode(i);
+    if(node.isLeaf()) return false;
+
+    const std::size_t c0 = node.children[0], c1 = node.children[1];
+    if(selfDistanceRecurse(tree, c0, cdata, callback, min_dist)
+       || selfDistanceRecurse(tree, c1, cdata, callback, min_dist))
+      return true;
+
+    if(tree.getNode(c0).bv.distance(tree.getNode(c1).bv) >= min_dist)
+      return false;
+    return distanceRecurse(tree, c0, tree, c1, cdata, callback, min_dist);
+  }
+}
+
+DynamicAABBTreeCollisionManager::DynamicAABBTreeCollisionManager
+(FCL_REAL aabb_margin_) : aabb_margin(aabb_margin_),
+                          max_tree_nonbalanced_level(10),
+                          setup_(false)
+{
+}
+
+void DynamicAABBTreeCollisionManager::registerObjects
+(const std::vector<CollisionObject*>& other_objs)
+{
+  if(other_objs.empty()) return;
+
+  if(!empty())
+  {
+    BroadPhaseCollisionManager::registerObjects(other_objs);
+    return;
+  }
+
+  std::vector<AABB> bvs (other_objs.size());
+  std::vector<void*> data (other_objs.size());
+  for(std::size_t i = 0; i < other_objs.size(); ++i)
+  {
+    bvs[i] = fatAABB(other_objs[i]);
+    data[i] = other_objs[i];
+  }
+
+  std::vector<std::size_t> leaves;
+  dtree.build(bvs, data, leaves);
+  for(std::size_t i = 0; i < other_objs.size(); ++i)
+    table[other_objs[i]] = leaves[i];
+  setup_ = true;
+}
+
+void DynamicAABBTreeCollisionManager::registerObject(CollisionObject* obj)
+{
+  table[obj] = dtree.insert(fatAABB(obj), obj);
+  setup_ = false;
+}
+
+void DynamicAABBTreeCollisionManager::unregisterObject(CollisionObject* obj)
+{
+  ObjectLeafMap::iterator it = table.find(obj);
+  if(it == table.end()) return;
+  dtree.remove(it->second);
+  table.erase(it);
+}
+
+void DynamicAABBTreeCollisionManager::setup()
+{
+  if(setup_) return;
+  setup_ = true;
+
+  const std::size_t n = dtree.size();
+  if(n < 2) return;
+
+  const FCL_REAL balanced_height = std::ceil(std::log((FCL_REAL)n) / std::log(2.));
+  if(dtree.getHeight() - balanced_height < max_tree_nonbalanced_level)
+    return;
+
+  std::vector<CollisionObject*> objs;
+  getObjects(objs);
+  dtree.clear();
+  table.clear();
+  registerObjects(objs);
+}
+
+void DynamicAABBTreeCollisionManager::updateLeaf(CollisionObject* obj,
+                                                 std::size_t leaf)
+{
+  if(!dtree.getNode(leaf).bv.contain(obj->getAABB()))
+    dtree.update(leaf, fatAABB(obj));
+}
+
+void DynamicAABBTreeCollisionManager::update()
+{
+  for(ObjectLeafMap::const_iterator it = table.begin(); it != table.end(); ++it)
+    updateLeaf(it->first, it->second);
+  setup_ = false;
+  setup();
+}
+
+void DynamicAABBTreeCollisionManager::update(CollisionObject* updated_obj)
+{
+  ObjectLeafMap::const_iterator it = table.find(updated_obj);
+  if(it != table.end())
+    updateLeaf(it->first, it->second);
+}
+
+void DynamicAABBTreeCollisionManager::update
+(const std::vector<CollisionObject*>& updated_objs)
+{
+  for(std::size_t i = 0; i < updated_objs.size(); ++i)
+    update(updated_objs[i]);
+}
+
+void DynamicAABBTreeCollisionManager::clear()
+{
+  dtree.clear();
+  table.clear();
+  setup_ = false;
+}
+
+void DynamicAABBTreeCollisionManager::getObjects
+(std::vector<CollisionObject*>& objs) const
+{
+  objs.resize(table.size());
+  std::size_t i = 0;
+  for(ObjectLeafMap::const_iterator it = table.begin(); it != table.end(); ++it, ++i)
+    objs[i] = it->first;
+}
+
+void DynamicAABBTreeCollisionManager::collide
+(CollisionObject* obj, void* cdata, CollisionCallBack callback) const
+{
+  if(empty()) return;
+  collideRecurse(dtree, dtree.getRoot(), obj, cdata, callback);
+}
+
+void DynamicAABBTreeCollisionManager::distance
+(CollisionObject* obj, void* cdata, DistanceCallBack callback) const
+{
+  if(empty()) return;
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  distanceRecurse(dtree, dtree.getRoot(), obj, cdata, callback, min_dist);
+}
+
+void DynamicAABBTreeCollisionManager::collide
+(void* cdata, CollisionCallBack callback) const
+{
+  if(empty()) return;
+  selfCollideRecurse(dtree, dtree.getRoot(), cdata, callback);
+}
+
+void DynamicAABBTreeCollisionManager::distance
+(void* cdata, DistanceCallBack callback) const
+{
+  if(empty()) return;
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  selfDistanceRecurse(dtree, dtree.getRoot(), cdata, callback, min_dist);
+}
+
+void DynamicAABBTreeCollisionManager::collide
+(BroadPhaseCollisionManager* other_manager_, void* cdata,
+ CollisionCallBack callback) const
+{
+  const DynamicAABBTreeCollisionManager* other_manager =
+    dynamic_cast<const DynamicAABBTreeCollisionManager*>(other_manager_);
+  if(other_manager == NULL)
+  {
+    BroadPhaseCollisionManager::collide(other_manager_, cdata, callback);
+    return;
+  }
+
+  if(empty() || other_manager->empty()) return;
+  collideRecurse(dtree, dtree.getRoot(),
+                 other_manager->dtree, other_manager->dtree.getRoot(),
+                 cdata, callback);
+}
+
+void DynamicAABBTreeCollisionManager::distance
+(BroadPhaseCollisionManager* other_manager_, void* cdata,
+ DistanceCallBack callback) const
+{
+  const DynamicAABBTreeCollisionManager* other_manager =
+    dynamic_cast<const DynamicAABBTreeCollisionManager*>(other_manager_);
+  if(other_manager == NULL)
+  {
+    BroadPhaseCollisionManager::distance(other_manager_, cdata, callback);
+    return;
+  }
+
+  if(empty() || other_manager->empty()) return;
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  distanceRecurse(dtree, dtree.getRoot(),
+                  other_manager->dtree, other_manager->dtree.getRoot(),
+                  cdata, callback, min_dist);
+}
+
+}
+
+} // namespace hpp
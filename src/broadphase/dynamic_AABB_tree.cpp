@@ -0,0 +1,409 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <hpp/fcl/broadphase/dynamic_AABB_tree.h>
+
+#include <algorithm>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  /// Surface area of an AABB, used as insertion cost.
+  inline FCL_REAL area(const AABB& bv)
+  {
+    const Vec3f d (bv.max_ - bv.min_);
+    return 2 * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+  }
+
+  struct SortByCenter
+  {
+    SortByCenter(const std::vector<DynamicAABBTree::Node>& nodes_, int axis_)
+      : nodes(nodes_), axis(axis_) {}
+
+    bool operator() (std::size_t a, std::size_t b) const
+    {
+      const AABB& ba = nodes[a].bv;
+      const AABB& bb = nodes[b].bv;
+      return ba.min_[axis] + ba.max_[axis] < bb.min_[axis] + bb.max_[axis];
+    }
+
+    const std::vector<DynamicAABBTree::Node>& nodes;
+    int axis;
+  };
+}
+
+const std::size_t DynamicAABBTree::NULL_NODE;
+
+DynamicAABBTree::DynamicAABBTree() : root(NULL_NODE),
+                                     free_list(NULL_NODE),
+                                     n_leaves(0)
+{
+}
+
+std::size_t DynamicAABBTree::allocateNode()
+{
+  std::size_t i;
+  if(free_list != NULL_NODE)
+  {
+    i = free_list;
+    free_list = nodes[i].parent;
+  }
+  else
+  {
+    i = nodes.size();
+    nodes.push_back(Node());
+  }
+  Node& node = nodes[i];
+  node.parent = NULL_NODE;
+  node.children[0] = node.children[1] = NULL_NODE;
+  node.data = NULL;
+  node.height = 0;
+  return i;
+}
+
+void DynamicAABBTree::freeNode(std::size_t i)
+{
+  nodes[i].parent = free_list;
+  nodes[i].height = -1;
+  free_list = i;
+}
+
+std::size_t DynamicAABBTree::insert(const AABB& bv, void* data)
+{
+  std::size_t leaf = allocateNode();
+  nodes[leaf].bv = bv;
+  nodes[leaf].data = data;
+  insertLeaf(leaf);
+  ++n_leaves;
+  return leaf;
+}
+
+void DynamicAABBTree::remove(std::size_t leaf)
+{
+  assert(leaf < nodes.size() && nodes[leaf].isLeaf());
+  removeLeaf(leaf);
+  freeNode(leaf);
+  --n_leaves;
+}
+
+void DynamicAABBTree::update(std::size_t leaf, const AABB& bv)
+{
+  assert(leaf < nodes.size() && nodes[leaf].isLeaf());
+  removeLeaf(leaf);
+  nodes[leaf].bv = bv;
+  insertLeaf(leaf);
+}
+
+void DynamicAABBTree::clear()
+{
+  nodes.clear();
+  root = NULL_NODE;
+  free_list = NULL_NODE;
+  n_leaves = 0;
+}
+
+void DynamicAABBTree::insertLeaf(std::size_t leaf)
+{
+  if(root == NULL_NODE)
+  {
+    root = leaf;
+    nodes[root].parent = NULL_NODE;
+    return;
+  }
+
+  // Find the best sibling, using the surface area heuristic.
+  const AABB leaf_bv (nodes[leaf].bv);
+  std::size_t index = root;
+  while(!nodes[index].isLeaf())
+  {
+    const Node& node = nodes[index];
+    FCL_REAL node_area = area(node.bv);
+    FCL_REAL combined_area = area(node.bv + leaf_bv);
+
+    // Cost of creating a new parent for this node and the new leaf
+    FCL_REAL cost = 2 * combined_area;
+    // Minimum cost of pushing the leaf further down the tree
+    FCL_REAL inheritance_cost = 2 * (combined_area - node_area);
+
+    FCL_REAL child_cost[2];
+    for(int i = 0; i < 2; ++i)
+    {
+      const Node& child = nodes[node.children[i]];
+      child_cost[i] = area(child.bv + leaf_bv) + inheritance_cost;
+      if(!child.isLeaf())
+        child_cost[i] -= area(child.bv);
+    }
+
+    if(cost < child_cost[0] && cost < child_cost[1])
+      break;
+
+    index = (child_cost[0] < child_cost[1]) ? node.children[0] : node.children[1];
+  }
+
+  // Create a new parent for the sibling and the leaf.
+  const std::size_t sibling = index;
+  const std::size_t old_parent = nodes[sibling].parent;
+  const std::size_t new_parent = allocateNode();
+  Node& parent = nodes[new_parent];
+  parent.parent = old_parent;
+  parent.bv = leaf_bv + nodes[sibling].bv;
+  parent.height = nodes[sibling].height + 1;
+  parent.children[0] = sibling;
+  parent.children[1] = leaf;
+  nodes[sibling].parent = new_parent;
+  nodes[leaf].parent = new_parent;
+
+  if(old_parent != NULL_NODE)
+  {
+    Node& op = nodes[old_parent];
+    if(op.children[0] == sibling) op.children[0] = new_parent;
+    else                          op.children[1] = new_parent;
+  }
+  else
+    root = new_parent;
+
+  refitAndBalance(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::removeLeaf(std::size_t leaf)
+{
+  if(leaf == root)
+  {
+    root = NULL_NODE;
+    return;
+  }
+
+  const std::size_t parent = nodes[leaf].parent;
+  const std::size_t grand_parent = nodes[parent].parent;
+  const std::size_t sibling = (nodes[parent].children[0] == leaf) ?
+    nodes[parent].children[1] : nodes[parent].children[0];
+
+  freeNode(parent);
+  nodes[sibling].parent = grand_parent;
+  if(grand_parent != NULL_NODE)
+  {
+    Node& gp = nodes[grand_parent];
+    if(gp.children[0] == parent) gp.children[0] = sibling;
+    else                         gp.children[1] = sibling;
+    refitAndBalance(grand_parent);
+  }
+  else
+    root = sibling;
+}
+
+void DynamicAABBTree::refitAndBalance(std::size_t i)
+{
+  while(i != NULL_NODE)
+  {
+    i = balance(i);
+
+    Node& node = nodes[i];
+    const Node& c0 = nodes[node.children[0]];
+    const Node& c1 = nodes[node.children[1]];
+    node.height = 1 + std::max(c0.height, c1.height);
+    node.bv = c0.bv + c1.bv;
+
+    i = node.parent;
+  }
+}
+
+std::size_t DynamicAABBTree::balance(std::size_t iA)
+{
+  Node& A = nodes[iA];
+  if(A.isLeaf() || A.height < 2)
+    return iA;
+
+  const std::size_t iB = A.children[0];
+  const std::size_t iC = A.children[1];
+  Node& B = nodes[iB];
+  Node& C = nodes[iC];
+
+  const int imbalance = C.height - B.height;
+
+  // Rotate C up
+  if(imbalance > 1)
+  {
+    const std::size_t iF = C.children[0];
+    const std::size_t iG = C.children[1];
+    Node& F = nodes[iF];
+    Node& G = nodes[iG];
+
+    // Swap A and C
+    C.children[0] = iA;
+    C.parent = A.parent;
+    A.parent = iC;
+
+    if(C.parent != NULL_NODE)
+    {
+      Node& P = nodes[C.parent];
+      if(P.children[0] == iA) P.children[0] = iC;
+      else                    P.children[1] = iC;
+    }
+    else
+      root = iC;
+
+    if(F.height > G.height)
+    {
+      C.children[1] = iF;
+      A.children[1] = iG;
+      G.parent = iA;
+      A.bv = B.bv + G.bv;
+      C.bv = A.bv + F.bv;
+      A.height = 1 + std::max(B.height, G.height);
+      C.height = 1 + std::max(A.height, F.height);
+    }
+    else
+    {
+      C.children[1] = iG;
+      A.children[1] = iF;
+      F.parent = iA;
+      A.bv = B.bv + F.bv;
+      C.bv = A.bv + G.bv;
+      A.height = 1 + std::max(B.height, F.height);
+      C.height = 1 + std::max(A.height, G.height);
+    }
+    return iC;
+  }
+
+  // Rotate B up
+  if(imbalance < -1)
+  {
+    const std::size_t iD = B.children[0];
+    const std::size_t iE = B.children[1];
+    Node& D = nodes[iD];
+    Node& E = nodes[iE];
+
+    // Swap A and B
+    B.children[0] = iA;
+    B.parent = A.parent;
+    A.parent = iB;
+
+    if(B.parent != NULL_NODE)
+    {
+      Node& P = nodes[B.parent];
+      if(P.children[0] == iA) P.children[0] = iB;
+      else                    P.children[1] = iB;
+    }
+    else
+      root = iB;
+
+    if(D.height > E.height)
+    {
+      B.children[1] = iD;
+      A.children[0] = iE;
+      E.parent = iA;
+      A.bv = C.bv + E.bv;
+      B.bv = A.bv + D.bv;
+      A.height = 1 + std::max(C.height, E.height);
+      B.height = 1 + std::max(A.height, D.height);
+    }
+    else
+    {
+      B.children[1] = iE;
+      A.children[0] = iD;
+      D.parent = iA;
+      A.bv = C.bv + D.bv;
+      B.bv = A.bv + E.bv;
+      A.height = 1 + std::max(C.height, D.height);
+      B.height = 1 + std::max(A.height, E.height);
+    }
+    return iB;
+  }
+
+  return iA;
+}
+
+void DynamicAABBTree::build(const std::vector<AABB>& bvs,
+                            const std::vector<void*>& data,
+                            std::vector<std::size_t>& leaves)
+{
+  assert(bvs.size() == data.size());
+  clear();
+  const std::size_t n = bvs.size();
+  leaves.resize(n);
+  if(n == 0) return;
+
+  // A binary tree with n leaves has 2n-1 nodes.
+  nodes.reserve(2 * n - 1);
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    leaves[i] = allocateNode();
+    nodes[leaves[i]].bv = bvs[i];
+    nodes[leaves[i]].data = data[i];
+  }
+  n_leaves = n;
+
+  std::vector<std::size_t> order (leaves);
+  root = buildRecurse(&order[0], n);
+  nodes[root].parent = NULL_NODE;
+}
+
+std::size_t DynamicAABBTree::buildRecurse(std::size_t* leaves, std::size_t n)
+{
+  if(n == 1)
+    return leaves[0];
+
+  AABB centers;
+  for(std::size_t i = 0; i < n; ++i)
+    centers += nodes[leaves[i]].bv.center();
+
+  const Vec3f extent (centers.max_ - centers.min_);
+  int axis = 0;
+  if(extent[1] > extent[axis]) axis = 1;
+  if(extent[2] > extent[axis]) axis = 2;
+
+  const std::size_t half = n / 2;
+  std::nth_element(leaves, leaves + half, leaves + n, SortByCenter(nodes, axis));
+
+  const std::size_t c0 = buildRecurse(leaves, half);
+  const std::size_t c1 = buildRecurse(leaves + half, n - half);
+
+  const std::size_t i = allocateNode();
+  Node& node = nodes[i];
+  node.children[0] = c0;
+  node.children[1] = c1;
+  node.bv = nodes[c0].bv + nodes[c1].bv;
+  node.height = 1 + std::max(nodes[c0].height, nodes[c1].height);
+  nodes[c0].parent = i;
+  nodes[c1].parent = i;
+  return i;
+}
+
+}
+
+} // namespace hpp
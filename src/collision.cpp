@@ -126,6 +126,67 @@ std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
   return res;
 }
 
+ComputeCollision::ComputeCollision(const CollisionGeometry* o1_,
+                                   const CollisionGeometry* o2_) :
+  o1 (o1_), o2 (o2_)
+{
+  const CollisionFunctionMatrix& looktable = getCollisionFunctionLookTable();
+
+  OBJECT_TYPE object_type1 = o1->getObjectType();
+  OBJECT_TYPE object_type2 = o2->getObjectType();
+  NODE_TYPE node_type1 = o1->getNodeType();
+  NODE_TYPE node_type2 = o2->getNodeType();
+
+  swap_geoms = (object_type1 == OT_GEOM && object_type2 == OT_BVH);
+  if(swap_geoms)
+    func = looktable.collision_matrix[node_type2][node_type1];
+  else
+    func = looktable.collision_matrix[node_type1][node_type2];
+
+  if(!func)
+    std::cerr << "Warning: collision function between node type " << node_type1 << " and node type " << node_type2 << " is not supported"<< std::endl;
+}
+
+std::size_t ComputeCollision::operator()(const Transform3f& tf1,
+                                         const Transform3f& tf2,
+                                         const CollisionRequest& request,
+                                         CollisionResult& result) const
+{
+  result.distance_lower_bound = -1;
+  if(request.num_max_contacts == 0)
+  {
+    std::cerr << "Warning: should stop early as num_max_contact is " << request.num_max_contacts << " !" << std::endl;
+    return 0;
+  }
+  if(!func) return 0;
+
+  std::size_t res;
+  if(swap_geoms)
+  {
+    res = func(o2, tf2, o1, tf1, &solver, request, result);
+    invertResults(result);
+  }
+  else
+    res = func(o1, tf1, o2, tf2, &solver, request, result);
+  return res;
+}
+
+std::size_t ComputeCollision::operator()(const Transform3f* tf1,
+                                         const Transform3f* tf2,
+                                         std::size_t n,
+                                         const CollisionRequest& request,
+                                         CollisionResult* results,
+                                         bool stop_at_first_collision) const
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    results[i].clear();
+    std::size_t res = (*this)(tf1[i], tf2[i], request, results[i]);
+    if(stop_at_first_collision && res > 0) return i + 1;
+  }
+  return n;
+}
+
 std::size_t collide(const CollisionObject* o1, const CollisionObject* o2,
                     const GJKSolver* nsolver,
                     const CollisionRequest& request,
@@ -49,7 +49,8 @@ bool CollisionRequest::isSatisfied(const CollisionResult& result) const
 
 bool DistanceRequest::isSatisfied(const DistanceResult& result) const
 {
-  return (result.min_distance <= 0);
+  return (result.min_distance <= 0)
+    || (result.min_distance < distance_threshold);
 }
 
   CollisionRequest::CollisionRequest
@@ -62,7 +63,9 @@ bool DistanceRequest::isSatisfied(const DistanceResult& result) const
     enable_distance_lower_bound (enable_distance_lower_bound_),
     gjk_solver_type(gjk_solver_type_),
     security_margin (0),
-    break_distance (1e-3)
+    break_distance (1e-3),
+    num_threads (1),
+    octree_max_depth (0)
   {
     enable_cached_gjk_guess = false;
     cached_gjk_guess = Vec3f(1, 0, 0);
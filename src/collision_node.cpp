@@ -49,7 +49,7 @@ void collide(CollisionTraversalNodeBase* node,
 	     BVHFrontList* front_list,
              bool recursive)
 {
-  if(front_list && front_list->size() > 0)
+  if(front_list && !front_list->empty())
   {
     propagateBVHFrontListCollisionRecurse(node, request, result, front_list);
   }
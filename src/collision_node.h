@@ -43,6 +43,11 @@
 #include <hpp/fcl/BVH/BVH_front.h>
 #include <hpp/fcl/internal/traversal_node_base.h>
 #include <hpp/fcl/internal/traversal_node_bvhs.h>
+#include <hpp/fcl/internal/traversal_wide.h>
+#include <hpp/fcl/internal/traversal_quantized.h>
+#include <hpp/fcl/internal/traversal_static.h>
+#include <hpp/fcl/internal/traversal_parallel.h>
+#include <hpp/fcl/internal/traversal_ordered.h>
 
 /// @brief collision and distance function on traversal nodes. these functions provide a higher level abstraction for collision functions provided in collision_func_matrix
 namespace hpp
@@ -62,8 +67,71 @@ void collide(CollisionTraversalNodeBase* node, const CollisionRequest& request,
              CollisionResult& result, BVHFrontList* front_list = NULL,
              bool recursive = true);
 
+/// collision on traversal node between two meshes. When no front list is
+/// given and recursive is true, the traversal is shared by
+/// request.num_threads threads if it is not 1. Otherwise, the 4-ary
+/// hierarchies are traversed if both models have the wide layout, the
+/// quantized ones if both models have the quantized layout, and the binary
+/// ones by collisionStatic otherwise.
+template<typename BV, int Options>
+void collide(MeshCollisionTraversalNode<BV, Options>* node,
+             const CollisionRequest& request, CollisionResult& result,
+             BVHFrontList* front_list = NULL, bool recursive = true)
+{
+  if(!front_list && recursive)
+  {
+    FCL_REAL sqrDistLowerBound;
+    if(request.num_threads != 1)
+      collisionParallel(node, request.num_threads, sqrDistLowerBound);
+    else if(node->model1->getWideNodes() && node->model2->getWideNodes())
+      collisionWide(node, sqrDistLowerBound);
+    else if(!collisionQuantized(node, sqrDistLowerBound))
+      collisionStatic(node, 0, 0, sqrDistLowerBound);
+    result.distance_lower_bound = sqrt (sqrDistLowerBound);
+    return;
+  }
+  collide(static_cast<CollisionTraversalNodeBase*>(node), request, result,
+          front_list, recursive);
+}
+
+/// collision on traversal node between a mesh and a shape. When no front
+/// list is given and recursive is true, the 4-ary hierarchy is traversed if
+/// the mesh has the wide layout, the quantized one if it has the quantized
+/// layout, and the binary one by collisionStatic otherwise.
+template<typename BV, typename S, int Options>
+void collide(MeshShapeCollisionTraversalNode<BV, S, Options>* node,
+             const CollisionRequest& request, CollisionResult& result,
+             BVHFrontList* front_list = NULL, bool recursive = true)
+{
+  if(!front_list && recursive)
+  {
+    FCL_REAL sqrDistLowerBound;
+    if(node->model1->getWideNodes())
+      collisionWide(node, sqrDistLowerBound);
+    else if(!collisionQuantized(node, sqrDistLowerBound))
+      collisionStatic(node, 0, 0, sqrDistLowerBound);
+    result.distance_lower_bound = sqrt (sqrDistLowerBound);
+    return;
+  }
+  collide(static_cast<CollisionTraversalNodeBase*>(node), request, result,
+          front_list, recursive);
+}
+
 /// @brief distance computation on distance traversal node; can use front list to accelerate
 void distance(DistanceTraversalNodeBase* node, BVHFrontList* front_list = NULL, int qsize = 2);
+
+/// distance computation on a distance traversal node with a hierarchy,
+/// visiting the pairs of nodes closest first with distanceOrdered and the
+/// heap of the calling thread. Node must be the type of the traversal node,
+/// not one of its bases.
+template<typename Node>
+void distanceOrdered(Node* node)
+{
+  node->preprocess();
+  distanceOrdered(static_cast<const Node*>(node), 0, 0,
+                  details::threadDistanceHeap());
+  node->postprocess();
+}
 }
 
 } // namespace hpp
@@ -0,0 +1,217 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/continuous_collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/narrowphase/narrowphase.h>
+
+#include <iostream>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  /// @brief Radius of a ball centered at the origin of the object frame
+  /// and containing the object, infinite for unbounded objects.
+  FCL_REAL boundingRadius(const CollisionGeometry* o)
+  {
+    FCL_REAL r = 0;
+    switch(o->getNodeType())
+    {
+    case GEOM_BOX:
+      return static_cast<const Box*>(o)->halfSide.norm();
+    case GEOM_SPHERE:
+      return static_cast<const Sphere*>(o)->radius;
+    case GEOM_CAPSULE:
+      {
+        const Capsule* c = static_cast<const Capsule*>(o);
+        return c->halfLength + c->radius;
+      }
+    case GEOM_CONE:
+      {
+        const Cone* c = static_cast<const Cone*>(o);
+        return Vec3f(c->radius, 0, c->halfLength).norm();
+      }
+    case GEOM_CYLINDER:
+      {
+        const Cylinder* c = static_cast<const Cylinder*>(o);
+        return Vec3f(c->radius, 0, c->halfLength).norm();
+      }
+    case GEOM_CONVEX:
+      {
+        const ConvexBase* c = static_cast<const ConvexBase*>(o);
+        for(int i = 0; i < c->num_points; ++i)
+          r = std::max(r, c->points[i].norm());
+        return r;
+      }
+    case GEOM_TRIANGLE:
+      {
+        const TriangleP* t = static_cast<const TriangleP*>(o);
+        return std::max(t->a.norm(), std::max(t->b.norm(), t->c.norm()));
+      }
+    default:
+      break;
+    }
+
+    if(o->getObjectType() == OT_BVH)
+    {
+      const BVHModelBase* model = static_cast<const BVHModelBase*>(o);
+      for(int i = 0; i < model->num_vertices; ++i)
+        r = std::max(r, model->vertices[i].norm());
+      return r;
+    }
+    return std::numeric_limits<FCL_REAL>::infinity();
+  }
+
+  /// @brief Motion of an object between two poses, with a constant linear
+  /// velocity of its origin and a constant angular velocity.
+  struct InterpolatedMotion
+  {
+    InterpolatedMotion(const Transform3f& tf_beg, const Transform3f& tf_end) :
+      q_beg(tf_beg.getQuatRotation()), q_end(tf_end.getQuatRotation()),
+      T_beg(tf_beg.getTranslation()), T_end(tf_end.getTranslation()),
+      angular_speed(q_beg.angularDistance(q_end))
+    {
+    }
+
+    Transform3f at(FCL_REAL t) const
+    {
+      return Transform3f(q_beg.slerp(t, q_end), T_beg + t * (T_end - T_beg));
+    }
+
+    /// @brief Upper bound of the speed of the points of an object whose
+    /// bounding radius is r.
+    FCL_REAL speedBound(FCL_REAL r) const
+    {
+      // An unbounded object which does not rotate keeps a finite speed.
+      if(angular_speed == 0) return 0;
+      return angular_speed * r;
+    }
+
+    Quaternion3f q_beg, q_end;
+    Vec3f T_beg, T_end;
+    FCL_REAL angular_speed;
+  };
+}
+
+FCL_REAL continuousCollide(const CollisionGeometry* o1, const Transform3f& tf1_beg, const Transform3f& tf1_end,
+                           const CollisionGeometry* o2, const Transform3f& tf2_beg, const Transform3f& tf2_end,
+                           const ContinuousCollisionRequest& request,
+                           ContinuousCollisionResult& result)
+{
+  result = ContinuousCollisionResult();
+  if(request.gjk_solver_type != GST_INDEP)
+    return -1; // error
+
+  const InterpolatedMotion motion1(tf1_beg, tf1_end);
+  const InterpolatedMotion motion2(tf2_beg, tf2_end);
+
+  // Upper bound of the relative speed of any pair of points of the objects.
+  // The distance cannot decrease faster, so advancing by distance / speed
+  // never steps over a contact.
+  const FCL_REAL speed = (motion2.T_end - motion2.T_beg - motion1.T_end + motion1.T_beg).norm()
+    + motion1.speedBound(boundingRadius(o1))
+    + motion2.speedBound(boundingRadius(o2));
+  if(speed == std::numeric_limits<FCL_REAL>::infinity())
+    std::cerr << "Warning: continuous collision of a rotating unbounded object "
+      "is not supported, the objects are reported in contact at the start of the motion" << std::endl;
+
+  GJKSolver solver;
+  DistanceRequest distance_request(true);
+  Vec3f normal(Vec3f::Zero());
+
+  FCL_REAL t = 0;
+  for(; result.num_iterations < request.num_max_iterations; ++result.num_iterations)
+  {
+    const Transform3f tf1(motion1.at(t)), tf2(motion2.at(t));
+    DistanceResult distance_result;
+    const FCL_REAL d = distance(o1, tf1, o2, tf2, &solver, distance_request, distance_result);
+
+    const Vec3f& p1 = distance_result.nearest_points[0];
+    const Vec3f& p2 = distance_result.nearest_points[1];
+    if(d > 0 && (p2 - p1).squaredNorm() > 0)
+      normal = (p2 - p1).normalized();
+    else if(d <= 0 && result.num_iterations == 0)
+      normal = distance_result.normal;
+
+    if(d <= request.toc_err || speed == std::numeric_limits<FCL_REAL>::infinity())
+    {
+      result.is_collide = true;
+      result.time_of_contact = t;
+      result.contact_tf1 = tf1;
+      result.contact_tf2 = tf2;
+      result.contact_point = (p1 + p2) / 2;
+      result.normal = normal;
+      return t;
+    }
+
+    if(speed == 0) break;
+    t += d / speed;
+    if(t >= 1) break;
+  }
+
+  // Either the motion ends before the contact, or the number of steps is
+  // exhausted. In the latter case, the objects are free until time t only
+  // and the contact is not proven: report the motion as free up to t.
+  if(t < 1 && result.num_iterations == request.num_max_iterations)
+  {
+    result.time_of_contact = t;
+    result.contact_tf1 = motion1.at(t);
+    result.contact_tf2 = motion2.at(t);
+    return t;
+  }
+  result.contact_tf1 = tf1_end;
+  result.contact_tf2 = tf2_end;
+  return 1;
+}
+
+FCL_REAL continuousCollide(const CollisionObject* o1, const Transform3f& tf1_end,
+                           const CollisionObject* o2, const Transform3f& tf2_end,
+                           const ContinuousCollisionRequest& request,
+                           ContinuousCollisionResult& result)
+{
+  return continuousCollide(o1->collisionGeometry().get(), o1->getTransform(), tf1_end,
+                           o2->collisionGeometry().get(), o2->getTransform(), tf2_end,
+                           request, result);
+}
+
+}
+
+} // namespace hpp
@@ -60,6 +60,10 @@ FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
   const GJKSolver* nsolver = nsolver_;
   if(!nsolver_) 
     nsolver = new GJKSolver();
+  // GJK stops once it proves the shapes are farther than the threshold.
+  const FCL_REAL distance_early_break = nsolver->getDistanceEarlyBreak();
+  if(request.distance_threshold > 0)
+    nsolver->setDistanceEarlyBreak(request.distance_threshold);
 
   const DistanceFunctionMatrix& looktable = getDistanceFunctionLookTable();
 
@@ -102,6 +106,8 @@ FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
     }
   }
 
+  if(request.distance_threshold > 0)
+    nsolver->setDistanceEarlyBreak(distance_early_break);
   if(!nsolver_)
     delete nsolver;
 
@@ -0,0 +1,650 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <hpp/fcl/distance_field.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/internal/octree_voxel.h>
+#ifdef HPP_FCL_HAVE_OCTOMAP
+#include <hpp/fcl/octree.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  const int block_size = 8;
+
+  int floorDiv(int i, int n)
+  {
+    return i >= 0 ? i / n : - ((- i + n - 1) / n);
+  }
+
+  /// Number of voxels of the margin around the obstacles in which the
+  /// distances are computed.
+  int marginVoxels(FCL_REAL max_distance, FCL_REAL voxel_size)
+  {
+    return (int)std::ceil(max_distance / voxel_size) + 1;
+  }
+}
+
+DistanceField::DistanceField(FCL_REAL voxel_size_, FCL_REAL max_distance_,
+                             bool is_signed_) :
+  voxel_size(voxel_size_), max_distance(max_distance_), is_signed(is_signed_),
+  source(NULL)
+{
+}
+
+const DistanceField::Voxel* DistanceField::findVoxel(const Index& index) const
+{
+  Index block_index = {{ floorDiv(index[0], block_size),
+                         floorDiv(index[1], block_size),
+                         floorDiv(index[2], block_size) }};
+  BlockMap::const_iterator it = block_map.find(block_index);
+  if(it == block_map.end()) return NULL;
+  int local = (index[0] - block_size * block_index[0])
+    + block_size * ((index[1] - block_size * block_index[1])
+                    + block_size * (index[2] - block_size * block_index[2]));
+  return &blocks[it->second].voxels[local];
+}
+
+DistanceField::Voxel* DistanceField::findVoxel(const Index& index)
+{
+  return const_cast<Voxel*>
+    (static_cast<const DistanceField*>(this)->findVoxel(index));
+}
+
+DistanceField::Block& DistanceField::allocateBlock(const Index& block_index)
+{
+  BlockMap::const_iterator it = block_map.find(block_index);
+  if(it != block_map.end()) return blocks[it->second];
+
+  int id = (int)blocks.size();
+  block_map[block_index] = id;
+  blocks.push_back(Block());
+  Block& block = blocks.back();
+  block.index = block_index;
+  for(int n = 0; n < 27; ++n)
+  {
+    Index neighbor = {{ block_index[0] + n % 3 - 1,
+                        block_index[1] + (n / 3) % 3 - 1,
+                        block_index[2] + n / 9 - 1 }};
+    BlockMap::const_iterator it = block_map.find(neighbor);
+    if(it == block_map.end())
+    {
+      block.neighbors[n] = -1;
+      continue;
+    }
+    block.neighbors[n] = (int)it->second;
+    blocks[it->second].neighbors[26 - n] = id;
+  }
+  for(int i = 0; i < block_size * block_size * block_size; ++i)
+    resetVoxel(block.voxels[i], false);
+  return block;
+}
+
+bool DistanceField::neighborVoxel(int block, int x, int y, int z,
+                                  int& neighbor_block, int& local) const
+{
+  int n = (x < 0 ? 0 : (x < block_size ? 1 : 2))
+    + 3 * (y < 0 ? 0 : (y < block_size ? 1 : 2))
+    + 9 * (z < 0 ? 0 : (z < block_size ? 1 : 2));
+  neighbor_block = blocks[block].neighbors[n];
+  if(neighbor_block < 0) return false;
+  local = (x & (block_size - 1))
+    + block_size * ((y & (block_size - 1))
+                    + block_size * (z & (block_size - 1)));
+  return true;
+}
+
+void DistanceField::allocateAround(const std::vector<Index>& obstacles)
+{
+  std::vector<Index> obstacle_blocks;
+  obstacle_blocks.reserve(obstacles.size());
+  for(std::size_t i = 0; i < obstacles.size(); ++i)
+  {
+    Index b = {{ floorDiv(obstacles[i][0], block_size),
+                 floorDiv(obstacles[i][1], block_size),
+                 floorDiv(obstacles[i][2], block_size) }};
+    obstacle_blocks.push_back(b);
+  }
+  std::sort(obstacle_blocks.begin(), obstacle_blocks.end());
+  obstacle_blocks.erase(std::unique(obstacle_blocks.begin(),
+                                    obstacle_blocks.end()),
+                        obstacle_blocks.end());
+
+  int r = floorDiv(marginVoxels(max_distance, voxel_size) + block_size - 1,
+                   block_size);
+  for(std::size_t i = 0; i < obstacle_blocks.size(); ++i)
+    for(int x = -r; x <= r; ++x)
+      for(int y = -r; y <= r; ++y)
+        for(int z = -r; z <= r; ++z)
+        {
+          Index b = {{ obstacle_blocks[i][0] + x, obstacle_blocks[i][1] + y,
+                       obstacle_blocks[i][2] + z }};
+          allocateBlock(b);
+        }
+}
+
+void DistanceField::resetVoxel(Voxel& voxel, bool obstacle) const
+{
+  voxel.obstacle = obstacle;
+  voxel.site_valid = false;
+  if(!obstacle) voxel.distance = (float)max_distance;
+  else voxel.distance = is_signed ? - (float)max_distance : 0.f;
+}
+
+int DistanceField::siteDistance(const Index& index, const Index& site)
+{
+  // Squared distance from the voxel center to the site cube, in half
+  // voxels, so that the propagation can order the voxels exactly.
+  int squared = 0;
+  for(int i = 0; i < 3; ++i)
+  {
+    int d = std::max(2 * std::abs(index[i] - site[i]) - 1, 0);
+    squared += d * d;
+  }
+  return squared;
+}
+
+DistanceField::Index DistanceField::voxelIndex(const Vec3f& p) const
+{
+  Index index = {{ (int)std::floor(p[0] / voxel_size),
+                   (int)std::floor(p[1] / voxel_size),
+                   (int)std::floor(p[2] / voxel_size) }};
+  return index;
+}
+
+void DistanceField::voxelize(const AABB& box, std::vector<Index>& voxels) const
+{
+  // Voxels whose cube overlaps the box, so that the obstacle voxels cover
+  // the obstacles.
+  const FCL_REAL eps = 1e-9;
+  Index lo, hi;
+  for(int i = 0; i < 3; ++i)
+  {
+    lo[i] = (int)std::floor(box.min_[i] / voxel_size + eps);
+    hi[i] = std::max(lo[i], (int)std::ceil(box.max_[i] / voxel_size - eps) - 1);
+  }
+  Index index;
+  for(index[0] = lo[0]; index[0] <= hi[0]; ++index[0])
+    for(index[1] = lo[1]; index[1] <= hi[1]; ++index[1])
+      for(index[2] = lo[2]; index[2] <= hi[2]; ++index[2])
+        voxels.push_back(index);
+}
+
+void DistanceField::propagate(const std::vector<Index>& active_blocks)
+{
+  // Voxels are located by their block in blocks and their local index, so
+  // that neighbors are found through Block::neighbors without hashing.
+  // Site distances are square roots of integers, the queue is a bucket
+  // queue indexed by the squared distance.
+  typedef std::pair<int, int> Location;
+  const int max_half_voxels = 2 * marginVoxels(max_distance, voxel_size);
+  const int max_squared = 3 * max_half_voxels * max_half_voxels;
+  std::vector<std::vector<Location> > queue(max_squared + 1);
+  std::vector<FCL_REAL> distances(max_squared + 1);
+  for(int i = 0; i <= max_squared; ++i)
+    distances[i] = 0.5 * voxel_size * std::sqrt((FCL_REAL)i);
+  int current = max_squared + 1;
+
+  // Seed the voxels next to a voxel of the other kind, and the voxels kept
+  // from a previous propagation. Only blocks with an obstacle around them
+  // can contain voxels of both kinds.
+  std::vector<signed char> has_obstacle(blocks.size(), -1);
+  std::vector<int> squared_distances(block_size * block_size * block_size);
+  for(std::size_t b = 0; b < active_blocks.size(); ++b)
+  {
+    int block = (int)block_map.find(active_blocks[b])->second;
+    bool near_obstacle = false;
+    for(int n = 0; n < 27 && !near_obstacle; ++n)
+    {
+      int nb = blocks[block].neighbors[n];
+      if(nb < 0) continue;
+      if(has_obstacle[nb] < 0)
+      {
+        has_obstacle[nb] = 0;
+        for(int i = 0; i < block_size * block_size * block_size; ++i)
+          if(blocks[nb].voxels[i].obstacle)
+          {
+            has_obstacle[nb] = 1;
+            break;
+          }
+      }
+      near_obstacle = has_obstacle[nb] != 0;
+    }
+
+    const Index& base = blocks[block].index;
+    int local = 0;
+    for(int z = 0; z < block_size; ++z)
+      for(int y = 0; y < block_size; ++y)
+        for(int x = 0; x < block_size; ++x, ++local)
+        {
+          Voxel& voxel = blocks[block].voxels[local];
+          if(voxel.obstacle && !is_signed) continue;
+          if(!voxel.site_valid && !near_obstacle) continue;
+          Index index = {{ block_size * base[0] + x, block_size * base[1] + y,
+                           block_size * base[2] + z }};
+          int best = voxel.site_valid ? siteDistance(index, voxel.site)
+            : max_squared + 1;
+          for(int dz = -1; dz <= 1 && near_obstacle; ++dz)
+            for(int dy = -1; dy <= 1; ++dy)
+              for(int dx = -1; dx <= 1; ++dx)
+              {
+                int nb, nl;
+                if(!neighborVoxel(block, x + dx, y + dy, z + dz, nb, nl)
+                   || blocks[nb].voxels[nl].obstacle == voxel.obstacle)
+                  continue;
+                Index n = {{ index[0] + dx, index[1] + dy, index[2] + dz }};
+                int squared = siteDistance(index, n);
+                if(squared < best)
+                {
+                  best = squared;
+                  voxel.distance = (float)(voxel.obstacle ? -distances[best]
+                                           : distances[best]);
+                  voxel.site = n;
+                  voxel.site_valid = true;
+                }
+              }
+          if(!voxel.site_valid) continue;
+          queue[best].push_back(Location(block, local));
+          current = std::min(current, best);
+        }
+  }
+
+  while(current <= max_squared)
+  {
+    int next = current + 1;
+    // Voxels may be pushed to the current bucket while it is processed.
+    for(std::size_t e = 0; e < queue[current].size(); ++e)
+    {
+      Location location = queue[current][e];
+      int block = location.first, local = location.second;
+      const Voxel& voxel = blocks[block].voxels[local];
+      float distance = (float)distances[current];
+      if(std::abs(voxel.distance) != distance) continue;
+
+      int x = local % block_size, y = (local / block_size) % block_size,
+        z = local / (block_size * block_size);
+      const Index& base = blocks[block].index;
+      for(int dz = -1; dz <= 1; ++dz)
+        for(int dy = -1; dy <= 1; ++dy)
+          for(int dx = -1; dx <= 1; ++dx)
+          {
+            int nb, nl;
+            if(!neighborVoxel(block, x + dx, y + dy, z + dz, nb, nl)) continue;
+            Voxel& neighbor = blocks[nb].voxels[nl];
+            if(neighbor.obstacle != voxel.obstacle) continue;
+            Index n = {{ block_size * base[0] + x + dx,
+                         block_size * base[1] + y + dy,
+                         block_size * base[2] + z + dz }};
+            int squared = siteDistance(n, voxel.site);
+            if(squared > max_squared || distances[squared] >= max_distance
+               || (float)distances[squared] >= std::abs(neighbor.distance))
+              continue;
+            // A neighbor may be closer to the site than this voxel.
+            if(squared < current) next = std::min(next, squared);
+            neighbor.distance = (float)(voxel.obstacle ? -distances[squared]
+                                        : distances[squared]);
+            neighbor.site = voxel.site;
+            neighbor.site_valid = true;
+            queue[squared].push_back(Location(nb, nl));
+          }
+    }
+    std::vector<Location>().swap(queue[current]);
+    current = next;
+  }
+}
+
+void DistanceField::build(const BVHModelBase& model)
+{
+  blocks.clear();
+  block_map.clear();
+  source = &model;
+
+  // Triangles lying on voxel faces must mark the voxels on both sides,
+  // rounding would otherwise leave holes in the obstacle shell.
+  const Vec3f tolerance(Vec3f::Constant(1e-6 * voxel_size));
+  std::vector<Index> obstacles, candidates;
+  Transform3f identity;
+  for(int t = 0; t < model.num_tris; ++t)
+  {
+    const Triangle& tri = model.tri_indices[t];
+    const Vec3f& p1 = model.vertices[tri[0]];
+    const Vec3f& p2 = model.vertices[tri[1]];
+    const Vec3f& p3 = model.vertices[tri[2]];
+    candidates.clear();
+    voxelize(AABB(p1, p2, p3).expand(tolerance), candidates);
+    for(std::size_t i = 0; i < candidates.size(); ++i)
+    {
+      const Index& c = candidates[i];
+      Vec3f lo(c[0] * voxel_size, c[1] * voxel_size, c[2] * voxel_size);
+      AABB cube(lo - tolerance,
+                lo + Vec3f::Constant(voxel_size) + tolerance);
+      if(details::voxelTriangleIntersect(details::Voxel(cube, identity),
+                                         p1, p2, p3))
+        obstacles.push_back(c);
+    }
+  }
+  std::sort(obstacles.begin(), obstacles.end());
+  obstacles.erase(std::unique(obstacles.begin(), obstacles.end()),
+                  obstacles.end());
+
+  allocateAround(obstacles);
+  for(std::size_t i = 0; i < obstacles.size(); ++i)
+    resetVoxel(*findVoxel(obstacles[i]), true);
+
+  std::vector<Index> active_blocks;
+  active_blocks.reserve(block_map.size());
+  for(BlockMap::const_iterator it = block_map.begin(); it != block_map.end();
+      ++it)
+    active_blocks.push_back(it->first);
+  propagate(active_blocks);
+}
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+namespace
+{
+  /// Occupied leaves of the snapshot overlapping a region, or all of them
+  /// if region is NULL.
+  void occupiedLeaves(const OcTreeSnapshot& snapshot, unsigned int id,
+                      const AABB& bv, const AABB* region,
+                      std::vector<AABB>& leaves)
+  {
+    if(region && !bv.overlap(*region)) return;
+    if(!snapshot.nodeHasChildren(id))
+    {
+      if(snapshot.isNodeOccupied(id)) leaves.push_back(bv);
+      return;
+    }
+    for(unsigned int i = 0; i < 8; ++i)
+    {
+      if(!snapshot.nodeChildExists(id, i)) continue;
+      AABB child_bv;
+      computeChildBV(bv, i, child_bv);
+      occupiedLeaves(snapshot, snapshot.getNodeChild(id, i), child_bv, region,
+                     leaves);
+    }
+  }
+}
+
+void DistanceField::build(const OcTree& tree)
+{
+  blocks.clear();
+  block_map.clear();
+  source = &tree;
+
+  const OcTreeSnapshot& snapshot = tree.getSnapshot();
+  if(snapshot.empty()) return;
+  std::vector<AABB> leaves;
+  occupiedLeaves(snapshot, snapshot.getRoot(), snapshot.getRootBV(), NULL,
+                 leaves);
+  std::vector<Index> obstacles;
+  for(std::size_t i = 0; i < leaves.size(); ++i)
+    voxelize(leaves[i], obstacles);
+  std::sort(obstacles.begin(), obstacles.end());
+  obstacles.erase(std::unique(obstacles.begin(), obstacles.end()),
+                  obstacles.end());
+
+  allocateAround(obstacles);
+  for(std::size_t i = 0; i < obstacles.size(); ++i)
+    resetVoxel(*findVoxel(obstacles[i]), true);
+
+  std::vector<Index> active_blocks;
+  active_blocks.reserve(block_map.size());
+  for(BlockMap::const_iterator it = block_map.begin(); it != block_map.end();
+      ++it)
+    active_blocks.push_back(it->first);
+  propagate(active_blocks);
+}
+
+void DistanceField::update(const OcTree& tree, const OcTreeChanges& changes)
+{
+  if(changes.empty()) return;
+  source = &tree;
+
+  // The voxels overlapping a changed subtree are recomputed. The subtrees
+  // need not be aligned on the voxels, so the region is the union of the
+  // voxels overlapping them, which may extend over unchanged leaves.
+  std::vector<AABB> changed;
+  std::vector<Index> changed_voxels;
+  for(std::size_t k = 0; k < changes.keys.size(); ++k)
+  {
+    std::vector<Index> voxels;
+    voxelize(tree.getNodeBV(changes.keys[k], changes.depth), voxels);
+    const Index& lo = voxels.front();
+    const Index& hi = voxels.back();
+    changed.push_back(AABB(voxel_size * Vec3f(lo[0], lo[1], lo[2]),
+                           voxel_size * Vec3f(hi[0] + 1, hi[1] + 1,
+                                              hi[2] + 1)));
+    changed_voxels.insert(changed_voxels.end(), voxels.begin(), voxels.end());
+  }
+  std::sort(changed_voxels.begin(), changed_voxels.end());
+  changed_voxels.erase(std::unique(changed_voxels.begin(),
+                                   changed_voxels.end()),
+                       changed_voxels.end());
+
+  // Obstacles in the changed region.
+  const OcTreeSnapshot& snapshot = tree.getSnapshot();
+  std::vector<Index> obstacles;
+  if(!snapshot.empty())
+  {
+    std::vector<AABB> leaves;
+    for(std::size_t k = 0; k < changed.size(); ++k)
+      occupiedLeaves(snapshot, snapshot.getRoot(), snapshot.getRootBV(),
+                     &changed[k], leaves);
+    std::vector<Index> voxels;
+    for(std::size_t i = 0; i < leaves.size(); ++i)
+      voxelize(leaves[i], voxels);
+    std::sort(voxels.begin(), voxels.end());
+    // The unchanged leaves overlapping the region may extend beyond it,
+    // where their voxels are left as they are.
+    std::set_intersection(voxels.begin(), voxels.end(),
+                          changed_voxels.begin(), changed_voxels.end(),
+                          std::back_inserter(obstacles));
+  }
+  allocateAround(obstacles);
+
+  // Blocks within max_distance of the changed region.
+  int margin = marginVoxels(max_distance, voxel_size);
+  std::vector<Index> active_blocks;
+  for(std::size_t k = 0; k < changed.size(); ++k)
+  {
+    Index lo, hi;
+    for(int i = 0; i < 3; ++i)
+    {
+      lo[i] = floorDiv((int)std::floor(changed[k].min_[i] / voxel_size) - margin,
+                       block_size);
+      hi[i] = floorDiv((int)std::ceil(changed[k].max_[i] / voxel_size) + margin,
+                       block_size);
+    }
+    Index b;
+    for(b[0] = lo[0]; b[0] <= hi[0]; ++b[0])
+      for(b[1] = lo[1]; b[1] <= hi[1]; ++b[1])
+        for(b[2] = lo[2]; b[2] <= hi[2]; ++b[2])
+          if(block_map.find(b) != block_map.end()) active_blocks.push_back(b);
+  }
+  std::sort(active_blocks.begin(), active_blocks.end());
+  active_blocks.erase(std::unique(active_blocks.begin(), active_blocks.end()),
+                      active_blocks.end());
+
+  // Reset the voxels in the changed region, and the voxels whose closest
+  // site was there.
+  for(std::size_t b = 0; b < active_blocks.size(); ++b)
+  {
+    Block& block = blocks[block_map.find(active_blocks[b])->second];
+    Index base = {{ block_size * active_blocks[b][0],
+                    block_size * active_blocks[b][1],
+                    block_size * active_blocks[b][2] }};
+    Index index;
+    int local = 0;
+    for(index[2] = base[2]; index[2] < base[2] + block_size; ++index[2])
+      for(index[1] = base[1]; index[1] < base[1] + block_size; ++index[1])
+        for(index[0] = base[0]; index[0] < base[0] + block_size;
+            ++index[0], ++local)
+        {
+          Voxel& voxel = block.voxels[local];
+          if(std::binary_search(changed_voxels.begin(), changed_voxels.end(),
+                                index))
+          {
+            resetVoxel(voxel, false);
+            continue;
+          }
+          if(voxel.site_valid
+             && std::binary_search(changed_voxels.begin(),
+                                   changed_voxels.end(), voxel.site))
+            resetVoxel(voxel, voxel.obstacle);
+        }
+  }
+  for(std::size_t i = 0; i < obstacles.size(); ++i)
+    resetVoxel(*findVoxel(obstacles[i]), true);
+
+  propagate(active_blocks);
+}
+#endif
+
+FCL_REAL DistanceField::distance(const Vec3f& p) const
+{
+  const Voxel* voxel = findVoxel(voxelIndex(p));
+  return voxel ? voxel->distance : max_distance;
+}
+
+bool DistanceField::distance(const Vec3f& p, FCL_REAL& d, Vec3f& gradient) const
+{
+  Vec3f q = p / voxel_size - Vec3f(0.5, 0.5, 0.5);
+  Index base = {{ (int)std::floor(q[0]), (int)std::floor(q[1]),
+                  (int)std::floor(q[2]) }};
+  Vec3f t(q[0] - base[0], q[1] - base[1], q[2] - base[2]);
+
+  FCL_REAL values[8];
+  bool known = true;
+  for(int i = 0; i < 8; ++i)
+  {
+    Index index = {{ base[0] + (i & 1), base[1] + ((i >> 1) & 1),
+                     base[2] + ((i >> 2) & 1) }};
+    const Voxel* voxel = findVoxel(index);
+    if(voxel) values[i] = voxel->distance;
+    else
+    {
+      values[i] = max_distance;
+      known = false;
+    }
+  }
+
+  d = 0;
+  gradient.setZero();
+  for(int i = 0; i < 8; ++i)
+  {
+    Vec3f w, dw;
+    for(int k = 0; k < 3; ++k)
+    {
+      bool upper = (i >> k) & 1;
+      w[k] = upper ? t[k] : 1 - t[k];
+      dw[k] = upper ? 1 : -1;
+    }
+    d += w[0] * w[1] * w[2] * values[i];
+    gradient[0] += dw[0] * w[1] * w[2] * values[i];
+    gradient[1] += w[0] * dw[1] * w[2] * values[i];
+    gradient[2] += w[0] * w[1] * dw[2] * values[i];
+  }
+  gradient /= voxel_size;
+  return known;
+}
+
+FCL_REAL DistanceField::distanceLowerBound(const Vec3f& p) const
+{
+  // p is within half a diagonal of the center of its voxel, and the
+  // propagation may miss the closest obstacle voxel by a fraction of voxel.
+  return distance(p) - (0.5 * std::sqrt(3.) + 1) * voxel_size;
+}
+
+FCL_REAL DistanceField::conservativeDistance(const Sphere& sphere,
+                                             const Transform3f& tf,
+                                             FCL_REAL security_margin,
+                                             bool* exact) const
+{
+  FCL_REAL lower_bound = distanceLowerBound(tf.getTranslation())
+    - sphere.radius;
+  if(lower_bound > security_margin || !source)
+  {
+    if(exact) *exact = false;
+    return lower_bound;
+  }
+  if(exact) *exact = true;
+  DistanceRequest request;
+  DistanceResult result;
+  return hpp::fcl::distance(source, Transform3f(), &sphere, tf, request,
+                            result);
+}
+
+FCL_REAL DistanceField::conservativeDistance(const Capsule& capsule,
+                                             const Transform3f& tf,
+                                             FCL_REAL security_margin,
+                                             bool* exact) const
+{
+  Vec3f a = tf.transform(Vec3f(0, 0, -capsule.halfLength));
+  Vec3f b = tf.transform(Vec3f(0, 0, capsule.halfLength));
+  FCL_REAL length = (b - a).norm();
+  int n = std::max(1, (int)std::ceil(length / voxel_size));
+  // Every point of the axis is within half a step of a sample.
+  FCL_REAL lower_bound = std::numeric_limits<FCL_REAL>::max();
+  for(int i = 0; i <= n; ++i)
+    lower_bound = std::min(lower_bound,
+                           distanceLowerBound(a + (b - a) * ((FCL_REAL)i / n)));
+  lower_bound -= 0.5 * length / n + capsule.radius;
+  if(lower_bound > security_margin || !source)
+  {
+    if(exact) *exact = false;
+    return lower_bound;
+  }
+  if(exact) *exact = true;
+  DistanceRequest request;
+  DistanceResult result;
+  return hpp::fcl::distance(source, Transform3f(), &capsule, tf, request,
+                            result);
+}
+
+}
+
+} // namespace hpp
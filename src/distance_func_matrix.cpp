@@ -95,7 +95,7 @@ struct BVHShapeDistancer
     const T_SH* obj2 = static_cast<const T_SH*>(o2);
 
     initialize(node, *obj1_tmp, tf1_tmp, *obj2, tf2, nsolver, request, result);
-    fcl::distance(&node);
+    distanceOrdered(&node);
     
     delete obj1_tmp;
     return result.min_distance;
@@ -115,7 +115,7 @@ FCL_REAL orientedBVHShapeDistance(const CollisionGeometry* o1, const Transform3f
   const T_SH* obj2 = static_cast<const T_SH*>(o2);
 
   initialize(node, *obj1, tf1, *obj2, tf2, nsolver, request, result);
-  fcl::distance(&node);
+  distanceOrdered(&node);
 
   return result.min_distance;  
 }
@@ -168,7 +168,7 @@ FCL_REAL BVHDistance(const CollisionGeometry* o1, const Transform3f& tf1, const
   Transform3f tf2_tmp = tf2;
 
   initialize(node, *obj1_tmp, tf1_tmp, *obj2_tmp, tf2_tmp, request, result);
-  distance(&node);
+  distanceOrdered(&node);
   delete obj1_tmp;
   delete obj2_tmp;
   
@@ -187,7 +187,7 @@ FCL_REAL orientedMeshDistance(const CollisionGeometry* o1, const Transform3f& tf
   const BVHModel<T_BVH>* obj2 = static_cast<const BVHModel<T_BVH>* >(o2);
 
   initialize(node, *obj1, tf1, *obj2, tf2, request, result);
-  distance(&node);
+  distanceOrdered(&node);
 
   return result.min_distance;
 }
@@ -463,6 +463,96 @@ FCL_REAL TriangleDistance::sqrTriDistance
   return sqrTriDistance (S1, S2, S3, T1_transformed, T2_transformed, T3_transformed, P, Q);
 }
 
+namespace
+{
+  /// Add to sum the points where the edges of triangle A cross triangle B,
+  /// of normal n, and return their number.
+  int addEdgeCrossings (const Vec3f A[3], const Vec3f B[3], const Vec3f& n,
+                        Vec3f& sum)
+  {
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+      const Vec3f& a = A[i];
+      const Vec3f& b = A[(i+1)%3];
+      FCL_REAL da = n.dot (a - B[0]), db = n.dot (b - B[0]);
+      if ((da > 0 && db > 0) || (da < 0 && db < 0) || da == db) continue;
+      Vec3f x (a + (da / (da - db)) * (b - a));
+      bool inside = true;
+      for (int j = 0; j < 3 && inside; ++j)
+        inside = (B[(j+1)%3] - B[j]).cross (x - B[j]).dot (n) >= 0;
+      if (inside) { sum += x; ++count; }
+    }
+    return count;
+  }
+}
+
+FCL_REAL TriangleDistance::signedTriDistance
+(const Vec3f S[3], const Vec3f T[3], Vec3f& P, Vec3f& Q, Vec3f& normal)
+{
+  FCL_REAL sqrDist = sqrTriDistance (S, T, P, Q);
+  if (sqrDist > 0) {
+    FCL_REAL dist = sqrt (sqrDist);
+    normal = (Q - P) / dist;
+    return dist;
+  }
+
+  // The triangles intersect. The penetration depth is the smallest overlap
+  // of the projections of the triangles on the candidate separating axes:
+  // the normals of the triangles and the cross products of their edges.
+  Vec3f axes[11];
+  axes[0] = (S[1] - S[0]).cross (S[2] - S[0]);
+  axes[1] = (T[1] - T[0]).cross (T[2] - T[0]);
+  int n = 2;
+  for (int i = 0; i < 3; ++i) {
+    const Vec3f Se (S[(i+1)%3] - S[i]);
+    for (int j = 0; j < 3; ++j)
+      axes[n++] = Se.cross (T[(j+1)%3] - T[j]);
+  }
+
+  const FCL_REAL eps (std::numeric_limits<FCL_REAL>::epsilon());
+  FCL_REAL depth = std::numeric_limits<FCL_REAL>::max();
+  normal.setZero ();
+  for (int k = 0; k < n; ++k) {
+    FCL_REAL sqrNorm = axes[k].squaredNorm ();
+    if (sqrNorm <= eps * eps) continue;
+    Vec3f a (axes[k] / sqrt (sqrNorm));
+
+    FCL_REAL sMin, sMax, tMin, tMax;
+    sMin = sMax = a.dot (S[0]);
+    tMin = tMax = a.dot (T[0]);
+    for (int i = 1; i < 3; ++i) {
+      FCL_REAL s = a.dot (S[i]), t = a.dot (T[i]);
+      if (s < sMin) sMin = s; else if (s > sMax) sMax = s;
+      if (t < tMin) tMin = t; else if (t > tMax) tMax = t;
+    }
+
+    // Translating T by (sMax - tMin) * a, or by (sMin - tMax) * a,
+    // separates the projections.
+    if (sMax - tMin < depth) { depth = sMax - tMin; normal =  a; }
+    if (tMax - sMin < depth) { depth = tMax - sMin; normal = -a; }
+  }
+  if (depth < 0) depth = 0;
+
+  // The middle of the segment where the triangles cross each other, or the
+  // deepest points of each triangle along the normal if the triangles are
+  // coplanar.
+  Vec3f sum (Vec3f::Zero ());
+  int count = addEdgeCrossings (S, T, axes[1], sum)
+    + addEdgeCrossings (T, S, axes[0], sum);
+  if (count > 0) {
+    P = Q = sum / (FCL_REAL)count;
+    return -depth;
+  }
+  int iS = 0, iT = 0;
+  for (int i = 1; i < 3; ++i) {
+    if (normal.dot (S[i]) > normal.dot (S[iS])) iS = i;
+    if (normal.dot (T[i]) < normal.dot (T[iT])) iT = i;
+  }
+  P = S[iS];
+  Q = T[iT];
+  return -depth;
+}
+
 
 
 
@@ -167,12 +167,15 @@ void getShapeSupport(const Cylinder* cylinder, const Vec3f& dir, Vec3f& support)
   assert (fabs (support [0] * dir [1] - support [1] * dir [0]) < eps);
 }
 
-void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support)
+void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support,
+    int& hint)
 {
   const Vec3f* pts = convex->points;
   const ConvexBase::Neighbors* nn = convex->neighbors;
 
-  int i = 0;
+  // The hint may come from another shape. Any vertex is a valid starting
+  // point of the hill-climbing, as long as it exists.
+  int i = (hint >= 0 && hint < convex->num_points) ? hint : 0;
   FCL_REAL maxdot = pts[i].dot(dir);
   FCL_REAL dot;
   bool found = true;
@@ -191,15 +194,37 @@ void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support)
   }
 
   support = pts[i];
+  hint = i;
+}
+
+void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support)
+{
+  int hint = 0;
+  getShapeSupport(convex, dir, support, hint);
+}
+
+/// Only ConvexBase makes use of the hint.
+template <typename Shape>
+inline void getShapeSupport(const Shape* shape, const Vec3f& dir, Vec3f& support,
+    int& /*hint*/)
+{
+  getShapeSupport(shape, dir, support);
 }
 
 #define CALL_GET_SHAPE_SUPPORT(ShapeType)                                      \
   getShapeSupport (static_cast<const ShapeType*>(shape),                       \
       (shape_traits<ShapeType>::NeedNormalizedDir && !dirIsNormalized)         \
       ? dir.normalized() : dir,                                                \
-      support)
+      support, hint)
 
 Vec3f getSupport(const ShapeBase* shape, const Vec3f& dir, bool dirIsNormalized)
+{
+  int hint = 0;
+  return getSupport(shape, dir, dirIsNormalized, hint);
+}
+
+Vec3f getSupport(const ShapeBase* shape, const Vec3f& dir, bool dirIsNormalized,
+    int& hint)
 {
   Vec3f support;
   switch(shape->getNodeType())
@@ -240,20 +265,22 @@ Vec3f getSupport(const ShapeBase* shape, const Vec3f& dir, bool dirIsNormalized)
 template <typename Shape0, typename Shape1, bool TransformIsIdentity>
 void getSupportTpl (const Shape0* s0, const Shape1* s1,
     const Matrix3f& oR1, const Vec3f& ot1,
-    const Vec3f& dir, Vec3f& support0, Vec3f& support1)
+    const Vec3f& dir, Vec3f& support0, Vec3f& support1,
+    support_func_guess_t& hint)
 {
-  getShapeSupport (s0, dir, support0);
+  getShapeSupport (s0, dir, support0, hint[0]);
   if (TransformIsIdentity)
-    getShapeSupport (s1, - dir, support1);
+    getShapeSupport (s1, - dir, support1, hint[1]);
   else {
-    getShapeSupport (s1, - oR1.transpose() * dir, support1);
+    getShapeSupport (s1, - oR1.transpose() * dir, support1, hint[1]);
     support1 = oR1 * support1 + ot1;
   }
 }
 
 template <typename Shape0, typename Shape1, bool TransformIsIdentity>
 void getSupportFuncTpl (const MinkowskiDiff& md,
-    const Vec3f& dir, bool dirIsNormalized, Vec3f& support0, Vec3f& support1)
+    const Vec3f& dir, bool dirIsNormalized, Vec3f& support0, Vec3f& support1,
+    support_func_guess_t& hint)
 {
   enum { NeedNormalizedDir =
     bool ( (bool)shape_traits<Shape0>::NeedNormalizedDir
@@ -272,7 +299,7 @@ void getSupportFuncTpl (const MinkowskiDiff& md,
       static_cast <const Shape1*>(md.shapes[1]),
       md.oR1, md.ot1,
       (NeedNormalizedDir && !dirIsNormalized) ? dir.normalized() : dir,
-      support0, support1);
+      support0, support1, hint);
 }
 
 template <typename Shape0>
@@ -367,6 +394,7 @@ void GJK::initialize()
   status = Failed;
   distance_upper_bound = std::numeric_limits<FCL_REAL>::max();
   simplex = NULL;
+  iterations = 0;
 }
 
 Vec3f GJK::getGuessFromSimplex() const
@@ -433,9 +461,6 @@ bool GJK::getClosestPoints (const Simplex& simplex, Vec3f& w0, Vec3f& w1)
 
 GJK::Status GJK::evaluate(const MinkowskiDiff& shape_, const Vec3f& guess)
 {
-  size_t iterations = 0;
-  FCL_REAL alpha = 0;
-
   free_v[0] = &store_v[0];
   free_v[1] = &store_v[1];
   free_v[2] = &store_v[2];
@@ -453,6 +478,90 @@ GJK::Status GJK::evaluate(const MinkowskiDiff& shape_, const Vec3f& guess)
   else                       appendVertex(simplices[0], Vec3f(1, 0, 0), true);
   ray = simplices[0].vertex[0]->w;
 
+  return iterate();
+}
+
+GJK::Status GJK::evaluate(const MinkowskiDiff& shape_, const SimplexV* seed,
+                          vertex_id_t rank)
+{
+  assert (rank >= 1 && rank <= 4);
+
+  free_v[0] = &store_v[0];
+  free_v[1] = &store_v[1];
+  free_v[2] = &store_v[2];
+  free_v[3] = &store_v[3];
+
+  nfree = 4;
+  current = 0;
+  status = Valid;
+  shape = &shape_;
+  distance = 0.0;
+
+  Simplex& s = simplices[0];
+  s.rank = 0;
+  for (vertex_id_t i = 0; i < rank; ++i) {
+    SimplexV* v = free_v[--nfree];
+    v->w0 = seed[i].w0;
+    v->w1 = seed[i].w1;
+    v->w.noalias() = v->w0 - v->w1;
+    s.vertex[s.rank++] = v;
+  }
+
+  // Project the origin onto the seed. The seed may be degenerated after the
+  // motion of the shapes: drop its last vertices until the projection
+  // succeeds.
+  Project::ProjectResult projection;
+  while (s.rank > 1) {
+    SimplexV* const* vs = s.vertex;
+    switch (s.rank) {
+      case 2:
+        projection = Project::projectLineOrigin (vs[0]->w, vs[1]->w);
+        break;
+      case 3:
+        projection = Project::projectTriangleOrigin (vs[0]->w, vs[1]->w,
+                                                     vs[2]->w);
+        break;
+      case 4:
+        projection = Project::projectTetrahedraOrigin (vs[0]->w, vs[1]->w,
+                                                       vs[2]->w, vs[3]->w);
+        break;
+    }
+    if (projection.sqr_distance >= 0) break;
+    removeVertex (s);
+  }
+
+  if (s.rank == 1) {
+    ray = s.vertex[0]->w;
+  } else {
+    // Keep only the vertices of the sub-simplex which supports the
+    // projection, in their original order.
+    Simplex& next = simplices[1];
+    next.rank = 0;
+    ray.setZero();
+    for (vertex_id_t i = 0; i < s.rank; ++i) {
+      if (projection.encode & (1 << i)) {
+        next.vertex[next.rank++] = s.vertex[i];
+        ray += projection.parameterization[i] * s.vertex[i]->w;
+      } else
+        free_v[nfree++] = s.vertex[i];
+    }
+    current = 1;
+
+    if (next.rank == 4) {
+      status = Inside;
+      simplex = &simplices[current];
+      return status;
+    }
+  }
+
+  return iterate();
+}
+
+GJK::Status GJK::iterate()
+{
+  FCL_REAL alpha = 0;
+  iterations = 0;
+
   do
   {
     vertex_id_t next = (vertex_id_t)(1 - current);
@@ -1046,12 +1155,37 @@ bool GJK::projectTetrahedraOrigin(const Simplex& current, Simplex& next)
 
 void EPA::initialize()
 {
-  sv_store = new SimplexV[max_vertex_num];
-  fc_store = new SimplexF[max_face_num];
   status = Failed;
   normal = Vec3f(0, 0, 0);
   depth = 0;
   nextsv = 0;
+}
+
+void EPA::reset(unsigned int max_face_num_, unsigned int max_vertex_num_,
+                unsigned int max_iterations_, FCL_REAL tolerance_)
+{
+  if (max_face_num_ != max_face_num || max_vertex_num_ != max_vertex_num)
+  {
+    // The storage is reallocated lazily, in evaluate.
+    delete [] sv_store;
+    delete [] fc_store;
+    sv_store = NULL;
+    fc_store = NULL;
+    hull = SimplexList();
+    stock = SimplexList();
+    max_face_num = max_face_num_;
+    max_vertex_num = max_vertex_num_;
+  }
+  max_iterations = max_iterations_;
+  tolerance = tolerance_;
+  initialize();
+}
+
+void EPA::allocate()
+{
+  if (fc_store != NULL) return;
+  sv_store = new SimplexV[max_vertex_num];
+  fc_store = new SimplexF[max_face_num];
   for(size_t i = 0; i < max_face_num; ++i)
     stock.append(&fc_store[max_face_num-i-1]);
 }
@@ -1148,6 +1282,7 @@ EPA::Status EPA::evaluate(GJK& gjk, const Vec3f& guess)
   GJK::Simplex& simplex = *gjk.getSimplex();
   if((simplex.rank > 1) && gjk.encloseOrigin())
   {
+    allocate();
     while(hull.root)
     {
       SimplexF* f = hull.root;
@@ -0,0 +1,120 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <hpp/fcl/narrowphase/gjk_cache.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+GJKCache::GJKCache(std::size_t max_size_) : max_size (max_size_)
+{
+  assert(max_size > 0);
+}
+
+const GJKCache::Entry* GJKCache::find(const Key& key)
+{
+  Map::iterator it = map.find(key);
+  if(it == map.end()) return NULL;
+  items.splice(items.begin(), items, it->second);
+  return &it->second->second;
+}
+
+GJKCache::Entry& GJKCache::insert(const Key& key)
+{
+  Map::iterator it = map.find(key);
+  if(it != map.end())
+  {
+    items.splice(items.begin(), items, it->second);
+    return it->second->second;
+  }
+
+  if(map.size() >= max_size)
+  {
+    map.erase(items.back().first);
+    items.pop_back();
+  }
+  items.push_front(Item(key, Entry()));
+  map.insert(Map::value_type(key, items.begin()));
+  return items.front().second;
+}
+
+void GJKCache::invalidate(const void* object)
+{
+  for(List::iterator it = items.begin(); it != items.end();)
+  {
+    if(it->first.o1 == object || it->first.o2 == object)
+    {
+      map.erase(it->first);
+      it = items.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+void GJKCache::invalidate(const Key& key)
+{
+  Map::iterator it = map.find(key);
+  if(it == map.end()) return;
+  items.erase(it->second);
+  map.erase(it);
+}
+
+void GJKCache::clear()
+{
+  items.clear();
+  map.clear();
+}
+
+void GJKCache::setMaxSize(std::size_t max_size_)
+{
+  assert(max_size_ > 0);
+  max_size = max_size_;
+  shrink();
+}
+
+void GJKCache::shrink()
+{
+  while(map.size() > max_size)
+  {
+    map.erase(items.back().first);
+    items.pop_back();
+  }
+}
+
+}
+
+} // namespace hpp
@@ -639,8 +639,10 @@ bool GJKSolver::shapeDistance<Capsule, Capsule>
     details::MinkowskiDiff shape;
     shape.set (&t1, &t2);
 
-    details::GJK gjk((unsigned int) gjk_max_iterations, gjk_tolerance);
-    details::GJK::Status gjk_status = gjk.evaluate(shape, -guess);
+    gjk.reset((unsigned int) gjk_max_iterations, gjk_tolerance);
+    gjk.setDistanceEarlyBreak(distance_upper_bound);
+    details::GJK::Status gjk_status = evaluateGJK(shape, -guess, Transform3f(),
+                                                  tf1, tf2);
     if(enable_cached_guess) cached_guess = gjk.getGuessFromSimplex();
 
     details::GJK::getClosestPoints (*gjk.getSimplex(), p1, p2);
@@ -672,6 +674,43 @@ bool GJKSolver::shapeDistance<Capsule, Capsule>
     assert (false && "should not reach this point");
     return false;
   }
+
+  details::GJK::Status GJKSolver::evaluateGJK
+  (const details::MinkowskiDiff& shape, const Vec3f& guess,
+   const Transform3f& tf0, const Transform3f& tf1, const Transform3f& tf2) const
+  {
+    if (gjk_cache == NULL || gjk_cache_key.o1 == NULL)
+      return gjk.evaluate(shape, guess);
+
+    // Poses of the geometries in the frame of the Minkowski difference.
+    const Transform3f oM1 (tf0.inverseTimes(tf1)), oM2 (tf0.inverseTimes(tf2));
+
+    details::GJK::Status status;
+    const GJKCache::Entry* cached = gjk_cache->find(gjk_cache_key);
+    if (cached != NULL && cached->rank > 0) {
+      details::GJK::SimplexV seed[4];
+      for (unsigned char i = 0; i < cached->rank; ++i) {
+        seed[i].w0 = oM1.transform(cached->w0[i]);
+        seed[i].w1 = oM2.transform(cached->w1[i]);
+      }
+      gjk.support_hint = cached->support_hint;
+      status = gjk.evaluate(shape, seed, cached->rank);
+    } else
+      status = gjk.evaluate(shape, guess);
+
+    const details::GJK::Simplex& simplex = *gjk.getSimplex();
+    GJKCache::Entry& entry = gjk_cache->insert(gjk_cache_key);
+    entry.rank = simplex.rank;
+    for (unsigned char i = 0; i < simplex.rank; ++i) {
+      entry.w0[i] = oM1.getRotation().transpose()
+        * (simplex.vertex[i]->w0 - oM1.getTranslation());
+      entry.w1[i] = oM2.getRotation().transpose()
+        * (simplex.vertex[i]->w1 - oM2.getTranslation());
+    }
+    entry.ray = oM1.getRotation().transpose() * gjk.ray;
+    entry.support_hint = gjk.support_hint;
+    return status;
+  }
 } // fcl
 
 } // namespace hpp
@@ -0,0 +1,231 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/internal/octree_voxel.h>
+#include <hpp/fcl/BV/OBB.h>
+
+#include <algorithm>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace details
+{
+
+bool voxelBoxIntersect(const Voxel& voxel, const Box& box,
+                       const Transform3f& tf)
+{
+  // Box in the voxel frame.
+  const Matrix3f B (voxel.R.transpose() * tf.getRotation());
+  const Vec3f T (voxel.toLocal(tf.getTranslation()));
+  return !obbDisjoint(B, T, voxel.half, box.halfSide);
+}
+
+bool voxelSphereDistance(const Voxel& voxel, const Sphere& sphere,
+                         const Transform3f& tf, FCL_REAL& dist,
+                         Vec3f& p1, Vec3f& p2, Vec3f& normal)
+{
+  // Closest point of the voxel to the center of the sphere, as in
+  // details::boxSphereDistance.
+  const Vec3f c (voxel.toLocal(tf.getTranslation()));
+  const Vec3f q (c.cwiseMax(-voxel.half).cwiseMin(voxel.half));
+  const Vec3f& os = tf.getTranslation();
+  if(q != c)
+  {
+    p1 = voxel.toWorld(q);
+    normal = os - p1;
+    const FCL_REAL pdist = normal.norm();
+    normal /= pdist;
+    dist = pdist - sphere.radius;
+    if(dist <= 0)
+    {
+      p2 = p1;
+      return false;
+    }
+    p2 = os - sphere.radius * normal;
+    return true;
+  }
+
+  // The center is inside the voxel: the sphere leaves it through the
+  // closest face.
+  int i;
+  (voxel.half - c.cwiseAbs()).minCoeff(&i);
+  Vec3f f (c);
+  f[i] = c[i] >= 0 ? voxel.half[i] : -voxel.half[i];
+  p1 = p2 = voxel.toWorld(f);
+  normal = c[i] >= 0 ? voxel.R.col(i) : Vec3f(-voxel.R.col(i));
+  dist = - (voxel.half[i] - std::abs(c[i])) - sphere.radius;
+  return false;
+}
+
+namespace
+{
+  /// @brief Squared distance between the segment a + t d, t in [0, 1], and
+  /// the box of half sides h centered at the origin.
+  /// The squared distance is a convex piecewise quadratic function of t,
+  /// whose pieces are delimited by the crossings of the faces planes.
+  /// @retval t_min parameter of the closest point of the segment.
+  FCL_REAL segmentBoxSqrDistance(const Vec3f& a, const Vec3f& d,
+                                 const Vec3f& h, FCL_REAL& t_min)
+  {
+    FCL_REAL ts[8];
+    int n = 0;
+    ts[n++] = 0;
+    ts[n++] = 1;
+    for(int i = 0; i < 3; ++i)
+    {
+      if(d[i] == 0) continue;
+      for(int s = -1; s <= 1; s += 2)
+      {
+        FCL_REAL t = (s * h[i] - a[i]) / d[i];
+        if(t > 0 && t < 1) ts[n++] = t;
+      }
+    }
+    std::sort(ts, ts + n);
+
+    FCL_REAL min_sqr = std::numeric_limits<FCL_REAL>::max();
+    t_min = 0;
+    for(int k = 0; k + 1 < n; ++k)
+    {
+      const FCL_REAL t0 = ts[k], t1 = ts[k + 1];
+      const FCL_REAL tm = (t0 + t1) / 2;
+      // On [t0, t1], each coordinate stays on one side of the box.
+      FCL_REAL A = 0, B = 0, C = 0;
+      for(int i = 0; i < 3; ++i)
+      {
+        const FCL_REAL x = a[i] + tm * d[i];
+        FCL_REAL e;
+        if(x < -h[i]) e = a[i] + h[i];
+        else if(x > h[i]) e = a[i] - h[i];
+        else continue;
+        A += d[i] * d[i];
+        B += 2 * d[i] * e;
+        C += e * e;
+      }
+      FCL_REAL t = t0;
+      if(A > 0) t = std::min(t1, std::max(t0, - B / (2 * A)));
+      const FCL_REAL sqr = (A * t + B) * t + C;
+      if(sqr < min_sqr)
+      {
+        min_sqr = sqr;
+        t_min = t;
+      }
+    }
+    return std::max(min_sqr, FCL_REAL(0));
+  }
+}
+
+bool voxelCapsuleDistance(const Voxel& voxel, const Capsule& capsule,
+                          const Transform3f& tf, FCL_REAL& dist,
+                          Vec3f& p1, Vec3f& p2, Vec3f& normal)
+{
+  // Axis of the capsule in the voxel frame.
+  const Vec3f axis (tf.getRotation().col(2) * capsule.halfLength);
+  const Vec3f a (voxel.toLocal(tf.getTranslation() - axis));
+  const Vec3f d (voxel.R.transpose() * (2 * axis));
+
+  FCL_REAL t;
+  const FCL_REAL sqr = segmentBoxSqrDistance(a, d, voxel.half, t);
+  if(sqr == 0)
+  {
+    dist = 0;
+    return false;
+  }
+
+  const Vec3f x (a + t * d);
+  const Vec3f q (x.cwiseMax(-voxel.half).cwiseMin(voxel.half));
+  const FCL_REAL axis_dist = std::sqrt(sqr);
+  dist = axis_dist - capsule.radius;
+  // normal goes from the voxel to the capsule.
+  normal = voxel.R * ((x - q) / axis_dist);
+  p1 = voxel.toWorld(q);
+  p2 = voxel.toWorld(x) - capsule.radius * normal;
+  return true;
+}
+
+namespace
+{
+  /// @brief Whether the projections of the triangle and of the box on axis
+  /// are disjoint.
+  inline bool separates(const Vec3f& axis, const Vec3f& v0, const Vec3f& v1,
+                        const Vec3f& v2, const Vec3f& h)
+  {
+    const FCL_REAL p0 = axis.dot(v0), p1 = axis.dot(v1), p2 = axis.dot(v2);
+    const FCL_REAL r = h.dot(axis.cwiseAbs());
+    return std::min(p0, std::min(p1, p2)) > r
+      || std::max(p0, std::max(p1, p2)) < -r;
+  }
+}
+
+bool voxelTriangleIntersect(const Voxel& voxel, const Vec3f& P1,
+                            const Vec3f& P2, const Vec3f& P3)
+{
+  // Separating axis test of Akenine-Moller, in the voxel frame.
+  const Vec3f v0 (voxel.toLocal(P1));
+  const Vec3f v1 (voxel.toLocal(P2));
+  const Vec3f v2 (voxel.toLocal(P3));
+  const Vec3f& h = voxel.half;
+
+  // Axes of the voxel.
+  for(int i = 0; i < 3; ++i)
+  {
+    if(std::min(v0[i], std::min(v1[i], v2[i])) > h[i]
+       || std::max(v0[i], std::max(v1[i], v2[i])) < -h[i])
+      return false;
+  }
+
+  // Normal of the triangle.
+  const Vec3f e0 (v1 - v0), e1 (v2 - v1), e2 (v0 - v2);
+  const Vec3f n (e0.cross(e1));
+  if(std::abs(n.dot(v0)) > h.dot(n.cwiseAbs())) return false;
+
+  // Cross products of the axes of the voxel and of the edges.
+  const Vec3f* edges[] = { &e0, &e1, &e2 };
+  for(int j = 0; j < 3; ++j)
+  {
+    const Vec3f& e = *edges[j];
+    if(separates(Vec3f(0, -e[2], e[1]), v0, v1, v2, h)) return false;
+    if(separates(Vec3f(e[2], 0, -e[0]), v0, v1, v2, h)) return false;
+    if(separates(Vec3f(-e[1], e[0], 0), v0, v1, v2, h)) return false;
+  }
+  return true;
+}
+
+}
+
+}
+
+} // namespace hpp
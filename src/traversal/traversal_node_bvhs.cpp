@@ -58,11 +58,8 @@ static inline void meshDistanceOrientedNodeleafComputeDistance(int b1, int b2,
 {
   if(enable_statistics) num_leaf_tests++;
 
-  const BVNode<BV>& node1 = model1->getBV(b1);
-  const BVNode<BV>& node2 = model2->getBV(b2);
-
-  int primitive_id1 = node1.primitiveId();
-  int primitive_id2 = node2.primitiveId();
+  int primitive_id1 = model1->primitiveId(b1);
+  int primitive_id2 = model2->primitiveId(b2);
 
   const Triangle& tri_id1 = tri_indices1[primitive_id1];
   const Triangle& tri_id2 = tri_indices2[primitive_id2];
@@ -155,6 +152,11 @@ void MeshDistanceTraversalNodeRSS::postprocess()
 FCL_REAL MeshDistanceTraversalNodeRSS::BVDistanceLowerBound(int b1, int b2) const
 {
   if(enable_statistics) num_bv_tests++;
+  if(model1->decodesVolumes() || model2->decodesVolumes())
+  {
+    RSS buffer1, buffer2;
+    return distance(R, T, model1->getVolume(b1, buffer1), model2->getVolume(b2, buffer2));
+  }
   return distance(R, T, model1->getBV(b1).bv, model2->getBV(b2).bv);
 }
 
@@ -183,6 +185,11 @@ void MeshDistanceTraversalNodekIOS::postprocess()
 FCL_REAL MeshDistanceTraversalNodekIOS::BVDistanceLowerBound(int b1, int b2) const
 {
   if(enable_statistics) num_bv_tests++;
+  if(model1->decodesVolumes() || model2->decodesVolumes())
+  {
+    kIOS buffer1, buffer2;
+    return distance(R, T, model1->getVolume(b1, buffer1), model2->getVolume(b2, buffer2));
+  }
   return distance(R, T, model1->getBV(b1).bv, model2->getBV(b2).bv);
 }
 
@@ -211,6 +218,11 @@ void MeshDistanceTraversalNodeOBBRSS::postprocess()
 FCL_REAL MeshDistanceTraversalNodeOBBRSS::BVDistanceLowerBound(int b1, int b2) const
 {
   if(enable_statistics) num_bv_tests++;
+  if(model1->decodesVolumes() || model2->decodesVolumes())
+  {
+    OBBRSS buffer1, buffer2;
+    return distance(R, T, model1->getVolume(b1, buffer1), model2->getVolume(b2, buffer2));
+  }
   return distance(R, T, model1->getBV(b1).bv, model2->getBV(b2).bv);
 }
 
@@ -57,6 +57,8 @@ static inline bool setupMeshDistanceOrientedNode(OrientedNode& node,
 
   node.request = request;
   node.result = &result;
+  node.rel_err = request.rel_err;
+  node.abs_err = request.abs_err;
 
   node.model1 = &model1;
   node.tf1 = tf1;
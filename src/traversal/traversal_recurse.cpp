@@ -37,6 +37,9 @@
 
 
 #include <hpp/fcl/internal/traversal_recurse.h>
+#include <hpp/fcl/internal/traversal_ordered.h>
+
+#include <boost/thread/tss.hpp>
 
 #include <vector>
 
@@ -362,24 +365,27 @@ void propagateBVHFrontListCollisionRecurse
 {
   FCL_REAL sqrDistLowerBound = -1,
     sqrDistLowerBound1 = 0, sqrDistLowerBound2 = 0;
-  BVHFrontList::iterator front_iter;
-  BVHFrontList append;
-  for(front_iter = front_list->begin(); front_iter != front_list->end(); ++front_iter)
+
+  // The nodes appended by collisionRecurse are up to date: only the nodes
+  // of the previous front are propagated. They are accessed by index since
+  // appending may reallocate the storage.
+  const std::size_t front_size = front_list->size();
+  for(std::size_t i = 0; i < front_size; ++i)
   {
-    int b1 = front_iter->left;
-    int b2 = front_iter->right;
+    int b1 = (*front_list)[i].left;
+    int b2 = (*front_list)[i].right;
     bool l1 = node->isFirstNodeLeaf(b1);
     bool l2 = node->isSecondNodeLeaf(b2);
 
     if(l1 & l2)
     {
-      front_iter->valid = false; // the front node is no longer valid, in collideRecurse will add again.
-      collisionRecurse(node, b1, b2, &append, sqrDistLowerBound);
+      (*front_list)[i].valid = false; // the front node is no longer valid, in collideRecurse will add again.
+      collisionRecurse(node, b1, b2, front_list, sqrDistLowerBound);
     }
     else
     {
       if(!node->BVDisjoints(b1, b2, sqrDistLowerBound)) {
-        front_iter->valid = false;
+        (*front_list)[i].valid = false;
         if(node->firstOverSecond(b1, b2)) {
           int c1 = node->getFirstLeftChild(b1);
           int c2 = node->getFirstRightChild(b1);
@@ -402,22 +408,19 @@ void propagateBVHFrontListCollisionRecurse
     result.distance_lower_bound = sqrt (sqrDistLowerBound);
   }
 
-
   // clean the old front list (remove invalid node)
-  for(front_iter = front_list->begin(); front_iter != front_list->end();)
-  {
-    if(!front_iter->valid)
-      front_iter = front_list->erase(front_iter);
-    else
-      ++front_iter;
-  }
+  compactFrontList(front_list);
+}
 
-  for(front_iter = append.begin(); front_iter != append.end(); ++front_iter)
+namespace details
+{
+  DistanceHeap& threadDistanceHeap()
   {
-    front_list->push_back(*front_iter);
+    static boost::thread_specific_ptr<DistanceHeap> heap;
+    if(!heap.get()) heap.reset(new DistanceHeap);
+    return *heap;
   }
-}
-
+} // namespace details
 
 }
 
@@ -0,0 +1,149 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_MODULE FCL_BATCH
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/fcl/batch.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
+
+#include "utility.h"
+
+using namespace hpp::fcl;
+
+struct Geometries
+{
+  Box box;
+  Cylinder cylinder;
+  Sphere sphere;
+  BVHModel<OBBRSS> mesh;
+  std::vector<const CollisionGeometry*> geoms;
+
+  Geometries () : box (1, 2, 1), cylinder (0.5, 1), sphere (0.7)
+  {
+    generateBVHModel(mesh, Sphere (1), Transform3f(), 16, 16);
+    geoms.push_back (&box);
+    geoms.push_back (&cylinder);
+    geoms.push_back (&sphere);
+    geoms.push_back (&mesh);
+  }
+
+  void makeQueries (std::size_t n, std::vector<GeometryQuery>& queries) const
+  {
+    std::vector<Transform3f> tf1, tf2;
+    FCL_REAL extents[] = {-2, -2, -2, 2, 2, 2};
+    generateRandomTransforms(extents, tf1, n);
+    generateRandomTransforms(extents, tf2, n);
+
+    queries.resize (n);
+    for (std::size_t i = 0; i < n; ++i)
+      queries[i] = GeometryQuery (geoms[i % geoms.size()], tf1[i],
+                                  geoms[(i / geoms.size()) % geoms.size()],
+                                  tf2[i]);
+  }
+};
+
+BOOST_AUTO_TEST_CASE(batch_collide)
+{
+  Geometries g;
+  std::vector<GeometryQuery> queries;
+  g.makeQueries (1000, queries);
+  CollisionRequest request (CONTACT, 1);
+
+  std::vector<CollisionResult> results1, results4;
+  std::size_t n1 = collide (queries, request, results1, 1);
+  std::size_t n4 = collide (queries, request, results4, 4);
+  BOOST_CHECK_EQUAL (n1, n4);
+  BOOST_CHECK (n1 > 0 && n1 < queries.size());
+  BOOST_REQUIRE_EQUAL (results1.size(), queries.size());
+  BOOST_REQUIRE_EQUAL (results4.size(), queries.size());
+
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    const GeometryQuery& q = queries[i];
+    CollisionResult result;
+    collide (q.o1, q.tf1, q.o2, q.tf2, request, result);
+    BOOST_REQUIRE_EQUAL (result.numContacts (), results1[i].numContacts ());
+    BOOST_REQUIRE_EQUAL (result.numContacts (), results4[i].numContacts ());
+    if (result.isCollision ()) {
+      const Contact& c = result.getContact (0);
+      const Contact& c1 = results1[i].getContact (0);
+      const Contact& c4 = results4[i].getContact (0);
+      BOOST_CHECK (c1.o1 == q.o1 && c4.o1 == q.o1);
+      BOOST_CHECK_EQUAL (c.b1, c4.b1);
+      BOOST_CHECK_EQUAL (c.b2, c4.b2);
+      // The results do not depend on the number of threads.
+      BOOST_CHECK (c1.normal == c4.normal);
+      BOOST_CHECK (c1.pos == c4.pos);
+      BOOST_CHECK_EQUAL (c1.penetration_depth, c4.penetration_depth);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch_distance)
+{
+  Geometries g;
+  std::vector<GeometryQuery> queries;
+  g.makeQueries (1000, queries);
+  DistanceRequest request (true);
+
+  std::vector<DistanceResult> results1, results4;
+  distance (queries, request, results1, 1);
+  distance (queries, request, results4, 4);
+  BOOST_REQUIRE_EQUAL (results1.size(), queries.size());
+  BOOST_REQUIRE_EQUAL (results4.size(), queries.size());
+
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    const GeometryQuery& q = queries[i];
+    DistanceResult result;
+    distance (q.o1, q.tf1, q.o2, q.tf2, request, result);
+    BOOST_CHECK_CLOSE (result.min_distance, results4[i].min_distance, 1e-6);
+    // The results do not depend on the number of threads.
+    BOOST_CHECK_EQUAL (results1[i].min_distance, results4[i].min_distance);
+    BOOST_CHECK (results1[i].nearest_points[0] == results4[i].nearest_points[0]);
+    BOOST_CHECK (results1[i].nearest_points[1] == results4[i].nearest_points[1]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch_empty)
+{
+  std::vector<GeometryQuery> queries;
+  std::vector<CollisionResult> results (3);
+  BOOST_CHECK_EQUAL (collide (queries, CollisionRequest (), results), 0);
+  BOOST_CHECK (results.empty ());
+}
@@ -15,11 +15,19 @@
 // hpp-fcl. If not, see <http://www.gnu.org/licenses/>.
 
 #include <boost/filesystem.hpp>
+#include <sstream>
 
 #include <hpp/fcl/internal/traversal_node_setup.h>
 #include <hpp/fcl/internal/traversal_node_bvhs.h>
 #include "../src/collision_node.h"
 #include <hpp/fcl/internal/BV_splitter.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/continuous_collision.h>
+#ifdef HPP_FCL_HAVE_OCTOMAP
+#include <hpp/fcl/octree.h>
+#endif
+#include <hpp/fcl/shape/geometric_shapes.h>
 
 #include "utility.h"
 #include "fcl_resources/config.h"
@@ -39,16 +47,16 @@ void makeModel (const std::vector<Vec3f>& vertices, const std::vector<Triangle>&
 template<typename BV, typename TraversalNode>
 double distance (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose);
+               int& num_bv_tests);
 
 template<typename BV, typename TraversalNode>
 double collide (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose);
+               int& num_bv_tests);
 
 template<typename BV>
 double run (const std::vector<Transform3f>& tf,
-    const BVHModel<BV> (&models)[2][3], int split_method,
+    const BVHModel<BV> (&models)[2][4], int split_method,
           const char* sm_name);
 
 template <typename BV> struct traits {
@@ -86,10 +94,59 @@ void makeModel (const std::vector<Vec3f>& vertices, const std::vector<Triangle>&
   model.endModel();
 }
 
+/// Surface area of the box of dimensions width, height and depth of a BV.
+template<typename BV>
+FCL_REAL area (const BV& bv)
+{
+  return bv.width() * bv.height() + bv.height() * bv.depth()
+    + bv.depth() * bv.width();
+}
+
+/// SAH cost of the hierarchy, relative to the root, with unit costs for
+/// a BV test and for a primitive test. Also compute the maximal depth.
+template<typename BV>
+FCL_REAL treeCost (const BVHModel<BV>& model, int id, int depth, int& max_depth)
+{
+  const BVNode<BV>& node = model.getBV(id);
+  FCL_REAL a = area(node.bv) / area(model.getBV(0).bv);
+  if (node.isLeaf()) {
+    max_depth = std::max (max_depth, depth);
+    return a * node.num_primitives;
+  }
+  return a + treeCost (model, node.leftChild(), depth + 1, max_depth)
+    + treeCost (model, node.rightChild(), depth + 1, max_depth);
+}
+
+/// Build env and rob with each split method, and print the build time,
+/// the SAH cost and the depth of the hierarchies.
+template<typename BV>
+void makeModels (const std::vector<Vec3f>& p1, const std::vector<Triangle>& t1,
+                 const std::vector<Vec3f>& p2, const std::vector<Triangle>& t2,
+                 BVHModel<BV> (&models)[2][4], const char* name)
+{
+  const char* split_names[] = { "mean", "median", "bv center", "binned SAH" };
+  for (int split = 0; split < 4; ++split) {
+    Timer timer;
+    timer.start();
+    makeModel (p1, t1, (SplitMethodType)split, models[0][split]);
+    makeModel (p2, t2, (SplitMethodType)split, models[1][split]);
+    timer.stop();
+
+    std::cout << name << " - " << split_names[split] << ":\t build "
+      << timer.getElapsedTimeInMicroSec() << " us, (SAH cost, depth)";
+    for (int k = 0; k < 2; ++k) {
+      int depth = 0;
+      FCL_REAL cost = treeCost (models[k][split], 0, 0, depth);
+      std::cout << " (" << cost << ", " << depth << ")";
+    }
+    std::cout << "\n";
+  }
+}
+
 template<typename BV, typename TraversalNode>
 double distance (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose)
+               int& num_bv_tests)
 {
   Transform3f pose2;
 
@@ -97,7 +154,7 @@ double distance (const std::vector<Transform3f>& tf,
   DistanceRequest request(true);
   TraversalNode node;
 
-  node.enable_statistics = verbose;
+  node.enable_statistics = true;
 
   Timer timer;
   timer.start();
@@ -109,66 +166,586 @@ double distance (const std::vector<Transform3f>& tf,
     distance(&node, NULL);
   }
   timer.stop();
+  num_bv_tests = node.num_bv_tests;
   return timer.getElapsedTimeInMicroSec();
 }
 
 template<typename BV, typename TraversalNode>
 double collide (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose)
+               int& num_bv_tests)
 {
   Transform3f pose2;
 
-  CollisionResult local_result;	
   CollisionRequest request;
   TraversalNode node (request);
 
-  node.enable_statistics = verbose;
+  node.enable_statistics = true;
 
   Timer timer;
   timer.start();
 
   for (std::size_t i = 0; i < tf.size(); ++i) {
-    bool success (initialize(node, m1, tf[i], m2, pose2, local_result));
+    CollisionResult result;
+    bool success (initialize(node, m1, tf[i], m2, pose2, result));
     (void)success;
     assert (success);
 
-    CollisionResult result;
     collide(&node, request, result);
   }
 
   timer.stop();
+  num_bv_tests = node.num_bv_tests;
   return timer.getElapsedTimeInMicroSec();
 }
 
 template<typename BV>
 double run (const std::vector<Transform3f>& tf,
-          const BVHModel<BV> (&models)[2][3], int split_method,
+          const BVHModel<BV> (&models)[2][4], int split_method,
           const char* prefix)
 {
+  int col_tests, dist_tests;
   double col  = collide <BV, typename traits<BV>::CollisionTraversalNode>
-    (tf, models[0][split_method], models[1][split_method], verbose);
+    (tf, models[0][split_method], models[1][split_method], col_tests);
   double dist = distance<BV, typename traits<BV>::DistanceTraversalNode>
-    (tf, models[0][split_method], models[1][split_method], verbose);
+    (tf, models[0][split_method], models[1][split_method], dist_tests);
 
-  std::cout << prefix << " (" << col << ", " << dist << ")\n";
+  std::cout << prefix << " (" << col << ", " << dist << "), BV tests ("
+    << col_tests << ", " << dist_tests << ")\n";
   return col + dist;
 }
 
 template<>
 double run<OBB> (const std::vector<Transform3f>& tf,
-                 const BVHModel<OBB> (&models)[2][3], int split_method,
+                 const BVHModel<OBB> (&models)[2][4], int split_method,
                  const char* prefix)
 {
+  int col_tests;
   double col  = collide <OBB,traits<OBB>::CollisionTraversalNode>
-    (tf, models[0][split_method], models[1][split_method], verbose);
+    (tf, models[0][split_method], models[1][split_method], col_tests);
   double dist = 0;
 
-  std::cout << prefix << " (\t" << col << ", \tNaN)\n";
+  std::cout << prefix << " (\t" << col << ", \tNaN), BV tests ("
+    << col_tests << ", NaN)\n";
   return col + dist;
 }
 
 
+/// Compare the query times with the two node layouts. The bytes read per
+/// node by a traversal stand for the cache misses, which cannot be counted
+/// portably.
+template<typename BV>
+double runNodeLayout (const std::vector<Vec3f>& p1, const std::vector<Triangle>& t1,
+                      const std::vector<Vec3f>& p2, const std::vector<Triangle>& t2,
+                      const std::vector<Transform3f>& tf, const char* name)
+{
+  BVHModel<BV> models[2][2][4];
+  BVHNodeLayout layouts[] = { BVH_LAYOUT_NODES, BVH_LAYOUT_SPLIT };
+  std::size_t bytes[] = { sizeof(BVNode<BV>),
+    sizeof(int) + sizeof(details::CompactBV<BV>) };
+  double total_time = 0;
+  for (int k = 0; k < 2; ++k) {
+    makeModel (p1, t1, SPLIT_METHOD_MEAN, models[k][0][SPLIT_METHOD_MEAN]);
+    makeModel (p2, t2, SPLIT_METHOD_MEAN, models[k][1][SPLIT_METHOD_MEAN]);
+    models[k][0][SPLIT_METHOD_MEAN].setNodeLayout (layouts[k]);
+    models[k][1][SPLIT_METHOD_MEAN].setNodeLayout (layouts[k]);
+    std::ostringstream prefix;
+    prefix << name << (k ? " split" : " nodes") << ", " << bytes[k]
+      << " bytes per node:\t";
+    total_time += run (tf, models[k], SPLIT_METHOD_MEAN, prefix.str().c_str());
+  }
+  return total_time;
+}
+
+/// Compare the query times of the binary hierarchy and of the 4-ary one of
+/// the wide layout. A BV test of the wide hierarchy counts one per child.
+template<typename BV>
+double runWideNodes (const std::vector<Vec3f>& p1, const std::vector<Triangle>& t1,
+                     const std::vector<Vec3f>& p2, const std::vector<Triangle>& t2,
+                     const std::vector<Transform3f>& tf, const char* name)
+{
+  BVHModel<BV> models[2][2][4];
+  BVHNodeLayout layouts[] = { BVH_LAYOUT_NODES, BVH_LAYOUT_WIDE };
+  double total_time = 0;
+  for (int k = 0; k < 2; ++k) {
+    makeModel (p1, t1, SPLIT_METHOD_MEAN, models[k][0][SPLIT_METHOD_MEAN]);
+    makeModel (p2, t2, SPLIT_METHOD_MEAN, models[k][1][SPLIT_METHOD_MEAN]);
+    models[k][0][SPLIT_METHOD_MEAN].setNodeLayout (layouts[k]);
+    models[k][1][SPLIT_METHOD_MEAN].setNodeLayout (layouts[k]);
+    std::ostringstream prefix;
+    prefix << name << (k ? " wide:\t" : " binary:\t");
+    total_time += run (tf, models[k], SPLIT_METHOD_MEAN, prefix.str().c_str());
+  }
+  return total_time;
+}
+
+/// Compare the collision traversal through the virtual methods of the
+/// traversal node with the one bound to its type (see collisionStatic).
+template<typename BV>
+void runStaticTraversal (const std::vector<Transform3f>& tf,
+                         const BVHModel<BV>& m1, const BVHModel<BV>& m2,
+                         const char* prefix)
+{
+  CollisionRequest request;
+  typename traits<BV>::CollisionTraversalNode node (request);
+  Transform3f pose2;
+  double time[2];
+  Timer timer;
+  for (int k = 0; k < 2; ++k) {
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      CollisionResult result;
+      initialize (node, m1, tf[i], m2, pose2, result);
+      if (k)
+        collide (&node, request, result);
+      else
+        collide (static_cast<CollisionTraversalNodeBase*> (&node), request,
+                 result);
+    }
+    timer.stop();
+    time[k] = timer.getElapsedTimeInMicroSec();
+  }
+  std::cout << prefix << " (" << time[0] << ", " << time[1] << ") us\n";
+}
+
+/// Time of the queries of all the contacts between env and rob, with 1, 2
+/// and 4 threads.
+void runParallelCollision (const std::vector<Transform3f>& tf,
+                           const BVHModel<OBBRSS>& m1, const BVHModel<OBBRSS>& m2)
+{
+  CollisionRequest request (CONTACT, std::numeric_limits<int>::max());
+  MeshCollisionTraversalNodeOBBRSS node (request);
+  Transform3f pose2;
+  unsigned int num_threads[] = { 1, 2, 4 };
+  std::cout << "\nParallel collision: (OBBRSS, all contacts) (1, 2, 4 threads)\n";
+  std::size_t contacts = 0;
+  for (int k = 0; k < 3; ++k) {
+    request.num_threads = num_threads[k];
+    Timer timer;
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      CollisionResult result;
+      initialize (node, m1, tf[i], m2, pose2, result);
+      collide (&node, request, result);
+      contacts += result.numContacts();
+    }
+    timer.stop();
+    std::cout << (k ? ", " : "(") << timer.getElapsedTimeInMicroSec();
+  }
+  std::cout << ") us, " << contacts / 3 << " contacts\n";
+}
+
+/// Compare the distance traversal of distanceRecurse with the closest first
+/// one of distanceOrdered, exact, with errors of 10% and 10 and with an
+/// upper bound on the distance.
+template<typename BV>
+void runOrderedDistance (const std::vector<Transform3f>& tf,
+                         const BVHModel<BV>& m1, const BVHModel<BV>& m2,
+                         FCL_REAL upper_bound, const char* prefix)
+{
+  typename traits<BV>::DistanceTraversalNode node;
+  node.enable_statistics = true;
+  Transform3f pose2;
+  std::cout << prefix;
+  for (int k = 0; k < 4; ++k) {
+    DistanceRequest request (true, k == 2 ? 0.1 : 0., k == 2 ? 10. : 0.);
+    node.num_bv_tests = 0;
+    Timer timer;
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      DistanceResult result (k == 3 ? upper_bound
+                             : std::numeric_limits<FCL_REAL>::max());
+      initialize (node, m1, tf[i], m2, pose2, request, result);
+      if (k)
+        distanceOrdered (&node);
+      else
+        distance (&node);
+    }
+    timer.stop();
+    std::cout << (k ? ", " : " (") << timer.getElapsedTimeInMicroSec()
+      << " us " << node.num_bv_tests;
+  }
+  std::cout << ")\n";
+}
+
+/// Compare exact distance queries with queries of whether the distance is
+/// below a threshold, between env and rob and between env and a cylinder.
+template<typename BV>
+void runDistanceThreshold (const std::vector<Transform3f>& tf,
+                           const BVHModel<BV>& m1, const BVHModel<BV>& m2,
+                           FCL_REAL threshold, const char* prefix)
+{
+  Cylinder cylinder (50, 200);
+  const CollisionGeometry* o2[] = { &m2, &cylinder };
+  std::cout << prefix;
+  for (int j = 0; j < 2; ++j) {
+    std::size_t below = 0;
+    for (int k = 0; k < 2; ++k) {
+      DistanceRequest request;
+      request.distance_threshold = k ? threshold : 0;
+      GJKSolver solver;
+      Timer timer;
+      timer.start();
+      for (std::size_t i = 0; i < tf.size(); ++i) {
+        DistanceResult result;
+        distance (&m1, Transform3f(), o2[j], tf[i], &solver, request, result);
+        if (k && result.min_distance < threshold) ++below;
+      }
+      timer.stop();
+      std::cout << (k ? ", " : (j ? " (" : "\t(")) << timer.getElapsedTimeInMicroSec();
+    }
+    std::cout << ") us " << below << " below";
+  }
+  std::cout << "\n";
+}
+
+/// Compare the collision of the static env with a box, with the nodes and
+/// the quantized layouts of an AABB hierarchy, and the bytes of their boxes.
+void runQuantizedNodes (const std::vector<Vec3f>& p1, const std::vector<Triangle>& t1,
+                        const std::vector<Transform3f>& tf)
+{
+  BVHNodeLayout layouts[] = { BVH_LAYOUT_NODES, BVH_LAYOUT_QUANTIZED };
+  std::size_t bytes[] = { sizeof(AABB), sizeof(details::QuantizedNode) };
+  const char* names[] = { "nodes", "quantized" };
+  Box box (500, 500, 500);
+  GJKSolver solver;
+  CollisionRequest request (CONTACT, std::numeric_limits<int>::max());
+  for (int k = 0; k < 2; ++k) {
+    BVHModel<AABB> env;
+    makeModel (p1, t1, SPLIT_METHOD_MEAN, env);
+    env.setNodeLayout (layouts[k]);
+    MeshShapeCollisionTraversalNode<AABB, Box> node (request);
+    node.enable_statistics = true;
+
+    std::size_t contacts = 0;
+    Timer timer;
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      CollisionResult result;
+      Transform3f pose1;
+      initialize (node, env, pose1, box, tf[i], &solver, result);
+      collide (&node, request, result);
+      contacts += result.numContacts();
+    }
+    timer.stop();
+    std::cout << names[k] << ", " << bytes[k] * (std::size_t)env.getNumBVs()
+      << " bytes of boxes:\t" << timer.getElapsedTimeInMicroSec()
+      << " us, BV tests " << node.num_bv_tests << ", " << contacts
+      << " contacts\n";
+  }
+}
+
+/// Compare the triangle-triangle kernel used between mesh leaves with GJK
+/// on pairs of triangles of env.obj and rob.obj close to each other.
+void runTriangleKernels (const std::vector<Vec3f>& p1, const std::vector<Triangle>& t1,
+                         const std::vector<Vec3f>& p2, const std::vector<Triangle>& t2,
+                         std::size_t n)
+{
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1, -1, -1, 1, 1, 1};
+  generateRandomTransforms(extents, transforms, n);
+
+  // Put the center of the second triangle at a random offset, of the order
+  // of the size of the first triangle, from the center of the first one.
+  std::vector<Vec3f> S (3*n), T (3*n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const Triangle& a = t1[rand() % t1.size()];
+    const Triangle& b = t2[rand() % t2.size()];
+    Vec3f ca ((p1[a[0]] + p1[a[1]] + p1[a[2]]) / 3);
+    Vec3f cb ((p2[b[0]] + p2[b[1]] + p2[b[2]]) / 3);
+    FCL_REAL size = (p1[a[0]] - ca).norm();
+    for (int k = 0; k < 3; ++k) {
+      S[3*i+k] = p1[a[k]];
+      T[3*i+k] = transforms[i].getRotation() * (p2[b[k]] - cb) + ca
+        + size * transforms[i].getTranslation();
+    }
+  }
+
+  std::vector<FCL_REAL> gjk_dist (n), kernel_dist (n);
+  Vec3f q1, q2, normal;
+
+  Timer timer;
+  timer.start();
+  for (std::size_t i = 0; i < n; ++i) {
+    TriangleP tri1 (S[3*i], S[3*i+1], S[3*i+2]);
+    TriangleP tri2 (T[3*i], T[3*i+1], T[3*i+2]);
+    GJKSolver solver;
+    solver.shapeDistance (tri1, Transform3f(), tri2, Transform3f(),
+                          gjk_dist[i], q1, q2, normal);
+  }
+  timer.stop();
+  double gjk_time = timer.getElapsedTimeInMicroSec();
+
+  timer.start();
+  for (std::size_t i = 0; i < n; ++i)
+    kernel_dist[i] = TriangleDistance::signedTriDistance (&S[3*i], &T[3*i],
+                                                          q1, q2, normal);
+  timer.stop();
+  double kernel_time = timer.getElapsedTimeInMicroSec();
+
+  std::size_t n_collisions = 0;
+  FCL_REAL max_error = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (kernel_dist[i] <= 0) ++n_collisions;
+    else max_error = std::max (max_error, std::fabs (kernel_dist[i] - gjk_dist[i]));
+  }
+
+  std::cout << "Triangle-triangle:\t (GJK " << gjk_time << ", kernel "
+    << kernel_time << ")\n"
+    << "  " << n_collisions << " / " << n << " pairs in collision, "
+    << "max distance difference " << max_error << "\n";
+}
+
+/// Time per query of mesh-mesh collision along small motions, with and
+/// without front list, on the scenarios of test/frontlist.cpp.
+template<typename BV, typename TraversalNode>
+void runFrontList (const std::vector<Transform3f>& tf1,
+                   const std::vector<Transform3f>& tf2,
+                   const BVHModel<BV>& m1, const BVHModel<BV>& m2,
+                   std::size_t steps, const char* prefix)
+{
+  CollisionRequest request (NO_REQUEST, std::numeric_limits<int>::max());
+  CollisionResult result;
+  TraversalNode node (request);
+  BVHFrontList front_list;
+  Transform3f pose2;
+
+  double time[2] = { 0, 0 };
+  std::size_t contacts[2] = { 0, 0 };
+  Timer timer;
+  for (int use_front_list = 0; use_front_list < 2; ++use_front_list) {
+    for (std::size_t i = 0; i < tf1.size(); ++i) {
+      front_list.clear();
+      for (std::size_t k = 0; k <= steps; ++k) {
+        FCL_REAL alpha = (FCL_REAL)k / (FCL_REAL)steps;
+        Transform3f pose1 (tf1[i].getQuatRotation().slerp
+                           (alpha, tf2[i].getQuatRotation()),
+                           (1 - alpha) * tf1[i].getTranslation()
+                           + alpha * tf2[i].getTranslation());
+        initialize (node, m1, pose1, m2, pose2, result);
+        result.clear();
+
+        timer.start();
+        collide (&node, request, result,
+                 use_front_list ? &front_list : NULL);
+        timer.stop();
+        time[use_front_list] += timer.getElapsedTimeInMicroSec();
+        contacts[use_front_list] += result.numContacts();
+      }
+    }
+  }
+
+  const FCL_REAL n ((FCL_REAL)(tf1.size() * (steps + 1)));
+  std::cout << prefix << " (" << time[0] / n << ", " << time[1] / n
+    << ") us per query, " << contacts[0] << " / " << contacts[1]
+    << " contacts\n";
+}
+
+/// Build time of a point cloud of the size of a depth image, and build time
+/// and SAH cost of env and rob, with the top-down and the linear builders.
+void runLinearBuild (const std::vector<Vec3f>& p1, const std::vector<Triangle>& t1,
+                     const std::vector<Vec3f>& p2, const std::vector<Triangle>& t2)
+{
+  std::vector<Vec3f> cloud;
+  for (int i = 0; i < 640; ++i)
+    for (int j = 0; j < 480; ++j)
+      cloud.push_back (Vec3f (i, j, 100 * std::sin (i / 50.) * std::cos (j / 30.)));
+
+  BVHBuildMethod methods[] = { BVH_BUILD_TOP_DOWN, BVH_BUILD_LINEAR };
+  const char* names[] = { "top-down", "linear" };
+  std::cout << "\nBuild: (" << cloud.size() << " points AABB, env + rob OBBRSS)"
+    << " (SAH cost env, rob)\n";
+  for (int k = 0; k < 2; ++k) {
+    Timer timer;
+    BVHModel<AABB> pc;
+    pc.build_method = methods[k];
+    timer.start();
+    pc.beginModel();
+    pc.addSubModel(cloud);
+    pc.endModel();
+    timer.stop();
+    double cloud_time = timer.getElapsedTimeInMicroSec();
+
+    BVHModel<OBBRSS> env, rob;
+    env.build_method = rob.build_method = methods[k];
+    timer.start();
+    makeModel (p1, t1, SPLIT_METHOD_MEAN, env);
+    makeModel (p2, t2, SPLIT_METHOD_MEAN, rob);
+    timer.stop();
+
+    int depth = 0;
+    std::cout << names[k] << ":\t (" << cloud_time << ", "
+      << timer.getElapsedTimeInMicroSec() << ") us, ("
+      << treeCost (env, 0, 0, depth) << ", " << treeCost (rob, 0, 0, depth)
+      << ")\n";
+  }
+}
+
+void runRefit (const std::vector<Vec3f>& p1, const std::vector<Triangle>& t1)
+{
+  BVHModel<OBBRSS> env;
+  makeModel (p1, t1, SPLIT_METHOD_MEAN, env);
+  std::vector<Vec3f> vertices (p1);
+  const int n = 100;
+
+  std::cout << "\nRefit: (" << t1.size() << " triangles OBBRSS)"
+    << " (all vertices, 10 vertices)\n";
+  Timer timer;
+  timer.start();
+  for (int i = 0; i < n; ++i) {
+    FCL_REAL scale = (i % 2) ? 1.01 : 1 / 1.01;
+    for (std::size_t j = 0; j < vertices.size(); ++j)
+      vertices[j] *= scale;
+    env.beginUpdateModel();
+    env.updateSubModel(vertices);
+    env.endUpdateModel();
+  }
+  timer.stop();
+  double full_time = timer.getElapsedTimeInMicroSec() / n;
+
+  timer.start();
+  for (int i = 0; i < n; ++i) {
+    for (int k = 0; k < 10; ++k)
+      vertices[(std::size_t)(i * 10 + k) * 97 % vertices.size()] += Vec3f (1, 0, 0);
+    env.beginUpdateModel();
+    env.updateSubModel(vertices);
+    env.endUpdateModel();
+  }
+  timer.stop();
+  std::cout << "bottom-up:\t (" << full_time << ", "
+    << timer.getElapsedTimeInMicroSec() / n << ") us\n";
+}
+
+/// Compare the check of the motions of rob from tf1 to tf2, by discrete
+/// collision checks at regularly sampled poses (which may miss a collision),
+/// and by continuous collision.
+template<typename BV>
+void runContinuousCollision (const std::vector<Transform3f>& tf1,
+                             const std::vector<Transform3f>& tf2,
+                             const BVHModel<BV>& m1, const BVHModel<BV>& m2,
+                             std::size_t samples, const char* prefix)
+{
+  GJKSolver solver;
+  std::size_t collisions = 0;
+  Timer timer;
+  timer.start();
+  for (std::size_t i = 0; i < tf1.size(); ++i) {
+    Quaternion3f q1 (tf1[i].getQuatRotation()), q2 (tf2[i].getQuatRotation());
+    for (std::size_t j = 0; j <= samples; ++j) {
+      FCL_REAL t = (FCL_REAL) j / (FCL_REAL) samples;
+      Transform3f tf (q1.slerp (t, q2), (1 - t) * tf1[i].getTranslation()
+                      + t * tf2[i].getTranslation());
+      CollisionRequest request;
+      CollisionResult result;
+      if (collide (&m1, Transform3f(), &m2, tf, &solver, request, result)) {
+        ++collisions;
+        break;
+      }
+    }
+  }
+  timer.stop();
+  std::cout << prefix << timer.getElapsedTimeInMicroSec() << " us "
+    << collisions << " collisions, ";
+
+  collisions = 0;
+  std::size_t iterations = 0;
+  timer.start();
+  for (std::size_t i = 0; i < tf1.size(); ++i) {
+    ContinuousCollisionRequest request;
+    ContinuousCollisionResult result;
+    continuousCollide (&m1, Transform3f(), Transform3f(),
+                       &m2, tf1[i], tf2[i], request, result);
+    // Motions not proven free within the steps count as collisions.
+    if (result.time_of_contact < 1) ++collisions;
+    iterations += result.num_iterations;
+  }
+  timer.stop();
+  std::cout << timer.getElapsedTimeInMicroSec() << " us " << collisions
+    << " collisions " << iterations << " steps\n";
+}
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+/// Octomap of the surface of a mesh, sampled every half voxel.
+OcTree makeSurfaceOcTree (const std::vector<Vec3f>& points,
+                          const std::vector<Triangle>& triangles,
+                          FCL_REAL resolution)
+{
+  octomap::OcTreePtr_t octree (new octomap::OcTree (resolution));
+  for (std::size_t t = 0; t < triangles.size (); ++t) {
+    const Vec3f& a = points[triangles[t][0]];
+    Vec3f u (points[triangles[t][1]] - a), v (points[triangles[t][2]] - a);
+    int n = (int) std::ceil (2 * std::max (u.norm (), v.norm ()) / resolution);
+    for (int i = 0; i <= n; ++i)
+      for (int j = 0; i + j <= n; ++j) {
+        Vec3f p (a + u * i / n + v * j / n);
+        octree->updateNode (octomap::point3d ((float) p[0], (float) p[1],
+                                              (float) p[2]), true, true);
+      }
+  }
+  octree->updateInnerOccupancy ();
+  return OcTree (octree);
+}
+
+/// Collision and distance between two maps of env, at full depth and with
+/// the traversal stopped 2 levels above the leaves.
+void runOcTreePair (const std::vector<Vec3f>& p1,
+                    const std::vector<Triangle>& t1,
+                    const std::vector<Transform3f>& transforms)
+{
+  OcTree map1 (makeSurfaceOcTree (p1, t1, 50)),
+    map2 (makeSurfaceOcTree (p1, t1, 40));
+  std::cout << "\nOctree pair: (" << map1.getSnapshot ().size () << ", "
+    << map2.getSnapshot ().size () << " nodes) (collision, distance) us,"
+    " at full depth then 2 levels above\n";
+
+  // Small misalignments of the same map, as when merging maps, and random
+  // poses.
+  std::vector<Transform3f> close;
+  FCL_REAL extents[] = {-100, -100, -100, 100, 100, 100};
+  generateRandomTransforms (extents, close, 100);
+  for (std::size_t i = 0; i < close.size (); ++i)
+    close[i].setRotation (Eigen::AngleAxis<FCL_REAL>
+      (0.05, transforms[i].getTranslation ().normalized ())
+      .toRotationMatrix ());
+  std::vector<Transform3f> far (transforms.begin (), transforms.begin () + 100);
+  const std::vector<Transform3f>* sets[] = { &close, &far };
+  const char* names[] = { "misaligned:\t", "random:\t" };
+
+  for (int k = 0; k < 2; ++k) {
+    std::cout << names[k];
+    for (unsigned int depth = 0; depth < 2; ++depth) {
+      const std::vector<Transform3f>& tf = *sets[k];
+      CollisionRequest request;
+      request.octree_max_depth = depth
+        ? map1.getSnapshot ().getTreeDepth () - 2 : 0;
+      std::size_t collisions = 0;
+      Timer timer;
+      timer.start ();
+      for (std::size_t i = 0; i < tf.size (); ++i) {
+        CollisionResult result;
+        if (collide (&map1, Transform3f (), &map2, tf[i], request, result))
+          ++collisions;
+      }
+      timer.stop ();
+      std::cout << "(" << timer.getElapsedTimeInMicroSec () / tf.size ()
+        << ", ";
+
+      DistanceRequest drequest;
+      drequest.octree_max_depth = request.octree_max_depth;
+      timer.start ();
+      for (std::size_t i = 0; i < tf.size (); ++i) {
+        DistanceResult dresult;
+        distance (&map1, Transform3f (), &map2, tf[i], drequest, dresult);
+      }
+      timer.stop ();
+      std::cout << timer.getElapsedTimeInMicroSec () / tf.size () << ") "
+        << collisions << " collisions ";
+    }
+    std::cout << "\n";
+  }
+}
+#endif
+
 int main (int, char*[])
 {
   std::vector<Vec3f> p1, p2;
@@ -178,37 +755,17 @@ int main (int, char*[])
   loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
 
   // Make models
-  BVHModel<RSS> ms_rss[2][3];
-  makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_rss[0][SPLIT_METHOD_MEAN     ]);
-  makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_rss[0][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_rss[0][SPLIT_METHOD_MEDIAN   ]);
-  makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_rss[1][SPLIT_METHOD_MEAN     ]);
-  makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_rss[1][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_rss[1][SPLIT_METHOD_MEDIAN   ]);
-
-  BVHModel<kIOS> ms_kios[2][3];
-  makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_kios[0][SPLIT_METHOD_MEAN     ]);
-  makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_kios[0][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_kios[0][SPLIT_METHOD_MEDIAN   ]);
-  makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_kios[1][SPLIT_METHOD_MEAN     ]);
-  makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_kios[1][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_kios[1][SPLIT_METHOD_MEDIAN   ]);
-
-  BVHModel<OBB> ms_obb[2][3];
-  makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_obb[0][SPLIT_METHOD_MEAN     ]);
-  makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_obb[0][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_obb[0][SPLIT_METHOD_MEDIAN   ]);
-  makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_obb[1][SPLIT_METHOD_MEAN     ]);
-  makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_obb[1][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_obb[1][SPLIT_METHOD_MEDIAN   ]);
-
-  BVHModel<OBBRSS> ms_obbrss[2][3];
-  makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_obbrss[0][SPLIT_METHOD_MEAN     ]);
-  makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_obbrss[0][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_obbrss[0][SPLIT_METHOD_MEDIAN   ]);
-  makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_obbrss[1][SPLIT_METHOD_MEAN     ]);
-  makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_obbrss[1][SPLIT_METHOD_BV_CENTER]);
-  makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_obbrss[1][SPLIT_METHOD_MEDIAN   ]);
+  BVHModel<RSS> ms_rss[2][4];
+  makeModels (p1, t1, p2, t2, ms_rss, "RSS");
+
+  BVHModel<kIOS> ms_kios[2][4];
+  makeModels (p1, t1, p2, t2, ms_kios, "kIOS");
+
+  BVHModel<OBB> ms_obb[2][4];
+  makeModels (p1, t1, p2, t2, ms_obb, "OBB");
+
+  BVHModel<OBBRSS> ms_obbrss[2][4];
+  makeModels (p1, t1, p2, t2, ms_obbrss, "OBBRSS");
 
   std::vector<Transform3f> transforms; // t0
   FCL_REAL extents[] = {-3000, -3000, -3000, 3000, 3000, 3000};
@@ -220,18 +777,94 @@ int main (int, char*[])
   total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_BINNED_SAH);
 
   total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_BINNED_SAH);
 
   total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_BINNED_SAH);
 
   total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_BINNED_SAH);
 
   std::cout << "\n\nTotal time: " << total_time << std::endl;
+
+  std::cout << "\nNode layout: (collision, distance) us\n";
+  runNodeLayout<RSS> (p1, t1, p2, t2, transforms, "RSS");
+  runNodeLayout<kIOS> (p1, t1, p2, t2, transforms, "kIOS");
+  runNodeLayout<OBB> (p1, t1, p2, t2, transforms, "OBB");
+  runNodeLayout<OBBRSS> (p1, t1, p2, t2, transforms, "OBBRSS");
+
+  std::cout << "\nWide nodes: (collision, distance) us\n";
+  runWideNodes<OBB> (p1, t1, p2, t2, transforms, "OBB");
+  runWideNodes<RSS> (p1, t1, p2, t2, transforms, "RSS");
+  runWideNodes<OBBRSS> (p1, t1, p2, t2, transforms, "OBBRSS");
+
+  std::cout << "\nCollision traversal: (virtual, static)\n";
+  runStaticTraversal (transforms, ms_rss[0][SPLIT_METHOD_MEAN],
+                      ms_rss[1][SPLIT_METHOD_MEAN], "RSS:\t");
+  runStaticTraversal (transforms, ms_obb[0][SPLIT_METHOD_MEAN],
+                      ms_obb[1][SPLIT_METHOD_MEAN], "OBB:\t");
+  runStaticTraversal (transforms, ms_obbrss[0][SPLIT_METHOD_MEAN],
+                      ms_obbrss[1][SPLIT_METHOD_MEAN], "OBBRSS:\t");
+
+  runParallelCollision (transforms, ms_obbrss[0][SPLIT_METHOD_MEAN],
+                        ms_obbrss[1][SPLIT_METHOD_MEAN]);
+
+  std::cout << "\nDistance traversal: (recursive, ordered, ordered with "
+    "errors (10%, 10), ordered below 100) time and BV tests\n";
+  runOrderedDistance (transforms, ms_rss[0][SPLIT_METHOD_MEAN],
+                      ms_rss[1][SPLIT_METHOD_MEAN], 100, "RSS:\t");
+  runOrderedDistance (transforms, ms_kios[0][SPLIT_METHOD_MEAN],
+                      ms_kios[1][SPLIT_METHOD_MEAN], 100, "kIOS:\t");
+  runOrderedDistance (transforms, ms_obbrss[0][SPLIT_METHOD_MEAN],
+                      ms_obbrss[1][SPLIT_METHOD_MEAN], 100, "OBBRSS:\t");
+
+  std::cout << "\nDistance threshold: env - (rob, cylinder) (exact, below 100)\n";
+  runDistanceThreshold (transforms, ms_rss[0][SPLIT_METHOD_MEAN],
+                        ms_rss[1][SPLIT_METHOD_MEAN], 100, "RSS:");
+  runDistanceThreshold (transforms, ms_obbrss[0][SPLIT_METHOD_MEAN],
+                        ms_obbrss[1][SPLIT_METHOD_MEAN], 100, "OBBRSS:");
+
+  std::cout << "\nQuantized nodes: (env AABB - box collision)\n";
+  runQuantizedNodes (p1, t1, transforms);
+
+  runTriangleKernels (p1, t1, p2, t2, 100000);
+
+  runLinearBuild (p1, t1, p2, t2);
+  runRefit (p1, t1);
+
+  std::vector<Transform3f> transforms1, transforms2;
+  FCL_REAL extents_front_list[] = {-3000, -3000, 0, 3000, 3000, 3000};
+  FCL_REAL delta_trans[] = {1, 1, 1};
+  generateRandomTransforms(extents_front_list, delta_trans, 0.005 * 2 * 3.1415,
+                           transforms1, transforms2, 1000);
+  std::cout << "\nFront list: (without, with)\n";
+  runFrontList<RSS, MeshCollisionTraversalNodeRSS> (transforms1, transforms2,
+      ms_rss[0][SPLIT_METHOD_MEAN], ms_rss[1][SPLIT_METHOD_MEAN], 10, "RSS:\t");
+  runFrontList<OBB, MeshCollisionTraversalNodeOBB> (transforms1, transforms2,
+      ms_obb[0][SPLIT_METHOD_MEAN], ms_obb[1][SPLIT_METHOD_MEAN], 10, "OBB:\t");
+  runFrontList<OBBRSS, MeshCollisionTraversalNodeOBBRSS> (transforms1, transforms2,
+      ms_obbrss[0][SPLIT_METHOD_MEAN], ms_obbrss[1][SPLIT_METHOD_MEAN], 10, "OBBRSS:\t");
+
+  std::vector<Transform3f> motion_beg, motion_end;
+  FCL_REAL delta_motion[] = {200, 200, 200};
+  generateRandomTransforms(extents_front_list, delta_motion, 0.05 * 2 * 3.1415,
+                           motion_beg, motion_end, 1000);
+  std::cout << "\nContinuous collision: (20 discrete checks, continuous)\n";
+  runContinuousCollision (motion_beg, motion_end, ms_rss[0][SPLIT_METHOD_MEAN],
+      ms_rss[1][SPLIT_METHOD_MEAN], 20, "RSS:\t");
+  runContinuousCollision (motion_beg, motion_end, ms_obbrss[0][SPLIT_METHOD_MEAN],
+      ms_obbrss[1][SPLIT_METHOD_MEAN], 20, "OBBRSS:\t");
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+  runOcTreePair (p1, t1, transforms);
+#endif
 }
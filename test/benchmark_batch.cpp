@@ -0,0 +1,127 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <hpp/fcl/batch.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+
+#include "utility.h"
+#include "fcl_resources/config.h"
+
+using namespace hpp::fcl;
+
+inline std::size_t batch (const std::vector<GeometryQuery>& queries,
+    const CollisionRequest& request, std::vector<CollisionResult>& results,
+    std::size_t num_threads)
+{
+  return collide (queries, request, results, num_threads);
+}
+
+inline std::size_t batch (const std::vector<GeometryQuery>& queries,
+    const DistanceRequest& request, std::vector<DistanceResult>& results,
+    std::size_t num_threads)
+{
+  distance (queries, request, results, num_threads);
+  return 0;
+}
+
+// Time the batch queries for an increasing number of threads, and print the
+// speed-up with respect to one thread.
+template<typename Request, typename Result>
+void run (const std::vector<GeometryQuery>& queries, const Request& request,
+          std::size_t max_threads, const char* name)
+{
+  std::vector<Result> results;
+  double t1 = 0;
+  std::cout << name << std::endl;
+  std::size_t num_threads = 1;
+  while (true) {
+    Timer timer;
+    timer.start();
+    batch (queries, request, results, num_threads);
+    timer.stop();
+    double t = timer.getElapsedTimeInMicroSec();
+    if (num_threads == 1) t1 = t;
+    std::cout << "  " << num_threads << " threads:\t" << t / 1000 << " ms\t"
+      << "speed-up " << t1 / t << std::endl;
+    if (num_threads == max_threads) break;
+    num_threads = std::min (2 * num_threads, max_threads);
+  }
+}
+
+int main (int argc, char* argv[])
+{
+  std::size_t max_threads = boost::thread::hardware_concurrency();
+  if (argc > 1) max_threads = (std::size_t) atoi (argv[1]);
+  if (max_threads == 0) max_threads = 1;
+
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t1, t2;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "env.obj").string().c_str(), p1, t1);
+  loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
+
+  BVHModel<OBBRSS> env, rob;
+  env.beginModel(); env.addSubModel(p1, t1); env.endModel();
+  rob.beginModel(); rob.addSubModel(p2, t2); rob.endModel();
+  Box box (500, 200, 150);
+  Capsule capsule (100, 1000);
+
+  const CollisionGeometry* geoms[] = { &env, &rob, &box, &capsule };
+  std::vector<Transform3f> tf1, tf2;
+  FCL_REAL extents[] = {-3000, -3000, -3000, 3000, 3000, 3000};
+  std::size_t n = 20000;
+  generateRandomTransforms(extents, tf1, n);
+  generateRandomTransforms(extents, tf2, n);
+
+  std::vector<GeometryQuery> queries (n);
+  for (std::size_t i = 0; i < n; ++i)
+    queries[i] = GeometryQuery (geoms[(i / 4) % 2], tf1[i], geoms[i % 4],
+                                tf2[i]);
+
+  std::cout << queries.size() << " queries, up to " << max_threads
+    << " threads" << std::endl;
+  run<CollisionRequest, CollisionResult> (queries,
+      CollisionRequest (CONTACT, 1), max_threads, "collide");
+  run<DistanceRequest, DistanceResult> (queries,
+      DistanceRequest (true), max_threads, "distance");
+
+  return 0;
+}
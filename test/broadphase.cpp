@@ -41,18 +41,11 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/utility/binary.hpp>
 
-#include <hpp/fcl/config.h>
 #include <hpp/fcl/broadphase/broadphase.h>
 #include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
 #include <hpp/fcl/math/transform.h>
 #include "utility.h"
 
-#if USE_GOOGLEHASH
-#include <sparsehash/sparse_hash_map>
-#include <sparsehash/dense_hash_map>
-#include <hash_map>
-#endif
-
 #include <boost/math/constants/constants.hpp>
 #include <iostream>
 #include <iomanip>
@@ -100,20 +93,6 @@ void broad_phase_update_collision_test(double env_scale, std::size_t env_size, s
 FCL_REAL DELTA = 0.01;
 
 
-#if USE_GOOGLEHASH
-template<typename U, typename V>
-struct GoogleSparseHashTable : public google::sparse_hash_map<U, V, std::tr1::hash<size_t>, std::equal_to<size_t> > {};
-
-template<typename U, typename V>
-struct GoogleDenseHashTable : public google::dense_hash_map<U, V, std::tr1::hash<size_t>, std::equal_to<size_t> >
-{
-  GoogleDenseHashTable() : google::dense_hash_map<U, V, std::tr1::hash<size_t>, std::equal_to<size_t> >()
-  {
-    this->set_empty_key(NULL);
-  }
-};
-#endif
-
 /// check the update, only return collision or not
 BOOST_AUTO_TEST_CASE(test_core_bf_broad_phase_update_collision_binary)
 {
@@ -286,6 +265,105 @@ BOOST_AUTO_TEST_CASE(test_core_mesh_bf_broad_phase_collision_mesh_exhaustive)
 #endif
 }
 
+/// check that the overlapping pairs of sweep and prune are kept up to date
+/// by insertions, removals and incremental updates
+BOOST_AUTO_TEST_CASE(test_SaP_overlapping_pairs)
+{
+  std::vector<CollisionObject*> env;
+  generateEnvironments(env, 200, 100);
+
+  SaPCollisionManager manager;
+  std::vector<CollisionObject*> bulk (env.begin(), env.begin() + env.size() / 2);
+  manager.registerObjects(bulk);
+  for(std::size_t i = env.size() / 2; i < env.size(); ++i)
+    manager.registerObject(env[i]);
+
+  FCL_REAL delta_trans_max = 10;
+  for(int step = 0; step < 20; ++step)
+  {
+    // move a few objects
+    std::vector<CollisionObject*> moved;
+    for(std::size_t k = 0; k < 10; ++k)
+    {
+      CollisionObject* obj = env[rand() % env.size()];
+      Vec3f dT (2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max,
+                2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max,
+                2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max);
+      obj->setTranslation(obj->getTranslation() + dT);
+      obj->computeAABB();
+      moved.push_back(obj);
+    }
+    manager.update(moved);
+
+    // remove and insert back one object
+    if(step % 5 == 4)
+    {
+      CollisionObject* obj = env[rand() % env.size()];
+      manager.unregisterObject(obj);
+      BOOST_CHECK_EQUAL(manager.size(), env.size() - 1);
+      manager.registerObject(obj);
+    }
+
+    std::set<SaPCollisionManager::ObjectPair> expected;
+    for(std::size_t i = 0; i < env.size(); ++i)
+      for(std::size_t j = i + 1; j < env.size(); ++j)
+        if(env[i]->getAABB().overlap(env[j]->getAABB()))
+          expected.insert(env[i] < env[j] ? std::make_pair(env[i], env[j]) : std::make_pair(env[j], env[i]));
+
+    BOOST_CHECK(manager.getOverlappingPairs() == expected);
+  }
+
+  for(std::size_t i = 0; i < env.size(); ++i)
+    delete env[i];
+}
+
+/// collect the objects reported by the broad phase
+static bool collectObject(CollisionObject* o1, CollisionObject*, void* cdata)
+{
+  static_cast<std::set<CollisionObject*>*>(cdata)->insert(o1);
+  return false;
+}
+
+/// check that sweep and prune removes the right bounds when other objects
+/// have bounds at infinity
+BOOST_AUTO_TEST_CASE(test_SaP_unbounded_objects)
+{
+  std::vector<CollisionObject*> env;
+  generateEnvironments(env, 200, 10);
+  env.push_back(new CollisionObject(boost::shared_ptr<CollisionGeometry>
+                                    (new Halfspace(Vec3f(0, 0, 1), 0))));
+  env.push_back(new CollisionObject(boost::shared_ptr<CollisionGeometry>
+                                    (new Halfspace(Vec3f(1, 1, 1).normalized(), 0))));
+
+  SaPCollisionManager manager;
+  for(std::size_t i = 0; i < env.size(); ++i)
+    manager.registerObject(env[i]);
+
+  CollisionObject query (boost::shared_ptr<CollisionGeometry>(new Box(50, 50, 50)));
+  for(std::size_t k = 0; k < env.size() - 2; ++k)
+  {
+    manager.unregisterObject(env[k]);
+    BOOST_CHECK_EQUAL(manager.size(), env.size() - k - 1);
+
+    std::set<CollisionObject*> expected, reported;
+    for(std::size_t i = k + 1; i < env.size(); ++i)
+      if(env[i]->getAABB().overlap(query.getAABB()))
+        expected.insert(env[i]);
+    manager.collide(&query, &reported, collectObject);
+    BOOST_CHECK(reported == expected);
+
+    std::set<SaPCollisionManager::ObjectPair> pairs;
+    for(std::size_t i = k + 1; i < env.size(); ++i)
+      for(std::size_t j = i + 1; j < env.size(); ++j)
+        if(env[i]->getAABB().overlap(env[j]->getAABB()))
+          pairs.insert(env[i] < env[j] ? std::make_pair(env[i], env[j]) : std::make_pair(env[j], env[i]));
+    BOOST_CHECK(manager.getOverlappingPairs() == pairs);
+  }
+
+  for(std::size_t i = 0; i < env.size(); ++i)
+    delete env[i];
+}
+
 void generateEnvironments(std::vector<CollisionObject*>& env, double env_scale, std::size_t n)
 {
   FCL_REAL extents[] = {-env_scale, env_scale, -env_scale, env_scale, -env_scale, env_scale};
@@ -499,36 +577,9 @@ void broad_phase_collision_test(double env_scale, std::size_t env_size, std::siz
   std::vector<BroadPhaseCollisionManager*> managers;
   
   managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
   managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  // FCL_REAL ncell_per_axis = std::pow((FCL_REAL)env_size / 10, 1 / 3.0);
-  FCL_REAL ncell_per_axis = 20;
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / ncell_per_axis, (upper_limit[1] - lower_limit[1]) / ncell_per_axis), (upper_limit[2] - lower_limit[2]) / ncell_per_axis);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
   managers.push_back(new DynamicAABBTreeCollisionManager());
-
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  managers.push_back(new DynamicAABBTreeCollisionManager(0.01 * env_scale));
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -688,33 +739,9 @@ void broad_phase_self_distance_test(double env_scale, std::size_t env_size, bool
   std::vector<BroadPhaseCollisionManager*> managers;
   
   managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
   managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / 5, (upper_limit[1] - lower_limit[1]) / 5), (upper_limit[2] - lower_limit[2]) / 5);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
   managers.push_back(new DynamicAABBTreeCollisionManager());
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  managers.push_back(new DynamicAABBTreeCollisionManager(0.01 * env_scale));
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -831,33 +858,9 @@ void broad_phase_distance_test(double env_scale, std::size_t env_size, std::size
   std::vector<BroadPhaseCollisionManager*> managers;
 
   managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
   managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / 20, (upper_limit[1] - lower_limit[1]) / 20), (upper_limit[2] - lower_limit[2])/20);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
   managers.push_back(new DynamicAABBTreeCollisionManager());
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  managers.push_back(new DynamicAABBTreeCollisionManager(0.01 * env_scale));
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -960,35 +963,9 @@ void broad_phase_update_collision_test(double env_scale, std::size_t env_size, s
   std::vector<BroadPhaseCollisionManager*> managers;
   
   managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
-
-  
   managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / 20, (upper_limit[1] - lower_limit[1]) / 20), (upper_limit[2] - lower_limit[2])/20);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
   managers.push_back(new DynamicAABBTreeCollisionManager());
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  managers.push_back(new DynamicAABBTreeCollisionManager(0.01 * env_scale));
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -1021,13 +998,10 @@ void broad_phase_update_collision_test(double env_scale, std::size_t env_size, s
     FCL_REAL rand_angle_z = 2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_angle_max;
     FCL_REAL rand_trans_z = 2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max;
 
-    Quaternion3f q1, q2, q3;
-    q1.fromAxisAngle(Vec3f(1, 0, 0), rand_angle_x);
-    q2.fromAxisAngle(Vec3f(0, 1, 0), rand_angle_y);
-    q3.fromAxisAngle(Vec3f(0, 0, 1), rand_angle_z);
-    Quaternion3f q = q1 * q2 * q3;
-    Matrix3f dR;
-    q.toRotation(dR);
+    Quaternion3f q = fromAxisAngle(Vec3f(1, 0, 0), rand_angle_x)
+      * fromAxisAngle(Vec3f(0, 1, 0), rand_angle_y)
+      * fromAxisAngle(Vec3f(0, 0, 1), rand_angle_z);
+    Matrix3f dR (q.toRotationMatrix());
     Vec3f dT(rand_trans_x, rand_trans_y, rand_trans_z);
     
     Matrix3f R = env[i]->getRotation();
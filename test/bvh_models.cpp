@@ -44,14 +44,19 @@
 #include "fcl_resources/config.h"
 
 #include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
 #include <hpp/fcl/BVH/BVH_model.h>
 #include <hpp/fcl/BVH/BVH_utility.h>
+#include <hpp/fcl/internal/BV_splitter.h>
+#include <hpp/fcl/internal/intersect.h>
 #include <hpp/fcl/math/transform.h>
 #include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
 #include <hpp/fcl/mesh_loader/assimp.h>
 #include <hpp/fcl/mesh_loader/loader.h>
 #include "utility.h"
 #include <iostream>
+#include <algorithm>
 
 using namespace hpp::fcl;
 
@@ -340,3 +345,622 @@ BOOST_AUTO_TEST_CASE (gerard_bauzil)
   testLoadGerardBauzil<kIOS>();
   testLoadGerardBauzil<OBBRSS>();
 }
+
+/// Check that each primitive is in exactly one leaf, and that each inner
+/// node contains the primitives of its children.
+template<class BV>
+void checkHierarchy (const BVHModel<BV>& model, int num_primitives)
+{
+  BOOST_REQUIRE_EQUAL (model.getNumBVs(), 2 * num_primitives - 1);
+  std::vector<int> leaves (num_primitives, 0);
+  for (int i = 0; i < model.getNumBVs(); ++i) {
+    const BVNode<BV>& node = model.getBV(i);
+    if (node.isLeaf()) {
+      BOOST_CHECK_EQUAL (node.num_primitives, 1);
+      ++leaves[node.primitiveId()];
+    } else {
+      BOOST_CHECK (node.leftChild() > 0 && node.rightChild() < model.getNumBVs());
+      const BVNode<BV>& left = model.getBV(node.leftChild());
+      const BVNode<BV>& right = model.getBV(node.rightChild());
+      BOOST_CHECK_EQUAL (left.first_primitive, node.first_primitive);
+      BOOST_CHECK_EQUAL (right.first_primitive,
+                         left.first_primitive + left.num_primitives);
+      BOOST_CHECK_EQUAL (node.num_primitives,
+                         left.num_primitives + right.num_primitives);
+    }
+  }
+  for (int i = 0; i < num_primitives; ++i)
+    BOOST_CHECK_EQUAL (leaves[i], 1);
+}
+
+/// Check that two hierarchies are the same.
+template<class BV>
+void checkSameHierarchy (const BVHModel<BV>& a, const BVHModel<BV>& b)
+{
+  BOOST_REQUIRE_EQUAL (a.getNumBVs(), b.getNumBVs());
+  for (int i = 0; i < a.getNumBVs(); ++i) {
+    BOOST_CHECK_EQUAL (a.getBV(i).first_child, b.getBV(i).first_child);
+    BOOST_CHECK_EQUAL (a.getBV(i).first_primitive, b.getBV(i).first_primitive);
+    BOOST_CHECK_EQUAL (a.getBV(i).num_primitives, b.getBV(i).num_primitives);
+    BOOST_CHECK (a.getBV(i).bv.center() == b.getBV(i).bv.center());
+  }
+}
+
+template<class BV>
+void testSplitMethods ()
+{
+  // Large enough for the top levels to be built in parallel.
+  Sphere sphere (1);
+  SplitMethodType methods[] = { SPLIT_METHOD_MEAN, SPLIT_METHOD_MEDIAN,
+    SPLIT_METHOD_BV_CENTER, SPLIT_METHOD_BINNED_SAH };
+
+  for (int k = 0; k < 4; ++k) {
+    BVHModel<BV> sequential, parallel;
+    sequential.bv_splitter.reset (new BVSplitter<BV> (methods[k]));
+    parallel.bv_splitter.reset (new BVSplitter<BV> (methods[k]));
+    sequential.num_build_threads = 1;
+    parallel.num_build_threads = 4;
+    generateBVHModel (sequential, sphere, Transform3f(), 100, 100);
+    generateBVHModel (parallel, sphere, Transform3f(), 100, 100);
+
+    // The layout does not depend on the number of threads.
+    checkHierarchy (sequential, sequential.num_tris);
+    checkSameHierarchy (sequential, parallel);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(split_methods)
+{
+  testSplitMethods<AABB>();
+  testSplitMethods<OBB>();
+  testSplitMethods<RSS>();
+  testSplitMethods<kIOS>();
+  testSplitMethods<OBBRSS>();
+  testSplitMethods<KDOP<16> >();
+}
+
+template<class BV>
+void testLinearBuild ()
+{
+  Sphere sphere (1);
+  BVHModel<BV> top_down, sequential, parallel;
+  sequential.build_method = parallel.build_method = BVH_BUILD_LINEAR;
+  sequential.num_build_threads = 1;
+  parallel.num_build_threads = 4;
+  generateBVHModel (top_down, sphere, Transform3f(), 100, 100);
+  generateBVHModel (sequential, sphere, Transform3f(), 100, 100);
+  generateBVHModel (parallel, sphere, Transform3f(), 100, 100);
+
+  checkHierarchy (sequential, sequential.num_tris);
+  checkSameHierarchy (sequential, parallel);
+
+  // Same collisions as with the default hierarchy.
+  Box box (0.1, 0.2, 0.3);
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1.2, -1.2, -1.2, 1.2, 1.2, 1.2};
+  generateRandomTransforms (extents, transforms, 200);
+  CollisionRequest request (NO_REQUEST, 1000);
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    CollisionResult result1, result2;
+    collide (&top_down, Transform3f(), &box, transforms[i], request, result1);
+    collide (&sequential, Transform3f(), &box, transforms[i], request, result2);
+    BOOST_CHECK_EQUAL (result1.numContacts(), result2.numContacts());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(linear_build)
+{
+  testLinearBuild<AABB>();
+  testLinearBuild<OBB>();
+  testLinearBuild<RSS>();
+  testLinearBuild<OBBRSS>();
+  testLinearBuild<KDOP<24> >();
+
+  // Point cloud, with duplicated points.
+  std::vector<Vec3f> points;
+  for (int i = 0; i < 20000; ++i)
+    points.push_back (Vec3f (rand() % 100, rand() % 100, 0));
+  BVHModel<AABB> model;
+  model.build_method = BVH_BUILD_LINEAR;
+  model.beginModel ();
+  model.addSubModel (points);
+  model.endModel ();
+  checkHierarchy (model, (int)points.size());
+  for (int i = 0; i < model.getNumBVs(); ++i) {
+    const BVNode<AABB>& node = model.getBV(i);
+    if (node.isLeaf())
+      BOOST_CHECK (node.bv.contain (points[node.primitiveId()]));
+    else
+      BOOST_CHECK (node.bv.contain (model.getBV(node.leftChild()).bv)
+                   && node.bv.contain (model.getBV(node.rightChild()).bv));
+  }
+}
+
+void updateModel (BVHModel<AABB>& model, const std::vector<Vec3f>& vertices,
+                  bool bottomup)
+{
+  model.beginUpdateModel ();
+  model.updateSubModel (vertices);
+  model.endUpdateModel (true, bottomup);
+}
+
+/// Check that the bottom-up refit gives the same boxes as the top-down one,
+/// which fits every node to its primitives.
+void checkSameBoxes (const BVHModel<AABB>& a, const BVHModel<AABB>& b)
+{
+  BOOST_REQUIRE_EQUAL (a.getNumBVs(), b.getNumBVs());
+  for (int i = 0; i < a.getNumBVs(); ++i) {
+    BOOST_CHECK (a.getBV(i).bv.min_ == b.getBV(i).bv.min_);
+    BOOST_CHECK (a.getBV(i).bv.max_ == b.getBV(i).bv.max_);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(refit)
+{
+  // Large enough for the levels to be refitted in parallel.
+  Sphere sphere (1);
+  BVHModel<AABB> sequential, parallel, top_down;
+  sequential.num_build_threads = 1;
+  parallel.num_build_threads = 4;
+  generateBVHModel (sequential, sphere, Transform3f(), 200, 200);
+  generateBVHModel (parallel, sphere, Transform3f(), 200, 200);
+  generateBVHModel (top_down, sphere, Transform3f(), 200, 200);
+  std::vector<Vec3f> vertices (sequential.vertices,
+                               sequential.vertices + sequential.num_vertices);
+
+  // All the vertices move.
+  for (std::size_t i = 0; i < vertices.size(); ++i)
+    vertices[i] *= 1.1;
+  updateModel (sequential, vertices, true);
+  updateModel (parallel, vertices, true);
+  updateModel (top_down, vertices, false);
+  checkSameBoxes (sequential, top_down);
+  checkSameBoxes (parallel, top_down);
+
+  // A few vertices move, then none: only the nodes above them are refitted.
+  for (int frame = 0; frame < 3; ++frame) {
+    if (frame != 1) {
+      for (int k = 0; k < 10; ++k)
+        vertices[rand() % vertices.size()] += Vec3f (0.1, -0.2, 0.3);
+    }
+    updateModel (sequential, vertices, true);
+    updateModel (top_down, vertices, false);
+    checkSameBoxes (sequential, top_down);
+  }
+}
+
+/// Whether a volume contains a point, when the volume exports the test.
+template<class BV>
+bool contains (const BV&, const Vec3f&) { return true; }
+bool contains (const AABB& bv, const Vec3f& p) { return bv.contain (p); }
+bool contains (const OBB& bv, const Vec3f& p) { return bv.contain (p); }
+bool contains (const OBBRSS& bv, const Vec3f& p) { return bv.obb.contain (p); }
+
+template<class BV>
+void testNodeLayout ()
+{
+  Sphere sphere (1);
+  Box box (0.4, 0.6, 0.8);
+  BVHModel<BV> nodes1, split1, nodes2, split2;
+  generateBVHModel (nodes1, sphere, Transform3f(), 40, 40);
+  generateBVHModel (split1, sphere, Transform3f(), 40, 40);
+  generateBVHModel (nodes2, box, Transform3f());
+  generateBVHModel (split2, box, Transform3f());
+  split1.setNodeLayout (BVH_LAYOUT_SPLIT);
+  split2.setNodeLayout (BVH_LAYOUT_SPLIT);
+  BOOST_CHECK_EQUAL (split1.getNodeLayout(), BVH_LAYOUT_SPLIT);
+
+  // Same hierarchy, and the volumes of the leaves contain their triangle.
+  for (int i = 0; i < split1.getNumBVs(); ++i) {
+    const BVNode<BV>& node = nodes1.getBV(i);
+    BOOST_CHECK_EQUAL (split1.isLeaf(i), node.isLeaf());
+    if (!node.isLeaf()) {
+      BOOST_CHECK_EQUAL (split1.leftChild(i), node.leftChild());
+      continue;
+    }
+    BOOST_CHECK_EQUAL (split1.primitiveId(i), node.primitiveId());
+    BV buffer;
+    const BV& bv = split1.getVolume(i, buffer);
+    const Triangle& t = split1.tri_indices[node.primitiveId()];
+    for (int k = 0; k < 3; ++k)
+      BOOST_CHECK (contains (bv, split1.vertices[t[k]]));
+  }
+
+  // Same results with both layouts.
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1.5, -1.5, -1.5, 1.5, 1.5, 1.5};
+  generateRandomTransforms (extents, transforms, 200);
+  CollisionRequest request (CONTACT, 1000);
+  DistanceRequest drequest (true);
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    CollisionResult result1, result2;
+    collide (&nodes1, Transform3f(), &nodes2, transforms[i], request, result1);
+    collide (&split1, Transform3f(), &split2, transforms[i], request, result2);
+    BOOST_CHECK_EQUAL (result1.numContacts(), result2.numContacts());
+
+    CollisionResult result3, result4;
+    collide (&nodes1, Transform3f(), &box, transforms[i], request, result3);
+    collide (&split1, Transform3f(), &box, transforms[i], request, result4);
+    BOOST_CHECK_EQUAL (result3.numContacts(), result4.numContacts());
+
+    DistanceResult dresult1, dresult2;
+    distance (&nodes1, Transform3f(), &nodes2, transforms[i], drequest, dresult1);
+    distance (&split1, Transform3f(), &split2, transforms[i], drequest, dresult2);
+    BOOST_CHECK_CLOSE (dresult1.min_distance, dresult2.min_distance, 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(node_layout)
+{
+  testNodeLayout<AABB>();
+  testNodeLayout<OBB>();
+  testNodeLayout<RSS>();
+  testNodeLayout<kIOS>();
+  testNodeLayout<OBBRSS>();
+}
+
+/// Leaves of the binary hierarchy under the wide node w.
+template<typename BV>
+void wideLeaves (const BVHModel<BV>& model, int w, std::vector<int>& leaves)
+{
+  const details::WideNode<BV>& node = model.getWideNodes()[w];
+  BOOST_CHECK (node.num_children >= 2 && node.num_children <= 4);
+  for (int i = 0; i < node.num_children; ++i) {
+    if (node.wide_children[i] < 0) {
+      BOOST_CHECK (model.isLeaf (node.children[i]));
+      leaves.push_back (node.children[i]);
+    } else
+      wideLeaves (model, node.wide_children[i], leaves);
+  }
+}
+
+/// Sorted pairs of primitives in contact.
+void contactPairs (const CollisionResult& result,
+                   std::vector<std::pair<int, int> >& pairs)
+{
+  pairs.clear();
+  for (std::size_t i = 0; i < result.numContacts(); ++i)
+    pairs.push_back (std::make_pair (result.getContact(i).b1,
+                                     result.getContact(i).b2));
+  std::sort (pairs.begin(), pairs.end());
+}
+
+/// The merge of two oriented volumes, used by the bottom-up refit, may not
+/// contain them. The wide hierarchy skips some of these merges, so that
+/// contacts after such a refit are compared for AABB only.
+template<typename BV>
+void testWideNodes (bool testRefit)
+{
+  Sphere sphere1 (1), sphere2 (0.6);
+  Box box (0.4, 0.6, 0.8);
+  BVHModel<BV> nodes1, wide1, nodes2, wide2;
+  generateBVHModel (nodes1, sphere1, Transform3f(), 40, 40);
+  generateBVHModel (wide1, sphere1, Transform3f(), 40, 40);
+  generateBVHModel (nodes2, sphere2, Transform3f(), 20, 20);
+  generateBVHModel (wide2, sphere2, Transform3f(), 20, 20);
+  wide1.setNodeLayout (BVH_LAYOUT_WIDE);
+  wide2.setNodeLayout (BVH_LAYOUT_WIDE);
+  BOOST_CHECK (nodes1.getWideNodes() == NULL);
+  BOOST_REQUIRE (wide1.getWideNodes() != NULL);
+
+  // The wide hierarchy reaches each leaf once.
+  std::vector<int> leaves, expected;
+  wideLeaves (wide1, 0, leaves);
+  for (int i = 0; i < wide1.getNumBVs(); ++i)
+    if (wide1.isLeaf (i)) expected.push_back (i);
+  std::sort (leaves.begin(), leaves.end());
+  BOOST_CHECK (leaves == expected);
+
+  // Same contacts with both layouts, before and after a refit.
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1.5, -1.5, -1.5, 1.5, 1.5, 1.5};
+  generateRandomTransforms (extents, transforms, 200);
+  CollisionRequest request (CONTACT, 100000);
+  CollisionRequest first (CONTACT, 1);
+  std::vector<std::pair<int, int> > pairs1, pairs2;
+  for (int refit = 0; refit < (testRefit ? 2 : 1); ++refit) {
+    if (refit) {
+      std::vector<Vec3f> vertices (wide1.vertices,
+                                   wide1.vertices + wide1.num_vertices);
+      for (std::size_t i = 0; i < vertices.size(); ++i)
+        vertices[i] *= 1 + 0.2 * vertices[i][2];
+      nodes1.beginUpdateModel(); nodes1.updateSubModel (vertices);
+      nodes1.endUpdateModel (true, true);
+      wide1.beginUpdateModel(); wide1.updateSubModel (vertices);
+      wide1.endUpdateModel (true, true);
+    }
+    for (std::size_t i = 0; i + 1 < transforms.size(); ++i) {
+      // An updated model can not be replaced, which the collision of AABB
+      // models does to move the vertices.
+      const Transform3f tf1 = refit ? Transform3f() : transforms[i];
+      const Transform3f& tf2 = transforms[i+1];
+      CollisionResult result1, result2;
+      collide (&nodes1, tf1, &nodes2, tf2, request, result1);
+      collide (&wide1, tf1, &wide2, tf2, request, result2);
+      contactPairs (result1, pairs1);
+      contactPairs (result2, pairs2);
+      BOOST_CHECK (pairs1 == pairs2);
+
+      CollisionResult result3, result4;
+      collide (&nodes1, tf1, &box, tf2, request, result3);
+      collide (&wide1, tf1, &box, tf2, request, result4);
+      contactPairs (result3, pairs1);
+      contactPairs (result4, pairs2);
+      BOOST_CHECK (pairs1 == pairs2);
+
+      // Early stop
+      CollisionResult result5;
+      collide (&wide1, tf1, &wide2, tf2, first, result5);
+      BOOST_CHECK_EQUAL (result5.isCollision(), result1.isCollision());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(wide_nodes)
+{
+  testWideNodes<AABB>(true);
+  testWideNodes<OBB>(false);
+  testWideNodes<RSS>(false);
+  testWideNodes<OBBRSS>(false);
+}
+
+BOOST_AUTO_TEST_CASE(quantized_nodes)
+{
+  Sphere sphere1 (1), sphere2 (0.6);
+  Box box (0.4, 0.6, 0.8);
+  BVHModel<AABB> nodes1, quantized1, nodes2, quantized2;
+  generateBVHModel (nodes1, sphere1, Transform3f(), 40, 40);
+  generateBVHModel (quantized1, sphere1, Transform3f(), 40, 40);
+  generateBVHModel (nodes2, sphere2, Transform3f(), 20, 20);
+  generateBVHModel (quantized2, sphere2, Transform3f(), 20, 20);
+  quantized1.setNodeLayout (BVH_LAYOUT_QUANTIZED);
+  quantized2.setNodeLayout (BVH_LAYOUT_QUANTIZED);
+  BOOST_CHECK_EQUAL (quantized1.getNodeLayout(), BVH_LAYOUT_QUANTIZED);
+  BOOST_REQUIRE (quantized1.getQuantizedNodes() != NULL);
+
+  // Only AABB models support the quantized layout.
+  BVHModel<OBB> obb;
+  generateBVHModel (obb, box, Transform3f());
+  obb.setNodeLayout (BVH_LAYOUT_QUANTIZED);
+  BOOST_CHECK_EQUAL (obb.getNodeLayout(), BVH_LAYOUT_NODES);
+
+  // Same hierarchy, and the decoded boxes contain the original ones and the
+  // boxes of the children.
+  for (int i = 0; i < quantized1.getNumBVs(); ++i) {
+    const BVNode<AABB>& node = nodes1.getBV(i);
+    BOOST_CHECK_EQUAL (quantized1.isLeaf(i), node.isLeaf());
+    AABB buffer, left, right;
+    const AABB& bv = quantized1.getVolume(i, buffer);
+    BOOST_CHECK (bv.contain (node.bv));
+    if (node.isLeaf()) {
+      BOOST_CHECK_EQUAL (quantized1.primitiveId(i), node.primitiveId());
+      continue;
+    }
+    BOOST_CHECK_EQUAL (quantized1.leftChild(i), node.leftChild());
+    BOOST_CHECK (bv.contain (quantized1.getVolume(node.leftChild(), left)));
+    BOOST_CHECK (bv.contain (quantized1.getVolume(node.rightChild(), right)));
+  }
+
+  // Same results with both layouts.
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1.5, -1.5, -1.5, 1.5, 1.5, 1.5};
+  generateRandomTransforms (extents, transforms, 100);
+  CollisionRequest request (CONTACT, 100000);
+  CollisionRequest first (CONTACT, 1);
+  DistanceRequest drequest (true);
+  std::vector<std::pair<int, int> > pairs1, pairs2;
+  for (std::size_t i = 0; i + 1 < transforms.size(); ++i) {
+    const Transform3f& tf1 = transforms[i];
+    const Transform3f& tf2 = transforms[i+1];
+    CollisionResult result1, result2;
+    collide (&nodes1, tf1, &nodes2, tf2, request, result1);
+    collide (&quantized1, tf1, &quantized2, tf2, request, result2);
+    contactPairs (result1, pairs1);
+    contactPairs (result2, pairs2);
+    BOOST_CHECK (pairs1 == pairs2);
+
+    CollisionResult result3, result4;
+    collide (&nodes1, tf1, &box, tf2, request, result3);
+    collide (&quantized1, tf1, &box, tf2, request, result4);
+    contactPairs (result3, pairs1);
+    contactPairs (result4, pairs2);
+    BOOST_CHECK (pairs1 == pairs2);
+
+    // Early stop
+    CollisionResult result5;
+    collide (&quantized1, tf1, &quantized2, tf2, first, result5);
+    BOOST_CHECK_EQUAL (result5.isCollision(), result1.isCollision());
+
+    DistanceResult dresult1, dresult2;
+    distance (&nodes1, tf1, &nodes2, tf2, drequest, dresult1);
+    distance (&quantized1, tf1, &quantized2, tf2, drequest, dresult2);
+    BOOST_CHECK_CLOSE (dresult1.min_distance, dresult2.min_distance, 1e-8);
+  }
+
+  // The boxes are already relative to their parent.
+  quantized1.makeParentRelative ();
+  BOOST_CHECK (quantized1.getQuantizedNodes() != NULL);
+
+  // The nodes are rebuilt when leaving the quantized layout.
+  quantized1.setNodeLayout (BVH_LAYOUT_NODES);
+  BOOST_CHECK (quantized1.getQuantizedNodes() == NULL);
+  checkSameBoxes (nodes1, quantized1);
+}
+
+int depth (const BVHModel<AABB>& model, int i)
+{
+  if (model.isLeaf(i)) return 0;
+  return 1 + std::max (depth (model, model.leftChild(i)),
+                       depth (model, model.rightChild(i)));
+}
+
+BOOST_AUTO_TEST_CASE(deep_hierarchy)
+{
+  // Triangle k lies at a distance k! from the origin. The mean split then
+  // separates the last triangle from the others, so that the depth of the
+  // hierarchy exceeds the stack of the traversal.
+  const int n = 100;
+  std::vector<Vec3f> vertices;
+  std::vector<Triangle> triangles;
+  FCL_REAL x = 1;
+  for (int k = 0; k < n; ++k) {
+    x *= k + 1;
+    vertices.push_back (Vec3f (x, 0, 0));
+    vertices.push_back (Vec3f (1.5 * x, 0, 0));
+    vertices.push_back (Vec3f (x, 0.5 * x, 0));
+    triangles.push_back (Triangle (3 * k, 3 * k + 1, 3 * k + 2));
+  }
+  BVHModel<AABB> model1, model2;
+  model1.bv_splitter.reset (new BVSplitter<AABB> (SPLIT_METHOD_MEAN));
+  model2.bv_splitter.reset (new BVSplitter<AABB> (SPLIT_METHOD_MEAN));
+  model1.beginModel (); model1.addSubModel (vertices, triangles); model1.endModel ();
+  model2.beginModel (); model2.addSubModel (vertices, triangles); model2.endModel ();
+  BOOST_REQUIRE (depth (model1, 0) > 64);
+
+  // Each triangle only touches its copy.
+  CollisionRequest request (CONTACT, 1000);
+  CollisionResult result;
+  collide (&model1, Transform3f(), &model2, Transform3f(), request, result);
+  std::vector<std::pair<int, int> > pairs;
+  contactPairs (result, pairs);
+  BOOST_REQUIRE_EQUAL (pairs.size(), (std::size_t)n);
+  for (int k = 0; k < n; ++k)
+    BOOST_CHECK (pairs[k] == std::make_pair (k, k));
+
+  // Early stop
+  CollisionRequest first (CONTACT, 1);
+  CollisionResult result1;
+  collide (&model1, Transform3f(), &model2, Transform3f(), first, result1);
+  BOOST_CHECK_EQUAL (result1.numContacts(), 1);
+}
+
+template<typename BV>
+void testParallelCollision ()
+{
+  Sphere sphere1 (1), sphere2 (0.6);
+  BVHModel<BV> model1, model2;
+  generateBVHModel (model1, sphere1, Transform3f(), 40, 40);
+  generateBVHModel (model2, sphere2, Transform3f(), 20, 20);
+
+  // Same contacts with any number of threads, sorted.
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1.5, -1.5, -1.5, 1.5, 1.5, 1.5};
+  generateRandomTransforms (extents, transforms, 50);
+  CollisionRequest request (CONTACT, 100000);
+  unsigned int num_threads[] = { 2, 4, 0 };
+  std::vector<std::pair<int, int> > pairs1, pairs2;
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    const Transform3f tf1;
+    CollisionResult result1;
+    request.num_threads = 1;
+    collide (&model1, tf1, &model2, transforms[i], request, result1);
+    contactPairs (result1, pairs1);
+    for (int k = 0; k < 3; ++k) {
+      request.num_threads = num_threads[k];
+      CollisionResult result2;
+      collide (&model1, tf1, &model2, transforms[i], request, result2);
+      BOOST_REQUIRE_EQUAL (result2.numContacts(), result1.numContacts());
+      for (std::size_t j = 0; j < result2.numContacts(); ++j)
+        BOOST_CHECK (result2.getContact(j).b1 == pairs1[j].first &&
+                     result2.getContact(j).b2 == pairs1[j].second);
+    }
+
+    // Early stop
+    CollisionRequest first (CONTACT, 1);
+    first.num_threads = 4;
+    CollisionResult result3;
+    collide (&model1, tf1, &model2, transforms[i], first, result3);
+    BOOST_CHECK_EQUAL (result3.isCollision(), result1.isCollision());
+    BOOST_CHECK (result3.numContacts() <= 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_collision)
+{
+  testParallelCollision<AABB>();
+  testParallelCollision<OBBRSS>();
+}
+
+/// Compare distance with brute force, between two meshes and, when the
+/// distance with shapes is implemented for BV, between a mesh and a box.
+template<typename BV>
+void testOrderedDistance (bool testShape)
+{
+  Sphere sphere1 (1), sphere2 (0.6);
+  Box box (0.5, 1, 1.5);
+  BVHModel<BV> model1, model2;
+  generateBVHModel (model1, sphere1, Transform3f(), 12, 12);
+  generateBVHModel (model2, sphere2, Transform3f(), 8, 8);
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-4, -4, -4, 4, 4, 4};
+  generateRandomTransforms (extents, transforms, 20);
+  GJKSolver solver;
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    const Transform3f& tf = transforms[i];
+
+    // Closest pair of triangles, by brute force.
+    FCL_REAL exact = std::numeric_limits<FCL_REAL>::max();
+    Vec3f P1, P2;
+    for (int k1 = 0; k1 < model1.num_tris; ++k1) {
+      const Triangle& t1 = model1.tri_indices[k1];
+      for (int k2 = 0; k2 < model2.num_tris; ++k2) {
+        const Triangle& t2 = model2.tri_indices[k2];
+        FCL_REAL d = sqrt (TriangleDistance::sqrTriDistance
+          (model1.vertices[t1[0]], model1.vertices[t1[1]],
+           model1.vertices[t1[2]], tf.transform (model2.vertices[t2[0]]),
+           tf.transform (model2.vertices[t2[1]]),
+           tf.transform (model2.vertices[t2[2]]), P1, P2));
+        exact = std::min (exact, d);
+      }
+    }
+
+    DistanceResult result;
+    distance (&model1, Transform3f(), &model2, tf, DistanceRequest(), result);
+    BOOST_CHECK_SMALL (result.min_distance - exact, 1e-8);
+
+    DistanceRequest approximate (false, 0.1, 0.1);
+    DistanceResult result1;
+    distance (&model1, Transform3f(), &model2, tf, approximate, result1);
+    BOOST_CHECK (result1.min_distance >= exact - 1e-8);
+    BOOST_CHECK (result1.min_distance <= 1.1 * exact + 1e-8);
+    BOOST_CHECK (result1.min_distance <= exact + 0.1 + 1e-8);
+
+    // An upper bound below the distance leaves the result unchanged.
+    if (exact > 0.1) {
+      DistanceResult result2 (exact - 0.1);
+      distance (&model1, Transform3f(), &model2, tf, DistanceRequest(), result2);
+      BOOST_CHECK_EQUAL (result2.min_distance, exact - 0.1);
+      BOOST_CHECK (result2.o1 == NULL);
+    }
+    DistanceResult result3 (exact + 0.1);
+    distance (&model1, Transform3f(), &model2, tf, DistanceRequest(), result3);
+    BOOST_CHECK_SMALL (result3.min_distance - exact, 1e-8);
+
+    if (!testShape) continue;
+    // Closest triangle to a box.
+    exact = std::numeric_limits<FCL_REAL>::max();
+    for (int k1 = 0; k1 < model1.num_tris; ++k1) {
+      const Triangle& t1 = model1.tri_indices[k1];
+      FCL_REAL d;
+      Vec3f normal;
+      solver.shapeTriangleInteraction (box, tf, model1.vertices[t1[0]],
+          model1.vertices[t1[1]], model1.vertices[t1[2]], Transform3f(), d,
+          P2, P1, normal);
+      exact = std::min (exact, d);
+    }
+    DistanceResult result4;
+    distance (&model1, Transform3f(), &box, tf, DistanceRequest(), result4);
+    if (exact > 0)
+      BOOST_CHECK_SMALL (result4.min_distance - exact, 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ordered_distance)
+{
+  testOrderedDistance<AABB>(false);
+  testOrderedDistance<OBB>(false);
+  testOrderedDistance<RSS>(true);
+  testOrderedDistance<kIOS>(true);
+  testOrderedDistance<OBBRSS>(true);
+}
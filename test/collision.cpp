@@ -53,6 +53,7 @@
 #include <hpp/fcl/shape/geometric_shapes.h>
 #include <hpp/fcl/narrowphase/narrowphase.h>
 #include <hpp/fcl/mesh_loader/assimp.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
 
 #include <hpp/fcl/internal/traversal_node_bvhs.h>
 #include <hpp/fcl/internal/traversal_node_setup.h>
@@ -653,3 +654,53 @@ BOOST_AUTO_TEST_CASE(mesh_mesh_benchmark)
   bench_stream = NULL;
   ofs.close();
 }
+
+BOOST_AUTO_TEST_CASE(compute_collision_batch)
+{
+  std::vector<Transform3f> tf1, tf2;
+  FCL_REAL extents[] = {-3, -3, -3, 3, 3, 3};
+  std::size_t n = 500;
+  generateRandomTransforms(extents, tf1, n);
+  generateRandomTransforms(extents, tf2, n);
+
+  Box box (1, 2, 1);
+  Capsule capsule (0.5, 1);
+  BVHModel<OBBRSS> mesh;
+  generateBVHModel(mesh, Sphere (1), Transform3f(), 16, 16);
+
+  CollisionRequest request (CONTACT, 1);
+  const CollisionGeometry* pairs[][2] = {
+    { &box, &capsule }, { &mesh, &box }, { &capsule, &mesh } };
+
+  for (std::size_t k = 0; k < 3; ++k) {
+    const CollisionGeometry* o1 = pairs[k][0];
+    const CollisionGeometry* o2 = pairs[k][1];
+    ComputeCollision compute (o1, o2);
+    BOOST_REQUIRE (compute.isSupported ());
+
+    std::vector<CollisionResult> results (n);
+    BOOST_CHECK_EQUAL (compute (&tf1[0], &tf2[0], n, request, &results[0]), n);
+
+    std::size_t first_collision = n;
+    for (std::size_t i = 0; i < n; ++i) {
+      CollisionResult result;
+      collide (o1, tf1[i], o2, tf2[i], request, result);
+      BOOST_REQUIRE_EQUAL (result.numContacts (), results[i].numContacts ());
+      if (result.isCollision ()) {
+        const Contact& c = result.getContact (0), cb = results[i].getContact (0);
+        BOOST_CHECK (c.o1 == o1 && cb.o1 == o1);
+        BOOST_CHECK_EQUAL (c.b1, cb.b1);
+        BOOST_CHECK_EQUAL (c.b2, cb.b2);
+        BOOST_CHECK (c.normal.isApprox (cb.normal));
+        if (first_collision == n) first_collision = i;
+      }
+    }
+    BOOST_REQUIRE (first_collision < n);
+
+    // Stop at the first pose in collision.
+    std::size_t checked = compute (&tf1[0], &tf2[0], n, request, &results[0],
+                                   true);
+    BOOST_CHECK_EQUAL (checked, first_collision + 1);
+    BOOST_CHECK (results[first_collision].isCollision ());
+  }
+}
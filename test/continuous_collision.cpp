@@ -0,0 +1,216 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_MODULE FCL_CONTINUOUS_COLLISION
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/fcl/continuous_collision.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
+
+#include "utility.h"
+
+using namespace hpp::fcl;
+
+Transform3f interpolate(const Transform3f& tf_beg, const Transform3f& tf_end, FCL_REAL t)
+{
+  return Transform3f(tf_beg.getQuatRotation().slerp(t, tf_end.getQuatRotation()),
+                     (1 - t) * tf_beg.getTranslation() + t * tf_end.getTranslation());
+}
+
+/// Check that the objects are free along the motion before the time of
+/// contact, and in contact at the time of contact.
+void checkContinuousCollision(const CollisionGeometry* o1, const Transform3f& tf1_beg, const Transform3f& tf1_end,
+                              const CollisionGeometry* o2, const Transform3f& tf2_beg, const Transform3f& tf2_end,
+                              ContinuousCollisionResult& result)
+{
+  ContinuousCollisionRequest request;
+  FCL_REAL t = continuousCollide(o1, tf1_beg, tf1_end, o2, tf2_beg, tf2_end, request, result);
+  BOOST_CHECK_EQUAL(t, result.time_of_contact);
+  BOOST_CHECK(t >= 0 && t <= 1);
+
+  const std::size_t n = 50;
+  for(std::size_t i = 0; t > 0 && i < n; ++i)
+  {
+    FCL_REAL s = t * (FCL_REAL)i / (FCL_REAL)n;
+    CollisionRequest collision_request;
+    CollisionResult collision_result;
+    collide(o1, interpolate(tf1_beg, tf1_end, s), o2, interpolate(tf2_beg, tf2_end, s),
+            collision_request, collision_result);
+    BOOST_CHECK(!collision_result.isCollision());
+  }
+
+  if(result.is_collide)
+  {
+    DistanceResult distance_result;
+    FCL_REAL d = distance(o1, result.contact_tf1, o2, result.contact_tf2,
+                          DistanceRequest(true), distance_result);
+    BOOST_CHECK(d <= request.toc_err);
+    BOOST_CHECK(result.contact_tf1.getTranslation().isApprox(interpolate(tf1_beg, tf1_end, t).getTranslation()));
+    BOOST_CHECK(result.contact_tf2.getTranslation().isApprox(interpolate(tf2_beg, tf2_end, t).getTranslation()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sphere_sphere)
+{
+  Sphere s1(1), s2(1);
+  ContinuousCollisionResult result;
+  checkContinuousCollision(&s1, Transform3f(), Transform3f(),
+                           &s2, Transform3f(Vec3f(5, 0, 0)), Transform3f(Vec3f(-5, 0, 0)),
+                           result);
+  BOOST_CHECK(result.is_collide);
+  BOOST_CHECK_CLOSE(result.time_of_contact, 0.3, 1e-1);
+  BOOST_CHECK(result.contact_point.isApprox(Vec3f(1, 0, 0), 1e-4));
+  BOOST_CHECK(result.normal.isApprox(Vec3f(1, 0, 0), 1e-6));
+
+  // The objects pass by each other.
+  checkContinuousCollision(&s1, Transform3f(), Transform3f(),
+                           &s2, Transform3f(Vec3f(5, 2.5, 0)), Transform3f(Vec3f(-5, 2.5, 0)),
+                           result);
+  BOOST_CHECK(!result.is_collide);
+  BOOST_CHECK_EQUAL(result.time_of_contact, 1);
+
+  // The objects are in collision at the start.
+  checkContinuousCollision(&s1, Transform3f(), Transform3f(),
+                           &s2, Transform3f(Vec3f(1, 0, 0)), Transform3f(Vec3f(-5, 0, 0)),
+                           result);
+  BOOST_CHECK(result.is_collide);
+  BOOST_CHECK_EQUAL(result.time_of_contact, 0);
+}
+
+template<typename BV>
+void testMeshShape()
+{
+  BVHModel<BV> mesh;
+  generateBVHModel(mesh, Box(2, 2, 2), Transform3f());
+  Sphere sphere(0.5);
+  ContinuousCollisionResult result;
+
+  checkContinuousCollision(&mesh, Transform3f(), Transform3f(),
+                           &sphere, Transform3f(Vec3f(5, 0, 0)), Transform3f(Vec3f(-5, 0, 0)),
+                           result);
+  BOOST_CHECK(result.is_collide);
+  BOOST_CHECK_CLOSE(result.time_of_contact, 0.35, 1e-1);
+  BOOST_CHECK(result.contact_point.isApprox(Vec3f(1, 0, 0), 1e-4));
+  BOOST_CHECK(result.normal.isApprox(Vec3f(1, 0, 0), 1e-6));
+
+  // Same motion, with the shape first.
+  checkContinuousCollision(&sphere, Transform3f(Vec3f(5, 0, 0)), Transform3f(Vec3f(-5, 0, 0)),
+                           &mesh, Transform3f(), Transform3f(),
+                           result);
+  BOOST_CHECK(result.is_collide);
+  BOOST_CHECK_CLOSE(result.time_of_contact, 0.35, 1e-1);
+  BOOST_CHECK(result.normal.isApprox(Vec3f(-1, 0, 0), 1e-6));
+
+  // A thin plate goes through the sphere between the two poses: the
+  // collision is missed by discrete checks at the ends of the motion.
+  BVHModel<BV> plate;
+  generateBVHModel(plate, Box(0.1, 2, 2), Transform3f());
+  checkContinuousCollision(&plate, Transform3f(Vec3f(-5, 0, 0)), Transform3f(Vec3f(5, 0, 0)),
+                           &sphere, Transform3f(), Transform3f(),
+                           result);
+  BOOST_CHECK(result.is_collide);
+  BOOST_CHECK_CLOSE(result.time_of_contact, 0.445, 1e-1);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_shape)
+{
+  testMeshShape<RSS>();
+  testMeshShape<OBBRSS>();
+}
+
+template<typename BV>
+void testMeshMesh()
+{
+  BVHModel<BV> bar, ball;
+  generateBVHModel(bar, Box(4, 0.2, 0.2), Transform3f());
+  generateBVHModel(ball, Sphere(0.2), Transform3f(), 16, 16);
+  ContinuousCollisionResult result;
+
+  // The bar turns by a quarter of a turn around z and hits the ball.
+  Matrix3f R;
+  R = Eigen::AngleAxis<FCL_REAL>(M_PI / 2, Vec3f::UnitZ());
+  checkContinuousCollision(&bar, Transform3f(), Transform3f(R, Vec3f::Zero()),
+                           &ball, Transform3f(Vec3f(1, 1, 0)), Transform3f(Vec3f(1, 1, 0)),
+                           result);
+  BOOST_CHECK(result.is_collide);
+  BOOST_CHECK(result.time_of_contact > 0 && result.time_of_contact < 0.5);
+
+  // The ball is out of reach of the bar.
+  checkContinuousCollision(&bar, Transform3f(), Transform3f(R, Vec3f::Zero()),
+                           &ball, Transform3f(Vec3f(2, 2, 0)), Transform3f(Vec3f(2, 2, 0)),
+                           result);
+  BOOST_CHECK(!result.is_collide);
+  BOOST_CHECK_EQUAL(result.time_of_contact, 1);
+
+  // Random motions.
+  std::vector<Transform3f> tf_beg, tf_end;
+  FCL_REAL extents[] = {-2, -2, -2, 2, 2, 2};
+  FCL_REAL delta_trans[] = {2, 2, 2};
+  generateRandomTransforms(extents, delta_trans, 0.5 * M_PI, tf_beg, tf_end, 50);
+  std::size_t num_collisions = 0;
+  for(std::size_t i = 0; i < tf_beg.size(); ++i)
+  {
+    checkContinuousCollision(&bar, tf_beg[i], tf_end[i],
+                             &ball, Transform3f(), Transform3f(),
+                             result);
+    if(result.is_collide) ++num_collisions;
+  }
+  BOOST_CHECK(num_collisions > 0);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_mesh)
+{
+  testMeshMesh<RSS>();
+  testMeshMesh<OBBRSS>();
+}
+
+BOOST_AUTO_TEST_CASE(collision_objects)
+{
+  CollisionGeometryPtr_t s1(new Sphere(1)), s2(new Sphere(1));
+  CollisionObject o1(s1, Transform3f());
+  CollisionObject o2(s2, Transform3f(Vec3f(5, 0, 0)));
+
+  ContinuousCollisionRequest request;
+  ContinuousCollisionResult result;
+  FCL_REAL t = continuousCollide(&o1, Transform3f(), &o2, Transform3f(Vec3f(-5, 0, 0)),
+                                 request, result);
+  BOOST_CHECK(result.is_collide);
+  BOOST_CHECK_CLOSE(t, 0.3, 1e-1);
+}
@@ -43,6 +43,8 @@
 #include <hpp/fcl/shape/convex.h>
 #include <hpp/fcl/collision.h>
 #include <hpp/fcl/distance.h>
+#include <hpp/fcl/narrowphase/gjk.h>
+#include <hpp/fcl/narrowphase/narrowphase.h>
 
 #include "utility.h"
 
@@ -106,6 +108,41 @@ Convex<Quadrilateral> buildBox (FCL_REAL l, FCL_REAL w, FCL_REAL d)
       );
 }
 
+/// Sphere tessellated with nlat parallels and nlon meridians.
+Convex<Triangle> buildSphere (FCL_REAL r, int nlat, int nlon)
+{
+  const int nv = 2 + (nlat - 1) * nlon;
+  const int nt = 2 * nlon * (nlat - 1);
+  Vec3f* pts = new Vec3f[nv];
+  Triangle* tris = new Triangle[nt];
+
+  pts[0] = Vec3f(0, 0,  r);
+  pts[1] = Vec3f(0, 0, -r);
+  for (int i = 1; i < nlat; ++i) {
+    FCL_REAL theta = M_PI * i / nlat;
+    for (int j = 0; j < nlon; ++j) {
+      FCL_REAL phi = 2 * M_PI * j / nlon;
+      pts[2 + (i-1) * nlon + j] = r * Vec3f(sin(theta) * cos(phi),
+          sin(theta) * sin(phi), cos(theta));
+    }
+  }
+
+  int k = 0;
+  for (int j = 0; j < nlon; ++j) {
+    int jn = (j + 1) % nlon;
+    tris[k++].set(0, 2 + j, 2 + jn);
+    tris[k++].set(1, 2 + (nlat-2) * nlon + jn, 2 + (nlat-2) * nlon + j);
+    for (int i = 1; i < nlat - 1; ++i) {
+      int a = 2 + (i-1) * nlon, b = 2 + i * nlon;
+      tris[k++].set(a + j, b + j , b + jn);
+      tris[k++].set(a + j, b + jn, a + jn);
+    }
+  }
+  assert (k == nt);
+
+  return Convex<Triangle> (true, pts, nv, tris, nt);
+}
+
 BOOST_AUTO_TEST_CASE(convex)
 {
   FCL_REAL l = 1, w = 1, d = 1;
@@ -238,3 +275,52 @@ BOOST_AUTO_TEST_CASE(compare_convex_box)
     compareShapeDistance    (box, convex_box, tf1, tf2);
   }
 }
+
+BOOST_AUTO_TEST_CASE(convex_support_hint)
+{
+  Convex<Triangle> sphere (buildSphere (1, 30, 40));
+  const int n = sphere.num_points;
+
+  for (int i = 0; i < 1000; ++i) {
+    Vec3f dir (Vec3f::Random());
+    FCL_REAL maxdot = -std::numeric_limits<FCL_REAL>::max();
+    for (int j = 0; j < n; ++j)
+      maxdot = std::max (maxdot, sphere.points[j].dot(dir));
+
+    // Any hint, even an invalid one, gives the support point.
+    int hints[] = { 0, i % n, (7 * i) % n, -1, n };
+    for (int j = 0; j < 5; ++j) {
+      int hint = hints[j];
+      Vec3f s = details::getSupport (&sphere, dir, false, hint);
+      BOOST_CHECK_CLOSE (s.dot(dir), maxdot, 1e-10);
+      BOOST_REQUIRE (hint >= 0 && hint < n);
+      BOOST_CHECK (sphere.points[hint] == s);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(convex_support_hint_gjk)
+{
+  Convex<Triangle> s1 (buildSphere (1, 30, 40)),
+                   s2 (buildSphere (2, 20, 30));
+
+  // The same solver is used for successive queries on a pair which moves
+  // slightly, so that the support searches are warm-started.
+  GJKSolver warm;
+  Transform3f tf1, tf2;
+  for (int i = 0; i < 200; ++i) {
+    FCL_REAL t = 0.01 * i;
+    tf1.setQuatRotation (Quaternion3f (Eigen::AngleAxis<FCL_REAL>
+          (t, Vec3f(0,0,1))));
+    tf2.setTranslation (Vec3f (4 * cos(t), 4 * sin(t), 0.5 * sin(3*t)));
+
+    GJKSolver cold;
+    FCL_REAL d_warm, d_cold;
+    Vec3f p1w, p2w, p1c, p2c, n;
+    BOOST_CHECK (warm.shapeDistance (s1, tf1, s2, tf2, d_warm, p1w, p2w, n));
+    BOOST_CHECK (cold.shapeDistance (s1, tf1, s2, tf2, d_cold, p1c, p2c, n));
+    BOOST_CHECK_CLOSE (d_warm, d_cold, 1e-4);
+    BOOST_CHECK (p1w.isApprox (p1c, 1e-4));
+    BOOST_CHECK (p2w.isApprox (p2c, 1e-4));
+  }
+}
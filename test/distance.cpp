@@ -46,6 +46,8 @@
 #include <hpp/fcl/internal/traversal_node_setup.h>
 #include "../src/collision_node.h"
 #include <hpp/fcl/internal/BV_splitter.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
 
 #include "utility.h"
 #include "fcl_resources/config.h"
@@ -333,6 +335,66 @@ BOOST_AUTO_TEST_CASE(mesh_distance)
   BOOST_TEST_MESSAGE("collision timing: " << col_time << " sec");
 }
 
+/// Check the queries with distance thresholds around the distance between
+/// o1 and o2.
+void checkDistanceThreshold(const CollisionGeometry* o1, const Transform3f& tf1,
+                            const CollisionGeometry* o2, const Transform3f& tf2)
+{
+  DistanceResult exact_result;
+  FCL_REAL exact = distance(o1, tf1, o2, tf2, DistanceRequest(), exact_result);
+  FCL_REAL factors[] = { 0.5, 0.99, 1.01, 2 };
+  for(int k = 0; k < 4; ++k)
+  {
+    DistanceRequest request;
+    request.distance_threshold = factors[k] * exact;
+    if(request.distance_threshold <= 0) continue;
+    DistanceResult result;
+    distance(o1, tf1, o2, tf2, request, result);
+    BOOST_CHECK_EQUAL(result.min_distance < request.distance_threshold,
+                      exact < request.distance_threshold);
+    BOOST_CHECK(result.min_distance
+                >= std::min(exact, request.distance_threshold) - DELTA);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(distance_threshold)
+{
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t1, t2;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "env.obj").string().c_str(), p1, t1);
+  loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
+
+  BVHModel<RSS> env, rob;
+  env.beginModel(); env.addSubModel(p1, t1); env.endModel();
+  rob.beginModel(); rob.addSubModel(p2, t2); rob.endModel();
+  Box box(100, 200, 300);
+  Cylinder cylinder(50, 200);
+  Sphere sphere1(100), sphere2(50);
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-3000, -3000, 0, 3000, 3000, 3000};
+  generateRandomTransforms(extents, transforms, 10);
+
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    const Transform3f& tf = transforms[i];
+    checkDistanceThreshold(&env, Transform3f(), &rob, tf);
+    checkDistanceThreshold(&env, Transform3f(), &box, tf);
+    checkDistanceThreshold(&box, Transform3f(), &cylinder, tf);
+    checkDistanceThreshold(&sphere1, Transform3f(), &sphere2, tf);
+  }
+
+  // The early break set by the caller on its solver is kept.
+  GJKSolver solver;
+  solver.setDistanceEarlyBreak(1e4);
+  DistanceRequest request;
+  request.distance_threshold = 10;
+  DistanceResult result;
+  distance(&box, Transform3f(), &cylinder, transforms[0], &solver, request, result);
+  BOOST_CHECK_EQUAL(solver.getDistanceEarlyBreak(), 1e4);
+}
+
 template<typename BV, typename TraversalNode>
 void distance_Test_Oriented(const Transform3f& tf,
                             const std::vector<Vec3f>& vertices1, const std::vector<Triangle>& triangles1,
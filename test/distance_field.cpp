@@ -0,0 +1,173 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, CNRS-LAAS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of CNRS-LAAS nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#define BOOST_TEST_MODULE FCL_DISTANCE_FIELD
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/fcl/distance_field.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
+
+#include "utility.h"
+
+using namespace hpp::fcl;
+
+/// Distance from a point outside an axis aligned box centered at the origin
+/// to the box.
+FCL_REAL boxDistance(const Box& box, const Vec3f& p)
+{
+  Vec3f d;
+  for(int i = 0; i < 3; ++i)
+    d[i] = std::max(std::abs(p[i]) - box.halfSide[i], 0.);
+  return d.norm();
+}
+
+BOOST_AUTO_TEST_CASE(mesh_field)
+{
+  Box box(0.6, 0.4, 0.3);
+  BVHModel<OBBRSS> mesh;
+  generateBVHModel(mesh, box, Transform3f());
+
+  const FCL_REAL voxel_size = 0.02, max_distance = 0.3;
+  DistanceField field(voxel_size, max_distance, true);
+  field.build(mesh);
+  BOOST_CHECK(field.numBlocks() > 0);
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-0.7, -0.6, -0.5, 0.7, 0.6, 0.5};
+  generateRandomTransforms(extents, transforms, 2000);
+
+  Sphere sphere(0.05);
+  std::size_t nexact = 0, nbound = 0;
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    const Vec3f& p = transforms[i].getTranslation();
+    FCL_REAL expected = boxDistance(box, p);
+    if(expected == 0)
+    {
+      // The interior of the mesh is not voxelized, only the voxels crossed
+      // by its triangles are obstacles.
+      continue;
+    }
+
+    FCL_REAL d = field.distance(p);
+    BOOST_CHECK(field.distanceLowerBound(p) <= expected);
+    if(expected < max_distance - 2 * voxel_size)
+      BOOST_CHECK_SMALL(d - expected, 2 * voxel_size);
+    else
+      BOOST_CHECK(d > max_distance - 4 * voxel_size);
+
+    Vec3f gradient;
+    FCL_REAL interpolated;
+    if(field.distance(p, interpolated, gradient)
+       && expected > 3 * voxel_size && expected < max_distance - 3 * voxel_size)
+    {
+      BOOST_CHECK_SMALL(interpolated - expected, 2 * voxel_size);
+      Vec3f direction;
+      for(int k = 0; k < 3; ++k)
+        direction[k] = (std::abs(p[k]) > box.halfSide[k])
+          ? (p[k] > 0 ? 1. : -1.) * (std::abs(p[k]) - box.halfSide[k]) : 0.;
+      BOOST_CHECK(gradient.normalized().dot(direction.normalized()) > 0.9);
+    }
+
+    bool exact;
+    FCL_REAL sd = field.conservativeDistance(sphere, transforms[i], 0, &exact);
+    if(expected <= sphere.radius)
+    {
+      // In collision, the exact distance must have been computed.
+      BOOST_CHECK(exact);
+      continue;
+    }
+    BOOST_CHECK(sd <= expected - sphere.radius + 1e-6);
+    if(exact)
+    {
+      BOOST_CHECK_SMALL(sd - (expected - sphere.radius), 1e-6);
+      ++nexact;
+    }
+    else
+    {
+      BOOST_CHECK(sd > 0);
+      ++nbound;
+    }
+  }
+  BOOST_CHECK(nexact > 0);
+  BOOST_CHECK(nbound > 0);
+
+  // Voxels on the surface are inside the obstacles.
+  BOOST_CHECK(field.distance(Vec3f(0.3 - 0.001, 0, 0)) < 0);
+}
+
+BOOST_AUTO_TEST_CASE(capsule_lower_bound)
+{
+  Box box(0.6, 0.4, 0.3);
+  BVHModel<OBBRSS> mesh;
+  generateBVHModel(mesh, box, Transform3f());
+
+  DistanceField field(0.02, 0.3);
+  field.build(mesh);
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1, -1, -1, 1, 1, 1};
+  generateRandomTransforms(extents, transforms, 500);
+
+  Capsule capsule(0.03, 0.3);
+  std::size_t nexact = 0;
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    DistanceRequest request;
+    DistanceResult result;
+    FCL_REAL expected = distance(&mesh, Transform3f(), &capsule, transforms[i],
+                                 request, result);
+    bool exact;
+    FCL_REAL d = field.conservativeDistance(capsule, transforms[i], 0.05,
+                                            &exact);
+    if(exact)
+    {
+      BOOST_CHECK_EQUAL(d, expected);
+      ++nexact;
+    }
+    else
+    {
+      BOOST_CHECK(d > 0.05);
+      BOOST_CHECK(d <= expected + 1e-6);
+    }
+  }
+  BOOST_CHECK(nexact > 0);
+  BOOST_CHECK(nexact < transforms.size());
+}
@@ -789,6 +789,37 @@ BOOST_AUTO_TEST_CASE(shapeIntersection_spheretriangle)
   BOOST_CHECK(isEqual(normal, transform.getRotation() * Vec3f(1, 0, 0), 1e-9));
 }
 
+BOOST_AUTO_TEST_CASE(shapeDistance_spheretriangle)
+{
+  // The closest point of the triangle to the center lies inside it.
+  Sphere s(1);
+  Vec3f t[3];
+  t[0] << 20, -10, 0;
+  t[1] << -20, -10, 0;
+  t[2] << 0, 20, 0;
+
+  Transform3f transform;
+  generateRandomTransform(extents, transform);
+
+  Vec3f c1, c2, normal;
+  FCL_REAL distance;
+  bool res;
+
+  res = solver1.shapeTriangleInteraction
+    (s, Transform3f(Vec3f(1, 2, 4)), t[0], t[1], t[2], Transform3f(),
+     distance, c1, c2, normal);
+  BOOST_CHECK(!res);
+  BOOST_CHECK_CLOSE(distance, 3, 1e-6);
+  BOOST_CHECK(isEqual(c2, Vec3f(1, 2, 0), 1e-9));
+
+  res = solver1.shapeTriangleInteraction
+    (s, transform * Transform3f(Vec3f(1, 2, -0.5)), t[0], t[1], t[2],
+     transform, distance, c1, c2, normal);
+  BOOST_CHECK(res);
+  BOOST_CHECK_CLOSE(distance, -0.5, 1e-6);
+  BOOST_CHECK(isEqual(c2, transform.transform(Vec3f(1, 2, 0)), 1e-9));
+}
+
 BOOST_AUTO_TEST_CASE(shapeIntersection_halfspacetriangle)
 {
   Halfspace hs(Vec3f(1, 0, 0), 0);
@@ -44,6 +44,11 @@
 #include <hpp/fcl/narrowphase/narrowphase.h>
 #include <hpp/fcl/shape/geometric_shapes.h>
 #include<hpp/fcl/internal/tools.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+
+#include <new>
+#include <cstdlib>
 
 using hpp::fcl::GJKSolver;
 using hpp::fcl::TriangleP;
@@ -52,6 +57,13 @@ using hpp::fcl::Quaternion3f;
 using hpp::fcl::Transform3f;
 using hpp::fcl::Matrix3f;
 using hpp::fcl::FCL_REAL;
+using hpp::fcl::Box;
+using hpp::fcl::Cylinder;
+using hpp::fcl::CollisionRequest;
+using hpp::fcl::CollisionResult;
+using hpp::fcl::DistanceRequest;
+using hpp::fcl::DistanceResult;
+using hpp::fcl::GJKCache;
 
 typedef Eigen::Matrix<FCL_REAL, Eigen::Dynamic, 1> vector_t;
 typedef Eigen::Matrix<FCL_REAL, 6, 1> vector6_t;
@@ -67,6 +79,30 @@ struct Result
 
 typedef std::vector <Result> Results_t;
 
+// Count the heap allocations made by the test executable.
+static std::size_t allocation_count = 0;
+
+void* operator new (std::size_t size)
+#if __cplusplus < 201103L
+  throw (std::bad_alloc)
+#endif
+{
+  ++allocation_count;
+  void* p = std::malloc (size == 0 ? 1 : size);
+  if (!p) throw std::bad_alloc ();
+  return p;
+}
+
+void operator delete (void* p)
+#if __cplusplus < 201103L
+  throw ()
+#else
+  noexcept
+#endif
+{
+  std::free (p);
+}
+
 BOOST_AUTO_TEST_CASE(distance_triangle_triangle_1)
 {
   Eigen::IOFormat numpy (Eigen::FullPrecision, Eigen::DontAlignCols, ", ",
@@ -288,3 +324,149 @@ BOOST_AUTO_TEST_CASE(distance_triangle_triangle_1)
   std::cerr << "-- No collisions -------------------------" << std::endl;
   std::cerr << "Total / average time gjk: " << totalTimeGjkNoColl << ", " << FCL_REAL(totalTimeGjkNoColl) / FCL_REAL(CLOCKS_PER_SEC*(N-nCol)) << "s" << std::endl;
 }
+
+BOOST_AUTO_TEST_CASE(gjk_epa_workspace_no_allocation)
+{
+  GJKSolver solver;
+  Box box (1, 1, 1);
+  Cylinder cylinder (0.5, 1);
+  Transform3f tf1, tf2 (Vec3f (0.6, 0.1, 0.2)), tf3 (Vec3f (3, 0, 0));
+  Vec3f P1 (0.1, -1, -1), P2 (0.1, 1, -1), P3 (0.1, 0, 1);
+  Vec3f contact, normal, p1, p2;
+  FCL_REAL depth, distance;
+
+  CollisionRequest request (hpp::fcl::CONTACT, 1);
+  CollisionResult result;
+
+  // The first penetration query allocates the EPA storage and the first
+  // contact allocates the contact vector of the result.
+  BOOST_CHECK (solver.shapeIntersect (box, tf1, cylinder, tf2,
+                                      &contact, &depth, &normal));
+  BOOST_CHECK (hpp::fcl::collide (&box, tf1, &cylinder, tf2, &solver,
+                                  request, result) > 0);
+
+  std::size_t before = allocation_count;
+  for (std::size_t i = 0; i < 100; ++i) {
+    bool collision = solver.shapeIntersect (box, tf1, cylinder, tf2,
+                                            &contact, &depth, &normal);
+    bool separated = solver.shapeDistance (box, tf1, cylinder, tf3,
+                                           distance, p1, p2, normal);
+    bool penetrating = !solver.shapeDistance (box, tf1, cylinder, tf2,
+                                              distance, p1, p2, normal);
+    bool triangle = solver.shapeTriangleInteraction (cylinder, tf1, P1, P2, P3,
+                                                     tf1, distance, p1, p2,
+                                                     normal);
+    result.clear ();
+    std::size_t num_contacts = hpp::fcl::collide
+      (&box, tf1, &cylinder, tf2, &solver, request, result);
+    if (!(collision && separated && penetrating && triangle
+          && num_contacts > 0)) {
+      BOOST_ERROR ("Unexpected narrow phase result");
+      break;
+    }
+  }
+  BOOST_CHECK_EQUAL (allocation_count - before, 0);
+}
+
+BOOST_AUTO_TEST_CASE(gjk_cache_bounded)
+{
+  GJKCache cache (3);
+  int o[4];
+  cache.insert (GJKCache::Key (&o[0], &o[1]));
+  cache.insert (GJKCache::Key (&o[0], &o[2]));
+  cache.insert (GJKCache::Key (&o[0], &o[1], 5));
+  BOOST_CHECK_EQUAL (cache.size (), 3);
+
+  // The least recently used entry is discarded.
+  BOOST_CHECK (cache.find (GJKCache::Key (&o[0], &o[1])) != NULL);
+  cache.insert (GJKCache::Key (&o[2], &o[3]));
+  BOOST_CHECK_EQUAL (cache.size (), 3);
+  BOOST_CHECK (cache.find (GJKCache::Key (&o[0], &o[2])) == NULL);
+  BOOST_CHECK (cache.find (GJKCache::Key (&o[0], &o[1])) != NULL);
+  BOOST_CHECK (cache.find (GJKCache::Key (&o[0], &o[1], 5)) != NULL);
+
+  cache.invalidate (GJKCache::Key (&o[0], &o[1], 5));
+  BOOST_CHECK_EQUAL (cache.size (), 2);
+  cache.invalidate (&o[1]);
+  BOOST_CHECK_EQUAL (cache.size (), 1);
+  BOOST_CHECK (cache.find (GJKCache::Key (&o[2], &o[3])) != NULL);
+
+  cache.setMaxSize (1);
+  cache.insert (GJKCache::Key (&o[3], &o[2]));
+  BOOST_CHECK_EQUAL (cache.size (), 1);
+  BOOST_CHECK (cache.find (GJKCache::Key (&o[3], &o[2])) != NULL);
+  cache.clear ();
+  BOOST_CHECK_EQUAL (cache.size (), 0);
+}
+
+BOOST_AUTO_TEST_CASE(gjk_seeded_simplex)
+{
+  using namespace hpp::fcl::details;
+  Box box (1, 2, 3);
+  Cylinder cylinder (0.5, 1);
+  Transform3f tf1, tf2 (Vec3f (2, 0.5, 0.2));
+
+  MinkowskiDiff shape;
+  shape.set (&box, &cylinder, tf1, tf2);
+  GJK gjk (128, 1e-6);
+  BOOST_CHECK_EQUAL (gjk.evaluate (shape, Vec3f (1, 0, 0)), GJK::Valid);
+  FCL_REAL distance (gjk.distance);
+
+  // Seeding with the final simplex converges immediately.
+  GJK::SimplexV seed[4];
+  GJK::vertex_id_t rank = gjk.getSimplex ()->rank;
+  for (GJK::vertex_id_t i = 0; i < rank; ++i)
+    seed[i] = *gjk.getSimplex ()->vertex[i];
+  gjk.reset (128, 1e-6);
+  BOOST_CHECK_EQUAL (gjk.evaluate (shape, seed, rank), GJK::Valid);
+  BOOST_CHECK_CLOSE (gjk.distance, distance, 1e-6);
+  BOOST_CHECK (gjk.getIterations () <= 1);
+
+  // Any point of the Minkowski difference is a valid seed, even in a
+  // degenerated simplex.
+  seed[0].w0 = Vec3f ( 0.5, 1, 1.5); seed[0].w1 = Vec3f (2, 0.5, 0.2);
+  seed[1] = seed[0];
+  seed[2].w0 = Vec3f (-0.5, 1, 1.5); seed[2].w1 = Vec3f (2, 0.5, 0.2);
+  gjk.reset (128, 1e-6);
+  BOOST_CHECK_EQUAL (gjk.evaluate (shape, seed, 3), GJK::Valid);
+  BOOST_CHECK_CLOSE (gjk.distance, distance, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(gjk_cache_warm_start)
+{
+  Box box (1, 2, 3);
+  Cylinder cylinder (0.5, 1);
+  GJKCache cache (16);
+  GJKSolver warm, cold;
+  warm.setGJKCache (&cache);
+
+  DistanceRequest request (true);
+  Transform3f tf1, tf2;
+  for (int i = 0; i < 200; ++i) {
+    FCL_REAL t = 0.02 * i;
+    tf1.setQuatRotation (Quaternion3f (Eigen::AngleAxis<FCL_REAL>
+          (t, Vec3f (0, 0, 1))));
+    // Separated, then penetrating.
+    tf2.setTranslation (Vec3f (2 - 0.009 * i, sin (t), 0.2));
+
+    DistanceResult rw, rc;
+    FCL_REAL dw = hpp::fcl::distance (&box, tf1, &cylinder, tf2, &warm,
+                                      request, rw);
+    FCL_REAL dc = hpp::fcl::distance (&box, tf1, &cylinder, tf2, &cold,
+                                      request, rc);
+    // Only compare the separated configurations: EPA is not accurate
+    // enough on curved shapes to compare penetration depths.
+    BOOST_CHECK_EQUAL (dw > 0, dc > 0);
+    if (dc > 0) {
+      BOOST_CHECK_SMALL (dw - dc, 1e-4);
+      // The closest points are not unique when faces are parallel.
+      BOOST_CHECK_CLOSE ((rw.nearest_points[1] - rw.nearest_points[0]).norm (),
+                         dw, 1e-4);
+    }
+  }
+  BOOST_CHECK_EQUAL (cache.size (), 1);
+  BOOST_CHECK (cache.find (GJKCache::Key (&box, &cylinder)) != NULL);
+
+  cache.invalidate (&box);
+  BOOST_CHECK_EQUAL (cache.size (), 0);
+}
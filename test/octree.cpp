@@ -37,14 +37,18 @@
 #define BOOST_TEST_MODULE FCL_OCTREE
 #define BOOST_TEST_DYN_LINK
 #include <fstream>
+#include <algorithm>
+#include <limits>
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 
 #include <hpp/fcl/BVH/BVH_model.h>
 #include <hpp/fcl/collision.h>
 #include <hpp/fcl/distance.h>
+#include <hpp/fcl/distance_field.h>
 #include <hpp/fcl/shape/geometric_shapes.h>
 #include <hpp/fcl/internal/BV_splitter.h>
+#include <hpp/fcl/internal/octree_voxel.h>
 
 #include "utility.h"
 #include "fcl_resources/config.h"
@@ -170,3 +174,442 @@ BOOST_AUTO_TEST_CASE (OCTREE)
     }
   }
 }
+
+// Compare the closed form kernels of the octree leaves with the narrow phase
+// solver on boxes, up to the tolerance of GJK.
+BOOST_AUTO_TEST_CASE (VOXEL_KERNELS)
+{
+  using hpp::fcl::details::Voxel;
+  hpp::fcl::GJKSolver solver;
+  hpp::fcl::Box box (0.6, 0.3, 0.4);
+  hpp::fcl::Sphere sphere (0.3);
+  hpp::fcl::Capsule capsule (0.2, 0.8);
+  hpp::fcl::AABB bv (Vec3f (0, 0, 0), Vec3f (0.5, 0.5, 0.5));
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1, -1, -1, 1.5, 1.5, 1.5};
+  std::size_t N = 1000;
+  generateRandomTransforms(extents, transforms, 2*N);
+
+  std::size_t collisions[] = { 0, 0, 0, 0 };
+  for (std::size_t i=0; i<N; ++i) {
+    Voxel voxel (bv, transforms [2*i]);
+    hpp::fcl::Box voxelBox;
+    Transform3f voxelTf;
+    voxel.toBox (voxelBox, voxelTf);
+    const Transform3f& tf (transforms [2*i+1]);
+
+    bool col = solver.shapeIntersect (voxelBox, voxelTf, box, tf, NULL, NULL, NULL);
+    BOOST_CHECK_EQUAL (col, hpp::fcl::details::voxelBoxIntersect (voxel, box, tf));
+    collisions [0] += col;
+
+    FCL_REAL dist, kernelDist;
+    Vec3f p1, p2, n, kp1, kp2, kn;
+    solver.shapeDistance (voxelBox, voxelTf, sphere, tf, dist, p1, p2, n);
+    bool disjoint = hpp::fcl::details::voxelSphereDistance
+      (voxel, sphere, tf, kernelDist, kp1, kp2, kn);
+    BOOST_CHECK_EQUAL (disjoint, dist > 0);
+    if (disjoint) {
+      BOOST_CHECK_SMALL (dist - kernelDist, 1e-5);
+      BOOST_CHECK_SMALL ((p1 - kp1).norm (), 1e-3);
+      BOOST_CHECK_SMALL ((kp2 - kp1).norm () - kernelDist, 1e-12);
+    } else {
+      ++collisions [1];
+    }
+
+    solver.shapeDistance (voxelBox, voxelTf, capsule, tf, dist, p1, p2, n);
+    disjoint = hpp::fcl::details::voxelCapsuleDistance
+      (voxel, capsule, tf, kernelDist, kp1, kp2, kn);
+    if (disjoint && kernelDist > 1e-6) {
+      BOOST_CHECK (dist > 0);
+      BOOST_CHECK_SMALL (dist - kernelDist, 1e-5);
+      BOOST_CHECK_SMALL ((kp2 - kp1).norm () - kernelDist, 1e-12);
+      BOOST_CHECK_SMALL ((kp2 - kp1).dot (kn) - kernelDist, 1e-12);
+    } else if (kernelDist < -1e-6) {
+      BOOST_CHECK (dist <= 0);
+    }
+    collisions [2] += !disjoint || kernelDist <= 0;
+
+    Vec3f P1 (tf.transform (Vec3f (0, 0, 0)));
+    Vec3f P2 (tf.transform (Vec3f (0.7, 0, 0)));
+    Vec3f P3 (tf.transform (Vec3f (0, 0.4, 0.1)));
+    col = solver.shapeTriangleInteraction (voxelBox, voxelTf, P1, P2, P3,
+        Transform3f (), dist, p1, p2, n);
+    if (std::abs (dist) > 1e-6) {
+      BOOST_CHECK_EQUAL (col, hpp::fcl::details::voxelTriangleIntersect
+          (voxel, P1, P2, P3));
+    }
+    collisions [3] += col;
+  }
+  for (int k = 0; k < 4; ++k) {
+    BOOST_CHECK (collisions [k] > 0);
+    BOOST_CHECK (collisions [k] < N);
+  }
+}
+
+void snapshotLeaves (const hpp::fcl::OcTreeSnapshot& snapshot, unsigned int id,
+                     const hpp::fcl::AABB& bv, std::vector<Vec3f>& centers)
+{
+  BOOST_CHECK (snapshot.isNodeOccupied (id) || id == snapshot.getRoot ());
+  if (!snapshot.nodeHasChildren (id)) {
+    if (snapshot.isNodeOccupied (id)) centers.push_back (bv.center ());
+    return;
+  }
+  for (unsigned int i = 0; i < 8; ++i) {
+    if (!snapshot.nodeChildExists (id, i)) continue;
+    hpp::fcl::AABB child_bv;
+    hpp::fcl::computeChildBV (bv, i, child_bv);
+    snapshotLeaves (snapshot, snapshot.getNodeChild (id, i), child_bv,
+                    centers);
+  }
+}
+
+bool lessVec3f (const Vec3f& a, const Vec3f& b)
+{
+  return std::lexicographical_compare (a.data (), a.data () + 3,
+                                       b.data (), b.data () + 3);
+}
+
+// The snapshot keeps the occupied leaves of the octomap tree and the
+// queries running on it agree with a brute force test of these leaves.
+BOOST_AUTO_TEST_CASE (OCTREE_SNAPSHOT)
+{
+  FCL_REAL resolution (0.1);
+  octomap::OcTreePtr_t octree (new octomap::OcTree (resolution));
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-2, -2, -2, 2, 2, 2};
+  generateRandomTransforms(extents, transforms, 2000);
+  for (std::size_t i = 0; i < transforms.size (); ++i) {
+    const Vec3f& t (transforms [i].getTranslation ());
+    octomap::point3d p ((float) t [0], (float) t [1], (float) t [2]);
+    octree->updateNode (p, i % 4 != 0);
+  }
+  octree->updateInnerOccupancy();
+  OcTree tree (octree);
+  const hpp::fcl::OcTreeSnapshot& snapshot (tree.getSnapshot ());
+  BOOST_REQUIRE (!snapshot.empty ());
+  BOOST_CHECK (snapshot.size () < octree->size ());
+
+  std::vector<Vec3f> centers;
+  snapshotLeaves (snapshot, snapshot.getRoot (), snapshot.getRootBV (),
+                  centers);
+  std::vector<boost::array<FCL_REAL, 6> > boxes (tree.toBoxes ());
+  BOOST_REQUIRE_EQUAL (centers.size (), boxes.size ());
+  std::vector<Vec3f> expected;
+  for (std::size_t i = 0; i < boxes.size (); ++i)
+    expected.push_back (Vec3f (boxes [i][0], boxes [i][1], boxes [i][2]));
+  std::sort (centers.begin (), centers.end (), lessVec3f);
+  std::sort (expected.begin (), expected.end (), lessVec3f);
+  for (std::size_t i = 0; i < centers.size (); ++i)
+    BOOST_CHECK_SMALL ((centers [i] - expected [i]).norm (), 1e-6);
+
+  hpp::fcl::Sphere sphere (0.15);
+  generateRandomTransforms(extents, transforms, 50);
+  for (std::size_t i = 0; i < transforms.size (); ++i) {
+    const Transform3f& tf (transforms [i]);
+    bool expectedCollision = false;
+    FCL_REAL expectedDistance = std::numeric_limits<FCL_REAL>::max ();
+    for (std::size_t j = 0; j < boxes.size (); ++j) {
+      hpp::fcl::Box box (boxes [j][3], boxes [j][3], boxes [j][3]);
+      Transform3f tfBox (Vec3f (boxes [j][0], boxes [j][1], boxes [j][2]));
+      hpp::fcl::AABB bv (tfBox.getTranslation () - box.halfSide,
+                         tfBox.getTranslation () + box.halfSide);
+      FCL_REAL d; Vec3f p1, p2, n;
+      hpp::fcl::details::voxelSphereDistance
+        (hpp::fcl::details::Voxel (bv, Transform3f ()), sphere, tf, d, p1, p2,
+         n);
+      expectedCollision = expectedCollision || d <= 0;
+      expectedDistance = std::min (expectedDistance, d);
+    }
+
+    CollisionRequest request;
+    CollisionResult result;
+    hpp::fcl::collide (&tree, Transform3f (), &sphere, tf, request, result);
+    BOOST_CHECK_EQUAL (result.isCollision (), expectedCollision);
+
+    hpp::fcl::DistanceRequest drequest;
+    hpp::fcl::DistanceResult dresult;
+    hpp::fcl::distance (&tree, Transform3f (), &sphere, tf, drequest,
+                        dresult);
+    if (!expectedCollision)
+      BOOST_CHECK_SMALL (dresult.min_distance - expectedDistance, 1e-6);
+  }
+}
+
+// Updating the octree rebuilds the snapshot from the previous one; it must
+// hold the same occupied leaves as a snapshot built from scratch.
+/// Check that the snapshot of tree matches a snapshot built from scratch.
+void checkSnapshot (const OcTree& tree, const octomap::OcTree& octree)
+{
+  hpp::fcl::OcTreeSnapshot expected (octree, tree.getOccupancyThres (),
+                                     tree.getFreeThres ());
+  const hpp::fcl::OcTreeSnapshot& snapshot (tree.getSnapshot ());
+  BOOST_REQUIRE (!snapshot.empty ());
+  BOOST_CHECK_EQUAL (snapshot.size (), expected.size ());
+  std::vector<Vec3f> leaves, expectedLeaves;
+  snapshotLeaves (snapshot, snapshot.getRoot (), snapshot.getRootBV (),
+                  leaves);
+  snapshotLeaves (expected, expected.getRoot (), expected.getRootBV (),
+                  expectedLeaves);
+  BOOST_REQUIRE_EQUAL (leaves.size (), expectedLeaves.size ());
+  std::sort (leaves.begin (), leaves.end (), lessVec3f);
+  std::sort (expectedLeaves.begin (), expectedLeaves.end (), lessVec3f);
+  for (std::size_t i = 0; i < leaves.size (); ++i)
+    BOOST_CHECK_SMALL ((leaves [i] - expectedLeaves [i]).norm (), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE (OCTREE_UPDATE)
+{
+  FCL_REAL resolution (0.1);
+  octomap::OcTreePtr_t octree (new octomap::OcTree (resolution));
+  OcTree tree (octree);
+  BOOST_CHECK (tree.isUpdatable ());
+  BOOST_CHECK (tree.getSnapshot ().empty ());
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-2, -2, -2, 2, 2, 2};
+  for (int k = 0; k < 5; ++k) {
+    generateRandomTransforms(extents, transforms, 300);
+    hpp::fcl::OcTreeUpdate batch;
+    std::vector<Vec3f> points;
+    for (std::size_t i = 0; i < transforms.size (); ++i) {
+      if (i % 10 == 0) batch.addFree (transforms [i].getTranslation ());
+      else points.push_back (transforms [i].getTranslation ());
+    }
+    batch.addPointCloud (points, Vec3f (0.05, 0.05, 0.05), 1.5);
+
+    hpp::fcl::OcTreeChanges changes;
+    tree.update (batch, &changes);
+    BOOST_REQUIRE (!changes.empty ());
+    BOOST_CHECK_EQUAL (changes.depth, octree->getTreeDepth () - 3);
+    BOOST_CHECK_SMALL (tree.getNodeBV (changes.keys [0], changes.depth).width ()
+                       - 8 * resolution, 1e-9);
+    checkSnapshot (tree, *octree);
+  }
+
+  // Once the voxels are clamped, applying the same misses again changes
+  // nothing.
+  hpp::fcl::OcTreeUpdate misses;
+  for (std::size_t i = 0; i < transforms.size (); i += 10)
+    misses.addFree (transforms [i].getTranslation ());
+  for (int k = 0; k < 20; ++k)
+    tree.update (misses);
+  hpp::fcl::OcTreeChanges changes;
+  tree.update (misses, &changes);
+  BOOST_CHECK (changes.empty ());
+  checkSnapshot (tree, *octree);
+
+  // Copies rebuild a snapshot that missed an update of the other one at
+  // their next update.
+  OcTree copy (tree);
+  generateRandomTransforms(extents, transforms, 100);
+  hpp::fcl::OcTreeUpdate batch1, batch2;
+  for (std::size_t i = 0; i < transforms.size (); ++i)
+    (i % 2 ? batch1 : batch2).addOccupied (transforms [i].getTranslation ());
+  tree.update (batch1);
+  checkSnapshot (tree, *octree);
+  copy.update (batch2);
+  checkSnapshot (copy, *octree);
+  tree.update (hpp::fcl::OcTreeUpdate ());
+  checkSnapshot (tree, *octree);
+
+  // An OcTree built separately on the same octomap tree is resynchronized
+  // with updateSnapshot.
+  OcTree other (octree);
+  tree.update (batch2);
+  other.updateSnapshot ();
+  checkSnapshot (other, *octree);
+  other.update (batch1);
+  checkSnapshot (other, *octree);
+
+  OcTree constTree
+    (boost::shared_ptr<const octomap::OcTree> (new octomap::OcTree (resolution)));
+  BOOST_CHECK (!constTree.isUpdatable ());
+  BOOST_CHECK_THROW (constTree.update (hpp::fcl::OcTreeUpdate ()),
+                     std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE (OCTREE_DISTANCE_FIELD)
+{
+  FCL_REAL resolution (0.1);
+  std::vector<Transform3f> transforms, queries;
+  FCL_REAL extents[] = {-1, -1, -1, 1, 1, 1};
+  generateRandomTransforms(extents, queries, 1000);
+  // The second voxel size does not divide the size of the changed subtrees.
+  FCL_REAL voxel_sizes[] = {0.05, 0.07};
+  for (int v = 0; v < 2; ++v) {
+    octomap::OcTreePtr_t octree (new octomap::OcTree (resolution));
+    OcTree tree (octree);
+    hpp::fcl::DistanceField field (voxel_sizes [v], 0.5, true);
+    for (int k = 0; k < 4; ++k) {
+      generateRandomTransforms(extents, transforms, 100);
+      hpp::fcl::OcTreeUpdate batch;
+      std::vector<Vec3f> points;
+      for (std::size_t i = 0; i < transforms.size (); ++i) {
+        if (k > 0 && i % 4 == 0)
+          batch.addFree (transforms [i].getTranslation ());
+        else points.push_back (transforms [i].getTranslation ());
+      }
+      batch.addPointCloud (points, Vec3f (0, 0, 0), 1.);
+
+      hpp::fcl::OcTreeChanges changes;
+      tree.update (batch, &changes);
+      if (k == 0) field.build (tree);
+      else field.update (tree, changes);
+
+      // The incrementally updated field matches a field built from scratch.
+      hpp::fcl::DistanceField expected (voxel_sizes [v], 0.5, true);
+      expected.build (tree);
+      for (std::size_t i = 0; i < queries.size (); ++i) {
+        const Vec3f& p (queries [i].getTranslation ());
+        BOOST_CHECK_SMALL (field.distance (p) - expected.distance (p), 1e-6);
+      }
+    }
+
+    // Occupied leaves are obstacles.
+    std::vector<Vec3f> leaves;
+    const hpp::fcl::OcTreeSnapshot& snapshot (tree.getSnapshot ());
+    snapshotLeaves (snapshot, snapshot.getRoot (), snapshot.getRootBV (),
+                    leaves);
+    BOOST_REQUIRE (!leaves.empty ());
+    for (std::size_t i = 0; i < leaves.size (); ++i)
+      BOOST_CHECK (field.distance (leaves [i]) <= 0);
+  }
+
+  // A voxel straddling the boundary of a changed subtree is freed with the
+  // leaf it overlaps, although its center lies in an unchanged subtree.
+  octomap::OcTreePtr_t octree (new octomap::OcTree (resolution));
+  OcTree tree (octree);
+  Vec3f point (0.75, 0.05, 0.05), p (0.78, 0.05, 0.05);
+  hpp::fcl::OcTreeUpdate hit, miss;
+  hit.addOccupied (point);
+  miss.addFree (point);
+  tree.update (hit);
+  hpp::fcl::DistanceField field (0.07, 0.5, true);
+  field.build (tree);
+  BOOST_CHECK (field.distance (p) <= 0);
+  for (int k = 0; k < 5; ++k) {
+    hpp::fcl::OcTreeChanges changes;
+    tree.update (miss, &changes);
+    field.update (tree, changes);
+  }
+  hpp::fcl::DistanceField expected (0.07, 0.5, true);
+  expected.build (tree);
+  BOOST_CHECK (expected.distance (p) > 0);
+  BOOST_CHECK_SMALL (field.distance (p) - expected.distance (p), 1e-6);
+  for (std::size_t i = 0; i < queries.size (); ++i) {
+    const Vec3f& q (queries [i].getTranslation ());
+    BOOST_CHECK_SMALL (field.distance (q) - expected.distance (q), 1e-6);
+  }
+}
+
+/// Octree with a solid cube of 4x4x4 voxels, whose voxels are hit a varying
+/// number of times so that octomap does not prune them, and scattered
+/// voxels.
+OcTree makePairOctree (FCL_REAL resolution, const Vec3f& corner,
+                       std::size_t n)
+{
+  octomap::OcTreePtr_t octree (new octomap::OcTree (resolution));
+  for (int x = 0; x < 4; ++x)
+    for (int y = 0; y < 4; ++y)
+      for (int z = 0; z < 4; ++z) {
+        Vec3f p (corner + resolution * Vec3f (x + .5, y + .5, z + .5));
+        for (int k = 0; k <= (x + y + z) % 3; ++k)
+          octree->updateNode (octomap::point3d ((float) p [0], (float) p [1],
+                                                (float) p [2]), true);
+      }
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-1, -1, -1, 1, 1, 1};
+  generateRandomTransforms(extents, transforms, n);
+  for (std::size_t i = 0; i < transforms.size (); ++i) {
+    const Vec3f& t (transforms [i].getTranslation ());
+    octree->updateNode (octomap::point3d ((float) t [0], (float) t [1],
+                                          (float) t [2]), true);
+  }
+  octree->updateInnerOccupancy();
+  return OcTree (octree);
+}
+
+// Collision and distance between two octrees agree with a brute force test
+// of their leaves, and stopping at a coarser depth is conservative.
+BOOST_AUTO_TEST_CASE (OCTREE_PAIR)
+{
+  FCL_REAL resolution (0.1);
+  OcTree tree1 (makePairOctree (resolution, Vec3f (0, 0, 0), 60));
+  OcTree tree2 (makePairOctree (resolution, Vec3f (-.2, .1, 0), 60));
+
+  const hpp::fcl::OcTreeSnapshot& snapshot (tree1.getSnapshot ());
+  std::size_t full = 0;
+  for (unsigned int id = 0; id < snapshot.size (); ++id)
+    if (snapshot.nodeHasChildren (id) && snapshot.isNodeFull (id)) ++full;
+  BOOST_CHECK (full > 0);
+
+  std::vector<boost::array<FCL_REAL, 6> > boxes1 (tree1.toBoxes ()),
+    boxes2 (tree2.toBoxes ());
+  hpp::fcl::GJKSolver solver;
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-.5, -.5, -.5, .5, .5, .5};
+  generateRandomTransforms(extents, transforms, 20);
+  std::vector<Transform3f> offsets;
+  FCL_REAL offsetExtents[] = {-2, -2, -2, 2, 2, 2};
+  generateRandomTransforms(offsetExtents, offsets, transforms.size ());
+  std::size_t collisions = 0;
+  for (std::size_t i = 0; i < transforms.size (); ++i) {
+    const Transform3f& tf1 (transforms [i]);
+    Transform3f tf2 (offsets [i]);
+    tf2.setTranslation (tf2.getTranslation () + tf1.getTranslation ());
+
+    bool expectedCollision = false;
+    FCL_REAL expectedDistance = std::numeric_limits<FCL_REAL>::max ();
+    for (std::size_t j = 0; j < boxes1.size (); ++j) {
+      hpp::fcl::Box box1 (boxes1 [j][3], boxes1 [j][3], boxes1 [j][3]);
+      Transform3f tfBox1 (tf1 * Transform3f
+                          (Vec3f (boxes1 [j][0], boxes1 [j][1], boxes1 [j][2])));
+      for (std::size_t k = 0; k < boxes2.size (); ++k) {
+        hpp::fcl::Box box2 (boxes2 [k][3], boxes2 [k][3], boxes2 [k][3]);
+        Transform3f tfBox2 (tf2 * Transform3f
+                            (Vec3f (boxes2 [k][0], boxes2 [k][1], boxes2 [k][2])));
+        Transform3f relative (tfBox1.inverseTimes (tfBox2));
+        if (!hpp::fcl::obbDisjoint (relative.getRotation (),
+                                    relative.getTranslation (),
+                                    box1.halfSide, box2.halfSide))
+          expectedCollision = true;
+        FCL_REAL d; Vec3f p1, p2, n;
+        solver.shapeDistance (box1, tfBox1, box2, tfBox2, d, p1, p2, n);
+        expectedDistance = std::min (expectedDistance, d);
+      }
+    }
+    if (expectedCollision) ++collisions;
+
+    CollisionRequest request;
+    CollisionResult result;
+    hpp::fcl::collide (&tree1, tf1, &tree2, tf2, request, result);
+    BOOST_CHECK_EQUAL (result.isCollision (), expectedCollision);
+
+    CollisionRequest contactRequest (hpp::fcl::CONTACT, 1);
+    result.clear ();
+    hpp::fcl::collide (&tree1, tf1, &tree2, tf2, contactRequest, result);
+    BOOST_CHECK_EQUAL (result.isCollision (), expectedCollision);
+
+    hpp::fcl::DistanceRequest drequest;
+    hpp::fcl::DistanceResult dresult;
+    hpp::fcl::distance (&tree1, tf1, &tree2, tf2, drequest, dresult);
+    if (!expectedCollision)
+      BOOST_CHECK_SMALL (dresult.min_distance - expectedDistance, 1e-6);
+
+    // Nodes 2 levels above the leaves are boxes of 4x4x4 voxels, which
+    // contain the leaves.
+    request.octree_max_depth = snapshot.getTreeDepth () - 2;
+    result.clear ();
+    hpp::fcl::collide (&tree1, tf1, &tree2, tf2, request, result);
+    BOOST_CHECK (result.isCollision () || !expectedCollision);
+
+    drequest.octree_max_depth = request.octree_max_depth;
+    dresult.clear ();
+    hpp::fcl::distance (&tree1, tf1, &tree2, tf2, drequest, dresult);
+    if (!expectedCollision)
+      BOOST_CHECK (dresult.min_distance <= expectedDistance + 1e-6);
+  }
+  BOOST_CHECK (collisions > 0);
+  BOOST_CHECK (collisions < transforms.size ());
+}
@@ -106,18 +106,35 @@ void collide(const std::vector<Transform3f>& tf,
   }
 }
 
+// Same as collide, using the batch interface of ComputeCollision.
+// Only the mean time per pose is measured.
+void collideBatch(const std::vector<Transform3f>& tf,
+                  const CollisionGeometry* o1,
+                  const CollisionGeometry* o2,
+                  const CollisionRequest& request,
+                  Results& results)
+{
+  std::vector<Transform3f> Id (tf.size());
+  Timer timer;
+  timer.start();
+  ComputeCollision compute (o1, o2);
+  compute (&tf[0], &Id[0], tf.size(), request, &results.rs[0]);
+  timer.stop();
+  results.times.setConstant(timer.getElapsedTimeInMicroSec() / (double)tf.size());
+}
+
 const char* sep = ", ";
 
 void printResultHeaders ()
 {
-  std::cout << "Type 1" << sep << "Type 2" << sep << "mean time" << sep << "time std dev" << sep << "min time" << sep << "max time" << std::endl;
+  std::cout << "Type 1" << sep << "Type 2" << sep << "mode" << sep << "mean time" << sep << "time std dev" << sep << "min time" << sep << "max time" << std::endl;
 }
 
-void printResults (const Geometry& g1, const Geometry& g2, const Results& rs)
+void printResults (const Geometry& g1, const Geometry& g2, const char* mode, const Results& rs)
 {
   double mean = rs.times.mean();
   double var = rs.times.cwiseAbs2().mean() - mean*mean;
-  std::cout << g1.type << sep << g2.type << sep << mean << sep << std::sqrt(var) << sep << rs.times.minCoeff() << sep << rs.times.maxCoeff() << std::endl;
+  std::cout << g1.type << sep << g2.type << sep << mode << sep << mean << sep << std::sqrt(var) << sep << rs.times.minCoeff() << sep << rs.times.maxCoeff() << std::endl;
 }
 
 #ifndef NDEBUG // if debug mode
@@ -245,7 +262,9 @@ int main(int argc, char** argv)
     printResultHeaders();
     Results results (Ntransform);
     collide(transforms, first.o.get(), second.o.get(), request, results);
-    printResults(first, second, results);
+    printResults(first, second, "loop", results);
+    collideBatch(transforms, first.o.get(), second.o.get(), request, results);
+    printResults(first, second, "batch", results);
   } else {
     FCL_REAL extents[] = {-limit, -limit, -limit, limit, limit, limit};
     generateRandomTransforms(extents, transforms, Ntransform);
@@ -279,7 +298,9 @@ int main(int argc, char** argv)
         if (!supportedPair(geoms[i].o.get(), geoms[j].o.get())) continue;
         Results results (Ntransform);
         collide(transforms, geoms[i].o.get(), geoms[j].o.get(), request, results);
-        printResults(geoms[i], geoms[j], results);
+        printResults(geoms[i], geoms[j], "loop", results);
+        collideBatch(transforms, geoms[i].o.get(), geoms[j].o.get(), request, results);
+        printResults(geoms[i], geoms[j], "batch", results);
       }
     }
   }
@@ -364,8 +364,11 @@ bool defaultDistanceFunction(CollisionObject* o1, CollisionObject* o2, void* cda
 
   if(cdata->done) { dist = result.min_distance; return true; }
 
-  distance(o1, o2, request, result);
-  
+  // Some pairs of shapes overwrite the result instead of updating it.
+  DistanceResult pair_result;
+  distance(o1, o2, request, pair_result);
+  result.update(pair_result);
+
   dist = result.min_distance;
 
   if(dist <= 0) return true; // in collision or in touch